@@ -3,47 +3,140 @@
 #include <stdlib.h>
 
 // C++ library headers
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <new> // For placement new
 #include <vector>
 #include <mutex>
 #include <condition_variable>
 #include <functional> // For std::bind
+#include <stdexcept>
+#include <iterator>
+#include <utility>
+
+#include "select_waiter.hpp"
+
+class Select;
 
 // Go-like channel
 // Partial credit: https://st.xorian.net/blog/2012/08/go-style-channel-in-c/
 template <typename T>
 class Channel {
+  public:
+    using Clock = std::chrono::steady_clock;
+
   private:
-    /* NOTE: Using vector to guarantee contiguous memory for data.
-     *       While the potential downside is the internal shifting of the
-     *       buffer when reading/erasing from the front, the contiguous
-     *       nature of vectors takes advantage of cache line locality,
-     *       minimizing the shifting overhead as reads/erases get larger.
+    /* NOTE: The buffer is a circular buffer (i.e. an array w/ wrap-around,
+     *       as in BoundedFIFO) of raw storage. Items are constructed in place
+     *       when written and destroyed when read, so T needn't be
+     *       default-constructible. Reads/erases from the front are O(1) and
+     *       never shift the backlog, and batch reads/writes are at most two
+     *       contiguous copies.
+     *       The buffer starts empty & doubles as needed, up to maxSize_, so
+     *       a channel only holds as many slots as its backlog has needed.
      */
     size_t maxSize_ = 65535; // Arbitrarily decided
-    std::vector<T> buf_;
+    T* buf_ = nullptr;
+    size_t bufCap_ = 0; // Number of slots allocated in buf_
+    size_t head_ = 0; // Index of oldest element in buf_
+    size_t size_ = 0; // Number of elements in buf_
+
+    // Slots allocated by the buffer's first growth
+    static constexpr size_t MIN_BUF_CAP = 16;
     std::mutex bufMtx_;
     std::condition_variable newData_;
     std::condition_variable freeSlot_;
     bool closed_ = false;
 
+    // Number of batch Put()s currently waiting for more than one free slot.
+    // If any exist, freeing a slot must wake all writers, not just one.
+    size_t nBatchWaiters_ = 0;
+
+    // Select() waiters blocked on this channel becoming readable/writable
+    SelectWaitList recvWaiters_;
+    SelectWaitList sendWaiters_;
+
     /* Helper function for Put()
-     * If the channel is full, wait until it has room to write.
+     * If the channel doesn't have 'nSlots' free slots, wait until it does
+     * (or until 'deadline', if non-NULL).
      * Should be called by a thread that has the lock.
      * Returns:
      *  - true if caller can proceed with writing to the channel
      *  - false otherwise (caller should give up trying to write)
      */
-    bool isWritable_(std::unique_lock<std::mutex>& lock, bool wait);
+    bool isWritable_(std::unique_lock<std::mutex>& lock, bool wait,
+                     size_t nSlots = 1,
+                     const Clock::time_point* deadline = nullptr);
+
+    /* Helper function for Get()
+     * If 'wait' is true, wait until the channel has data or is closed (or
+     * until 'deadline', if non-NULL).
+     * Should be called by a thread that has the lock.
+     */
+    void waitForData_(std::unique_lock<std::mutex>& lock, bool wait,
+                      const Clock::time_point* deadline = nullptr);
+
+    // Helpers for indexing into the circular buffer.
+    // Should be called by a thread that has the lock.
+    size_t wrap_(size_t idx) const;
+    size_t tailIdx_() const;
+
+    // Grows the buffer to hold at least 'nSlots' (<= maxSize_) items.
+    // Should be called by a thread that has the lock.
+    void reserve_(size_t nSlots);
+
+    // Helpers to copy/move in/out of the circular buffer, handling
+    // wrap-around. Items are moved out of the buffer; whether they're copied
+    // or moved in depends on the iterator type (e.g. std::move_iterator).
+    // Should be called by a thread that has the lock.
+    template <typename InputIt>
+    void pushBack_(InputIt items, const size_t n);
+    void popFront_(std::vector<T>& dst, const size_t n);
+    template <typename... Args>
+    void pushOne_(Args&&... args);
+    void popOne_(T& item);
+
+    // Common implementation of the single-item Put()s/Emplace()s and Get()s.
+    // putOne_() constructs the item from 'args' in its slot.
+    template <typename... Args>
+    bool putOne_(bool wait, const Clock::time_point* deadline,
+                 Args&&... args);
+    bool getOne_(T& item, bool wait,
+                 const Clock::time_point* deadline = nullptr);
+
+    // Common implementation of the batch Put()s
+    template <typename InputIt>
+    bool putBatch_(InputIt items, const size_t n, bool wait);
+
+    // Wakes writers after 'nFreed' slots have been freed.
+    // Should be called by a thread that has the lock.
+    void notifyFreed_(size_t nFreed);
+
+    /* Hooks for Select: attempt a non-blocking Get()/Put(), and if the
+     * channel isn't ready, register 'waiter' (if non-NULL) to be signalled
+     * w/ 'caseIdx' once it is. Done under one lock so no wake-up is lost.
+     */
+    enum class SelectResult { NOT_READY, DONE, CLOSED };
+    SelectResult selectRecv_(T& item, SelectWaiter* waiter, uint32_t caseIdx);
+    SelectResult selectSend_(const T& item, SelectWaiter* waiter,
+                             uint32_t caseIdx);
+    void selectDeregister_(const SelectWaiter* waiter);
+    void selectPassOn_(bool recv);
+    friend class Select;
 
     // Predicates for wait conditions
     bool exitGetWait_();
-    bool notFull_ ();
+    bool hasRoom_(size_t nSlots);
 
   public:
     Channel();
     Channel(size_t max);
     ~Channel();
 
+    Channel(const Channel&) = delete;
+    Channel& operator=(const Channel&) = delete;
+
     // Mimicking Go-style... capitalizing first letter of methods
     // Length (i.e. number of elements waiting in channel)
     size_t Len();
@@ -71,11 +164,61 @@ class Channel {
      */
     bool Put(const T& item, bool wait = true);
 
+    // Same as above, but moves 'item' into the channel
+    bool Put(T&& item, bool wait = true);
+
+    /* Constructs an item from 'args' directly in the channel's next free
+     * slot, blocking until there is one. No temporary is made or moved, but
+     * the item's constructor runs while holding the channel's lock.
+     * Returns false if the channel is closed (nothing is constructed).
+     */
+    template <typename... Args>
+    bool Emplace(Args&&... args);
+
+    // Same as above, but returns false instead of waiting if the channel is
+    // full
+    template <typename... Args>
+    bool TryEmplace(Args&&... args);
+
+    // Same as Emplace(), but gives up if there's no free space by the
+    // deadline (or within the timeout)
+    template <typename... Args>
+    bool EmplaceUntil(const Clock::time_point& deadline, Args&&... args);
+
+    template <typename Rep, typename Period, typename... Args>
+    bool EmplaceFor(const std::chrono::duration<Rep, Period>& timeout,
+                    Args&&... args);
+
+    /* Writes 'n' items into the channel.
+     *  - If 'wait' is false, the write is all-or-nothing: false is returned
+     *    if there isn't room for all 'n' items.
+     *  - If 'wait' is true, block until there's room for all 'n' items. If
+     *    'n' exceeds the channel's capacity, items are written in chunks of
+     *    at most Cap() as room frees up; if the channel is closed midway,
+     *    false is returned and only a prefix of 'items' will have been
+     *    written.
+     */
     bool Put(const T* const items, const size_t n, bool wait = true);
 
     bool Put(const std::vector<T>& items, bool wait = true);
 
-    /* Reads an item from the channel and stores it into 'item'.
+    // Same as above, but moves the items into the channel
+    bool Put(std::vector<T>&& items, bool wait = true);
+
+    /* Same as Put(item), but gives up if there's no free space by the
+     * deadline (or within the timeout).
+     * Returns false if the item was not written (timed out, or closed)
+     */
+    bool PutUntil(const T& item, const Clock::time_point& deadline);
+    bool PutUntil(T&& item, const Clock::time_point& deadline);
+
+    template <typename Rep, typename Period>
+    bool PutFor(const T& item,
+                const std::chrono::duration<Rep, Period>& timeout);
+    template <typename Rep, typename Period>
+    bool PutFor(T&& item, const std::chrono::duration<Rep, Period>& timeout);
+
+    /* Reads an item from the channel and moves it into 'item'.
      * If the channel is empty and 'wait' is true, block until an item exists.
      * Returns:
      *  - true if an item was successfully read
@@ -91,6 +234,38 @@ class Channel {
      *          using the IsClosed() method
      */
     size_t Get(std::vector<T>& dst, size_t n, bool wait = true);
+
+    /* Moves every element currently in the channel to the end of 'dst',
+     * under a single lock acquisition.
+     * If the channel is empty and 'wait' is true, block until an item exists.
+     * Returns the number of elements fetched
+     *  - NOTE: If 0 is returned, should check whether the channel is closed
+     *          using the IsClosed() method
+     */
+    size_t Drain(std::vector<T>& dst, bool wait = true);
+
+    /* Same as Get(item), but gives up if no item arrives by the deadline
+     * (or within the timeout).
+     * Returns false if an item was not read (timed out, or closed & empty)
+     */
+    bool GetUntil(T& item, const Clock::time_point& deadline);
+
+    template <typename Rep, typename Period>
+    bool GetFor(T& item, const std::chrono::duration<Rep, Period>& timeout);
+
+    /* Collects up to 'n' elements into 'dst', waiting until either 'n' have
+     * been read, the deadline passes (or the timeout elapses), or the
+     * channel is closed & drained. Useful for coalescing work into windows
+     * of bounded latency.
+     * Returns the number of elements fetched [0, n], i.e. whatever arrived
+     * before the deadline.
+     */
+    size_t GetUntil(std::vector<T>& dst, size_t n,
+                    const Clock::time_point& deadline);
+
+    template <typename Rep, typename Period>
+    size_t GetFor(std::vector<T>& dst, size_t n,
+                  const std::chrono::duration<Rep, Period>& timeout);
 };
 
 
@@ -101,28 +276,135 @@ template <typename T>
 Channel<T>::Channel() {}
 
 template <typename T>
-Channel<T>::Channel(size_t max) : maxSize_(max) {}
+Channel<T>::Channel(size_t max) : maxSize_(max) {
+  if (max == 0) {
+    throw std::invalid_argument("Channel capacity must be at least 1");
+  }
+}
 
 template <typename T>
-Channel<T>::~Channel() {}
+Channel<T>::~Channel() {
+  size_t nFirst = std::min(size_, bufCap_ - head_);
+  std::destroy(buf_ + head_, buf_ + head_ + nFirst);
+  std::destroy(buf_, buf_ + (size_ - nFirst));
+  std::allocator<T>().deallocate(buf_, bufCap_);
+}
 
 // Should be called when thread has lock
 // TODO: See re-entrant locks
 template <typename T>
 bool Channel<T>::exitGetWait_() {
-  return !buf_.empty() || closed_;
+  return size_ != 0 || closed_;
 }
 
 // Should be called when thread has lock
 template <typename T>
-bool Channel<T>::notFull_ () {
-  return buf_.size() < maxSize_;
+bool Channel<T>::hasRoom_(size_t nSlots) {
+  return maxSize_ - size_ >= nSlots || closed_;
+}
+
+// Equivalent to (idx % bufCap_) for idx < (2 * bufCap_), w/o the division
+template <typename T>
+inline size_t Channel<T>::wrap_(size_t idx) const {
+  return idx >= bufCap_ ? idx - bufCap_ : idx;
+}
+
+// Index of the next free slot
+template <typename T>
+inline size_t Channel<T>::tailIdx_() const {
+  return wrap_(head_ + size_);
+}
+
+template <typename T>
+void Channel<T>::reserve_(size_t nSlots) {
+  if (nSlots <= bufCap_) {
+    return;
+  }
+
+  size_t newCap = std::max(bufCap_ * 2, MIN_BUF_CAP);
+  newCap = std::max(std::min(newCap, maxSize_), nSlots);
+  T* newBuf = std::allocator<T>().allocate(newCap);
+
+  // Move the items over in order, so the oldest lands at index 0
+  size_t nFirst = std::min(size_, bufCap_ - head_);
+  std::uninitialized_move(buf_ + head_, buf_ + head_ + nFirst, newBuf);
+  std::uninitialized_move(buf_, buf_ + (size_ - nFirst), newBuf + nFirst);
+  std::destroy(buf_ + head_, buf_ + head_ + nFirst);
+  std::destroy(buf_, buf_ + (size_ - nFirst));
+  std::allocator<T>().deallocate(buf_, bufCap_);
+
+  buf_ = newBuf;
+  bufCap_ = newCap;
+  head_ = 0;
+}
+
+// Copies 'n' items to the back of the buffer. Assumes there is enough room.
+template <typename T>
+template <typename InputIt>
+inline void Channel<T>::pushBack_(InputIt items, const size_t n) {
+  reserve_(size_ + n);
+
+  // Copy up to the end of the array, then wrap around to the beginning
+  size_t tail = tailIdx_();
+  size_t nFirst = std::min(n, bufCap_ - tail);
+  InputIt mid = std::next(items, static_cast<ptrdiff_t>(nFirst));
+  std::uninitialized_copy(items, mid, buf_ + tail);
+  std::uninitialized_copy(mid,
+      std::next(mid, static_cast<ptrdiff_t>(n - nFirst)), buf_);
+  size_ += n;
+}
+
+// Appends 'n' items from the front of the buffer to 'dst', and removes them.
+// Assumes there are at least 'n' items.
+template <typename T>
+inline void Channel<T>::popFront_(std::vector<T>& dst, const size_t n) {
+  // Move up to the end of the array, then wrap around to the beginning
+  size_t nFirst = std::min(n, bufCap_ - head_);
+  dst.insert(dst.end(), std::make_move_iterator(buf_ + head_),
+             std::make_move_iterator(buf_ + head_ + nFirst));
+  dst.insert(dst.end(), std::make_move_iterator(buf_),
+             std::make_move_iterator(buf_ + (n - nFirst)));
+  std::destroy(buf_ + head_, buf_ + head_ + nFirst);
+  std::destroy(buf_, buf_ + (n - nFirst));
+  head_ = wrap_(head_ + n);
+  size_ -= n;
+}
+
+// Constructs an item from 'args' at the back of the buffer. Assumes there is
+// enough room.
+template <typename T>
+template <typename... Args>
+inline void Channel<T>::pushOne_(Args&&... args) {
+  reserve_(size_ + 1);
+  new (buf_ + tailIdx_()) T(std::forward<Args>(args)...);
+  size_++;
+}
+
+// Moves the front of the buffer into 'item', and removes it.
+// Assumes there is at least one item.
+template <typename T>
+inline void Channel<T>::popOne_(T& item) {
+  item = std::move(buf_[head_]);
+  buf_[head_].~T();
+  head_ = wrap_(head_ + 1);
+  size_--;
+}
+
+template <typename T>
+inline void Channel<T>::notifyFreed_(size_t nFreed) {
+  if (nBatchWaiters_ != 0) {
+    freeSlot_.notify_all();
+  } else {
+    freeSlot_.notify_one();
+  }
+
+  sendWaiters_.signal(nFreed);
 }
 
 template <typename T>
 size_t Channel<T>::Len() {
   std::unique_lock<std::mutex> lock(bufMtx_); // Needed?
-  return buf_.size();
+  return size_;
 }
 
 template <typename T>
@@ -138,6 +420,9 @@ void Channel<T>::Close() {
   std::unique_lock<std::mutex> lock(bufMtx_);
   closed_ = true;
   newData_.notify_all();
+  freeSlot_.notify_all();
+  recvWaiters_.signalAll();
+  sendWaiters_.signalAll();
 }
 
 template <typename T>
@@ -147,22 +432,36 @@ bool Channel<T>::IsClosed() {
 }
 
 /* Helper function for Put()
- * If the channel is full, wait until it has room to write.
+ * If the channel doesn't have 'nSlots' free slots, wait until it does.
  * Should be called by a thread that has the lock.
  * Returns:
  *  - true if caller can proceed with writing to the channel
  *  - false otherwise (caller should give up trying to write)
  */
 template <typename T>
-inline bool Channel<T>::isWritable_(std::unique_lock<std::mutex>& lock, bool wait) {
+inline bool Channel<T>::isWritable_(std::unique_lock<std::mutex>& lock,
+                                    bool wait, size_t nSlots,
+                                    const Clock::time_point* deadline) {
   if (closed_) {
     return false;
   }
 
-  if ( buf_.size() >= maxSize_ ) {
-    if (wait) {
-      freeSlot_.wait(lock, std::bind(&Channel<T>::notFull_, this));
+  if (maxSize_ - size_ < nSlots) {
+    if (!wait) {
+      return false;
+    }
+
+    bool hasRoom = true;
+    nBatchWaiters_ += (nSlots > 1);
+    if (deadline == nullptr) {
+      freeSlot_.wait(lock, std::bind(&Channel<T>::hasRoom_, this, nSlots));
     } else {
+      hasRoom = freeSlot_.wait_until(lock, *deadline,
+          std::bind(&Channel<T>::hasRoom_, this, nSlots));
+    }
+    nBatchWaiters_ -= (nSlots > 1);
+
+    if (!hasRoom || closed_) {
       return false;
     }
   }
@@ -170,6 +469,20 @@ inline bool Channel<T>::isWritable_(std::unique_lock<std::mutex>& lock, bool wai
   return true;
 }
 
+template <typename T>
+inline void Channel<T>::waitForData_(std::unique_lock<std::mutex>& lock,
+                                     bool wait,
+                                     const Clock::time_point* deadline) {
+  if (!wait) {
+    return;
+  } else if (deadline == nullptr) {
+    newData_.wait(lock, std::bind(&Channel<T>::exitGetWait_, this));
+  } else {
+    newData_.wait_until(lock, *deadline,
+        std::bind(&Channel<T>::exitGetWait_, this));
+  }
+}
+
 /* Writes 'item' into the channel. If the channel is full and 'wait' is
  * true, then block until there is free space in the channel to write.
  * Returns
@@ -185,13 +498,54 @@ inline bool Channel<T>::isWritable_(std::unique_lock<std::mutex>& lock, bool wai
  */
 template <typename T>
 bool Channel<T>::Put(const T& item, bool wait) {
+  return putOne_(wait, nullptr, item);
+}
+
+template <typename T>
+bool Channel<T>::Put(T&& item, bool wait) {
+  return putOne_(wait, nullptr, std::move(item));
+}
+
+template <typename T>
+template <typename... Args>
+bool Channel<T>::Emplace(Args&&... args) {
+  return putOne_(true, nullptr, std::forward<Args>(args)...);
+}
+
+template <typename T>
+template <typename... Args>
+bool Channel<T>::TryEmplace(Args&&... args) {
+  return putOne_(false, nullptr, std::forward<Args>(args)...);
+}
+
+template <typename T>
+template <typename... Args>
+bool Channel<T>::EmplaceUntil(const Clock::time_point& deadline,
+                              Args&&... args) {
+  return putOne_(true, &deadline, std::forward<Args>(args)...);
+}
+
+template <typename T>
+template <typename Rep, typename Period, typename... Args>
+bool Channel<T>::EmplaceFor(const std::chrono::duration<Rep, Period>& timeout,
+                            Args&&... args) {
+  return EmplaceUntil(Clock::now() +
+      std::chrono::duration_cast<Clock::duration>(timeout),
+      std::forward<Args>(args)...);
+}
+
+template <typename T>
+template <typename... Args>
+bool Channel<T>::putOne_(bool wait, const Clock::time_point* deadline,
+                         Args&&... args) {
   std::unique_lock<std::mutex> lock(bufMtx_);
 
-  if ( !isWritable_(lock, wait) ) {
+  if ( !isWritable_(lock, wait, 1, deadline) ) {
     return false;
   }
 
-  buf_.push_back(item);
+  pushOne_(std::forward<Args>(args)...);
+  recvWaiters_.signal(1);
   lock.unlock();
   newData_.notify_one();
 
@@ -200,15 +554,33 @@ bool Channel<T>::Put(const T& item, bool wait) {
 
 template <typename T>
 bool Channel<T>::Put(const T* const items, const size_t n, bool wait) {
-  std::unique_lock<std::mutex> lock(bufMtx_);
+  return putBatch_(items, n, wait);
+}
 
-  if ( !isWritable_(lock, wait) ) {
+template <typename T>
+template <typename InputIt>
+bool Channel<T>::putBatch_(InputIt items, const size_t n, bool wait) {
+  // W/o waiting, batches that can never fit are rejected outright, rather
+  // than written in part
+  if (!wait && n > maxSize_) {
     return false;
   }
 
-  buf_.insert(buf_.end(), items, items + n);
-  lock.unlock();
-  newData_.notify_one();
+  std::unique_lock<std::mutex> lock(bufMtx_);
+
+  size_t written = 0;
+  do {
+    // Batches that fit in the channel are written atomically
+    size_t nBatch = std::min(n - written, maxSize_);
+    if ( !isWritable_(lock, wait, nBatch) ) {
+      return false;
+    }
+
+    pushBack_(std::next(items, static_cast<ptrdiff_t>(written)), nBatch);
+    written += nBatch;
+    newData_.notify_one();
+    recvWaiters_.signal(nBatch);
+  } while (written < n);
 
   return true;
 }
@@ -218,7 +590,39 @@ bool Channel<T>::Put(const std::vector<T>& items, bool wait) {
   return this->Put(items.data(), items.size(), wait);
 }
 
-/* Reads an item from the channel and stores it into 'item'.
+template <typename T>
+bool Channel<T>::Put(std::vector<T>&& items, bool wait) {
+  return putBatch_(std::make_move_iterator(items.begin()), items.size(),
+                   wait);
+}
+
+template <typename T>
+bool Channel<T>::PutUntil(const T& item, const Clock::time_point& deadline) {
+  return putOne_(true, &deadline, item);
+}
+
+template <typename T>
+bool Channel<T>::PutUntil(T&& item, const Clock::time_point& deadline) {
+  return putOne_(true, &deadline, std::move(item));
+}
+
+template <typename T>
+template <typename Rep, typename Period>
+bool Channel<T>::PutFor(const T& item,
+                        const std::chrono::duration<Rep, Period>& timeout) {
+  return PutUntil(item, Clock::now() +
+      std::chrono::duration_cast<Clock::duration>(timeout));
+}
+
+template <typename T>
+template <typename Rep, typename Period>
+bool Channel<T>::PutFor(T&& item,
+                        const std::chrono::duration<Rep, Period>& timeout) {
+  return PutUntil(std::move(item), Clock::now() +
+      std::chrono::duration_cast<Clock::duration>(timeout));
+}
+
+/* Reads an item from the channel and moves it into 'item'.
  * If the channel is empty and 'wait' is true, block until an item exists.
  * Returns:
  *  - true if an item was successfully read
@@ -228,18 +632,21 @@ bool Channel<T>::Put(const std::vector<T>& items, bool wait) {
  */
 template <typename T>
 bool Channel<T>::Get(T& item, bool wait) {
+  return getOne_(item, wait);
+}
+
+template <typename T>
+bool Channel<T>::getOne_(T& item, bool wait,
+                         const Clock::time_point* deadline) {
   std::unique_lock<std::mutex> lock(bufMtx_);
-  if (wait) {
-    newData_.wait(lock, std::bind(&Channel<T>::exitGetWait_, this));
-  }
+  waitForData_(lock, wait, deadline);
 
-  if (buf_.empty()) {
+  if (size_ == 0) {
     return false;
   }
 
-  item = buf_.front();
-  buf_.erase(buf_.begin());
-  freeSlot_.notify_one();
+  popOne_(item);
+  notifyFreed_(1);
   return true;
 }
 
@@ -251,25 +658,147 @@ bool Channel<T>::Get(T& item, bool wait) {
 template <typename T>
 size_t Channel<T>::Get(std::vector<T>& dst, size_t n, bool wait) {
   std::unique_lock<std::mutex> lock(bufMtx_);
-  if (wait) {
-    newData_.wait(lock, std::bind(&Channel<T>::exitGetWait_, this));
-  }
+  waitForData_(lock, wait);
 
-  if (buf_.empty()) {
+  if (size_ == 0) {
     return 0;
   }
 
-  if (buf_.size() < n) {
-    n = buf_.size();
+  if (size_ < n) {
+    n = size_;
   }
 
-  // 'nElems' is simply 'n' casted to vector's 'difference_type'
-  auto nElems = static_cast<typename std::vector<T>::difference_type>(n);
+  popFront_(dst, n);
+  notifyFreed_(n);
+
+  return n;
+}
+
+/* Moves every element currently in the channel to the end of 'dst'
+ * Returns the number of elements fetched
+ *  - NOTE: If 0 is returned, should check whether the channel is closed
+ *          using the IsClosed() method
+ */
+template <typename T>
+size_t Channel<T>::Drain(std::vector<T>& dst, bool wait) {
+  std::unique_lock<std::mutex> lock(bufMtx_);
+  waitForData_(lock, wait);
+
+  size_t n = size_;
+  if (n == 0) {
+    return 0;
+  }
 
-  dst.insert(dst.end(), buf_.begin(), buf_.begin() + nElems);
-  buf_.erase(buf_.begin(), buf_.begin() + nElems);
-  freeSlot_.notify_one();
+  popFront_(dst, n);
+  notifyFreed_(n);
 
   return n;
 }
 
+template <typename T>
+bool Channel<T>::GetUntil(T& item, const Clock::time_point& deadline) {
+  return getOne_(item, true, &deadline);
+}
+
+template <typename T>
+template <typename Rep, typename Period>
+bool Channel<T>::GetFor(T& item,
+                        const std::chrono::duration<Rep, Period>& timeout) {
+  return GetUntil(item, Clock::now() +
+      std::chrono::duration_cast<Clock::duration>(timeout));
+}
+
+/* Collects up to 'n' elements into 'dst', until the deadline
+ * Returns the number of elements fetched [0, n]
+ */
+template <typename T>
+size_t Channel<T>::GetUntil(std::vector<T>& dst, size_t n,
+                            const Clock::time_point& deadline) {
+  std::unique_lock<std::mutex> lock(bufMtx_);
+
+  // Take whatever is available each time we wake, releasing the lock in
+  // between so producers can keep filling the channel
+  size_t nRead = 0;
+  while (nRead < n) {
+    waitForData_(lock, true, &deadline);
+    if (size_ == 0) {
+      break; // Timed out, or closed & drained
+    }
+
+    size_t nBatch = std::min(size_, n - nRead);
+    popFront_(dst, nBatch);
+    notifyFreed_(nBatch);
+    nRead += nBatch;
+
+    if (Clock::now() >= deadline) {
+      break;
+    }
+  }
+
+  return nRead;
+}
+
+template <typename T>
+template <typename Rep, typename Period>
+size_t Channel<T>::GetFor(std::vector<T>& dst, size_t n,
+                          const std::chrono::duration<Rep, Period>& timeout) {
+  return GetUntil(dst, n, Clock::now() +
+      std::chrono::duration_cast<Clock::duration>(timeout));
+}
+
+template <typename T>
+typename Channel<T>::SelectResult
+Channel<T>::selectRecv_(T& item, SelectWaiter* waiter, uint32_t caseIdx) {
+  std::unique_lock<std::mutex> lock(bufMtx_);
+  if (size_ != 0) {
+    popOne_(item);
+    notifyFreed_(1);
+    return SelectResult::DONE;
+  } else if (closed_) {
+    return SelectResult::CLOSED;
+  }
+
+  if (waiter != nullptr) {
+    recvWaiters_.add(waiter, caseIdx);
+  }
+  return SelectResult::NOT_READY;
+}
+
+template <typename T>
+typename Channel<T>::SelectResult
+Channel<T>::selectSend_(const T& item, SelectWaiter* waiter,
+                        uint32_t caseIdx) {
+  std::unique_lock<std::mutex> lock(bufMtx_);
+  if (closed_) {
+    return SelectResult::CLOSED;
+  } else if (size_ < maxSize_) {
+    pushOne_(item);
+    newData_.notify_one();
+    recvWaiters_.signal(1);
+    return SelectResult::DONE;
+  }
+
+  if (waiter != nullptr) {
+    sendWaiters_.add(waiter, caseIdx);
+  }
+  return SelectResult::NOT_READY;
+}
+
+template <typename T>
+void Channel<T>::selectDeregister_(const SelectWaiter* waiter) {
+  std::unique_lock<std::mutex> lock(bufMtx_);
+  recvWaiters_.remove(waiter);
+  sendWaiters_.remove(waiter);
+}
+
+// Wakes the next waiter for data ('recv') or a free slot, in place of one
+// that was signalled but took something from another channel instead
+template <typename T>
+void Channel<T>::selectPassOn_(bool recv) {
+  std::unique_lock<std::mutex> lock(bufMtx_);
+  if (recv) {
+    recvWaiters_.signal(1);
+  } else {
+    sendWaiters_.signal(1);
+  }
+}
@@ -0,0 +1,150 @@
+#pragma once
+// C library headers
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+// C++ library headers
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+// Thin wrappers around the Linux futex syscall, used by the lock-free
+// channel variants to sleep only when they genuinely have to (i.e. when
+// the ring is empty or full), rather than on every operation.
+namespace FutexUtils {
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+              "std::atomic<uint32_t> must be layout-compatible w/ uint32_t");
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "std::atomic<uint32_t> must be lock-free to be used as a futex");
+
+// Size to pad to in order to avoid false sharing between producer and
+// consumer state. Hard-coded since std::hardware_destructive_interference_size
+// is not consistently available across our compilers.
+static constexpr size_t CACHE_LINE_SIZE = 64;
+
+/* Blocks the caller while '*addr' == 'expected'.
+ * If 'timeout' is non-NULL, it is a relative timeout.
+ * May return spuriously; callers must re-check their wait condition.
+ */
+inline void wait(std::atomic<uint32_t>& addr, uint32_t expected,
+                 const struct timespec* timeout = nullptr) {
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(&addr), FUTEX_WAIT_PRIVATE,
+          expected, timeout, nullptr, 0);
+}
+
+// Wakes up to 'n' threads blocked in wait() on 'addr'
+inline void wake(std::atomic<uint32_t>& addr, int n) {
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(&addr), FUTEX_WAKE_PRIVATE,
+          n, nullptr, nullptr, 0);
+}
+
+inline void wakeAll(std::atomic<uint32_t>& addr) {
+  wake(addr, INT32_MAX);
+}
+
+// Hint to the CPU that we're in a spin-wait loop
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield" ::: "memory");
+#endif
+}
+
+// Spinning before sleeping only makes sense if the other side can make
+// progress on another core at the same time.
+inline bool shouldSpin() {
+  static const bool multiCore = std::thread::hardware_concurrency() > 1;
+  return multiCore;
+}
+
+/* Event count: lets multiple threads sleep until "something changed",
+ * without the notifier needing a lock, and without issuing wake-up
+ * syscalls when nobody is asleep.
+ *
+ * The futex word holds an epoch (upper bits) and a count of registered
+ * waiters (lower bits). Notifying bumps the epoch and removes the woken
+ * threads from the count, so back-to-back notifications before the woken
+ * threads get scheduled don't turn into redundant syscalls.
+ *
+ * Waiter protocol:
+ *   key = prepareWait();
+ *   if (condition is now satisfied) { cancelWait(key); ... }
+ *   else { wait(key); } // Then re-check condition, since wake-ups may be
+ *                       // spurious; if stillRegistered(key), may wait again
+ *
+ * Notifier protocol:
+ *   make condition true (e.g. publish an item); notify(n);
+ */
+class EventCount {
+  private:
+    static constexpr uint32_t WAITER_BITS = 12;
+    static constexpr uint32_t WAITER_MASK = (1U << WAITER_BITS) - 1;
+    static constexpr uint32_t EPOCH_INC = 1U << WAITER_BITS;
+
+    std::atomic<uint32_t> state_{0};
+
+  public:
+    uint32_t prepareWait() {
+      uint32_t prev = state_.fetch_add(1, std::memory_order_seq_cst);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      return prev & ~WAITER_MASK;
+    }
+
+    // Deregisters the caller, unless a notifier has already done so for it
+    void cancelWait(uint32_t key) {
+      uint32_t state = state_.load(std::memory_order_relaxed);
+      while ((state & ~WAITER_MASK) == key && (state & WAITER_MASK) != 0) {
+        if (state_.compare_exchange_weak(state, state - 1,
+                                         std::memory_order_relaxed)) {
+          return;
+        }
+      }
+    }
+
+    // True if no notification has happened since prepareWait() returned 'key'
+    bool stillRegistered(uint32_t key) const {
+      return (state_.load(std::memory_order_acquire) & ~WAITER_MASK) == key;
+    }
+
+    // Sleeps until notified. May return spuriously.
+    void wait(uint32_t key) {
+      uint32_t state = state_.load(std::memory_order_acquire);
+      if ((state & ~WAITER_MASK) == key) {
+        FutexUtils::wait(state_, state);
+      }
+    }
+
+    // Wakes up to 'n' waiters. The fence pairs w/ the one in prepareWait():
+    // either we observe the waiter, or the waiter observes our new state.
+    void notify(uint32_t n) {
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      uint32_t state = state_.load(std::memory_order_relaxed);
+      while ((state & WAITER_MASK) != 0) {
+        uint32_t nWake = std::min(n, state & WAITER_MASK);
+        uint32_t next = ((state & ~WAITER_MASK) + EPOCH_INC) |
+                        ((state & WAITER_MASK) - nWake);
+        if (state_.compare_exchange_weak(state, next,
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed)) {
+          wake(state_, static_cast<int>(nWake));
+          return;
+        }
+      }
+    }
+
+    void notifyAll() {
+      uint32_t state = state_.load(std::memory_order_relaxed);
+      while (!state_.compare_exchange_weak(state,
+                                           (state & ~WAITER_MASK) + EPOCH_INC,
+                                           std::memory_order_seq_cst,
+                                           std::memory_order_relaxed)) {}
+      wakeAll(state_);
+    }
+};
+
+} // FutexUtils namespace
@@ -0,0 +1,429 @@
+#pragma once
+// C library headers
+#include <stdlib.h>
+#include <stdint.h>
+
+// C++ library headers
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "futex.hpp"
+
+/* Multi-producer/multi-consumer variant of Channel.
+ *
+ * Exposes the same Put()/Get()/Close()/IsClosed() semantics as Channel, but
+ * is implemented as a lock-free bounded queue w/ a sequence number per slot
+ * (D. Vyukov's bounded MPMC queue). Producers and consumers only contend on
+ * a CAS of the enqueue/dequeue position, rather than all serializing on one
+ * mutex. Batch operations claim a run of consecutive slots w/ a single CAS.
+ *
+ * Threads spin briefly and then sleep on a futex only when the queue is
+ * empty (consumers) or full (producers).
+ *
+ * NOTE: The underlying ring is rounded up to the next power of 2 (minimum 2),
+ *       but the channel holds at most the requested capacity, as reported
+ *       by Cap().
+ */
+template <typename T>
+class MPMCChannel {
+  private:
+    static constexpr size_t CACHE_LINE = FutexUtils::CACHE_LINE_SIZE;
+
+    // Number of times to poll the queue before going to sleep on the futex
+    // (on multi-core machines only; see FutexUtils::shouldSpin())
+    static constexpr uint32_t SPIN_LIMIT = 1024;
+    const uint32_t spinLimit_ = FutexUtils::shouldSpin() ? SPIN_LIMIT : 0;
+
+    /* Each slot's sequence number encodes its state relative to a position:
+     *  - seq == pos:     Slot is free for the producer claiming 'pos'
+     *  - seq == pos + 1: Slot holds the item for the consumer claiming 'pos'
+     * After consuming, the slot is freed for the next lap (pos + capacity).
+     */
+    struct Slot {
+      std::atomic<size_t> seq;
+      T data;
+    };
+
+    // Requested capacity, and mask into the underlying ring (whose size is
+    // rounded up to a power of 2 so that indexing is a single AND).
+    const size_t maxSize_ = 65535;
+    const size_t mask_ = 0;
+    std::unique_ptr<Slot[]> slots_;
+
+    alignas(CACHE_LINE) std::atomic<size_t> enqueuePos_{0};
+    alignas(CACHE_LINE) std::atomic<size_t> dequeuePos_{0};
+
+    // Sleep/wake state, only touched when the queue is empty or full
+    alignas(CACHE_LINE) FutexUtils::EventCount dataEvent_;
+    alignas(CACHE_LINE) FutexUtils::EventCount spaceEvent_;
+    std::atomic<bool> closed_{false};
+
+    static size_t roundUpPow2_(size_t n);
+
+    /* Claims up to 'n' consecutive free (or ready) slots for writing (or
+     * reading), w/ a single CAS on the enqueue (or dequeue) position.
+     * If 'allOrNothing' is true, either all 'n' slots are claimed or none.
+     * Returns the number of slots claimed, and their starting position
+     * through 'start'.
+     */
+    size_t claimPut_(size_t n, bool allOrNothing, size_t& start);
+    size_t claimGet_(size_t n, size_t& start);
+
+    /* Block until the queue may have free slots / items, or the channel is
+     * closed. Uses the supplied 'attempt' functor to re-check the queue
+     * after announcing ourselves as a waiter (to avoid lost wake-ups).
+     * Returns the first non-zero value returned by 'attempt', or 0 if the
+     * channel is closed.
+     */
+    template <typename Attempt>
+    size_t waitFor_(FutexUtils::EventCount& event, Attempt&& attempt);
+
+  public:
+    MPMCChannel();
+    MPMCChannel(size_t max);
+    ~MPMCChannel();
+
+    MPMCChannel(const MPMCChannel&) = delete;
+    MPMCChannel& operator=(const MPMCChannel&) = delete;
+
+    // Length (i.e. number of elements waiting in channel)
+    //  - NOTE: This is a snapshot and may be stale by the time it's returned
+    size_t Len() const;
+
+    // Maximum capacity of channel
+    size_t Cap() const;
+
+    // Close the channel
+    void Close();
+
+    bool IsClosed() const;
+
+    /* Writes 'item' into the channel. If the channel is full and 'wait' is
+     * true, then block until there is free space in the channel to write.
+     * Returns
+     *  - true if the item was successfully written
+     *  - false if the item was not written (channel full w/ 'wait' false,
+     *    or channel closed)
+     */
+    bool Put(const T& item, bool wait = true);
+
+    /* Writes 'n' items into the channel.
+     *  - If 'wait' is false, the write is all-or-nothing: false is returned
+     *    if there isn't room for all 'n' items.
+     *  - If 'wait' is true, items are written in runs as room frees up. Runs
+     *    from concurrent producers may interleave. If the channel is closed
+     *    midway, false is returned and only a prefix of 'items' will have
+     *    been written.
+     */
+    bool Put(const T* const items, const size_t n, bool wait = true);
+
+    bool Put(const std::vector<T>& items, bool wait = true);
+
+    /* Reads an item from the channel and moves it into 'item'.
+     * If the channel is empty and 'wait' is true, block until an item exists.
+     * Returns:
+     *  - true if an item was successfully read
+     *  - false if an item was not read
+     *      - NOTE: If 'false' is returned, should check whether the channel
+     *              is closed using the IsClosed() method
+     */
+    bool Get(T& item, bool wait = true);
+
+    /* Reads at most 'n' elements and appends it to 'dst'
+     * Returns the number of elements fetched [0, n]
+     *  - NOTE: If 0 is returned, should check whether the channel is closed
+     *          using the IsClosed() method
+     */
+    size_t Get(std::vector<T>& dst, size_t n, bool wait = true);
+};
+
+
+/***************************************
+ * Definitions for class MPMCChannel
+ ***************************************/
+template <typename T>
+size_t MPMCChannel<T>::roundUpPow2_(size_t n) {
+  size_t pow2 = 2;
+  while (pow2 < n) {
+    pow2 <<= 1;
+  }
+
+  return pow2;
+}
+
+template <typename T>
+MPMCChannel<T>::MPMCChannel() : MPMCChannel(65535) {}
+
+template <typename T>
+MPMCChannel<T>::MPMCChannel(size_t max)
+    : maxSize_(max), mask_(roundUpPow2_(max) - 1) {
+  if (max == 0) {
+    throw std::invalid_argument("MPMCChannel capacity must be at least 1");
+  }
+
+  slots_.reset(new Slot[mask_ + 1]);
+  for (size_t i = 0; i <= mask_; i++) {
+    slots_[i].seq.store(i, std::memory_order_relaxed);
+  }
+}
+
+template <typename T>
+MPMCChannel<T>::~MPMCChannel() {}
+
+template <typename T>
+size_t MPMCChannel<T>::Len() const {
+  // Load dequeue position first; enqueue position can only have grown since
+  size_t deqPos = dequeuePos_.load(std::memory_order_acquire);
+  size_t enqPos = enqueuePos_.load(std::memory_order_acquire);
+  return std::min(enqPos - deqPos, maxSize_);
+}
+
+template <typename T>
+size_t MPMCChannel<T>::Cap() const {
+  return maxSize_;
+}
+
+template <typename T>
+void MPMCChannel<T>::Close() {
+  closed_.store(true, std::memory_order_seq_cst);
+
+  // Wake everyone so they re-check closed_
+  dataEvent_.notifyAll();
+  spaceEvent_.notifyAll();
+}
+
+template <typename T>
+bool MPMCChannel<T>::IsClosed() const {
+  return closed_.load(std::memory_order_acquire);
+}
+
+template <typename T>
+size_t MPMCChannel<T>::claimPut_(size_t n, bool allOrNothing, size_t& start) {
+  size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+  while (true) {
+    // Stay w/in the requested capacity, which may be less than the ring's
+    intptr_t used = static_cast<intptr_t>(
+        pos - dequeuePos_.load(std::memory_order_acquire));
+    if (used < 0) {
+      // Consumers are past our view of 'pos', so it's stale
+      pos = enqueuePos_.load(std::memory_order_relaxed);
+      continue;
+    }
+    size_t room = maxSize_ - std::min(static_cast<size_t>(used), maxSize_);
+    if (room == 0 || (allOrNothing && room < n)) {
+      return 0; // Full
+    }
+
+    // Count consecutive free slots, starting at 'pos'
+    size_t k = 0;
+    intptr_t dif = 0;
+    for (; k < std::min(n, room); k++) {
+      size_t seq = slots_[(pos + k) & mask_].seq.load(std::memory_order_acquire);
+      dif = static_cast<intptr_t>(seq - (pos + k));
+      if (dif != 0) {
+        break;
+      }
+    }
+
+    if (k == 0 || (allOrNothing && k < n)) {
+      if (dif < 0) {
+        return 0; // Full (slot still holds an item from the previous lap)
+      }
+
+      // Another producer claimed the slot; our view of 'pos' is stale
+      pos = enqueuePos_.load(std::memory_order_relaxed);
+      continue;
+    }
+
+    // On failure, 'pos' is updated to the current enqueue position
+    if (enqueuePos_.compare_exchange_weak(pos, pos + k,
+                                          std::memory_order_relaxed)) {
+      start = pos;
+      return k;
+    }
+  }
+}
+
+template <typename T>
+size_t MPMCChannel<T>::claimGet_(size_t n, size_t& start) {
+  size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+  while (true) {
+    // Count consecutive ready slots, starting at 'pos'
+    size_t k = 0;
+    intptr_t dif = 0;
+    for (; k < n; k++) {
+      size_t seq = slots_[(pos + k) & mask_].seq.load(std::memory_order_acquire);
+      dif = static_cast<intptr_t>(seq - (pos + k + 1));
+      if (dif != 0) {
+        break;
+      }
+    }
+
+    if (k == 0) {
+      if (dif < 0) {
+        return 0; // Empty (slot not yet written by a producer)
+      }
+
+      // Another consumer claimed the slot; our view of 'pos' is stale
+      pos = dequeuePos_.load(std::memory_order_relaxed);
+      continue;
+    }
+
+    // On failure, 'pos' is updated to the current dequeue position
+    if (dequeuePos_.compare_exchange_weak(pos, pos + k,
+                                          std::memory_order_relaxed)) {
+      start = pos;
+      return k;
+    }
+  }
+}
+
+template <typename T>
+template <typename Attempt>
+size_t MPMCChannel<T>::waitFor_(FutexUtils::EventCount& event,
+                                Attempt&& attempt) {
+  uint32_t spins = 0;
+  while (true) {
+    // Check closed_ before attempting: if closed after the final Put(),
+    // observing closed_ guarantees we also observe that Put()'s slot.
+    bool closed = closed_.load(std::memory_order_acquire);
+
+    size_t res = attempt();
+    if (res != 0) {
+      return res;
+    } else if (closed) {
+      return 0;
+    }
+
+    if (spins < spinLimit_) {
+      spins++;
+      FutexUtils::cpuRelax();
+      continue;
+    }
+
+    // Announce we're going to sleep, then re-check before actually sleeping.
+    // Keep sleeping until notified (i.e. no longer registered).
+    uint32_t key = event.prepareWait();
+    do {
+      closed = closed_.load(std::memory_order_acquire);
+      res = attempt();
+      if (res != 0 || closed) {
+        event.cancelWait(key);
+        return res;
+      }
+
+      event.wait(key);
+    } while (event.stillRegistered(key));
+  }
+}
+
+template <typename T>
+bool MPMCChannel<T>::Put(const T& item, bool wait) {
+  return this->Put(&item, 1, wait);
+}
+
+template <typename T>
+bool MPMCChannel<T>::Put(const T* const items, const size_t n, bool wait) {
+  if (closed_.load(std::memory_order_acquire)) {
+    return false;
+  } else if (n == 0) {
+    return true;
+  }
+
+  size_t written = 0;
+  while (written < n) {
+    size_t start = 0;
+    size_t nClaimed = claimPut_(n - written, !wait, start);
+    if (nClaimed == 0) {
+      if (!wait) {
+        return false;
+      }
+
+      nClaimed = waitFor_(spaceEvent_, [&]() {
+        return claimPut_(n - written, false, start);
+      });
+
+      if (nClaimed == 0) {
+        return false; // Closed
+      }
+    }
+
+    for (size_t i = 0; i < nClaimed; i++) {
+      Slot& slot = slots_[(start + i) & mask_];
+      slot.data = items[written + i];
+      slot.seq.store(start + i + 1, std::memory_order_release);
+    }
+
+    written += nClaimed;
+    dataEvent_.notify(static_cast<uint32_t>(nClaimed));
+  }
+
+  return true;
+}
+
+template <typename T>
+bool MPMCChannel<T>::Put(const std::vector<T>& items, bool wait) {
+  return this->Put(items.data(), items.size(), wait);
+}
+
+template <typename T>
+bool MPMCChannel<T>::Get(T& item, bool wait) {
+  size_t start = 0;
+  size_t nClaimed = claimGet_(1, start);
+  if (nClaimed == 0) {
+    if (!wait) {
+      return false;
+    }
+
+    nClaimed = waitFor_(dataEvent_, [&]() {
+      return claimGet_(1, start);
+    });
+
+    if (nClaimed == 0) {
+      return false; // Closed & drained
+    }
+  }
+
+  Slot& slot = slots_[start & mask_];
+  item = std::move(slot.data);
+  slot.seq.store(start + mask_ + 1, std::memory_order_release);
+  spaceEvent_.notify(1);
+
+  return true;
+}
+
+template <typename T>
+size_t MPMCChannel<T>::Get(std::vector<T>& dst, size_t n, bool wait) {
+  if (n == 0) {
+    return 0;
+  }
+
+  size_t start = 0;
+  size_t nClaimed = claimGet_(n, start);
+  if (nClaimed == 0) {
+    if (!wait) {
+      return 0;
+    }
+
+    nClaimed = waitFor_(dataEvent_, [&]() {
+      return claimGet_(n, start);
+    });
+
+    if (nClaimed == 0) {
+      return 0; // Closed & drained
+    }
+  }
+
+  for (size_t i = 0; i < nClaimed; i++) {
+    Slot& slot = slots_[(start + i) & mask_];
+    dst.push_back(std::move(slot.data));
+    slot.seq.store(start + i + mask_ + 1, std::memory_order_release);
+  }
+  spaceEvent_.notify(static_cast<uint32_t>(nClaimed));
+
+  return nClaimed;
+}
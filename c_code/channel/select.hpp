@@ -0,0 +1,288 @@
+#pragma once
+// C library headers
+#include <stdint.h>
+
+// C++ library headers
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "channel.hpp"
+#include "select_waiter.hpp"
+
+/* Go-like select over any number of Channels, of any element types.
+ *
+ * Cases are added once, and the Select can then be waited on repeatedly.
+ * Each Recv()/Send() returns the case's index, which is what the Wait*()
+ * methods return when that case fires:
+ *
+ *   Select sel;
+ *   const size_t DATA = sel.Recv(dataChan, msg);
+ *   const size_t CTRL = sel.Recv(ctrlChan, cmd);
+ *   const size_t STOP = sel.Recv(stopChan, dummy);
+ *
+ *   while (true) {
+ *     size_t idx = sel.WaitFor(std::chrono::milliseconds(100));
+ *     if (idx == DATA) { ... msg holds the item read ... }
+ *     else if (idx == STOP) { break; }
+ *     else if (idx == Select::NONE) { ... timed out ... }
+ *   }
+ *
+ * Waiting threads sleep on their own futex word and are registered w/ each
+ * channel; a channel becoming ready wakes exactly one registered waiter
+ * (see SelectWaiter), rather than every thread selecting on it.
+ *
+ * If several cases are ready at once, they're tried starting from a
+ * rotating position, so no single case can starve the others.
+ *
+ * NOTE: A Select object should only be waited on by one thread at a time.
+ *       The channels, and the items passed to Recv()/Send(), must outlive it.
+ */
+class Select {
+  public:
+    // Returned by Poll() if no case is ready, and by WaitFor()/WaitUntil()
+    // on timeout
+    static constexpr size_t NONE = SIZE_MAX;
+
+    Select() = default;
+    Select(const Select&) = delete;
+    Select& operator=(const Select&) = delete;
+
+    /* Adds a case that fires when an item is read from 'chan' into 'item',
+     * or when 'chan' is closed (and drained). If 'ok' is non-NULL, it's set
+     * to whether an item was actually read when the case fires.
+     * Returns the case's index.
+     */
+    template <typename T>
+    size_t Recv(Channel<T>& chan, T& item, bool* ok = nullptr);
+
+    /* Adds a case that fires when 'item' is written to 'chan', or when
+     * 'chan' is closed. If 'ok' is non-NULL, it's set to whether the item
+     * was actually written when the case fires.
+     * Returns the case's index.
+     */
+    template <typename T>
+    size_t Send(Channel<T>& chan, const T& item, bool* ok = nullptr);
+
+    // Blocks until a case fires, and returns its index
+    size_t Wait();
+
+    // Same as Wait(), but returns NONE if no case fires before the timeout
+    template <typename Rep, typename Period>
+    size_t WaitFor(const std::chrono::duration<Rep, Period>& timeout);
+
+    size_t WaitUntil(const std::chrono::steady_clock::time_point& deadline);
+
+    // Go's 'default' case: fires a ready case if there is one, else
+    // returns NONE immediately
+    size_t Poll();
+
+  private:
+    enum class Result { NOT_READY, FIRED };
+
+    class Case {
+      public:
+        virtual ~Case() {}
+
+        // Try to fire the case; if not ready, register 'waiter' (if
+        // non-NULL) to be signalled w/ 'caseIdx'
+        virtual Result attempt(SelectWaiter* waiter, uint32_t caseIdx) = 0;
+        virtual void deregister(const SelectWaiter* waiter) = 0;
+
+        // Passes a wake-up this case's channel spent on us on to its next
+        // registered waiter
+        virtual void passOn() = 0;
+    };
+
+    template <typename T>
+    class RecvCase;
+
+    template <typename T>
+    class SendCase;
+
+    std::vector<std::unique_ptr<Case>> cases_;
+    SelectWaiter waiter_;
+    size_t nextStart_ = 0; // Where the next scan of the cases starts
+
+    /* Tries each case once, starting at a rotating position. If 'waiter' is
+     * non-NULL, it's registered w/ every case that isn't ready; it's left
+     * registered only if no case fires.
+     * Returns the index of the case that fired, or NONE.
+     */
+    size_t scan_(SelectWaiter* waiter);
+
+    void deregister_(size_t nCases);
+    size_t wait_(const std::chrono::steady_clock::time_point* deadline);
+};
+
+
+/***************************************
+ * Definitions for the cases
+ ***************************************/
+template <typename T>
+class Select::RecvCase : public Select::Case {
+  private:
+    Channel<T>& chan_;
+    T& item_;
+    bool* ok_;
+
+  public:
+    RecvCase(Channel<T>& chan, T& item, bool* ok)
+      : chan_(chan), item_(item), ok_(ok) {}
+
+    Result attempt(SelectWaiter* waiter, uint32_t caseIdx) override {
+      auto res = chan_.selectRecv_(item_, waiter, caseIdx);
+      if (res == Channel<T>::SelectResult::NOT_READY) {
+        return Result::NOT_READY;
+      }
+
+      if (ok_ != nullptr) {
+        *ok_ = (res == Channel<T>::SelectResult::DONE);
+      }
+      return Result::FIRED;
+    }
+
+    void deregister(const SelectWaiter* waiter) override {
+      chan_.selectDeregister_(waiter);
+    }
+
+    void passOn() override {
+      chan_.selectPassOn_(true);
+    }
+};
+
+template <typename T>
+class Select::SendCase : public Select::Case {
+  private:
+    Channel<T>& chan_;
+    const T& item_;
+    bool* ok_;
+
+  public:
+    SendCase(Channel<T>& chan, const T& item, bool* ok)
+      : chan_(chan), item_(item), ok_(ok) {}
+
+    Result attempt(SelectWaiter* waiter, uint32_t caseIdx) override {
+      auto res = chan_.selectSend_(item_, waiter, caseIdx);
+      if (res == Channel<T>::SelectResult::NOT_READY) {
+        return Result::NOT_READY;
+      }
+
+      if (ok_ != nullptr) {
+        *ok_ = (res == Channel<T>::SelectResult::DONE);
+      }
+      return Result::FIRED;
+    }
+
+    void deregister(const SelectWaiter* waiter) override {
+      chan_.selectDeregister_(waiter);
+    }
+
+    void passOn() override {
+      chan_.selectPassOn_(false);
+    }
+};
+
+
+/***************************************
+ * Definitions for class Select
+ ***************************************/
+template <typename T>
+size_t Select::Recv(Channel<T>& chan, T& item, bool* ok) {
+  cases_.emplace_back(new RecvCase<T>(chan, item, ok));
+  return cases_.size() - 1;
+}
+
+template <typename T>
+size_t Select::Send(Channel<T>& chan, const T& item, bool* ok) {
+  cases_.emplace_back(new SendCase<T>(chan, item, ok));
+  return cases_.size() - 1;
+}
+
+inline size_t Select::scan_(SelectWaiter* waiter) {
+  const size_t nCases = cases_.size();
+  const size_t start = nCases == 0 ? 0 : nextStart_++ % nCases;
+
+  for (size_t i = 0; i < nCases; i++) {
+    size_t idx = start + i < nCases ? start + i : start + i - nCases;
+    if (cases_[idx]->attempt(waiter, static_cast<uint32_t>(idx)) ==
+        Result::FIRED) {
+      if (waiter != nullptr) {
+        // A case registered earlier in this scan may have already signalled
+        // us, spending its channel's wake-up on a waiter that won't take
+        // its item/slot. Stop further signals, & pass that one on.
+        uint32_t signalled = 0;
+        if (waiter->cancel(signalled)) {
+          cases_[signalled]->passOn();
+        }
+
+        // Undo the registrations made so far in this scan
+        for (size_t j = 0; j < i; j++) {
+          size_t prev = start + j < nCases ? start + j : start + j - nCases;
+          cases_[prev]->deregister(waiter);
+        }
+      }
+      return idx;
+    }
+  }
+
+  return NONE;
+}
+
+inline void Select::deregister_(size_t nCases) {
+  for (size_t i = 0; i < nCases; i++) {
+    cases_[i]->deregister(&waiter_);
+  }
+}
+
+inline size_t Select::wait_(
+    const std::chrono::steady_clock::time_point* deadline) {
+  while (true) {
+    waiter_.reset();
+    size_t idx = scan_(&waiter_);
+    if (idx != NONE) {
+      return idx;
+    }
+
+    // Registered w/ every channel; sleep until one of them signals us.
+    // Deregister before touching the channels again, so no channel can
+    // signal a waiter that's no longer waiting.
+    uint32_t signalled = 0;
+    bool woken = waiter_.wait(deadline, signalled);
+    deregister_(cases_.size());
+    if (!woken) {
+      return NONE;
+    }
+
+    // Whoever signalled us is most likely still ready. If not, another
+    // thread beat us to it (e.g. a plain Get()); look around once more
+    // before going back to sleep.
+    if (cases_[signalled]->attempt(nullptr, signalled) == Result::FIRED) {
+      return signalled;
+    }
+
+    idx = scan_(nullptr);
+    if (idx != NONE) {
+      return idx;
+    }
+  }
+}
+
+inline size_t Select::Wait() {
+  return wait_(nullptr);
+}
+
+template <typename Rep, typename Period>
+size_t Select::WaitFor(const std::chrono::duration<Rep, Period>& timeout) {
+  return WaitUntil(std::chrono::steady_clock::now() +
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout));
+}
+
+inline size_t Select::WaitUntil(
+    const std::chrono::steady_clock::time_point& deadline) {
+  return wait_(&deadline);
+}
+
+inline size_t Select::Poll() {
+  return scan_(nullptr);
+}
@@ -0,0 +1,160 @@
+#pragma once
+// C library headers
+#include <stdint.h>
+#include <time.h>
+
+// C++ library headers
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+#include "futex.hpp"
+
+/* A thread blocked in Select::Wait(). Each waiter sleeps on its own futex
+ * word, and registers itself w/ every channel it's waiting on. A channel
+ * that becomes ready signals only the first still-waiting waiter it has
+ * registered (rather than broadcasting), so exactly one thread wakes up per
+ * item/slot.
+ *
+ * The futex word doubles as the "who woke me" slot: the first channel to
+ * signal stores its case index, and later signals (from other channels) fail
+ * and move on to the channel's next waiter. A signal can thus never be lost
+ * on a waiter that's already been woken by someone else.
+ */
+class SelectWaiter {
+  private:
+    static constexpr uint32_t WAITING = 0;
+    static constexpr uint32_t TIMED_OUT = UINT32_MAX; // Or cancelled
+
+    std::atomic<uint32_t> state_{WAITING};
+
+  public:
+    // Re-arms the waiter. Must only be called while it's not registered
+    // w/ any channel.
+    void reset() {
+      state_.store(WAITING, std::memory_order_relaxed);
+    }
+
+    /* Marks the waiter as woken by case 'caseIdx' and wakes its thread.
+     * Returns false if the waiter was already woken (or timed out), in which
+     * case the caller should try to signal another waiter.
+     */
+    bool signal(uint32_t caseIdx) {
+      uint32_t expected = WAITING;
+      if (!state_.compare_exchange_strong(expected, caseIdx + 1,
+                                          std::memory_order_acq_rel)) {
+        return false;
+      }
+
+      FutexUtils::wake(state_, 1);
+      return true;
+    }
+
+    /* Stops the waiter from being signalled, e.g. once one of its cases has
+     * fired w/o sleeping. Returns true and stores the signalling case index
+     * in 'caseIdx' if a channel signalled it first, in which case that
+     * channel's wake-up was spent on it & should be passed on.
+     */
+    bool cancel(uint32_t& caseIdx) {
+      uint32_t state = WAITING;
+      if (state_.compare_exchange_strong(state, TIMED_OUT,
+                                         std::memory_order_acq_rel)) {
+        return false;
+      }
+
+      caseIdx = state - 1;
+      return true;
+    }
+
+    /* Blocks until signalled, or until 'deadline' (if non-NULL) passes.
+     * Returns true and stores the signalling case index in 'caseIdx' if
+     * signalled; false on timeout. Once this returns false, the waiter can't
+     * be signalled until reset().
+     */
+    bool wait(const std::chrono::steady_clock::time_point* deadline,
+              uint32_t& caseIdx) {
+      uint32_t state = state_.load(std::memory_order_acquire);
+      while (state == WAITING) {
+        if (deadline == nullptr) {
+          FutexUtils::wait(state_, WAITING);
+        } else {
+          auto now = std::chrono::steady_clock::now();
+          if (now >= *deadline) {
+            // Race the channels for the final say
+            if (state_.compare_exchange_strong(state, TIMED_OUT,
+                                               std::memory_order_acq_rel)) {
+              return false;
+            }
+            break; // Signalled just in time; 'state' holds the case
+          }
+
+          auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        *deadline - now).count();
+          struct timespec timeout;
+          timeout.tv_sec = ns / 1000000000;
+          timeout.tv_nsec = ns % 1000000000;
+          FutexUtils::wait(state_, WAITING, &timeout);
+        }
+
+        state = state_.load(std::memory_order_acquire);
+      }
+
+      caseIdx = state - 1;
+      return true;
+    }
+};
+
+/* A channel's list of waiters registered for one direction (i.e. waiting for
+ * data, or waiting for a free slot). Kept in registration order, so the
+ * longest-waiting thread is woken first.
+ *  - NOTE: Not thread-safe; should be accessed w/ the channel's lock held.
+ */
+class SelectWaitList {
+  private:
+    struct Entry {
+      SelectWaiter* waiter;
+      uint32_t caseIdx;
+    };
+
+    std::vector<Entry> entries_;
+
+  public:
+    bool empty() const {
+      return entries_.empty();
+    }
+
+    void add(SelectWaiter* waiter, uint32_t caseIdx) {
+      entries_.push_back({waiter, caseIdx});
+    }
+
+    void remove(const SelectWaiter* waiter) {
+      entries_.erase(std::remove_if(entries_.begin(), entries_.end(),
+                                    [waiter](const Entry& entry) {
+                                      return entry.waiter == waiter;
+                                    }),
+                     entries_.end());
+    }
+
+    /* Wakes up to 'n' waiters, one per item/slot that became available.
+     * Waiters are dropped from the list as they're visited: either they're
+     * woken here, or they were already woken elsewhere and will deregister
+     * themselves anyway.
+     */
+    void signal(size_t n) {
+      size_t nVisited = 0;
+      while (n > 0 && nVisited < entries_.size()) {
+        const Entry& entry = entries_[nVisited++];
+        if (entry.waiter->signal(entry.caseIdx)) {
+          n--;
+        }
+      }
+
+      entries_.erase(entries_.begin(),
+                     entries_.begin() + static_cast<ptrdiff_t>(nVisited));
+    }
+
+    void signalAll() {
+      signal(entries_.size());
+    }
+};
@@ -0,0 +1,388 @@
+#pragma once
+// C library headers
+#include <stdlib.h>
+#include <stdint.h>
+
+// C++ library headers
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "futex.hpp"
+
+/* Single-producer/single-consumer variant of Channel.
+ *
+ * Exposes the same Put()/Get()/Close()/IsClosed() semantics as Channel, but
+ * is implemented as a fixed-capacity ring buffer w/ the producer and consumer
+ * indices living on separate cache lines. In the common case (ring neither
+ * empty nor full), a Put() or Get() is a handful of loads/stores and no
+ * syscalls. Threads only fall back to sleeping on a futex when the ring is
+ * empty (consumer) or full (producer).
+ *
+ * NOTE: It is UNDEFINED BEHAVIOUR to call Put() from more than one thread,
+ *       or Get() from more than one thread, concurrently. Close() and the
+ *       query methods may be called from any thread.
+ */
+template <typename T>
+class SPSCChannel {
+  private:
+    static constexpr size_t CACHE_LINE = FutexUtils::CACHE_LINE_SIZE;
+
+    // Number of times to poll the ring before going to sleep on the futex
+    // (on multi-core machines only; see FutexUtils::shouldSpin())
+    static constexpr uint32_t SPIN_LIMIT = 1024;
+    const uint32_t spinLimit_ = FutexUtils::shouldSpin() ? SPIN_LIMIT : 0;
+
+    // Requested capacity, and mask into the underlying buffer (whose size is
+    // rounded up to a power of 2 so that indexing is a single AND).
+    const size_t maxSize_ = 65535;
+    const size_t mask_ = 0;
+    std::unique_ptr<T[]> buf_;
+
+    // Indices are monotonically increasing; slot = index & mask_
+
+    // Consumer-owned state (plus the consumer's cached view of tail_)
+    alignas(CACHE_LINE) std::atomic<size_t> head_{0};
+    size_t cachedTail_ = 0;
+
+    // Producer-owned state (plus the producer's cached view of head_)
+    alignas(CACHE_LINE) std::atomic<size_t> tail_{0};
+    size_t cachedHead_ = 0;
+
+    // Sleep/wake state, only touched when the ring is empty or full
+    alignas(CACHE_LINE) std::atomic<uint32_t> dataSeq_{0};
+    std::atomic<uint32_t> consumerWaiting_{0};
+    alignas(CACHE_LINE) std::atomic<uint32_t> spaceSeq_{0};
+    std::atomic<uint32_t> producerWaiting_{0};
+    std::atomic<bool> closed_{false};
+
+    static size_t roundUpPow2_(size_t n);
+
+    /* Helper functions for Put()/Get().
+     * Block until the ring has a free slot / an item, or the channel is
+     * closed. Should only be called by the producer / consumer respectively.
+     * Returns:
+     *  - true if caller can proceed with writing to / reading from the ring
+     *  - false otherwise (caller should give up)
+     */
+    bool waitForSpace_(size_t tail);
+    bool waitForData_(size_t head);
+
+    // Wake the other side, if (and only if) it is sleeping
+    void notifyConsumer_();
+    void notifyProducer_();
+
+  public:
+    SPSCChannel();
+    SPSCChannel(size_t max);
+    ~SPSCChannel();
+
+    SPSCChannel(const SPSCChannel&) = delete;
+    SPSCChannel& operator=(const SPSCChannel&) = delete;
+
+    // Length (i.e. number of elements waiting in channel)
+    //  - NOTE: This is a snapshot and may be stale by the time it's returned
+    size_t Len() const;
+
+    // Maximum capacity of channel
+    size_t Cap() const;
+
+    // Close the channel
+    void Close();
+
+    bool IsClosed() const;
+
+    /* Writes 'item' into the channel. If the channel is full and 'wait' is
+     * true, then block until there is free space in the channel to write.
+     * Returns
+     *  - true if the item was successfully written
+     *  - false if the item was not written (channel full w/ 'wait' false,
+     *    or channel closed)
+     */
+    bool Put(const T& item, bool wait = true);
+
+    /* Writes 'n' items into the channel.
+     *  - If 'wait' is false, the write is all-or-nothing: false is returned
+     *    if there isn't room for all 'n' items.
+     *  - If 'wait' is true, items are written as room frees up. If the channel
+     *    is closed midway, false is returned and only a prefix of 'items'
+     *    will have been written.
+     */
+    bool Put(const T* const items, const size_t n, bool wait = true);
+
+    bool Put(const std::vector<T>& items, bool wait = true);
+
+    /* Reads an item from the channel and moves it into 'item'.
+     * If the channel is empty and 'wait' is true, block until an item exists.
+     * Returns:
+     *  - true if an item was successfully read
+     *  - false if an item was not read
+     *      - NOTE: If 'false' is returned, should check whether the channel
+     *              is closed using the IsClosed() method
+     */
+    bool Get(T& item, bool wait = true);
+
+    /* Reads at most 'n' elements and appends it to 'dst'
+     * Returns the number of elements fetched [0, n]
+     *  - NOTE: If 0 is returned, should check whether the channel is closed
+     *          using the IsClosed() method
+     */
+    size_t Get(std::vector<T>& dst, size_t n, bool wait = true);
+};
+
+
+/***************************************
+ * Definitions for class SPSCChannel
+ ***************************************/
+template <typename T>
+size_t SPSCChannel<T>::roundUpPow2_(size_t n) {
+  size_t pow2 = 1;
+  while (pow2 < n) {
+    pow2 <<= 1;
+  }
+
+  return pow2;
+}
+
+template <typename T>
+SPSCChannel<T>::SPSCChannel() : SPSCChannel(65535) {}
+
+template <typename T>
+SPSCChannel<T>::SPSCChannel(size_t max)
+    : maxSize_(max), mask_(roundUpPow2_(max) - 1) {
+  if (max == 0) {
+    throw std::invalid_argument("SPSCChannel capacity must be at least 1");
+  }
+
+  buf_.reset(new T[mask_ + 1]);
+}
+
+template <typename T>
+SPSCChannel<T>::~SPSCChannel() {}
+
+template <typename T>
+size_t SPSCChannel<T>::Len() const {
+  // Load head first; tail can only have grown since
+  size_t head = head_.load(std::memory_order_acquire);
+  size_t tail = tail_.load(std::memory_order_acquire);
+  return tail - head;
+}
+
+template <typename T>
+size_t SPSCChannel<T>::Cap() const {
+  return maxSize_;
+}
+
+template <typename T>
+void SPSCChannel<T>::Close() {
+  closed_.store(true, std::memory_order_seq_cst);
+
+  // Bump both sequences so any thread about to sleep re-checks closed_
+  dataSeq_.fetch_add(1, std::memory_order_seq_cst);
+  FutexUtils::wakeAll(dataSeq_);
+  spaceSeq_.fetch_add(1, std::memory_order_seq_cst);
+  FutexUtils::wakeAll(spaceSeq_);
+}
+
+template <typename T>
+bool SPSCChannel<T>::IsClosed() const {
+  return closed_.load(std::memory_order_acquire);
+}
+
+// The fence pairs w/ the one in waitForData_(): either we observe the
+// consumer's waiting flag, or the consumer observes our new tail_.
+// The flag is cleared by whoever wakes the sleeper, so that subsequent
+// calls don't issue redundant wake-ups before the sleeper gets scheduled.
+template <typename T>
+inline void SPSCChannel<T>::notifyConsumer_() {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (consumerWaiting_.load(std::memory_order_relaxed) &&
+      consumerWaiting_.exchange(0, std::memory_order_relaxed)) {
+    dataSeq_.fetch_add(1, std::memory_order_release);
+    FutexUtils::wake(dataSeq_, 1);
+  }
+}
+
+template <typename T>
+inline void SPSCChannel<T>::notifyProducer_() {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (producerWaiting_.load(std::memory_order_relaxed) &&
+      producerWaiting_.exchange(0, std::memory_order_relaxed)) {
+    spaceSeq_.fetch_add(1, std::memory_order_release);
+    FutexUtils::wake(spaceSeq_, 1);
+  }
+}
+
+template <typename T>
+bool SPSCChannel<T>::waitForSpace_(size_t tail) {
+  uint32_t spins = 0;
+  while (true) {
+    if (closed_.load(std::memory_order_acquire)) {
+      return false;
+    }
+
+    cachedHead_ = head_.load(std::memory_order_acquire);
+    if (tail - cachedHead_ < maxSize_) {
+      return true;
+    }
+
+    if (spins < spinLimit_) {
+      spins++;
+      FutexUtils::cpuRelax();
+      continue;
+    }
+
+    // Announce we're going to sleep, then re-check before actually sleeping
+    uint32_t seq = spaceSeq_.load(std::memory_order_acquire);
+    producerWaiting_.store(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    cachedHead_ = head_.load(std::memory_order_acquire);
+    if (tail - cachedHead_ >= maxSize_ &&
+        !closed_.load(std::memory_order_acquire)) {
+      FutexUtils::wait(spaceSeq_, seq);
+    }
+    producerWaiting_.store(0, std::memory_order_relaxed);
+  }
+}
+
+template <typename T>
+bool SPSCChannel<T>::waitForData_(size_t head) {
+  uint32_t spins = 0;
+  while (true) {
+    // Check closed_ before tail_: if the producer closed after its final
+    // Put(), observing closed_ guarantees we also observe that final tail_.
+    bool closed = closed_.load(std::memory_order_acquire);
+
+    cachedTail_ = tail_.load(std::memory_order_acquire);
+    if (cachedTail_ != head) {
+      return true;
+    } else if (closed) {
+      return false;
+    }
+
+    if (spins < spinLimit_) {
+      spins++;
+      FutexUtils::cpuRelax();
+      continue;
+    }
+
+    // Announce we're going to sleep, then re-check before actually sleeping
+    uint32_t seq = dataSeq_.load(std::memory_order_acquire);
+    consumerWaiting_.store(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    cachedTail_ = tail_.load(std::memory_order_acquire);
+    if (cachedTail_ == head && !closed_.load(std::memory_order_acquire)) {
+      FutexUtils::wait(dataSeq_, seq);
+    }
+    consumerWaiting_.store(0, std::memory_order_relaxed);
+  }
+}
+
+template <typename T>
+bool SPSCChannel<T>::Put(const T& item, bool wait) {
+  if (closed_.load(std::memory_order_acquire)) {
+    return false;
+  }
+
+  size_t tail = tail_.load(std::memory_order_relaxed);
+  if (tail - cachedHead_ >= maxSize_) {
+    cachedHead_ = head_.load(std::memory_order_acquire);
+    if (tail - cachedHead_ >= maxSize_ &&
+        (!wait || !waitForSpace_(tail))) {
+      return false;
+    }
+  }
+
+  buf_[tail & mask_] = item;
+  tail_.store(tail + 1, std::memory_order_release);
+  notifyConsumer_();
+
+  return true;
+}
+
+template <typename T>
+bool SPSCChannel<T>::Put(const T* const items, const size_t n, bool wait) {
+  if (closed_.load(std::memory_order_acquire)) {
+    return false;
+  }
+
+  size_t tail = tail_.load(std::memory_order_relaxed);
+  if (!wait) {
+    cachedHead_ = head_.load(std::memory_order_acquire);
+    if (maxSize_ - (tail - cachedHead_) < n) {
+      return false;
+    }
+  }
+
+  size_t written = 0;
+  while (written < n) {
+    if (tail - cachedHead_ >= maxSize_) {
+      cachedHead_ = head_.load(std::memory_order_acquire);
+      if (tail - cachedHead_ >= maxSize_ && !waitForSpace_(tail)) {
+        return false;
+      }
+    }
+
+    size_t nFree = maxSize_ - (tail - cachedHead_);
+    size_t nBatch = std::min(nFree, n - written);
+    for (size_t i = 0; i < nBatch; i++) {
+      buf_[(tail + i) & mask_] = items[written + i];
+    }
+
+    tail += nBatch;
+    written += nBatch;
+    tail_.store(tail, std::memory_order_release);
+    notifyConsumer_();
+  }
+
+  return true;
+}
+
+template <typename T>
+bool SPSCChannel<T>::Put(const std::vector<T>& items, bool wait) {
+  return this->Put(items.data(), items.size(), wait);
+}
+
+template <typename T>
+bool SPSCChannel<T>::Get(T& item, bool wait) {
+  size_t head = head_.load(std::memory_order_relaxed);
+  if (head == cachedTail_) {
+    cachedTail_ = tail_.load(std::memory_order_acquire);
+    if (head == cachedTail_ && (!wait || !waitForData_(head))) {
+      return false;
+    }
+  }
+
+  item = std::move(buf_[head & mask_]);
+  head_.store(head + 1, std::memory_order_release);
+  notifyProducer_();
+
+  return true;
+}
+
+template <typename T>
+size_t SPSCChannel<T>::Get(std::vector<T>& dst, size_t n, bool wait) {
+  size_t head = head_.load(std::memory_order_relaxed);
+  cachedTail_ = tail_.load(std::memory_order_acquire);
+  if (head == cachedTail_ && (!wait || !waitForData_(head))) {
+    return 0;
+  }
+
+  if (cachedTail_ - head < n) {
+    n = cachedTail_ - head;
+  }
+
+  for (size_t i = 0; i < n; i++) {
+    dst.push_back(std::move(buf_[(head + i) & mask_]));
+  }
+
+  head_.store(head + n, std::memory_order_release);
+  notifyProducer_();
+
+  return n;
+}
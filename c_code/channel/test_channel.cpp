@@ -1,13 +1,21 @@
 #include "channel.hpp"
+#include "spsc_channel.hpp"
+#include "mpmc_channel.hpp"
+#include "select.hpp"
 #include "../gtest-extras/test_utils.hpp"
 
 #include <gtest/gtest.h>
 #include <gtest/gtest-spi.h>
 
 // C++ libs
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
 #include <thread>
 #include <vector>
 #include <memory>
+#include <string>
 
 // C libs
 #include <stdint.h>
@@ -15,7 +23,12 @@
 using std::vector;
 using std::unique_ptr;
 
-void producer(int n, Channel<uint8_t>& chan, bool close = true) {
+using namespace std::chrono;
+
+// Helpers below are templated over the channel type so the same scenarios
+// can be run against each Channel variant.
+template <typename Chan>
+void producer(int n, Chan& chan, bool close = true) {
   for (int i = 0; i < n; i++) {
     chan.Put((uint8_t)(i % 255));
   }
@@ -27,11 +40,12 @@ void producer(int n, Channel<uint8_t>& chan, bool close = true) {
   return;
 }
 
+template <typename Chan = Channel<uint8_t>>
 bool TestChanSize1() {
   int numItems = 2000;
-  Channel<uint8_t> byteChan(1);
+  Chan byteChan(1);
 
-  std::thread prod(producer, numItems, std::ref(byteChan), true);
+  std::thread prod(producer<Chan>, numItems, std::ref(byteChan), true);
 
   uint8_t val = 0;
   for (int i = 0; i < numItems; i++) {
@@ -48,10 +62,11 @@ bool TestChanSize1() {
   return true;
 }
 
+template <typename Chan = Channel<uint8_t>>
 bool TestChanSize1CloseMidway() {
   int numItems = 100;
-  Channel<uint8_t> byteChan(1);
-  std::thread prod(producer, numItems, std::ref(byteChan), true);
+  Chan byteChan(1);
+  std::thread prod(producer<Chan>, numItems, std::ref(byteChan), true);
 
   uint8_t val = 0;
   for (int i = 0; i < numItems * 2; i++) {
@@ -69,12 +84,13 @@ bool TestChanSize1CloseMidway() {
   return true;
 }
 
+template <typename Chan = Channel<uint8_t>>
 bool TestChanSize1NoClose() {
   int numItems = 10;
-  Channel<uint8_t> byteChan(1);
+  Chan byteChan(1);
 
   // Launch producer that doesn't close at end
-  std::thread prod(producer, numItems, std::ref(byteChan), false);
+  std::thread prod(producer<Chan>, numItems, std::ref(byteChan), false);
 
   uint8_t val = 0;
   for (int i = 0; i < numItems; i++) {
@@ -93,7 +109,8 @@ bool TestChanSize1NoClose() {
   return true;
 }
 
-void producerVec(size_t n, size_t nBatch, Channel<uint8_t>& chan, bool close = true) {
+template <typename Chan>
+void producerVec(size_t n, size_t nBatch, Chan& chan, bool close = true) {
   vector<uint8_t> block;
   for (size_t i = 0; i < n; i++) {
     block.push_back((uint8_t)(i % 255));
@@ -115,7 +132,8 @@ void producerVec(size_t n, size_t nBatch, Channel<uint8_t>& chan, bool close = t
   return;
 }
 
-void producerArr(size_t n, size_t nBatch, Channel<uint8_t>& chan, bool close = true) {
+template <typename Chan>
+void producerArr(size_t n, size_t nBatch, Chan& chan, bool close = true) {
   unique_ptr<uint8_t[]> block(new uint8_t[nBatch]);
   size_t i = 0;
   for (i = 0; i < n; i++) {
@@ -141,18 +159,19 @@ void producerArr(size_t n, size_t nBatch, Channel<uint8_t>& chan, bool close = t
 //  - Only affects producer side (currently no Channel::Get() w/ arrays)
 // If closeMidway == true, consumer (this func) attempts to Get() more items than produced
 // If prodClose == true, producer closes after it finishes; else it doesn't
+template <typename Chan = Channel<uint8_t>>
 bool TestChanSize100(bool useVec = true,
                       bool closeMidway = false,
                       bool prodClose = true) {
   size_t numItems = 1000, batchSize = 50;
-  Channel<uint8_t> byteChan(100);
+  Chan byteChan(100);
 
   std::thread prod;
   if (useVec) {
-    prod = std::thread(producerVec, numItems,
+    prod = std::thread(producerVec<Chan>, numItems,
         batchSize, std::ref(byteChan), prodClose);
   } else {
-    prod = std::thread(producerArr, numItems,
+    prod = std::thread(producerArr<Chan>, numItems,
         batchSize, std::ref(byteChan), prodClose);
   }
 
@@ -227,6 +246,927 @@ TEST(ChannelTest, ChanSize100) {
       "timed out");
 }
 
+// Average time of a single-item Get() while draining a channel holding
+// 'depth' items. The channel's ring buffer should keep this flat regardless
+// of the backlog depth.
+TEST(ChannelTest, GetLatencyVsBacklog) {
+  const size_t DEPTHS[] = {16, 256, 4096, 65535};
+  const size_t TOTAL_GETS = 1 << 20;
+
+  for (const size_t depth : DEPTHS) {
+    Channel<uint64_t> chan(depth);
+    vector<uint64_t> items(depth, 42);
+    const size_t numRounds = std::max<size_t>(1, TOTAL_GETS / depth);
+
+    uint64_t val = 0;
+    duration<double, std::nano> elapsed(0);
+    for (size_t round = 0; round < numRounds; round++) {
+      ASSERT_TRUE(chan.Put(items, false));
+
+      auto start = steady_clock::now();
+      for (size_t i = 0; i < depth; i++) {
+        chan.Get(val, false);
+      }
+      elapsed += steady_clock::now() - start;
+    }
+
+    ASSERT_TRUE(chan.Len() == 0);
+    std::cerr << "Backlog depth " << depth << ": average Get() "
+              << elapsed.count() / static_cast<double>(numRounds * depth)
+              << " ns\n";
+  }
+}
+
+TEST(ChannelTest, BatchWrapAround) {
+  Channel<uint8_t> byteChan(5);
+
+  // Advance head/tail so subsequent batches straddle the end of the buffer
+  vector<uint8_t> dst;
+  EXPECT_TRUE(byteChan.Put(vector<uint8_t>({0, 1, 2}), false));
+  EXPECT_TRUE(byteChan.Get(dst, 3, false) == 3);
+
+  EXPECT_TRUE(byteChan.Put(vector<uint8_t>({3, 4, 5, 6}), false));
+  EXPECT_FALSE(byteChan.Put(vector<uint8_t>({7, 8}), false)); // All-or-nothing
+  EXPECT_TRUE(byteChan.Put(vector<uint8_t>({7}), false));
+  EXPECT_TRUE(byteChan.Len() == 5);
+
+  EXPECT_TRUE(byteChan.Get(dst, 10, false) == 5);
+  EXPECT_TRUE(dst == vector<uint8_t>({0, 1, 2, 3, 4, 5, 6, 7}));
+
+  // Even when larger than the capacity
+  const uint8_t tooMany[6] = {0, 1, 2, 3, 4, 5};
+  EXPECT_FALSE(byteChan.Put(tooMany, 6, false));
+  EXPECT_TRUE(byteChan.Len() == 0);
+
+  // Batches larger than the capacity are written in chunks as room frees up
+  vector<uint8_t> big(23);
+  for (uint8_t i = 0; i < big.size(); i++) {
+    big[i] = i;
+  }
+
+  std::thread prod([&]() {
+    EXPECT_TRUE(byteChan.Put(big));
+    byteChan.Close();
+  });
+
+  dst.clear();
+  while (byteChan.Get(dst, 2) != 0) {}
+  prod.join();
+  EXPECT_TRUE(dst == big);
+}
+
+// Counts copies, to check that payloads can cross a channel w/o any
+struct CopyCounter {
+  static std::atomic<size_t> nCopies;
+  unique_ptr<vector<uint8_t>> payload;
+
+  CopyCounter() = default;
+  explicit CopyCounter(size_t sz) : payload(new vector<uint8_t>(sz)) {}
+  CopyCounter(const CopyCounter& other)
+    : payload(other.payload ? new vector<uint8_t>(*other.payload) : nullptr) {
+    nCopies++;
+  }
+  CopyCounter(CopyCounter&&) = default;
+  CopyCounter& operator=(const CopyCounter& other) {
+    payload.reset(other.payload ? new vector<uint8_t>(*other.payload)
+                                : nullptr);
+    nCopies++;
+    return *this;
+  }
+  CopyCounter& operator=(CopyCounter&&) = default;
+};
+std::atomic<size_t> CopyCounter::nCopies(0);
+
+TEST(ChannelTest, MoveSemantics) {
+  Channel<CopyCounter> chan(4);
+  CopyCounter::nCopies = 0;
+
+  CopyCounter item(1024);
+  const uint8_t* raw = item.payload->data();
+  ASSERT_TRUE(chan.Put(std::move(item)));
+  ASSERT_TRUE(chan.Emplace(size_t(64)));
+
+  vector<CopyCounter> batch;
+  batch.emplace_back(16);
+  batch.emplace_back(32);
+  ASSERT_TRUE(chan.Put(std::move(batch)));
+  EXPECT_EQ(chan.Len(), 4UL);
+
+  // Same heap buffer comes out the other end
+  CopyCounter out;
+  ASSERT_TRUE(chan.Get(out));
+  EXPECT_EQ(out.payload->data(), raw);
+
+  vector<CopyCounter> drained;
+  EXPECT_EQ(chan.Drain(drained), 3UL);
+  ASSERT_EQ(drained.size(), 3UL);
+  EXPECT_EQ(drained[0].payload->size(), 64UL);
+  EXPECT_EQ(drained[1].payload->size(), 16UL);
+  EXPECT_EQ(drained[2].payload->size(), 32UL);
+  EXPECT_EQ(chan.Len(), 0UL);
+  EXPECT_EQ(chan.Drain(drained, false), 0UL);
+
+  EXPECT_EQ(CopyCounter::nCopies.load(), 0UL);
+
+  // Move-only payloads work too
+  Channel<unique_ptr<int>> ptrChan(2);
+  ASSERT_TRUE(ptrChan.Put(unique_ptr<int>(new int(5))));
+  ASSERT_TRUE(ptrChan.Emplace(new int(6)));
+  unique_ptr<int> ptr;
+  ASSERT_TRUE(ptrChan.Get(ptr));
+  EXPECT_EQ(*ptr, 5);
+  ASSERT_TRUE(ptrChan.Get(ptr));
+  EXPECT_EQ(*ptr, 6);
+}
+
+// Counts live instances; has no default constructor
+struct LiveCounter {
+  static int nLive;
+  int val;
+
+  explicit LiveCounter(int v) : val(v) { nLive++; }
+  LiveCounter(const LiveCounter& other) : val(other.val) { nLive++; }
+  LiveCounter& operator=(const LiveCounter&) = default;
+  ~LiveCounter() { nLive--; }
+};
+int LiveCounter::nLive = 0;
+
+// Items are constructed as they're written & destroyed as they're read, and
+// the buffer grows (past wrap-around) w/o losing its order
+TEST(ChannelTest, ItemLifetime) {
+  {
+    Channel<LiveCounter> chan(40);
+    EXPECT_EQ(LiveCounter::nLive, 0);
+
+    // Wrap around the initial buffer before it grows
+    for (int i = 0; i < 10; i++) {
+      ASSERT_TRUE(chan.Put(LiveCounter(i), false));
+    }
+    vector<LiveCounter> dst;
+    EXPECT_EQ(chan.Get(dst, 8, false), 8UL);
+    dst.clear();
+    EXPECT_EQ(LiveCounter::nLive, 2);
+
+    vector<LiveCounter> batch;
+    for (int i = 10; i < 49; i++) {
+      batch.emplace_back(i);
+    }
+    EXPECT_FALSE(chan.Put(batch, false)); // All-or-nothing, past Cap()
+    batch.pop_back();
+    ASSERT_TRUE(chan.Put(batch, false));
+    EXPECT_EQ(chan.Len(), 40UL);
+    EXPECT_EQ(LiveCounter::nLive, 40 + 38);
+    batch.clear();
+
+    // Old & new items come out in order
+    EXPECT_EQ(chan.Get(dst, 20, false), 20UL);
+    for (int i = 0; i < 20; i++) {
+      EXPECT_EQ(dst[static_cast<size_t>(i)].val, i + 8);
+    }
+    dst.clear();
+    EXPECT_EQ(LiveCounter::nLive, 20);
+  }
+
+  // Whatever was left in the channel is destroyed w/ it
+  EXPECT_EQ(LiveCounter::nLive, 0);
+}
+
+// Counts constructions & moves; has no default constructor
+struct MoveCounter {
+  static int nBuilt;
+  static int nMoves;
+  int a, b;
+
+  MoveCounter(int a, int b) : a(a), b(b) { nBuilt++; }
+  MoveCounter(MoveCounter&& other) : a(other.a), b(other.b) { nMoves++; }
+  MoveCounter& operator=(MoveCounter&& other) {
+    a = other.a;
+    b = other.b;
+    nMoves++;
+    return *this;
+  }
+};
+int MoveCounter::nBuilt = 0;
+int MoveCounter::nMoves = 0;
+
+// Emplace()s construct the item in its slot, & nothing if they fail
+TEST(ChannelTest, Emplace) {
+  Channel<MoveCounter> chan(2);
+  EXPECT_TRUE(chan.Emplace(1, 2));
+  EXPECT_TRUE(chan.TryEmplace(3, 4));
+  EXPECT_EQ(MoveCounter::nBuilt, 2);
+  EXPECT_EQ(MoveCounter::nMoves, 0);
+
+  // Full
+  EXPECT_FALSE(chan.TryEmplace(5, 6));
+  EXPECT_FALSE(chan.EmplaceFor(milliseconds(20), 5, 6));
+  EXPECT_FALSE(chan.EmplaceUntil(Channel<int>::Clock::now(), 5, 6));
+  EXPECT_EQ(MoveCounter::nBuilt, 2);
+
+  // A waiting Emplace() goes through once there's room
+  std::thread prod([&chan]() {
+    EXPECT_TRUE(chan.EmplaceFor(seconds(1), 7, 8));
+  });
+  MoveCounter item(0, 0);
+  std::this_thread::sleep_for(milliseconds(20));
+  ASSERT_TRUE(chan.Get(item));
+  EXPECT_EQ(item.a, 1);
+  EXPECT_EQ(item.b, 2);
+  prod.join();
+  EXPECT_EQ(MoveCounter::nMoves, 1); // Only out of the channel
+
+  ASSERT_TRUE(chan.Get(item));
+  ASSERT_TRUE(chan.Get(item));
+  EXPECT_EQ(item.a, 7);
+  EXPECT_EQ(item.b, 8);
+
+  chan.Close();
+  MoveCounter::nBuilt = 0;
+  EXPECT_FALSE(chan.Emplace(9, 10));
+  EXPECT_EQ(MoveCounter::nBuilt, 0);
+}
+
+TEST(ChannelTest, DrainWrapAround) {
+  Channel<int> chan(5);
+  for (int i = 0; i < 4; i++) {
+    chan.Put(i);
+  }
+
+  int item = 0;
+  chan.Get(item);
+  chan.Get(item);
+  for (int i = 4; i < 7; i++) {
+    chan.Put(i); // Wraps around
+  }
+
+  vector<int> drained;
+  EXPECT_EQ(chan.Drain(drained), 5UL);
+  EXPECT_EQ(drained, (vector<int>{2, 3, 4, 5, 6}));
+
+  // Blocks until data arrives, or channel is closed
+  std::thread prod([&]() {
+    std::this_thread::sleep_for(milliseconds(10));
+    chan.Put(7);
+    chan.Close();
+  });
+  drained.clear();
+  ASSERT_DURATION_LE(1, EXPECT_EQ(chan.Drain(drained), 1UL));
+  ASSERT_DURATION_LE(1, EXPECT_EQ(chan.Drain(drained), 0UL));
+  EXPECT_TRUE(chan.IsClosed());
+  prod.join();
+}
+
+TEST(ChannelTest, TimedGetPut) {
+  Channel<int> chan(1);
+  int item = 0;
+
+  // Empty channel: Get times out
+  auto start = steady_clock::now();
+  EXPECT_FALSE(chan.GetFor(item, milliseconds(30)));
+  auto elapsed = steady_clock::now() - start;
+  EXPECT_GE(elapsed, milliseconds(30));
+  EXPECT_LT(elapsed, seconds(1));
+
+  // Full channel: Put times out
+  EXPECT_TRUE(chan.PutFor(1, milliseconds(30)));
+  start = steady_clock::now();
+  EXPECT_FALSE(chan.PutUntil(2, steady_clock::now() + milliseconds(30)));
+  elapsed = steady_clock::now() - start;
+  EXPECT_GE(elapsed, milliseconds(30));
+  EXPECT_LT(elapsed, seconds(1));
+
+  // Ready before the deadline
+  EXPECT_TRUE(chan.GetUntil(item, steady_clock::now() + seconds(1)));
+  EXPECT_EQ(item, 1);
+
+  std::thread prod([&]() {
+    std::this_thread::sleep_for(milliseconds(10));
+    chan.Put(3);
+  });
+  ASSERT_DURATION_LE(1, EXPECT_TRUE(chan.GetFor(item, seconds(5))));
+  EXPECT_EQ(item, 3);
+  prod.join();
+
+  // Closing wakes timed waiters early
+  std::thread closer([&]() {
+    std::this_thread::sleep_for(milliseconds(10));
+    chan.Close();
+  });
+  ASSERT_DURATION_LE(1, EXPECT_FALSE(chan.GetFor(item, seconds(5))));
+  closer.join();
+  EXPECT_FALSE(chan.PutFor(4, seconds(5)));
+}
+
+// Batch variant returns whatever arrived within the window
+TEST(ChannelTest, TimedBatchGet) {
+  Channel<int> chan(100);
+  vector<int> dst;
+
+  // Fills the batch before the deadline
+  for (int i = 0; i < 10; i++) {
+    chan.Put(i);
+  }
+  EXPECT_EQ(chan.GetFor(dst, 5, seconds(5)), 5UL);
+  EXPECT_EQ(dst, (vector<int>{0, 1, 2, 3, 4}));
+
+  // Partial batch: only 5 items left, the rest never arrive
+  dst.clear();
+  auto start = steady_clock::now();
+  EXPECT_EQ(chan.GetFor(dst, 8, milliseconds(30)), 5UL);
+  EXPECT_GE(steady_clock::now() - start, milliseconds(30));
+  EXPECT_EQ(dst, (vector<int>{5, 6, 7, 8, 9}));
+
+  // Items trickling in are coalesced into one batch
+  std::thread prod([&]() {
+    for (int i = 0; i < 4; i++) {
+      std::this_thread::sleep_for(milliseconds(5));
+      chan.Put(i);
+    }
+  });
+  dst.clear();
+  EXPECT_EQ(chan.GetUntil(dst, 4, steady_clock::now() + seconds(5)), 4UL);
+  EXPECT_EQ(dst, (vector<int>{0, 1, 2, 3}));
+  prod.join();
+
+  // Nothing arrives
+  dst.clear();
+  EXPECT_EQ(chan.GetFor(dst, 4, milliseconds(10)), 0UL);
+  EXPECT_TRUE(dst.empty());
+}
+
+TEST(SPSCChannelTest, ChanSize1) {
+  using Chan = SPSCChannel<uint8_t>;
+
+  // Normal operation
+  ASSERT_DURATION_LE(1, EXPECT_TRUE(TestChanSize1<Chan>()));
+
+  // Producer closes, consumer attempts Get()
+  ASSERT_DURATION_LE(1, EXPECT_FALSE(TestChanSize1CloseMidway<Chan>()));
+
+  // Producer doesn't close, consumer attempts Get()
+  EXPECT_FATAL_FAILURE(
+      ASSERT_DURATION_LE(1, TestChanSize1NoClose<Chan>()),
+      "timed out");
+}
+
+TEST(SPSCChannelTest, ChanSize100) {
+  using Chan = SPSCChannel<uint8_t>;
+
+  // Normal operation using vectors & arrays
+  ASSERT_DURATION_LE(1, EXPECT_TRUE(TestChanSize100<Chan>(true, false, true)));
+  ASSERT_DURATION_LE(1, EXPECT_TRUE(TestChanSize100<Chan>(false, false, true)));
+
+  // Producer closes, consumer attempts Get()
+  ASSERT_DURATION_LE(1, EXPECT_FALSE(TestChanSize100<Chan>(true, true, true)));
+  ASSERT_DURATION_LE(1, EXPECT_FALSE(TestChanSize100<Chan>(false, true, true)));
+
+  // Producer doesn't close, consumer attempts Get()
+  EXPECT_FATAL_FAILURE(
+      ASSERT_DURATION_LE(1,
+          EXPECT_TRUE(TestChanSize100<Chan>(true, true, false))),
+      "timed out");
+}
+
+TEST(SPSCChannelTest, NonBlocking) {
+  SPSCChannel<uint8_t> byteChan(3);
+  EXPECT_TRUE(byteChan.Cap() == 3);
+
+  uint8_t val = 0;
+  EXPECT_FALSE(byteChan.Get(val, false)); // Empty
+
+  EXPECT_TRUE(byteChan.Put(1, false));
+  EXPECT_TRUE(byteChan.Put(2, false));
+  EXPECT_TRUE(byteChan.Put(3, false));
+  EXPECT_FALSE(byteChan.Put(4, false)); // Full (even though ring is 4 slots)
+  EXPECT_TRUE(byteChan.Len() == 3);
+
+  // All-or-nothing batch write when not waiting
+  uint8_t arr[2] = {4, 5};
+  EXPECT_TRUE(byteChan.Get(val, false) && val == 1);
+  EXPECT_FALSE(byteChan.Put(arr, 2, false));
+  EXPECT_TRUE(byteChan.Put(arr, 1, false));
+
+  vector<uint8_t> dst;
+  EXPECT_TRUE(byteChan.Get(dst, 10, false) == 3);
+  EXPECT_TRUE(dst == vector<uint8_t>({2, 3, 4}));
+
+  // Closed channel rejects writes, but remaining items are still readable
+  EXPECT_TRUE(byteChan.Put(6, false));
+  byteChan.Close();
+  EXPECT_TRUE(byteChan.IsClosed());
+  EXPECT_FALSE(byteChan.Put(7, false));
+  EXPECT_TRUE(byteChan.Get(val) && val == 6);
+  EXPECT_FALSE(byteChan.Get(val));
+}
+
+// Measures the average per-item handoff time between one producer and one
+// consumer thread, for a given channel type.
+template <typename Chan>
+double avgHandoffNs(const uint64_t numItems, const size_t cap) {
+  Chan chan(cap);
+  std::thread prod([&]() {
+    for (uint64_t i = 0; i < numItems; i++) {
+      chan.Put(i);
+    }
+    chan.Close();
+  });
+
+  uint64_t val = 0, sum = 0;
+  auto start = steady_clock::now();
+  while (chan.Get(val)) {
+    sum += val;
+  }
+  duration<double, std::nano> elapsed = steady_clock::now() - start;
+  prod.join();
+
+  EXPECT_TRUE(sum == numItems * (numItems - 1) / 2);
+  return elapsed.count() / static_cast<double>(numItems);
+}
+
+TEST(SPSCChannelTest, HandoffLatency) {
+  const uint64_t NUM_ITEMS = 2000000;
+  const size_t CAP = 4096;
+
+  double chanNs = avgHandoffNs<Channel<uint64_t>>(NUM_ITEMS, CAP);
+  double spscNs = avgHandoffNs<SPSCChannel<uint64_t>>(NUM_ITEMS, CAP);
+
+  std::cerr << "Average per-item handoff over " << NUM_ITEMS << " items:\n"
+            << "  Channel:     " << chanNs << " ns\n"
+            << "  SPSCChannel: " << spscNs << " ns\n";
+}
+
+TEST(MPMCChannelTest, ChanSize1) {
+  using Chan = MPMCChannel<uint8_t>;
+
+  // Normal operation
+  ASSERT_DURATION_LE(1, EXPECT_TRUE(TestChanSize1<Chan>()));
+
+  // Producer closes, consumer attempts Get()
+  ASSERT_DURATION_LE(1, EXPECT_FALSE(TestChanSize1CloseMidway<Chan>()));
+
+  // Producer doesn't close, consumer attempts Get()
+  EXPECT_FATAL_FAILURE(
+      ASSERT_DURATION_LE(1, TestChanSize1NoClose<Chan>()),
+      "timed out");
+}
+
+TEST(MPMCChannelTest, ChanSize100) {
+  using Chan = MPMCChannel<uint8_t>;
+
+  // Normal operation using vectors & arrays
+  ASSERT_DURATION_LE(1, EXPECT_TRUE(TestChanSize100<Chan>(true, false, true)));
+  ASSERT_DURATION_LE(1, EXPECT_TRUE(TestChanSize100<Chan>(false, false, true)));
+
+  // Producer closes, consumer attempts Get()
+  ASSERT_DURATION_LE(1, EXPECT_FALSE(TestChanSize100<Chan>(true, true, true)));
+  ASSERT_DURATION_LE(1, EXPECT_FALSE(TestChanSize100<Chan>(false, true, true)));
+
+  // Producer doesn't close, consumer attempts Get()
+  EXPECT_FATAL_FAILURE(
+      ASSERT_DURATION_LE(1,
+          EXPECT_TRUE(TestChanSize100<Chan>(true, true, false))),
+      "timed out");
+}
+
+TEST(MPMCChannelTest, NonBlocking) {
+  MPMCChannel<uint8_t> byteChan(3);
+  EXPECT_TRUE(byteChan.Cap() == 3); // Not the ring's rounded-up size
+
+  uint8_t val = 0;
+  EXPECT_FALSE(byteChan.Get(val, false)); // Empty
+
+  uint8_t arr[5] = {1, 2, 3, 4, 5};
+  EXPECT_FALSE(byteChan.Put(arr, 4, false)); // All-or-nothing
+  EXPECT_TRUE(byteChan.Len() == 0);
+  EXPECT_TRUE(byteChan.Put(arr, 2, false));
+  EXPECT_TRUE(byteChan.Put(arr[2], false));
+  EXPECT_FALSE(byteChan.Put(arr[3], false)); // Full
+  EXPECT_TRUE(byteChan.Len() == 3);
+
+  vector<uint8_t> dst;
+  EXPECT_TRUE(byteChan.Get(val, false) && val == 1);
+  EXPECT_TRUE(byteChan.Put(arr[3], false));
+  EXPECT_FALSE(byteChan.Put(arr[4], false)); // Full again
+  EXPECT_TRUE(byteChan.Get(val, false) && val == 2);
+  EXPECT_TRUE(byteChan.Put(arr[4], false)); // Wraps around
+  EXPECT_TRUE(byteChan.Get(dst, 10, false) == 3);
+  EXPECT_TRUE(dst == vector<uint8_t>({3, 4, 5}));
+
+  // A capacity of 1 holds a single item
+  MPMCChannel<int> oneChan(1);
+  EXPECT_TRUE(oneChan.Cap() == 1);
+  EXPECT_TRUE(oneChan.Put(1, false));
+  EXPECT_FALSE(oneChan.Put(2, false));
+  int item = 0;
+  EXPECT_TRUE(oneChan.Get(item, false) && item == 1);
+  EXPECT_TRUE(oneChan.Put(2, false));
+
+  // Closed channel rejects writes, but remaining items are still readable
+  EXPECT_TRUE(byteChan.Put(6, false));
+  byteChan.Close();
+  EXPECT_TRUE(byteChan.IsClosed());
+  EXPECT_FALSE(byteChan.Put(7, false));
+  EXPECT_TRUE(byteChan.Get(val) && val == 6);
+  EXPECT_FALSE(byteChan.Get(val));
+}
+
+/* Runs 'nProd' producers (each writing 'itemsPerProd' unique values in
+ * batches of 'batchSz') against 'nCons' consumers, and validates every value
+ * is received exactly once. Returns the elapsed time in seconds.
+ */
+template <typename Chan>
+double runMultiProdCons(const size_t nProd, const size_t nCons,
+                        const uint64_t itemsPerProd, const size_t batchSz,
+                        const size_t cap) {
+  Chan chan(cap);
+  std::atomic<size_t> nProdDone(0);
+  vector<std::thread> prods, cons;
+  vector<vector<uint64_t>> received(nCons);
+
+  auto start = steady_clock::now();
+  for (size_t p = 0; p < nProd; p++) {
+    prods.emplace_back([&, p]() {
+      vector<uint64_t> batch;
+      for (uint64_t i = 0; i < itemsPerProd; i++) {
+        batch.push_back(p * itemsPerProd + i);
+        if (batch.size() == batchSz || i == itemsPerProd - 1) {
+          chan.Put(batch);
+          batch.clear();
+        }
+      }
+
+      // Last producer out closes the channel
+      if (nProdDone.fetch_add(1) == nProd - 1) {
+        chan.Close();
+      }
+    });
+  }
+
+  for (size_t c = 0; c < nCons; c++) {
+    cons.emplace_back([&, c]() {
+      while (chan.Get(received[c], batchSz) != 0) {}
+    });
+  }
+
+  for (auto& thr : prods) {
+    thr.join();
+  }
+  for (auto& thr : cons) {
+    thr.join();
+  }
+  duration<double> elapsed = steady_clock::now() - start;
+
+  vector<uint64_t> all;
+  for (auto& vec : received) {
+    all.insert(all.end(), vec.begin(), vec.end());
+  }
+  std::sort(all.begin(), all.end());
+
+  EXPECT_TRUE(all.size() == nProd * itemsPerProd);
+  for (uint64_t i = 0; i < all.size(); i++) {
+    if (all[i] != i) {
+      ADD_FAILURE() << "Missing or duplicate value " << i;
+      break;
+    }
+  }
+
+  return elapsed.count();
+}
+
+TEST(MPMCChannelTest, MultiProdCons) {
+  ASSERT_DURATION_LE(5,
+      runMultiProdCons<MPMCChannel<uint64_t>>(4, 4, 50000, 1, 64));
+  ASSERT_DURATION_LE(5,
+      runMultiProdCons<MPMCChannel<uint64_t>>(4, 4, 50000, 16, 64));
+  ASSERT_DURATION_LE(5,
+      runMultiProdCons<MPMCChannel<uint64_t>>(3, 1, 50000, 100, 64));
+}
+
+// Throughput of Channel vs. MPMCChannel w/ 1..N producers and consumers
+TEST(MPMCChannelTest, Scaling) {
+  const uint64_t TOTAL_ITEMS = 1 << 20;
+  const size_t CAP = 4096;
+  const size_t MAX_THREADS =
+      std::max<size_t>(2, std::thread::hardware_concurrency() / 2);
+
+  std::cerr << "Throughput (M items/s) for N producers & N consumers:\n";
+  for (size_t n = 1; n <= MAX_THREADS; n++) {
+    for (const size_t batchSz : {1UL, 32UL}) {
+      uint64_t itemsPerProd = TOTAL_ITEMS / n;
+      double chanSec = runMultiProdCons<Channel<uint64_t>>(
+          n, n, itemsPerProd, batchSz, CAP);
+      double mpmcSec = runMultiProdCons<MPMCChannel<uint64_t>>(
+          n, n, itemsPerProd, batchSz, CAP);
+
+      double nItems = static_cast<double>(itemsPerProd * n) / 1e6;
+      std::cerr << "  N = " << n << ", batch = " << batchSz
+                << ": Channel " << nItems / chanSec
+                << ", MPMCChannel " << nItems / mpmcSec << "\n";
+    }
+  }
+}
+
+TEST(SelectTest, Poll) {
+  Channel<int> intChan(10);
+  Channel<std::string> strChan(10);
+  int i = 0;
+  std::string str;
+
+  Select sel;
+  const size_t INT_CASE = sel.Recv(intChan, i);
+  const size_t STR_CASE = sel.Recv(strChan, str);
+  EXPECT_EQ(sel.Poll(), Select::NONE);
+
+  strChan.Put("hello");
+  EXPECT_EQ(sel.Poll(), STR_CASE);
+  EXPECT_EQ(str, "hello");
+  EXPECT_EQ(sel.Poll(), Select::NONE);
+
+  intChan.Put(42);
+  EXPECT_EQ(sel.Poll(), INT_CASE);
+  EXPECT_EQ(i, 42);
+
+  // Closed channels are always ready, w/ 'ok' reporting no item
+  bool ok = true;
+  Select closedSel;
+  const size_t CLOSED_CASE = closedSel.Recv(intChan, i, &ok);
+  intChan.Close();
+  EXPECT_EQ(closedSel.Poll(), CLOSED_CASE);
+  EXPECT_FALSE(ok);
+}
+
+TEST(SelectTest, Timeout) {
+  Channel<int> chan(1);
+  int item = 0;
+  Select sel;
+  sel.Recv(chan, item);
+
+  auto start = steady_clock::now();
+  EXPECT_EQ(sel.WaitFor(milliseconds(50)), Select::NONE);
+  auto elapsed = steady_clock::now() - start;
+  EXPECT_GE(elapsed, milliseconds(50));
+  EXPECT_LT(elapsed, seconds(1));
+
+  // Deadline already passed, but a case is ready
+  chan.Put(7);
+  EXPECT_EQ(sel.WaitUntil(steady_clock::now() - seconds(1)), 0UL);
+  EXPECT_EQ(item, 7);
+}
+
+// Data, control, and shutdown channels of different types, w/ producers
+// on separate threads
+TEST(SelectTest, Heterogeneous) {
+  const int N_DATA = 10000;
+  const int N_CTRL = 100;
+  Channel<uint64_t> dataChan(64);
+  Channel<std::string> ctrlChan(4);
+  Channel<bool> stopChan(1);
+
+  std::thread dataThr([&]() {
+    for (int i = 0; i < N_DATA; i++) {
+      dataChan.Put(static_cast<uint64_t>(i));
+    }
+  });
+  std::thread ctrlThr([&]() {
+    for (int i = 0; i < N_CTRL; i++) {
+      ctrlChan.Put(std::to_string(i));
+    }
+  });
+
+  uint64_t data = 0;
+  std::string ctrl;
+  bool stop = false;
+  Select sel;
+  const size_t DATA_CASE = sel.Recv(dataChan, data);
+  const size_t CTRL_CASE = sel.Recv(ctrlChan, ctrl);
+  const size_t STOP_CASE = sel.Recv(stopChan, stop);
+
+  uint64_t dataSum = 0;
+  int nData = 0, nCtrl = 0;
+  ASSERT_DURATION_LE(5, {
+    while (true) {
+      size_t idx = sel.Wait();
+      if (idx == DATA_CASE) {
+        dataSum += data;
+        if (++nData == N_DATA) {
+          stopChan.Put(true);
+        }
+      } else if (idx == CTRL_CASE) {
+        EXPECT_EQ(ctrl, std::to_string(nCtrl));
+        nCtrl++;
+      } else if (idx == STOP_CASE) {
+        break;
+      }
+    }
+  });
+
+  dataThr.join();
+  ctrlThr.join();
+
+  // Stop was only sent after all data, but control items may still be
+  // waiting; drain them
+  while (sel.Poll() == CTRL_CASE) {
+    nCtrl++;
+  }
+
+  EXPECT_EQ(nData, N_DATA);
+  EXPECT_EQ(dataSum, static_cast<uint64_t>(N_DATA) * (N_DATA - 1) / 2);
+  EXPECT_EQ(nCtrl, N_CTRL);
+}
+
+TEST(SelectTest, Send) {
+  Channel<int> outChan(1);
+  Channel<int> inChan(1);
+  int out = 5, in = 0;
+  bool ok = false;
+
+  Select sel;
+  const size_t SEND_CASE = sel.Send(outChan, out, &ok);
+  const size_t RECV_CASE = sel.Recv(inChan, in);
+
+  EXPECT_EQ(sel.Poll(), SEND_CASE);
+  EXPECT_TRUE(ok);
+  EXPECT_EQ(outChan.Len(), 1UL);
+
+  // Channel is full; Send blocks until someone reads
+  std::thread reader([&]() {
+    std::this_thread::sleep_for(milliseconds(20));
+    int tmp = 0;
+    outChan.Get(tmp);
+  });
+  ASSERT_DURATION_LE(1, EXPECT_EQ(sel.Wait(), SEND_CASE));
+  reader.join();
+
+  // Close wakes a blocked sender, which reports the failed write
+  std::thread closer([&]() {
+    std::this_thread::sleep_for(milliseconds(20));
+    outChan.Close();
+  });
+  ok = true;
+  ASSERT_DURATION_LE(1, EXPECT_EQ(sel.Wait(), SEND_CASE));
+  EXPECT_FALSE(ok);
+  closer.join();
+
+  EXPECT_NE(sel.Poll(), RECV_CASE);
+}
+
+// Several threads selecting on the same channels; every item must be
+// delivered to exactly one of them.
+TEST(SelectTest, ManySelectors) {
+  const size_t N_SELECTORS = 4;
+  const uint64_t N_ITEMS = 20000; // Per channel
+  Channel<uint64_t> chanA(16);
+  Channel<uint64_t> chanB(16);
+  vector<vector<uint64_t>> received(N_SELECTORS);
+
+  vector<std::thread> selectors;
+  for (size_t s = 0; s < N_SELECTORS; s++) {
+    selectors.emplace_back([&, s]() {
+      uint64_t a = 0, b = 0;
+      bool okA = false, okB = false;
+      Select sel;
+      const size_t A_CASE = sel.Recv(chanA, a, &okA);
+      const size_t B_CASE = sel.Recv(chanB, b, &okB);
+
+      // Closed channels keep firing; stop once both have
+      bool closedA = false, closedB = false;
+      while (!closedA || !closedB) {
+        size_t idx = sel.Wait();
+        if (idx == A_CASE) {
+          okA ? received[s].push_back(a) : (void)(closedA = true);
+        } else if (idx == B_CASE) {
+          okB ? received[s].push_back(b) : (void)(closedB = true);
+        }
+      }
+    });
+  }
+
+  std::thread prodA([&]() {
+    for (uint64_t i = 0; i < N_ITEMS; i++) {
+      chanA.Put(i * 2);
+    }
+    chanA.Close();
+  });
+  std::thread prodB([&]() {
+    for (uint64_t i = 0; i < N_ITEMS; i++) {
+      chanB.Put(i * 2 + 1);
+    }
+    chanB.Close();
+  });
+
+  ASSERT_DURATION_LE(10, {
+    prodA.join();
+    prodB.join();
+    for (auto& thr : selectors) {
+      thr.join();
+    }
+  });
+
+  vector<uint64_t> all;
+  for (auto& vec : received) {
+    all.insert(all.end(), vec.begin(), vec.end());
+  }
+  std::sort(all.begin(), all.end());
+
+  ASSERT_EQ(all.size(), N_ITEMS * 2);
+  for (uint64_t i = 0; i < all.size(); i++) {
+    if (all[i] != i) {
+      ADD_FAILURE() << "Missing or duplicate value " << i;
+      break;
+    }
+  }
+}
+
+// Item whose copy blocks until released, to pause a Select mid-scan
+struct GatedCopy {
+  static std::atomic<bool> copying;
+  static std::atomic<bool> released;
+
+  GatedCopy() {}
+  GatedCopy(const GatedCopy&) {
+    copying = true;
+    while (!released) {
+      std::this_thread::yield();
+    }
+  }
+};
+std::atomic<bool> GatedCopy::copying(false);
+std::atomic<bool> GatedCopy::released(false);
+
+// A Select whose scan fires a later case after an earlier one has already
+// signalled it must pass that wake-up on, or another Select sharing the
+// earlier channel sleeps through an item meant for it
+TEST(SelectTest, SharedChannelWakeup) {
+  Channel<int> shared(4);
+  Channel<GatedCopy> other(4);
+  int item1 = 0, item2 = 0;
+  GatedCopy out;
+
+  // sel1 registers on 'shared' (its 1st case), then blocks sending 'out'
+  Select sel1;
+  sel1.Recv(shared, item1);
+  const size_t SEND = sel1.Send(other, out);
+  size_t idx1 = Select::NONE;
+  std::thread t1([&]() { idx1 = sel1.Wait(); });
+  while (!GatedCopy::copying) {
+    std::this_thread::yield();
+  }
+
+  // sel2 waits on 'shared' behind sel1, so sel1 is the one signalled
+  Select sel2;
+  sel2.Recv(shared, item2);
+  size_t idx2 = Select::NONE;
+  std::thread t2([&]() { idx2 = sel2.WaitFor(seconds(1)); });
+  std::this_thread::sleep_for(milliseconds(50));
+  shared.Put(5);
+
+  // sel1's send then fires, leaving the item in 'shared' to sel2
+  GatedCopy::released = true;
+  t1.join();
+  t2.join();
+  EXPECT_EQ(idx1, SEND);
+  EXPECT_EQ(idx2, 0UL);
+  EXPECT_EQ(item2, 5);
+  EXPECT_EQ(shared.Len(), 0UL);
+}
+
+// A single item wakes a single selector; the rest stay asleep
+TEST(SelectTest, WakesOneWaiter) {
+  const size_t N_SELECTORS = 4;
+  Channel<int> chan(N_SELECTORS);
+  std::atomic<size_t> nItems(0);
+  std::atomic<size_t> nDone(0);
+
+  vector<std::thread> selectors;
+  for (size_t s = 0; s < N_SELECTORS; s++) {
+    selectors.emplace_back([&]() {
+      int item = 0;
+      bool ok = false;
+      Select sel;
+      sel.Recv(chan, item, &ok);
+      sel.Wait();
+      nItems += ok;
+      nDone++;
+    });
+  }
+
+  std::this_thread::sleep_for(milliseconds(50));
+  chan.Put(1);
+  std::this_thread::sleep_for(milliseconds(50));
+  EXPECT_EQ(nDone.load(), 1UL);
+  EXPECT_EQ(nItems.load(), 1UL);
+
+  // Closing wakes everyone else
+  chan.Close();
+  ASSERT_DURATION_LE(1, {
+    for (auto& thr : selectors) {
+      thr.join();
+    }
+  });
+  EXPECT_EQ(nDone.load(), N_SELECTORS);
+  EXPECT_EQ(nItems.load(), 1UL);
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -4,9 +4,17 @@
 
 // C libs
 #include <stdint.h>
+#include <string.h>
 
 // C++ libs
 #include <array>
+#include <stdexcept>
+#include <type_traits>
+
+#if defined(__x86_64__)
+#define CRC_HAVE_X86_64
+#include <immintrin.h>
+#endif
 
 // Tins lib
 #include <tins/small_uint.h>
@@ -113,8 +121,111 @@ namespace CRCUtils {
 // 0x104C11DB7 = 0x82608EDB w/ explicit +1
 #define CRC_POLY_32 (0x104C11DB7)
 
+// Castagnoli (CRC-32C), reflected. Has a hardware crc32 instruction on x86
+// (SSE4.2); see CRC32C().
+// 0x11EDC6F41 = 0x8F6E37A0 w/ explicit +1
+#define CRC_POLY_32C (0x11EDC6F41)
+
+// CRCs wider than 32 bits: (x + 1) * a primitive polynomial of degree N - 1,
+// for HD=4 up to 2^(N - 1) - 1 bits (i.e. far beyond any realistic length)
+
+// 0x28EE51B1D = 0x147728D8E w/ explicit +1
+#define CRC_POLY_33 (0x28EE51B1D)
+
+// 0x78EE51937 = 0x3C7728C9B w/ explicit +1
+#define CRC_POLY_34 (0x78EE51937)
+
+// 0xD8EE51923 = 0x6C7728C91 w/ explicit +1
+#define CRC_POLY_35 (0xD8EE51923)
+
+// 0x198EE51B03 = 0xCC7728D81 w/ explicit +1
+#define CRC_POLY_36 (0x198EE51B03)
+
+// 0x298EE51961 = 0x14C7728CB0 w/ explicit +1
+#define CRC_POLY_37 (0x298EE51961)
+
+// 0x798EE51B4B = 0x3CC7728DA5 w/ explicit +1
+#define CRC_POLY_38 (0x798EE51B4B)
+
+// 0xD98EE51913 = 0x6CC7728C89 w/ explicit +1
+#define CRC_POLY_39 (0xD98EE51913)
+
+// 0x1998EE5197F = 0xCCC7728CBF w/ explicit +1
+#define CRC_POLY_40 (0x1998EE5197F)
+
+// 0x2998EE51915 = 0x14CC7728C8A w/ explicit +1
+#define CRC_POLY_41 (0x2998EE51915)
+
+// 0x7998EE51937 = 0x3CCC7728C9B w/ explicit +1
+#define CRC_POLY_42 (0x7998EE51937)
+
+// 0xB998EE51AC7 = 0x5CCC7728D63 w/ explicit +1
+#define CRC_POLY_43 (0xB998EE51AC7)
+
+// 0x1F998EE51B63 = 0xFCCC7728DB1 w/ explicit +1
+#define CRC_POLY_44 (0x1F998EE51B63)
+
+// 0x2F998EE51979 = 0x17CCC7728CBC w/ explicit +1
+#define CRC_POLY_45 (0x2F998EE51979)
+
+// 0x7F998EE51923 = 0x3FCCC7728C91 w/ explicit +1
+#define CRC_POLY_46 (0x7F998EE51923)
+
+// 0xBF998EE51975 = 0x5FCCC7728CBA w/ explicit +1
+#define CRC_POLY_47 (0xBF998EE51975)
+
+// 0x13F998EE5193D = 0x9FCCC7728C9E w/ explicit +1
+#define CRC_POLY_48 (0x13F998EE5193D)
+
+// 0x3BF998EE51BCF = 0x1DFCCC7728DE7 w/ explicit +1
+#define CRC_POLY_49 (0x3BF998EE51BCF)
+
+// 0x5BF998EE51961 = 0x2DFCCC7728CB0 w/ explicit +1
+#define CRC_POLY_50 (0x5BF998EE51961)
+
+// 0x9BF998EE51B71 = 0x4DFCCC7728DB8 w/ explicit +1
+#define CRC_POLY_51 (0x9BF998EE51B71)
+
+// 0x11BF998EE51961 = 0x8DFCCC7728CB0 w/ explicit +1
+#define CRC_POLY_52 (0x11BF998EE51961)
+
+// 0x21BF998EE51BC5 = 0x10DFCCC7728DE2 w/ explicit +1
+#define CRC_POLY_53 (0x21BF998EE51BC5)
+
+// 0x41BF998EE51925 = 0x20DFCCC7728C92 w/ explicit +1
+#define CRC_POLY_54 (0x41BF998EE51925)
+
+// 0x81BF998EE5196D = 0x40DFCCC7728CB6 w/ explicit +1
+#define CRC_POLY_55 (0x81BF998EE5196D)
+
+// 0x1C1BF998EE5196D = 0xE0DFCCC7728CB6 w/ explicit +1
+#define CRC_POLY_56 (0x1C1BF998EE5196D)
+
+// 0x341BF998EE51FE3 = 0x1A0DFCCC7728FF1 w/ explicit +1
+#define CRC_POLY_57 (0x341BF998EE51FE3)
+
+// 0x641BF998EE51967 = 0x320DFCCC7728CB3 w/ explicit +1
+#define CRC_POLY_58 (0x641BF998EE51967)
+
+// 0xC41BF998EE51901 = 0x620DFCCC7728C80 w/ explicit +1
+#define CRC_POLY_59 (0xC41BF998EE51901)
+
+// 0x1441BF998EE51B1B = 0xA20DFCCC7728D8D w/ explicit +1
+#define CRC_POLY_60 (0x1441BF998EE51B1B)
+
+// 0x3C41BF998EE51A97 = 0x1E20DFCCC7728D4B w/ explicit +1
+#define CRC_POLY_61 (0x3C41BF998EE51A97)
+
+// 0x6C41BF998EE5197F = 0x3620DFCCC7728CBF w/ explicit +1
+#define CRC_POLY_62 (0x6C41BF998EE5197F)
+
+// 0xAC41BF998EE5191F = 0x5620DFCCC7728C8F w/ explicit +1
+#define CRC_POLY_63 (0xAC41BF998EE5191F)
+
+// ECMA-182 (as used by CRC-64/XZ when reflected), w/ an implicit x^64 term
+#define CRC_POLY_64 (0x42F0E1EBA9EA3693)
+
 // Table for looking up CRC polynomials based on bit length
-// TODO: Add more polynomials to support up to 64-bit CRCs
 constexpr uint64_t CRC_POLY_TABLE[] = {
     NO_POLY, NO_POLY, NO_POLY, CRC_POLY_3, CRC_POLY_4,
     CRC_POLY_5, CRC_POLY_6, CRC_POLY_7, CRC_POLY_8, CRC_POLY_9,
@@ -122,13 +233,177 @@ constexpr uint64_t CRC_POLY_TABLE[] = {
     CRC_POLY_15, CRC_POLY_16, CRC_POLY_17, CRC_POLY_18, CRC_POLY_19,
     CRC_POLY_20, CRC_POLY_21, CRC_POLY_22, CRC_POLY_23, CRC_POLY_24,
     CRC_POLY_25, CRC_POLY_26, CRC_POLY_27, CRC_POLY_28, CRC_POLY_29,
-    CRC_POLY_30, CRC_POLY_31, CRC_POLY_32
+    CRC_POLY_30, CRC_POLY_31, CRC_POLY_32, CRC_POLY_33, CRC_POLY_34,
+    CRC_POLY_35, CRC_POLY_36, CRC_POLY_37, CRC_POLY_38, CRC_POLY_39,
+    CRC_POLY_40, CRC_POLY_41, CRC_POLY_42, CRC_POLY_43, CRC_POLY_44,
+    CRC_POLY_45, CRC_POLY_46, CRC_POLY_47, CRC_POLY_48, CRC_POLY_49,
+    CRC_POLY_50, CRC_POLY_51, CRC_POLY_52, CRC_POLY_53, CRC_POLY_54,
+    CRC_POLY_55, CRC_POLY_56, CRC_POLY_57, CRC_POLY_58, CRC_POLY_59,
+    CRC_POLY_60, CRC_POLY_61, CRC_POLY_62, CRC_POLY_63, CRC_POLY_64
 };
 
 #define CRC_INIT (0xDEADBEEFFEEDFACE)
 
 #define BYTE_NUM_VALS (256UL)
 
+// Buffers shorter than this are not worth the setup cost of the carry-less
+// multiply path
+#define CRC_CLMUL_MIN_LEN (256UL)
+
+// Block sizes for the three interleaved streams of the hardware CRC-32C path.
+// Combining the streams' CRCs costs a few table look-ups per set of blocks,
+// so the largest block size that fits is used first.
+#define CRC32C_LONG_BLOCK (8192UL)
+#define CRC32C_MEDIUM_BLOCK (512UL)
+#define CRC32C_SHORT_BLOCK (64UL)
+
+/**
+ * @brief Implementation to use for calculating a CRC. All produce identical
+ *        results; AUTO picks the fastest one supported by the running CPU.
+ *
+ *  - BYTEWISE:    One table look-up per byte.
+ *  - SLICE_BY_8:  Eight tables, eight bytes per iteration.
+ *  - SLICE_BY_16: Sixteen tables, sixteen bytes per iteration.
+ *  - CLMUL:       Folds 64 bytes per iteration w/ carry-less multiplication
+ *                 (x86 PCLMULQDQ). Falls back to SLICE_BY_16 if the CPU
+ *                 doesn't support it.
+ *  - HW_CRC32C:   The CPU's crc32 instruction (x86 SSE4.2), over three
+ *                 interleaved streams. Only computes CRC-32C (i.e. reflected
+ *                 CRC_POLY_32C); same as AUTO for any other CRC, or if the CPU
+ *                 doesn't support it. AUTO picks it whenever it can.
+ */
+enum class CRCMethod {
+  AUTO,
+  BYTEWISE,
+  SLICE_BY_8,
+  SLICE_BY_16,
+  CLMUL,
+  HW_CRC32C
+};
+
+/**
+ * @brief Register the table-driven and carry-less multiply paths work in for
+ *        an N-bit CRC: 32 bits wide for N <= 32, else 64 bits wide.
+ *
+ *        MSB-first CRCs narrower than the register are kept left-aligned in
+ *        it (i.e. the CRC's MSB is the register's MSB), and reflected
+ *        (LSB-first) CRCs right-aligned, which lets every width (including
+ *        those under 8 bits) share the same slicing/folding code.
+ */
+template <uint32_t N>
+using crc_reg_t =
+    typename std::conditional<(N <= 32), uint32_t, uint64_t>::type;
+
+// Implementation details of CRC(); not meant to be called directly
+namespace internal {
+
+// Reverses the order of the low 'n' bits of 'val'
+constexpr uint64_t reflectBits(uint64_t val, const uint32_t n) {
+  uint64_t res = 0;
+  for (uint32_t i = 0; i < n; i++, val >>= 1) {
+    res = (res << 1) | (val & 1);
+  }
+  return res;
+}
+
+// The generator polynomial in register form, w/o the x^N term (which doesn't
+// fit in the register):
+//  - MSB-first: Q = P * x^(REG_BITS - N), since
+//               (A mod P) * x^k == (A * x^k) mod (P * x^k)
+//  - Reflected: P bit-reversed, right-aligned
+template <uint32_t N, bool reflected>
+constexpr crc_reg_t<N> regPoly(const uint64_t crcPoly) {
+  using Reg = crc_reg_t<N>;
+  constexpr uint32_t REG_BITS = 8 * sizeof(Reg);
+  const uint64_t low = N == 64 ? crcPoly : crcPoly & ((1ULL << N) - 1);
+
+  if constexpr (reflected) {
+    return static_cast<Reg>(reflectBits(low, N));
+  } else {
+    return static_cast<Reg>(low << (REG_BITS - N));
+  }
+}
+
+// Converts a CRC value to/from register form
+template <uint32_t N, bool reflected>
+constexpr crc_reg_t<N> toReg(const uint64_t crc) {
+  constexpr uint32_t REG_BITS = 8 * sizeof(crc_reg_t<N>);
+  return static_cast<crc_reg_t<N>>(reflected ? crc : crc << (REG_BITS - N));
+}
+
+template <uint32_t N, bool reflected>
+constexpr typename Tins::small_uint<N>::repr_type fromReg(
+    const crc_reg_t<N> reg) {
+  constexpr uint32_t REG_BITS = 8 * sizeof(crc_reg_t<N>);
+  using repr_type = typename Tins::small_uint<N>::repr_type;
+  return static_cast<repr_type>(reflected ? reg : reg >> (REG_BITS - N));
+}
+
+} // internal namespace
+
+/**
+ * @brief Pre-generate the look-up tables used for slicing-by-'SLICES' CRC
+ *        calculations. Table 'k' holds the CRC contribution of a byte that
+ *        is followed by 'k' more bytes. Entries are in register form (see
+ *        crc_reg_t).
+ *
+ * @tparam N The CRC bit-width.
+ * @tparam SLICES The number of tables (i.e. bytes processed per look-up).
+ * @tparam reflected Whether bytes are fed in LSB-first.
+ * @tparam crcPoly The generator polynomial to use for calculating the CRC,
+ *                 w/ or w/o its x^N term. Always given MSB-first, even for
+ *                 reflected CRCs.
+ *
+ * @return Array of 'SLICES' tables, each w/ 256 entries
+ */
+template <uint32_t N, uint32_t SLICES, bool reflected = false>
+constexpr std::array<std::array<crc_reg_t<N>, BYTE_NUM_VALS>, SLICES>
+generateCRCSliceLUT(const uint64_t crcPoly) {
+  static_assert(N > 0 && N <= 64);
+  static_assert(SLICES > 0);
+
+  using Reg = crc_reg_t<N>;
+  constexpr uint32_t REG_BITS = 8 * sizeof(Reg);
+  const Reg q = internal::regPoly<N, reflected>(crcPoly);
+  std::array<std::array<Reg, BYTE_NUM_VALS>, SLICES> tables = {};
+
+  for (uint32_t i = 0; i < BYTE_NUM_VALS; i++) {
+    Reg crc = static_cast<Reg>(i);
+    if constexpr (!reflected) {
+      crc = static_cast<Reg>(crc << (REG_BITS - 8));
+    }
+    for (int bit = 0; bit < 8; bit++) {
+      if constexpr (reflected) {
+        crc = (crc & 1) ? static_cast<Reg>((crc >> 1) ^ q) :
+                          static_cast<Reg>(crc >> 1);
+      } else {
+        const bool carry = (crc >> (REG_BITS - 1)) != 0;
+        crc = static_cast<Reg>(crc << 1);
+        if (carry) {
+          crc ^= q;
+        }
+      }
+    }
+    tables[0][i] = crc;
+  }
+
+  // Appending a zero byte == feeding the register's outgoing byte through
+  // table 0 after shifting it out
+  for (uint32_t k = 1; k < SLICES; k++) {
+    for (uint32_t i = 0; i < BYTE_NUM_VALS; i++) {
+      Reg prev = tables[k - 1][i];
+      if constexpr (reflected) {
+        tables[k][i] = (prev >> 8) ^ tables[0][prev & 0xFF];
+      } else {
+        tables[k][i] = static_cast<Reg>(prev << 8) ^
+                       tables[0][prev >> (REG_BITS - 8)];
+      }
+    }
+  }
+
+  return tables;
+}
+
 /**
  * @brief Pre-generate look-up table to help speed up CRC calculations.
  *
@@ -140,38 +415,504 @@ constexpr uint64_t CRC_POLY_TABLE[] = {
 template <uint32_t N>
 constexpr std::array<typename Tins::small_uint<N>::repr_type, BYTE_NUM_VALS>
 generateCRCLUT(const uint64_t crcPoly) {
-  static_assert(N >= 8); // TODO: Modify later to support N < 8
-
   using repr_type = typename Tins::small_uint<N>::repr_type;
-  constexpr repr_type MSB_ONE = 1UL << (N - 1);
-  constexpr repr_type MAX_VAL = Tins::small_uint<N>::max_value;
+  constexpr uint32_t REG_BITS = 8 * sizeof(crc_reg_t<N>);
+
+  const auto aligned = generateCRCSliceLUT<N, 1>(crcPoly);
   std::array<repr_type, BYTE_NUM_VALS> table = {};
 
   for (uint32_t i = 0; i < BYTE_NUM_VALS; i++) {
-    uint64_t crc = 0;
+    table[i] = static_cast<repr_type>(aligned[0][i] >> (REG_BITS - N));
+  }
 
-    crc = crc ^ (i << (N - 8));
-    for (int bit = 0; bit < 8; bit++) {
-      if (0 == (crc & MSB_ONE)) {
-        crc = crc << 1;
+  return table;
+}
+
+namespace internal {
+
+inline uint32_t loadBE32(const uint8_t* const p) {
+  uint32_t val;
+  memcpy(&val, p, sizeof(val));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  val = __builtin_bswap32(val);
+#endif
+  return val;
+}
+
+inline uint32_t loadLE32(const uint8_t* const p) {
+  uint32_t val;
+  memcpy(&val, p, sizeof(val));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  val = __builtin_bswap32(val);
+#endif
+  return val;
+}
+
+/**
+ * @brief Feeds 'len' bytes into a CRC register (in register form),
+ *        'SLICES' bytes at a time (SLICES must be 1 or a multiple of the
+ *        register's size), and any remainder one byte at a time.
+ *
+ * @return The updated register.
+ */
+template <uint32_t N, uint64_t crcPoly, uint32_t SLICES, bool reflected>
+crc_reg_t<N> crcSliced(crc_reg_t<N> reg, const uint8_t* data, uint64_t len) {
+  using Reg = crc_reg_t<N>;
+  constexpr uint32_t REG_BITS = 8 * sizeof(Reg);
+  static_assert(SLICES == 1 || SLICES % sizeof(Reg) == 0);
+  static constexpr auto LUT =
+      generateCRCSliceLUT<N, SLICES, reflected>(crcPoly);
+
+  for (; SLICES > 1 && len >= SLICES; len -= SLICES, data += SLICES) {
+    Reg acc = 0;
+    for (uint32_t w = 0; w < SLICES / 4; w++) {
+      // Byte 'b' of word 'w' is followed by (SLICES - 1 - 4w - b) bytes. The
+      // register is XOR'd into the first word(s).
+      const uint32_t t = SLICES - 1 - 4 * w;
+      if constexpr (reflected) {
+        uint32_t word = loadLE32(data + 4 * w);
+        if (4 * w < sizeof(Reg)) {
+          word ^= static_cast<uint32_t>(reg >> (32 * w));
+        }
+        acc ^= LUT[t][word & 0xFF] ^
+               LUT[t - 1][(word >> 8) & 0xFF] ^
+               LUT[t - 2][(word >> 16) & 0xFF] ^
+               LUT[t - 3][word >> 24];
       } else {
-        crc = (crc << 1) ^ crcPoly;
+        uint32_t word = loadBE32(data + 4 * w);
+        if (4 * w < sizeof(Reg)) {
+          word ^= static_cast<uint32_t>(reg >> (REG_BITS - 32 * (w + 1)));
+        }
+        acc ^= LUT[t][word >> 24] ^
+               LUT[t - 1][(word >> 16) & 0xFF] ^
+               LUT[t - 2][(word >> 8) & 0xFF] ^
+               LUT[t - 3][word & 0xFF];
       }
     }
+    reg = acc;
+  }
 
-    table[i] = crc & MAX_VAL;
+  for (; len > 0; len--, data++) {
+    if constexpr (reflected) {
+      reg = LUT[0][(reg ^ *data) & 0xFF] ^ (reg >> 8);
+    } else {
+      reg = LUT[0][(reg >> (REG_BITS - 8)) ^ *data] ^ (reg << 8);
+    }
   }
 
+  return reg;
+}
+
+// GF(2) polynomial math for the folding/combining constants, w/
+// polynomials stored as integers (bit i == coefficient of x^i). 'q' is a
+// polynomial of degree REG_BITS (i.e. the register's width) w/o its top term.
+
+// x^k mod q
+template <typename Reg>
+constexpr Reg xPowMod(const uint32_t k, const Reg q) {
+  constexpr uint32_t REG_BITS = 8 * sizeof(Reg);
+  Reg r = 1;
+  for (uint32_t i = 0; i < k; i++) {
+    const bool carry = (r >> (REG_BITS - 1)) != 0;
+    r = static_cast<Reg>(r << 1);
+    if (carry) {
+      r ^= q;
+    }
+  }
+  return r;
+}
+
+// (a * b) mod q, where a, b < x^REG_BITS
+template <typename Reg>
+constexpr Reg mulMod(const Reg a, const Reg b, const Reg q) {
+  constexpr uint32_t REG_BITS = 8 * sizeof(Reg);
+  Reg r = 0;
+  for (int i = REG_BITS - 1; i >= 0; i--) {
+    const bool carry = (r >> (REG_BITS - 1)) != 0;
+    r = static_cast<Reg>(r << 1);
+    if (carry) {
+      r ^= q;
+    }
+    if ((b >> i) & 1) {
+      r ^= a;
+    }
+  }
+  return r;
+}
+
+// Table of x^(8 * 2^i) mod q, i.e. the effect of appending 2^i zero bytes
+template <typename Reg>
+constexpr std::array<Reg, 64> zeroBytesPowTable(const Reg q) {
+  std::array<Reg, 64> table = {};
+  table[0] = xPowMod<Reg>(8, q);
+  for (uint32_t i = 1; i < table.size(); i++) {
+    table[i] = mulMod<Reg>(table[i - 1], table[i - 1], q);
+  }
   return table;
 }
 
+/**
+ * @brief Advances a left-aligned (MSB-first) CRC register past 'len' zero
+ *        bytes, i.e. computes (reg * x^(8 * len)) mod Q in O(log(len))
+ *        multiplications.
+ */
+template <uint32_t N, uint64_t crcPoly>
+crc_reg_t<N> shiftZeroBytes(crc_reg_t<N> reg, uint64_t len) {
+  using Reg = crc_reg_t<N>;
+  static constexpr Reg Q = regPoly<N, false>(crcPoly);
+  static constexpr auto POW = zeroBytesPowTable<Reg>(Q);
+
+  for (uint32_t i = 0; len != 0; i++, len >>= 1) {
+    if (len & 1) {
+      reg = mulMod<Reg>(reg, POW[i], Q);
+    }
+  }
+  return reg;
+}
+
+#ifdef CRC_HAVE_X86_64
+// floor(x^64 / q), where q is of degree 32 (given w/ its x^32 term)
+constexpr uint64_t barrettMu(uint64_t q) {
+  unsigned __int128 rem = static_cast<unsigned __int128>(1) << 64;
+  uint64_t quot = 0;
+  for (uint32_t i = 64; i >= 32; i--) {
+    if ((rem >> i) & 1) {
+      rem ^= static_cast<unsigned __int128>(q) << (i - 32);
+      quot |= 1ULL << (i - 32);
+    }
+  }
+  return quot;
+}
+
+// Whether the running CPU supports the instructions used by crcFold()
+inline bool hasCLMUL() {
+  static const bool supported = __builtin_cpu_supports("pclmul") &&
+                                __builtin_cpu_supports("ssse3");
+  return supported;
+}
+
+/**
+ * @brief Constant for folding a 128-bit block forward by 'k' bits w/
+ *        carry-less multiplication. The block's high and low 64-bit halves
+ *        take {x^(k+64), x^k} mod Q respectively. For reflected CRCs the
+ *        halves (and constants) are bit-reversed, and the product of two
+ *        reversed 64-bit values comes out one bit short, so the pair becomes
+ *        {x^(k+63), x^(k-1)} (w/ the halves swapped).
+ */
+template <uint32_t N, uint64_t crcPoly, bool reflected>
+constexpr uint64_t clmulConst(const uint32_t k, const bool hi) {
+  constexpr crc_reg_t<N> Q = regPoly<N, false>(crcPoly);
+  if constexpr (reflected) {
+    return reflectBits(xPowMod<crc_reg_t<N>>(hi ? k - 1 : k + 63, Q), 64);
+  } else {
+    return xPowMod<crc_reg_t<N>>(hi ? k + 64 : k, Q);
+  }
+}
+
+// Constants for folding an N-bit CRC w/ carry-less multiplication
+template <uint32_t N, uint64_t crcPoly, bool reflected>
+struct CLMULConsts {
+  using Reg = crc_reg_t<N>;
+  static constexpr Reg Q = regPoly<N, false>(crcPoly);
+
+  // Folding by 4 and 1 128-bit blocks
+  static constexpr uint64_t K512_HI =
+      clmulConst<N, crcPoly, reflected>(512, true);
+  static constexpr uint64_t K512_LO =
+      clmulConst<N, crcPoly, reflected>(512, false);
+  static constexpr uint64_t K128_HI =
+      clmulConst<N, crcPoly, reflected>(128, true);
+  static constexpr uint64_t K128_LO =
+      clmulConst<N, crcPoly, reflected>(128, false);
+
+  // Final reduction of a 32-bit MSB-first register
+  static constexpr uint64_t X64 = xPowMod<Reg>(64, Q);
+  static constexpr uint64_t X96 = xPowMod<Reg>(96, Q);
+  static constexpr uint64_t Q_FULL = (1ULL << 32) | Q;
+  static constexpr uint64_t MU = barrettMu(Q_FULL);
+};
+
+#define CRC_CLMUL_TARGET __attribute__((target("pclmul,ssse3")))
+
+// Advances a 128-bit block, where K holds the pair of folding constants
+CRC_CLMUL_TARGET
+inline __m128i clmulFold(__m128i acc, __m128i k) {
+  return _mm_xor_si128(_mm_clmulepi64_si128(acc, k, 0x11),
+                       _mm_clmulepi64_si128(acc, k, 0x00));
+}
+
+// Loads 16 bytes such that the first byte is the most significant (or, for
+// reflected CRCs, the least significant)
+template <bool reflected>
+CRC_CLMUL_TARGET
+inline __m128i load128(const uint8_t* const p) {
+  const __m128i val = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  if constexpr (reflected) {
+    return val;
+  } else {
+    const __m128i BSWAP = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7,
+                                       8, 9, 10, 11, 12, 13, 14, 15);
+    return _mm_shuffle_epi8(val, BSWAP);
+  }
+}
+
+/**
+ * @brief Feeds 'len' bytes (a non-zero multiple of 64) into a CRC register,
+ *        w/ four independent 128-bit folding lanes.
+ *        Based on Intel's "Fast CRC Computation for Generic Polynomials
+ *        Using PCLMULQDQ Instruction".
+ *
+ * @return The updated register.
+ */
+template <uint32_t N, uint64_t crcPoly, bool reflected>
+CRC_CLMUL_TARGET
+crc_reg_t<N> crcFold(crc_reg_t<N> reg, const uint8_t* data, uint64_t len) {
+  using Reg = crc_reg_t<N>;
+  using K = CLMULConsts<N, crcPoly, reflected>;
+  constexpr uint32_t REG_BITS = 8 * sizeof(Reg);
+  const __m128i K512 = _mm_set_epi64x(static_cast<int64_t>(K::K512_HI),
+                                      static_cast<int64_t>(K::K512_LO));
+  const __m128i K128 = _mm_set_epi64x(static_cast<int64_t>(K::K128_HI),
+                                      static_cast<int64_t>(K::K128_LO));
+
+  // The register's contribution == XOR'ing it into the first bytes
+  const uint64_t reg64 = reg;
+  const __m128i regVal = reflected ?
+      _mm_cvtsi64_si128(static_cast<int64_t>(reg64)) :
+      _mm_set_epi64x(static_cast<int64_t>(reg64 << (64 - REG_BITS)), 0);
+
+  __m128i x0 = _mm_xor_si128(load128<reflected>(data), regVal);
+  __m128i x1 = load128<reflected>(data + 16);
+  __m128i x2 = load128<reflected>(data + 32);
+  __m128i x3 = load128<reflected>(data + 48);
+  data += 64;
+  len -= 64;
+
+  for (; len >= 64; len -= 64, data += 64) {
+    x0 = _mm_xor_si128(clmulFold(x0, K512), load128<reflected>(data));
+    x1 = _mm_xor_si128(clmulFold(x1, K512), load128<reflected>(data + 16));
+    x2 = _mm_xor_si128(clmulFold(x2, K512), load128<reflected>(data + 32));
+    x3 = _mm_xor_si128(clmulFold(x3, K512), load128<reflected>(data + 48));
+  }
+
+  // Collapse the lanes into one 128-bit value, congruent to the data mod Q
+  x1 = _mm_xor_si128(clmulFold(x0, K128), x1);
+  x2 = _mm_xor_si128(clmulFold(x1, K128), x2);
+  x3 = _mm_xor_si128(clmulFold(x2, K128), x3);
+
+  if constexpr (reflected || REG_BITS != 32) {
+    // The remainder of the last 16 bytes == their CRC w/ a zeroed register
+    uint8_t last[16];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(last),
+                     load128<reflected>(reinterpret_cast<uint8_t*>(&x3)));
+    return crcSliced<N, crcPoly, 16, reflected>(0, last, sizeof(last));
+  } else {
+    // Remainder of (x3 * x^32) mod Q. First reduce to 96, then 64 bits:
+    //   x3 * x^32 == hi64 * x^96 + lo64 * x^32
+    __m128i t = _mm_xor_si128(
+        _mm_clmulepi64_si128(x3, _mm_cvtsi64_si128(
+            static_cast<int64_t>(K::X96)), 0x01),
+        _mm_slli_si128(_mm_move_epi64(x3), 4));
+    //   t == hi32 * x^64 + lo64
+    t = _mm_xor_si128(
+        _mm_clmulepi64_si128(_mm_srli_si128(t, 8), _mm_cvtsi64_si128(
+            static_cast<int64_t>(K::X64)), 0x00),
+        _mm_move_epi64(t));
+
+    // Barrett reduction of the 64-bit remainder:
+    //   quot = floor(floor(t / x^32) * mu / x^32), rem = t - quot * Q
+    __m128i quot = _mm_srli_epi64(
+        _mm_clmulepi64_si128(_mm_srli_epi64(t, 32),
+            _mm_cvtsi64_si128(static_cast<int64_t>(K::MU)), 0x00),
+        32);
+    __m128i rem = _mm_xor_si128(t, _mm_clmulepi64_si128(quot,
+        _mm_cvtsi64_si128(static_cast<int64_t>(K::Q_FULL)), 0x00));
+
+    return static_cast<Reg>(_mm_cvtsi128_si32(rem));
+  }
+}
+
+// Whether an N-bit CRC w/ 'crcPoly' is CRC-32C, i.e. the CRC computed by the
+// crc32 instruction
+template <uint32_t N, uint64_t crcPoly, bool reflected>
+constexpr bool isCRC32C() {
+  return N == 32 && reflected &&
+         (crcPoly & 0xFFFFFFFF) == (CRC_POLY_32C & 0xFFFFFFFF);
+}
+
+// Whether the running CPU supports the instructions used by crc32cHW()
+inline bool hasSSE42() {
+  static const bool supported = __builtin_cpu_supports("sse4.2");
+  return supported;
+}
+
+/**
+ * @brief Pre-generate the tables for advancing a (reflected) CRC-32C register
+ *        past 'nBytes' zero bytes. The shift is linear in the register, so
+ *        it's the XOR of one look-up per register byte.
+ */
+constexpr std::array<std::array<uint32_t, BYTE_NUM_VALS>, 4>
+generateCRC32CShiftLUT(const uint64_t nBytes) {
+  constexpr uint32_t Q = regPoly<32, false>(CRC_POLY_32C);
+  const uint32_t shift = xPowMod<uint32_t>(static_cast<uint32_t>(8 * nBytes),
+                                           Q);
+  std::array<std::array<uint32_t, BYTE_NUM_VALS>, 4> tables = {};
+
+  for (uint32_t k = 0; k < 4; k++) {
+    for (uint32_t i = 0; i < BYTE_NUM_VALS; i++) {
+      // Reflected register -> MSB-first, shift, and back
+      const uint32_t reg = static_cast<uint32_t>(reflectBits(i << (8 * k), 32));
+      tables[k][i] = static_cast<uint32_t>(
+          reflectBits(mulMod<uint32_t>(reg, shift, Q), 32));
+    }
+  }
+
+  return tables;
+}
+
+inline uint32_t crc32cShift(
+    const std::array<std::array<uint32_t, BYTE_NUM_VALS>, 4>& lut,
+    const uint32_t reg) {
+  return lut[0][reg & 0xFF] ^ lut[1][(reg >> 8) & 0xFF] ^
+         lut[2][(reg >> 16) & 0xFF] ^ lut[3][reg >> 24];
+}
+
+#define CRC_SSE42_TARGET __attribute__((target("sse4.2")))
+
+// Feeds 'nBlocks' sets of three consecutive 'BLOCK'-byte blocks into a
+// CRC-32C register, w/ a separate crc32 stream for each block
+template <uint64_t BLOCK>
+CRC_SSE42_TARGET
+uint32_t crc32cBlocks(uint32_t reg, const uint8_t*& data, uint64_t nBlocks) {
+  static_assert(BLOCK % 8 == 0);
+  static constexpr auto SHIFT = generateCRC32CShiftLUT(BLOCK);
+
+  for (; nBlocks > 0; nBlocks--, data += 3 * BLOCK) {
+    uint64_t crc0 = reg, crc1 = 0, crc2 = 0;
+    for (uint64_t i = 0; i < BLOCK; i += 8) {
+      uint64_t word0, word1, word2;
+      memcpy(&word0, data + i, sizeof(word0));
+      memcpy(&word1, data + BLOCK + i, sizeof(word1));
+      memcpy(&word2, data + 2 * BLOCK + i, sizeof(word2));
+      crc0 = _mm_crc32_u64(crc0, word0);
+      crc1 = _mm_crc32_u64(crc1, word1);
+      crc2 = _mm_crc32_u64(crc2, word2);
+    }
+
+    // CRC(A || B) == CRC(A) * x^(8 * len(B)) ^ CRC(B), for CRC(B) w/ init 0
+    reg = crc32cShift(SHIFT, static_cast<uint32_t>(crc0)) ^
+          static_cast<uint32_t>(crc1);
+    reg = crc32cShift(SHIFT, reg) ^ static_cast<uint32_t>(crc2);
+  }
+
+  return reg;
+}
+
+/**
+ * @brief Feeds 'len' bytes into a CRC-32C register using the crc32
+ *        instruction. A single stream is bound by the instruction's 3-cycle
+ *        latency, so the bulk of the data is split into three independent
+ *        streams and their CRCs combined afterwards.
+ *        Based on Mark Adler's crc32c.c.
+ *
+ * @return The updated register.
+ */
+CRC_SSE42_TARGET
+inline uint32_t crc32cHW(uint32_t reg, const uint8_t* data, uint64_t len) {
+  uint64_t crc = reg;
+
+  // Align to 8 bytes
+  for (; len > 0 && (reinterpret_cast<uintptr_t>(data) & 7) != 0;
+       len--, data++) {
+    crc = _mm_crc32_u8(static_cast<uint32_t>(crc), *data);
+  }
+
+  if (len >= 3 * CRC32C_SHORT_BLOCK) {
+    reg = crc32cBlocks<CRC32C_LONG_BLOCK>(static_cast<uint32_t>(crc), data,
+                                          len / (3 * CRC32C_LONG_BLOCK));
+    len %= 3 * CRC32C_LONG_BLOCK;
+    reg = crc32cBlocks<CRC32C_MEDIUM_BLOCK>(reg, data,
+                                            len / (3 * CRC32C_MEDIUM_BLOCK));
+    len %= 3 * CRC32C_MEDIUM_BLOCK;
+    reg = crc32cBlocks<CRC32C_SHORT_BLOCK>(reg, data,
+                                           len / (3 * CRC32C_SHORT_BLOCK));
+    len %= 3 * CRC32C_SHORT_BLOCK;
+    crc = reg;
+  }
+
+  for (; len >= 8; len -= 8, data += 8) {
+    uint64_t word;
+    memcpy(&word, data, sizeof(word));
+    crc = _mm_crc32_u64(crc, word);
+  }
+  for (; len > 0; len--, data++) {
+    crc = _mm_crc32_u8(static_cast<uint32_t>(crc), *data);
+  }
+
+  return static_cast<uint32_t>(crc);
+}
+#endif // CRC_HAVE_X86_64
+
+/**
+ * @brief Feeds 'len' bytes into a CRC register (in register form) using
+ *        'method'.
+ *
+ * @return The updated register.
+ */
+template <uint32_t N, uint64_t crcPoly, CRCMethod method, bool reflected>
+crc_reg_t<N> crcUpdate(crc_reg_t<N> reg, const uint8_t* data, uint64_t len) {
+  if constexpr (method == CRCMethod::BYTEWISE) {
+    return crcSliced<N, crcPoly, 1, reflected>(reg, data, len);
+  } else if constexpr (method == CRCMethod::SLICE_BY_8) {
+    return crcSliced<N, crcPoly, 8, reflected>(reg, data, len);
+  }
+
+#ifdef CRC_HAVE_X86_64
+  if constexpr (isCRC32C<N, crcPoly, reflected>() &&
+                (method == CRCMethod::HW_CRC32C ||
+                 method == CRCMethod::AUTO)) {
+    if (hasSSE42()) {
+      return crc32cHW(reg, data, len);
+    }
+  }
+
+  if constexpr (method == CRCMethod::CLMUL || method == CRCMethod::AUTO ||
+                method == CRCMethod::HW_CRC32C) {
+    const uint64_t minLen = method == CRCMethod::CLMUL ? 64 : CRC_CLMUL_MIN_LEN;
+    if (len >= minLen && hasCLMUL()) {
+      const uint64_t nFolded = len & ~63ULL;
+      reg = crcFold<N, crcPoly, reflected>(reg, data, nFolded);
+      data += nFolded;
+      len -= nFolded;
+    }
+  }
+#endif
+
+  return crcSliced<N, crcPoly, 16, reflected>(reg, data, len);
+}
+
+} // internal namespace
+
 /**
  * @brief CRC calculation function for custom-width CRCs.
  *        Credit for look-up table optimization of CRC:
  *          - https://create.stephan-brumme.com/crc32/
  *
- * @tparam N The CRC bit-width.
- * @tparam crcPoly The generator polynomial to use for calculating the CRC.
+ *        Reflected CRCs feed each byte in LSB-first, like most standard
+ *        CRCs (e.g. CRC-32C, CRC-64/XZ) do. For these, both 'init' and the
+ *        result are in reflected bit order, so one result can be passed as
+ *        the next call's 'init' (like zlib's crc32()). Any final XOR is up to
+ *        the caller, e.g. for CRC-32C (also available as CRC32C()):
+ *
+ *        CRC<32, 0x1EDC6F41, CRCMethod::AUTO, true>(data, len, 0xFFFFFFFF)
+ *            ^ 0xFFFFFFFF
+ *
+ * @tparam N The CRC bit-width (1 to 64).
+ * @tparam crcPoly The generator polynomial to use for calculating the CRC,
+ *                 w/ or w/o its x^N term. Always given MSB-first (as listed
+ *                 in CRC catalogues), even for reflected CRCs.
+ * @tparam method The implementation to use (see CRCMethod).
+ * @tparam reflected Whether bytes are fed in LSB-first.
  *
  * @param data Pointer to data to calculate CRC for.
  * @param dataLen Length of data.
@@ -180,28 +921,22 @@ generateCRCLUT(const uint64_t crcPoly) {
  * @return The calculated CRC of the data, in the closest unsigned integer type
  *         given the specified CRC bit-width 'N'.
  */
-template <uint32_t N, uint64_t crcPoly>
+template <uint32_t N, uint64_t crcPoly, CRCMethod method = CRCMethod::AUTO,
+          bool reflected = false>
 typename Tins::small_uint<N>::repr_type CRC(const uint8_t* const data,
                                             uint64_t dataLen,
                                             Tins::small_uint<N> init) {
-  static_assert(N >= 8); // TODO: Modify later to support N < 8
-  static_assert(N < sizeof(CRC_POLY_TABLE));
+  static_assert(N > 0 && N <= 64);
   static_assert(crcPoly != 0);
 
-  using repr_type = typename Tins::small_uint<N>::repr_type;
-  constexpr repr_type MAX_VAL = Tins::small_uint<N>::max_value;
-  static constexpr auto LUT = generateCRCLUT<N>(crcPoly);
-
   if (data == nullptr) {
     throw std::invalid_argument("Cannot calculate CRC w/ NULL buffer");
   }
 
-  uint64_t crc = init;
-  for (uint64_t i = 0; i < dataLen; i++) {
-    crc = (LUT[(crc >> (N - 8)) ^ data[i]] ^ (crc << 8)) & MAX_VAL;
-  }
+  auto reg = internal::toReg<N, reflected>(init);
+  reg = internal::crcUpdate<N, crcPoly, method, reflected>(reg, data, dataLen);
 
-  return crc & MAX_VAL;
+  return internal::fromReg<N, reflected>(reg);
 }
 
 /**
@@ -209,7 +944,8 @@ typename Tins::small_uint<N>::repr_type CRC(const uint8_t* const data,
  *        Will automatically select a generator polynomial depending on the
  *        CRC bit-width 'N'.
  *
- * @tparam N The CRC bit-width.
+ * @tparam N The CRC bit-width (3 to 64).
+ * @tparam method The implementation to use (see CRCMethod).
  *
  * @param data Pointer to data to calculate CRC for.
  * @param dataLen Length of data.
@@ -218,15 +954,149 @@ typename Tins::small_uint<N>::repr_type CRC(const uint8_t* const data,
  * @return The calculated CRC of the data, in the closest unsigned integer type
  *         given the specified CRC bit-width 'N'.
  */
-template <uint32_t N>
+template <uint32_t N, CRCMethod method = CRCMethod::AUTO>
 typename Tins::small_uint<N>::repr_type CRC(const uint8_t* const data,
                                             uint64_t dataLen,
                                             Tins::small_uint<N> init) {
-  static_assert(N >= 8); // TODO: Modify later to support N < 8
-  static_assert(N < sizeof(CRC_POLY_TABLE));
+  static_assert(N < sizeof(CRC_POLY_TABLE) / sizeof(CRC_POLY_TABLE[0]));
   static_assert(CRC_POLY_TABLE[N] != 0);
 
-  return CRC<N, CRC_POLY_TABLE[N]>(data, dataLen, init);
+  return CRC<N, CRC_POLY_TABLE[N], method>(data, dataLen, init);
+}
+
+/**
+ * @brief Standard CRC-32C (Castagnoli), as used by iSCSI, SCTP, ext4, etc.
+ *        Uses the CPU's crc32 instruction where available (see
+ *        CRCMethod::HW_CRC32C), w/ a table-driven fallback otherwise.
+ *
+ *        Includes CRC-32C's pre- and post-inversion, so a CRC over several
+ *        buffers can be calculated by passing each result as the next call's
+ *        'crc':
+ *
+ *        uint32_t crc = CRC32C(hdr, hdrLen);
+ *        crc = CRC32C(payload, payloadLen, crc);
+ *
+ * @param data Pointer to data to calculate CRC for.
+ * @param dataLen Length of data.
+ * @param crc CRC-32C of any preceding data, or 0 if none.
+ *
+ * @return The CRC-32C of the data.
+ */
+inline uint32_t CRC32C(const uint8_t* const data, uint64_t dataLen,
+                       uint32_t crc = 0) {
+  return ~CRC<32, CRC_POLY_32C, CRCMethod::AUTO, true>(data, dataLen, ~crc);
+}
+
+/**
+ * @brief Incremental CRC calculation, for data that isn't in one contiguous
+ *        buffer (e.g. scatter-gather segments, or a header that must be
+ *        checked w/ some field zeroed out). Feeding the same bytes through
+ *        any number of update() calls gives the same result as one call to
+ *        CRC().
+ *
+ *        CRCState<14> state(init);
+ *        state.update(hdr, hdrLen).update(payload, payloadLen);
+ *        auto crc = state.finalize();
+ *
+ * @tparam N The CRC bit-width.
+ * @tparam crcPoly The generator polynomial to use for calculating the CRC.
+ * @tparam method The implementation to use (see CRCMethod).
+ * @tparam reflected Whether bytes are fed in LSB-first (see CRC()).
+ */
+template <uint32_t N, uint64_t crcPoly = CRC_POLY_TABLE[N],
+          CRCMethod method = CRCMethod::AUTO, bool reflected = false>
+class CRCState {
+  public:
+    using repr_type = typename Tins::small_uint<N>::repr_type;
+
+  private:
+    static_assert(N > 0 && N <= 64);
+    static_assert(crcPoly != 0);
+
+    crc_reg_t<N> reg_ = 0; // CRC register (see crc_reg_t)
+    uint64_t len_ = 0;     // Number of bytes fed in so far
+
+  public:
+    CRCState(Tins::small_uint<N> init = 0) {
+      reset(init);
+    }
+
+    // Restarts the calculation w/ initial value 'init'
+    void reset(Tins::small_uint<N> init = 0) {
+      reg_ = internal::toReg<N, reflected>(init);
+      len_ = 0;
+    }
+
+    // Feeds the next 'dataLen' bytes of the data into the CRC
+    CRCState& update(const uint8_t* const data, uint64_t dataLen) {
+      if (data == nullptr) {
+        throw std::invalid_argument("Cannot calculate CRC w/ NULL buffer");
+      }
+
+      reg_ = internal::crcUpdate<N, crcPoly, method, reflected>(reg_, data,
+                                                                dataLen);
+      len_ += dataLen;
+      return *this;
+    }
+
+    // Returns the CRC of all data fed in so far. The state is left as is, so
+    // more data may still be fed in afterwards.
+    repr_type finalize() const {
+      return internal::fromReg<N, reflected>(reg_);
+    }
+
+    uint64_t length() const {
+      return len_;
+    }
+};
+
+/**
+ * @brief Combines the CRCs of two consecutive pieces of data, A and B, into
+ *        the CRC of A followed by B, w/o touching the data. Useful for
+ *        calculating CRCs of large buffers in parallel chunks.
+ *        Costs O(log(lenB)) polynomial multiplications.
+ *
+ * @tparam N The CRC bit-width.
+ * @tparam crcPoly The generator polynomial to use for calculating the CRC.
+ * @tparam reflected Whether bytes are fed in LSB-first (see CRC()).
+ *
+ * @param crcA CRC of A (w/ whatever initial value the whole should have).
+ * @param crcB CRC of B.
+ * @param lenB Length of B, in bytes.
+ * @param initB Initial value that was used to calculate 'crcB'.
+ *
+ * @return The CRC of A followed by B.
+ */
+template <uint32_t N, uint64_t crcPoly = CRC_POLY_TABLE[N],
+          bool reflected = false>
+typename Tins::small_uint<N>::repr_type CRCCombine(Tins::small_uint<N> crcA,
+                                                   Tins::small_uint<N> crcB,
+                                                   uint64_t lenB,
+                                                   Tins::small_uint<N> initB
+                                                       = 0) {
+  static_assert(N > 0 && N <= 64);
+  static_assert(crcPoly != 0);
+
+  using repr_type = typename Tins::small_uint<N>::repr_type;
+
+  // CRC(init, B) == init * x^(8 * lenB) + CRC(0, B)   (mod P), so:
+  //   CRC(A || B) == CRC(crcA, B) == (crcA ^ initB) * x^(8 * lenB) ^ crcB
+  // A reflected CRC is the bit-reversed CRC of the bit-reversed bytes, so
+  // the same holds once it's reversed back to MSB-first.
+  uint64_t diff = static_cast<repr_type>(crcA ^ initB);
+  if constexpr (reflected) {
+    diff = internal::reflectBits(diff, N);
+  }
+
+  auto reg = internal::toReg<N, false>(diff);
+  reg = internal::shiftZeroBytes<N, crcPoly>(reg, lenB);
+
+  uint64_t shifted = internal::fromReg<N, false>(reg);
+  if constexpr (reflected) {
+    shifted = internal::reflectBits(shifted, N);
+  }
+
+  return static_cast<repr_type>(shifted ^ crcB);
 }
 
 } // CRCUtils namespace
@@ -8,6 +8,10 @@
 #include <string>
 #include <memory>
 #include <chrono>
+#include <algorithm>
+#include <thread>
+#include <utility>
+#include <vector>
 
 // C libs
 #include <stdint.h>
@@ -25,6 +29,9 @@ using std::string;
 using std::unique_ptr;
 using LogUtils::cppPrintf;
 using CRCUtils::CRC;
+using CRCUtils::CRCMethod;
+using CRCUtils::CRCState;
+using CRCUtils::CRCCombine;
 using TestUtils::FillRandBytes;
 
 using namespace std::chrono;
@@ -282,6 +289,433 @@ TEST(CRC32, Rand_1MB_Looped) {
                 elapsed.count() * 1000 / NUM_LOOPS);
 }
 
+/***************
+ * CRC32C Tests
+ ***************/
+TEST(CRC32C, BasicData) {
+  const string CHECK = "123456789";
+  EXPECT_EQ(CRCUtils::CRC32C((const uint8_t*)CHECK.data(), CHECK.size()),
+            0xE3069283U);
+  EXPECT_EQ(CRCUtils::CRC32C((const uint8_t*)CHECK.data(), 0), 0U);
+
+  // Chained over several buffers
+  uint32_t crc = CRCUtils::CRC32C((const uint8_t*)CHECK.data(), 4);
+  crc = CRCUtils::CRC32C((const uint8_t*)CHECK.data() + 4, CHECK.size() - 4,
+                         crc);
+  EXPECT_EQ(crc, 0xE3069283U);
+
+  // RFC 3720 (iSCSI), appendix B.4
+  uint8_t buf[32];
+  memset(buf, 0x00, sizeof(buf));
+  EXPECT_EQ(CRCUtils::CRC32C(buf, sizeof(buf)), 0x8A9136AAU);
+  memset(buf, 0xFF, sizeof(buf));
+  EXPECT_EQ(CRCUtils::CRC32C(buf, sizeof(buf)), 0x62A8AB43U);
+  for (uint8_t i = 0; i < sizeof(buf); i++) {
+    buf[i] = i;
+  }
+  EXPECT_EQ(CRCUtils::CRC32C(buf, sizeof(buf)), 0x46DD794EU);
+}
+
+// The interleaved hardware path must match the table-driven one for every
+// alignment and around each block boundary
+TEST(CRC32C, MatchesTableDriven) {
+  const uint64_t LONG3 = 3 * CRC32C_LONG_BLOCK;
+  const uint64_t MEDIUM3 = 3 * CRC32C_MEDIUM_BLOCK;
+  const uint64_t SHORT3 = 3 * CRC32C_SHORT_BLOCK;
+  const uint32_t BUF_SIZE = 2 * LONG3 + 2 * MEDIUM3 + 2 * SHORT3 + 64;
+  unique_ptr<uint8_t[]> pData(new uint8_t[BUF_SIZE]);
+  FillRandBytes(pData.get(), BUF_SIZE);
+
+  std::vector<uint64_t> lengths;
+  for (uint64_t len = 0; len <= 64; len++) {
+    lengths.push_back(len);
+  }
+  for (uint64_t base : {SHORT3, 2 * SHORT3, MEDIUM3, MEDIUM3 + SHORT3, LONG3,
+                        2 * LONG3 + 2 * MEDIUM3 + SHORT3}) {
+    for (uint64_t len = base - 9; len <= base + 9; len++) {
+      lengths.push_back(len);
+    }
+  }
+
+  for (uint64_t offset = 0; offset < 8; offset++) {
+    for (uint64_t len : lengths) {
+      const uint8_t* const data = pData.get() + offset;
+      const uint32_t init = static_cast<uint32_t>(CRC_INIT);
+      EXPECT_EQ((CRC<32, CRC_POLY_32C, CRCMethod::HW_CRC32C, true>(
+                    data, len, init)),
+                (CRC<32, CRC_POLY_32C, CRCMethod::SLICE_BY_16, true>(
+                    data, len, init)))
+          << "offset = " << offset << ", len = " << len;
+    }
+  }
+}
+
+// Throughput of CRC-32C (hardware & table-driven) vs. the default CRC<32>
+template <typename CRCFunc>
+double crcThroughputGBps(CRCFunc crcFunc, const uint8_t* const data,
+                         const uint32_t len) {
+  // Declare volatile to avoid timing loop from being optimized out
+  [[maybe_unused]] volatile uint32_t crc = 0;
+  const uint64_t TOTAL_BYTES = 256 * 1024 * 1024;
+  const uint64_t numLoops = TOTAL_BYTES / len;
+
+  auto start = steady_clock::now();
+  for (uint64_t i = 0; i < numLoops; i++) {
+    crc = crcFunc(data, len);
+  }
+  duration<double> elapsed = steady_clock::now() - start;
+
+  return static_cast<double>(numLoops * len) / elapsed.count() / 1e9;
+}
+
+TEST(CRC32C, Throughput) {
+  const uint32_t MAX_SIZE = 64 * 1024;
+  unique_ptr<uint8_t[]> pData(new uint8_t[MAX_SIZE]);
+  FillRandBytes(pData.get(), MAX_SIZE);
+
+  auto crc32 = [](const uint8_t* data, uint32_t len) {
+    return CRC<32>(data, len, 0);
+  };
+  auto crc32cTable = [](const uint8_t* data, uint32_t len) {
+    return CRC<32, CRC_POLY_32C, CRCMethod::SLICE_BY_16, true>(data, len, 0);
+  };
+  auto crc32cHW = [](const uint8_t* data, uint32_t len) {
+    return CRCUtils::CRC32C(data, len);
+  };
+
+  std::cerr << cppPrintf("Throughput (GB/s):\n");
+  std::cerr << cppPrintf("  %8s %10s %14s %10s\n",
+                         "Size", "CRC<32>", "CRC32C table", "CRC32C");
+  for (uint32_t len = 16; len <= MAX_SIZE; len *= 4) {
+    std::cerr << cppPrintf("  %8u %10.2lf %14.2lf %10.2lf\n", len,
+        crcThroughputGBps(crc32, pData.get(), len),
+        crcThroughputGBps(crc32cTable, pData.get(), len),
+        crcThroughputGBps(crc32cHW, pData.get(), len));
+  }
+}
+
+/*********************************
+ * Tests across CRC implementations
+ *********************************/
+// Every method must match the byte-at-a-time reference, for every width
+template <uint32_t N, uint64_t CRC_POLY>
+void expectMethodsMatch(const uint8_t* const data, const uint64_t len) {
+  const small_uint<N> INIT = CRC_INIT & small_uint<N>::max_value;
+  for (const auto init : {small_uint<N>(0), INIT}) {
+    auto ref = CRC<N, CRC_POLY, CRCMethod::BYTEWISE>(data, len, init);
+    EXPECT_EQ(ref, (CRC<N, CRC_POLY, CRCMethod::SLICE_BY_8>(data, len, init)))
+        << "N = " << N << ", len = " << len;
+    EXPECT_EQ(ref, (CRC<N, CRC_POLY, CRCMethod::SLICE_BY_16>(data, len, init)))
+        << "N = " << N << ", len = " << len;
+    EXPECT_EQ(ref, (CRC<N, CRC_POLY, CRCMethod::CLMUL>(data, len, init)))
+        << "N = " << N << ", len = " << len;
+    EXPECT_EQ(ref, (CRC<N, CRC_POLY, CRCMethod::AUTO>(data, len, init)))
+        << "N = " << N << ", len = " << len;
+  }
+}
+
+template <uint32_t... Offsets>
+void expectMethodsMatchAllWidths(const uint8_t* const data, const uint64_t len,
+                                 std::integer_sequence<uint32_t, Offsets...>) {
+  (expectMethodsMatch<8 + Offsets, CRCUtils::CRC_POLY_TABLE[8 + Offsets]>(
+      data, len), ...);
+}
+
+TEST(CRCMethods, BitExact) {
+  const uint32_t BUF_SIZE = 64 * 1024 + 77;
+  unique_ptr<uint8_t[]> pData(new uint8_t[BUF_SIZE]);
+  FillRandBytes(pData.get(), BUF_SIZE);
+
+  std::vector<uint64_t> lengths;
+  for (uint64_t len = 0; len <= 600; len++) {
+    lengths.push_back(len);
+  }
+  lengths.push_back(4096);
+  lengths.push_back(BUF_SIZE);
+
+  for (uint64_t len : lengths) {
+    expectMethodsMatchAllWidths(pData.get(), len,
+                                std::make_integer_sequence<uint32_t, 25>());
+
+    // Polynomials w/o the explicit top bit
+    expectMethodsMatch<16, 0x1021>(pData.get(), len);
+    expectMethodsMatch<32, 0x04C11DB7>(pData.get(), len);
+
+    // Unaligned start
+    if (len > 0) {
+      expectMethodsMatch<32, CRCUtils::CRC_POLY_TABLE[32]>(pData.get() + 1,
+                                                          len - 1);
+    }
+  }
+}
+
+// Bit-at-a-time CRC, straight from the definition
+template <uint32_t N, uint64_t CRC_POLY, bool REFLECTED>
+uint64_t bitwiseCRC(const uint8_t* const data, const uint64_t len,
+                    uint64_t crc) {
+  const uint64_t MASK = N == 64 ? ~0ULL : (1ULL << N) - 1;
+  uint64_t poly = CRC_POLY & MASK;
+  if (REFLECTED) {
+    poly = CRCUtils::internal::reflectBits(poly, N);
+  }
+
+  for (uint64_t i = 0; i < len; i++) {
+    for (uint32_t bit = 0; bit < 8; bit++) {
+      if (REFLECTED) {
+        bool out = ((crc ^ (data[i] >> bit)) & 1) != 0;
+        crc = (crc >> 1) ^ (out ? poly : 0);
+      } else {
+        bool out = (((crc >> (N - 1)) ^ (data[i] >> (7 - bit))) & 1) != 0;
+        crc = ((crc << 1) & MASK) ^ (out ? poly : 0);
+      }
+    }
+  }
+
+  return crc;
+}
+
+template <uint32_t N, uint64_t CRC_POLY, bool REFLECTED>
+void expectMatchesBitwise(const uint8_t* const data, const uint64_t len) {
+  const small_uint<N> INIT = CRC_INIT & small_uint<N>::max_value;
+  const auto ref = bitwiseCRC<N, CRC_POLY, REFLECTED>(data, len, INIT);
+  EXPECT_EQ(ref, (CRC<N, CRC_POLY, CRCMethod::BYTEWISE, REFLECTED>(
+                     data, len, INIT)))
+      << "N = " << N << ", reflected = " << REFLECTED << ", len = " << len;
+  EXPECT_EQ(ref, (CRC<N, CRC_POLY, CRCMethod::SLICE_BY_8, REFLECTED>(
+                     data, len, INIT)))
+      << "N = " << N << ", reflected = " << REFLECTED << ", len = " << len;
+  EXPECT_EQ(ref, (CRC<N, CRC_POLY, CRCMethod::SLICE_BY_16, REFLECTED>(
+                     data, len, INIT)))
+      << "N = " << N << ", reflected = " << REFLECTED << ", len = " << len;
+  EXPECT_EQ(ref, (CRC<N, CRC_POLY, CRCMethod::CLMUL, REFLECTED>(
+                     data, len, INIT)))
+      << "N = " << N << ", reflected = " << REFLECTED << ", len = " << len;
+}
+
+template <uint32_t... Offsets>
+void expectAllWidthsMatchBitwise(const uint8_t* const data,
+                                 const uint64_t len,
+                                 std::integer_sequence<uint32_t, Offsets...>) {
+  (expectMatchesBitwise<3 + Offsets, CRCUtils::CRC_POLY_TABLE[3 + Offsets],
+                        false>(data, len), ...);
+  (expectMatchesBitwise<3 + Offsets, CRCUtils::CRC_POLY_TABLE[3 + Offsets],
+                        true>(data, len), ...);
+}
+
+// Every width from 3 to 64 bits, in both bit orders
+TEST(CRCMethods, AllWidths) {
+  const uint32_t BUF_SIZE = 4096 + 77;
+  unique_ptr<uint8_t[]> pData(new uint8_t[BUF_SIZE]);
+  FillRandBytes(pData.get(), BUF_SIZE);
+
+  std::vector<uint64_t> lengths;
+  for (uint64_t len = 0; len <= 70; len++) {
+    lengths.push_back(len);
+  }
+  for (uint64_t len : {127UL, 128UL, 129UL, 255UL, 256UL, 257UL, 1000UL}) {
+    lengths.push_back(len);
+  }
+  lengths.push_back(BUF_SIZE);
+
+  for (uint64_t len : lengths) {
+    expectAllWidthsMatchBitwise(pData.get(), len,
+                                std::make_integer_sequence<uint32_t, 62>());
+  }
+}
+
+// "Check" values of standard CRCs, from the CRC RevEng catalogue
+TEST(CRCMethods, StandardCheckValues) {
+  const string CHECK = "123456789";
+  const uint8_t* const data = (const uint8_t*)CHECK.data();
+  const uint64_t len = CHECK.size();
+
+  // CRC-3/GSM
+  EXPECT_EQ((CRC<3, 0x3>(data, len, 0) ^ 0x7), 0x4);
+  // CRC-4/G-704
+  EXPECT_EQ((CRC<4, 0x3, CRCMethod::AUTO, true>(data, len, 0)), 0x7);
+  // CRC-5/USB
+  EXPECT_EQ((CRC<5, 0x05, CRCMethod::AUTO, true>(data, len, 0x1F)) ^ 0x1F,
+            0x19);
+  // CRC-6/G-704
+  EXPECT_EQ((CRC<6, 0x03, CRCMethod::AUTO, true>(data, len, 0)), 0x06);
+  // CRC-7/MMC
+  EXPECT_EQ((CRC<7, 0x09>(data, len, 0)), 0x75);
+  // CRC-8/SMBUS
+  EXPECT_EQ((CRC<8, 0x07>(data, len, 0)), 0xF4);
+  // CRC-16/XMODEM
+  EXPECT_EQ((CRC<16, 0x1021>(data, len, 0)), 0x31C3);
+  // CRC-16/ARC
+  EXPECT_EQ((CRC<16, 0x8005, CRCMethod::AUTO, true>(data, len, 0)), 0xBB3D);
+  // CRC-24/OPENPGP
+  EXPECT_EQ((CRC<24, 0x864CFB>(data, len, 0xB704CE)), 0x21CF02U);
+  // CRC-32/BZIP2
+  EXPECT_EQ((CRC<32, 0x04C11DB7>(data, len, 0xFFFFFFFF) ^ 0xFFFFFFFF),
+            0xFC891918U);
+  // CRC-32/ISO-HDLC (i.e. zlib's crc32())
+  EXPECT_EQ((CRC<32, 0x04C11DB7, CRCMethod::AUTO, true>(
+                data, len, 0xFFFFFFFF)) ^ 0xFFFFFFFF,
+            0xCBF43926U);
+  // CRC-32C
+  EXPECT_EQ((CRC<32, 0x1EDC6F41, CRCMethod::AUTO, true>(
+                data, len, 0xFFFFFFFF)) ^ 0xFFFFFFFF,
+            0xE3069283U);
+  // CRC-40/GSM
+  EXPECT_EQ((CRC<40, 0x0004820009>(data, len, 0) ^ 0xFFFFFFFFFF),
+            0xD4164FC646UL);
+  // CRC-64/ECMA-182
+  EXPECT_EQ(CRC<64>(data, len, 0), 0x6C40DF5F0B497347UL);
+  // CRC-64/XZ
+  EXPECT_EQ((CRC<64, CRC_POLY_64, CRCMethod::AUTO, true>(
+                data, len, ~0UL)) ^ ~0UL,
+            0x995DC9BBDF1939FAUL);
+  // CRC-64/GO-ISO
+  EXPECT_EQ((CRC<64, 0x1B, CRCMethod::AUTO, true>(data, len, ~0UL)) ^ ~0UL,
+            0xB90956C775A41001UL);
+}
+
+template <uint32_t N, CRCMethod METHOD>
+double avgCRCTimeMs(const uint8_t* const data, const uint32_t len,
+                    const uint32_t numLoops) {
+  // Declare volatile to avoid timing loop from being optimized out
+  [[maybe_unused]] volatile typename small_uint<N>::repr_type crc = 0;
+
+  auto start = steady_clock::now();
+  for (uint32_t i = 0; i < numLoops; i++) {
+    crc = CRC<N, METHOD>(data, len, 0x0);
+  }
+  duration<double> elapsed = steady_clock::now() - start;
+
+  return elapsed.count() * 1000 / numLoops;
+}
+
+TEST(CRCMethods, Rand_1MB_Looped) {
+  const uint32_t BUF_SIZE = 1024 * 1024;
+  unique_ptr<uint8_t[]> pData(new uint8_t[BUF_SIZE]);
+  const uint32_t NUM_LOOPS = 200;
+
+  FillRandBytes(pData.get(), BUF_SIZE);
+
+  std::cerr << cppPrintf("Average time over %u bytes (ms):\n", BUF_SIZE);
+  std::cerr << cppPrintf("  CRC14: bytewise %lf, slice-by-8 %lf, "
+                         "slice-by-16 %lf, clmul %lf\n",
+      avgCRCTimeMs<14, CRCMethod::BYTEWISE>(pData.get(), BUF_SIZE, NUM_LOOPS),
+      avgCRCTimeMs<14, CRCMethod::SLICE_BY_8>(pData.get(), BUF_SIZE, NUM_LOOPS),
+      avgCRCTimeMs<14, CRCMethod::SLICE_BY_16>(pData.get(), BUF_SIZE, NUM_LOOPS),
+      avgCRCTimeMs<14, CRCMethod::CLMUL>(pData.get(), BUF_SIZE, NUM_LOOPS));
+  std::cerr << cppPrintf("  CRC32: bytewise %lf, slice-by-8 %lf, "
+                         "slice-by-16 %lf, clmul %lf\n",
+      avgCRCTimeMs<32, CRCMethod::BYTEWISE>(pData.get(), BUF_SIZE, NUM_LOOPS),
+      avgCRCTimeMs<32, CRCMethod::SLICE_BY_8>(pData.get(), BUF_SIZE, NUM_LOOPS),
+      avgCRCTimeMs<32, CRCMethod::SLICE_BY_16>(pData.get(), BUF_SIZE, NUM_LOOPS),
+      avgCRCTimeMs<32, CRCMethod::CLMUL>(pData.get(), BUF_SIZE, NUM_LOOPS));
+  std::cerr << cppPrintf("  CRC64: bytewise %lf, slice-by-8 %lf, "
+                         "slice-by-16 %lf, clmul %lf\n",
+      avgCRCTimeMs<64, CRCMethod::BYTEWISE>(pData.get(), BUF_SIZE, NUM_LOOPS),
+      avgCRCTimeMs<64, CRCMethod::SLICE_BY_8>(pData.get(), BUF_SIZE, NUM_LOOPS),
+      avgCRCTimeMs<64, CRCMethod::SLICE_BY_16>(pData.get(), BUF_SIZE, NUM_LOOPS),
+      avgCRCTimeMs<64, CRCMethod::CLMUL>(pData.get(), BUF_SIZE, NUM_LOOPS));
+}
+
+/*********************************
+ * Streaming CRC & combine Tests
+ *********************************/
+template <uint32_t N, uint64_t CRC_POLY, bool REFLECTED = false>
+void expectStreamingMatches(const uint8_t* const data, const uint64_t len) {
+  const small_uint<N> INIT = CRC_INIT & small_uint<N>::max_value;
+  const auto expected =
+      CRC<N, CRC_POLY, CRCMethod::AUTO, REFLECTED>(data, len, INIT);
+
+  // Arbitrary, uneven chunks
+  CRCState<N, CRC_POLY, CRCMethod::AUTO, REFLECTED> state(INIT);
+  uint64_t pos = 0;
+  for (uint64_t chunk = 1; pos < len; chunk = chunk * 3 + 1) {
+    uint64_t sz = std::min(chunk, len - pos);
+    state.update(data + pos, sz);
+    pos += sz;
+  }
+  EXPECT_EQ(state.finalize(), expected) << "N = " << N << ", len = " << len;
+  EXPECT_EQ(state.length(), len);
+
+  // Split at every 97th point, and combine the CRCs of both halves
+  for (uint64_t split = 0; split <= len; split += 97) {
+    auto crcA = CRC<N, CRC_POLY, CRCMethod::AUTO, REFLECTED>(data, split, INIT);
+    auto crcB = CRC<N, CRC_POLY, CRCMethod::AUTO, REFLECTED>(data + split,
+                                                             len - split, 0);
+    EXPECT_EQ((CRCCombine<N, CRC_POLY, REFLECTED>(crcA, crcB, len - split)),
+              expected)
+        << "N = " << N << ", len = " << len << ", split = " << split;
+
+    // Second half calculated w/ a non-zero init
+    crcB = CRC<N, CRC_POLY, CRCMethod::AUTO, REFLECTED>(data + split,
+                                                        len - split, INIT);
+    EXPECT_EQ((CRCCombine<N, CRC_POLY, REFLECTED>(crcA, crcB, len - split,
+                                                  INIT)),
+              expected)
+        << "N = " << N << ", len = " << len << ", split = " << split;
+  }
+}
+
+TEST(CRCStreaming, MatchesOneShot) {
+  const uint32_t BUF_SIZE = 8 * 1024 + 3;
+  unique_ptr<uint8_t[]> pData(new uint8_t[BUF_SIZE]);
+  FillRandBytes(pData.get(), BUF_SIZE);
+
+  for (uint64_t len : {0UL, 1UL, 7UL, 100UL, 1000UL, 4096UL,
+                       static_cast<uint64_t>(BUF_SIZE)}) {
+    expectStreamingMatches<8, CRCUtils::CRC_POLY_TABLE[8]>(pData.get(), len);
+    expectStreamingMatches<14, CRCUtils::CRC_POLY_TABLE[14]>(pData.get(), len);
+    expectStreamingMatches<16, 0x1021>(pData.get(), len);
+    expectStreamingMatches<23, CRCUtils::CRC_POLY_TABLE[23]>(pData.get(), len);
+    expectStreamingMatches<32, CRCUtils::CRC_POLY_TABLE[32]>(pData.get(), len);
+    expectStreamingMatches<5, CRCUtils::CRC_POLY_TABLE[5]>(pData.get(), len);
+    expectStreamingMatches<40, CRCUtils::CRC_POLY_TABLE[40]>(pData.get(), len);
+    expectStreamingMatches<64, CRCUtils::CRC_POLY_TABLE[64]>(pData.get(), len);
+
+    // Reflected
+    expectStreamingMatches<5, 0x05, true>(pData.get(), len);
+    expectStreamingMatches<32, 0x1EDC6F41, true>(pData.get(), len);
+    expectStreamingMatches<64, CRC_POLY_64, true>(pData.get(), len);
+  }
+
+  // Reset restarts the calculation
+  CRCState<32> state;
+  state.update(pData.get(), 10);
+  state.reset(5);
+  state.update(pData.get(), 20);
+  EXPECT_EQ(state.finalize(), CRC<32>(pData.get(), 20, 5));
+  EXPECT_THROW(state.update(nullptr, 1), std::invalid_argument);
+}
+
+// CRC of a large buffer, computed as independent chunks then combined
+TEST(CRCStreaming, ParallelChunks) {
+  const uint32_t BUF_SIZE = 4 * 1024 * 1024 + 5;
+  const uint32_t NUM_CHUNKS = 4;
+  unique_ptr<uint8_t[]> pData(new uint8_t[BUF_SIZE]);
+  FillRandBytes(pData.get(), BUF_SIZE);
+
+  const uint32_t CHUNK = BUF_SIZE / NUM_CHUNKS;
+  std::vector<small_uint<32>::repr_type> crcs(NUM_CHUNKS);
+  std::vector<std::thread> workers;
+  for (uint32_t i = 0; i < NUM_CHUNKS; i++) {
+    workers.emplace_back([&, i]() {
+      uint64_t len = (i == NUM_CHUNKS - 1) ? BUF_SIZE - i * CHUNK : CHUNK;
+      crcs[i] = CRC<32>(pData.get() + i * CHUNK, len,
+                        i == 0 ? CRC_INIT & 0xFFFFFFFF : 0);
+    });
+  }
+  for (auto& thr : workers) {
+    thr.join();
+  }
+
+  auto combined = crcs[0];
+  for (uint32_t i = 1; i < NUM_CHUNKS; i++) {
+    uint64_t len = (i == NUM_CHUNKS - 1) ? BUF_SIZE - i * CHUNK : CHUNK;
+    combined = CRCCombine<32>(combined, crcs[i], len);
+  }
+
+  EXPECT_EQ(combined, CRC<32>(pData.get(), BUF_SIZE, CRC_INIT & 0xFFFFFFFF));
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -0,0 +1,62 @@
+#pragma once
+
+// C library headers
+#include <stddef.h>
+#include <stdint.h>
+
+// C++ library headers
+#include <random>
+#include <vector>
+
+// Helpers for building Message Groups (see ../mplex-msg) in tests. Templated
+// on the group type, so any header version or buffer provider can be used.
+namespace TestUtils {
+
+/* Fills a 'sz'-byte group of type Group, one frame at a time, until it's full
+ * or writeFrame() returns false. writeFrame(frame, frameNum) should write the
+ * frame's data & header, returning false if it couldn't.
+ * If 'nFrames' is non-NULL, it's set to the number of frames written.
+ * Returns the group's bytes, up to & including its trailer.
+ */
+template <typename Group, typename WriteFrame>
+std::vector<uint8_t> writeGroup(uint16_t sz, WriteFrame writeFrame,
+                                size_t* nFrames = nullptr) {
+  Group msgGroup(sz);
+  size_t n = 0;
+  for (auto pMsg = msgGroup.currFrame();
+       pMsg != nullptr && writeFrame(*pMsg, n);
+       pMsg = msgGroup.commitFrame()) {
+    n++;
+  }
+  msgGroup.writeHeaderTrailer();
+
+  if (nFrames != nullptr) {
+    *nFrames = n;
+  }
+  return std::vector<uint8_t>(msgGroup.getBuf(),
+                              msgGroup.getBuf() + msgGroup.processedSize());
+}
+
+// Same as above, w/ frames of 1-64 random uint32_t's & IDs cycling 0-99
+template <typename Group>
+std::vector<uint8_t> writeRandomGroup(std::default_random_engine& eng,
+                                      uint16_t sz,
+                                      size_t* nFrames = nullptr) {
+  std::uniform_int_distribution<uint32_t> distr;
+  auto writeFrame = [&eng, &distr](typename Group::msg_t& frame,
+                                   size_t frameNum) {
+    std::vector<uint32_t> vals(1 + distr(eng) % 64);
+    for (uint32_t& val : vals) {
+      val = distr(eng);
+    }
+    if (frame.writeSpan(vals.data(), vals.size()) == false) {
+      return false;
+    }
+    frame.writeHeader(static_cast<uint8_t>(frameNum % 100));
+    return true;
+  };
+
+  return writeGroup<Group>(sz, writeFrame, nFrames);
+}
+
+} // namespace TestUtils
@@ -0,0 +1,320 @@
+/*
+ * Throughput benchmark for the mplex-msg codecs. For v0 & v1 headers, over
+ * several payload size distributions, reports frames/s & payload bytes/s
+ * for:
+ *  - write:    writing frames into MTU-sized groups (data, header & CRC)
+ *  - validate: isValid() on each frame of the written groups (CRC check)
+ *  - stuff:    byte-stuffing each payload, & destuff: undoing it
+ *  - scan:     walking the groups' frames w/ nextValidFrame()
+ *  - resync:   the same, w/ a bit flipped in each group's first frame
+ * and, for each StuffMethod, stuffing an escape-heavy MTU-sized payload.
+ *
+ * Usage: ./bench_MsgCodec [scale]
+ *   'scale' multiplies the work done per measurement (default 1).
+ */
+
+// C++ libs
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// C libs
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "byte_stuff.hpp"
+#include "mplex_msg_group.hpp"
+
+// 1472 = 1500 - 20 - 8; to emulate MTU of 1500
+#define BUF_SIZE 1472
+
+using namespace std;
+using ByteStuffUtils::StuffMethod;
+
+typedef vector<uint8_t> bytes_t;
+
+// Payload sizes drawn per distribution
+const size_t NUM_FRAMES = 20000;
+// Payload Bytes to process per measurement, at a scale of 1
+const double TARGET_BYTES = 32.0 * 1024 * 1024;
+
+// Keeps results from being optimized away
+volatile uint64_t sink;
+
+// Payload sizes, drawn from [1, 'maxLen']
+struct Distribution {
+  const char* name;
+  function<uint16_t(default_random_engine&, uint16_t maxLen)> draw;
+};
+
+const Distribution DISTRIBUTIONS[] = {
+  {"fixed 16 B", [](default_random_engine&, uint16_t) -> uint16_t {
+    return 16;
+  }},
+  {"uniform 1 B-max", [](default_random_engine& eng, uint16_t maxLen) {
+    return uniform_int_distribution<uint16_t>(1, maxLen)(eng);
+  }},
+  {"bimodal 90% 64 B, 10% max", [](default_random_engine& eng,
+                                   uint16_t maxLen) -> uint16_t {
+    return uniform_int_distribution<uint16_t>(0, 9)(eng) == 0 ? maxLen : 64;
+  }},
+  {"fixed max", [](default_random_engine&, uint16_t maxLen) {
+    return maxLen;
+  }},
+};
+
+void report(const char* op, double nFrames, double nBytes, double secs) {
+  cout << "    " << left << setw(10) << op << right << fixed
+       << setprecision(2) << setw(9) << nFrames / secs / 1e6 << " M frames/s"
+       << setw(11) << nBytes / secs / 1e6 << " MB/s" << endl;
+}
+
+template <typename MsgGroupHeader>
+class CodecBench {
+  typedef MplexMsgGroup<MsgGroupHeader> group_t;
+  typedef typename group_t::msg_t msg_t;
+  typedef typename MsgHeaders<MsgGroupHeader::VERS>::frame_header_t
+      frame_header_t;
+
+  // Largest payload that fits in a group
+  static const uint16_t MAX_LEN = BUF_SIZE - group_t::MIN_SIZE -
+                                  sizeof(frame_header_t);
+
+  // A written frame: its group & offset in it
+  struct FrameLoc {
+    size_t group;
+    uint16_t offset;
+  };
+
+  vector<uint16_t> lens_;
+  bytes_t payload_;
+  size_t payloadBytes_ = 0;
+  size_t nLoops_ = 1;
+
+  vector<bytes_t> groups_;
+  vector<FrameLoc> frames_;
+
+  /**
+   * @brief Writes all the payloads into groups, passing each finished group
+   *        to 'emit'.
+   */
+  template <typename Emit>
+  void writeAll_(group_t& group, Emit emit) {
+    group.reset();
+    for (size_t i = 0; i < lens_.size(); i++) {
+      size_t frameSz = sizeof(frame_header_t) + lens_[i];
+      if (size_t(group.processedSize()) + frameSz > group.getBufSize()) {
+        group.writeHeaderTrailer();
+        emit(group);
+        group.reset();
+      }
+
+      msg_t* pMsg = group.currFrame();
+      pMsg->writeSpan(payload_.data(), lens_[i]);
+      pMsg->writeHeader(static_cast<uint8_t>(i % 64));
+      group.commitFrame();
+    }
+    group.writeHeaderTrailer();
+    emit(group);
+  }
+
+  template <typename Fn>
+  double time_(Fn fn) {
+    auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i < nLoops_; i++) {
+      fn();
+    }
+    chrono::duration<double> secs = chrono::steady_clock::now() - start;
+    return secs.count();
+  }
+
+  /**
+   * @brief Walks the frames of each group, returning the # found.
+   */
+  size_t scan_(vector<bytes_t>& groups) {
+    size_t nFound = 0;
+    for (bytes_t& bytes : groups) {
+      group_t view(MPLEX_VIEW, bytes.data(),
+                   static_cast<uint16_t>(bytes.size()));
+      nFound += view.forEachValidFrame([](msg_t&) {});
+    }
+    return nFound;
+  }
+
+  public:
+    void run(const Distribution& distr, double scale) {
+      default_random_engine eng(1);
+      lens_.resize(NUM_FRAMES);
+      payloadBytes_ = 0;
+      for (uint16_t& len : lens_) {
+        len = distr.draw(eng, MAX_LEN);
+        payloadBytes_ += len;
+      }
+      payload_.resize(MAX_LEN);
+      for (uint8_t& byte : payload_) {
+        byte = static_cast<uint8_t>(eng());
+      }
+
+      // Roughly the same time per measurement, w/ a per-frame overhead
+      double perLoop = double(payloadBytes_) + 64.0 * NUM_FRAMES;
+      nLoops_ = static_cast<size_t>(scale * TARGET_BYTES / perLoop) + 1;
+      double nFrames = double(NUM_FRAMES) * double(nLoops_);
+      double nBytes = double(payloadBytes_) * double(nLoops_);
+
+      // Keep a copy of the groups, & where their frames are
+      group_t group(BUF_SIZE);
+      groups_.clear();
+      frames_.clear();
+      writeAll_(group, [this](group_t& written) {
+        groups_.emplace_back(written.getBuf(),
+                             written.getBuf() + written.processedSize());
+      });
+      for (size_t g = 0; g < groups_.size(); g++) {
+        group_t view(MPLEX_VIEW, groups_[g].data(),
+                     static_cast<uint16_t>(groups_[g].size()));
+        msg_t* pMsg = view.currFrame();
+        for (uint16_t offset = sizeof(MsgGroupHeader);
+             pMsg != nullptr && pMsg->isEndOfMsgGroup() == false;
+             pMsg = view.nextValidFrame()) {
+          frames_.push_back({g, offset});
+          offset = static_cast<uint16_t>(offset + pMsg->msgSize());
+        }
+      }
+      if (frames_.size() != NUM_FRAMES) {
+        // TODO: Replace w/ log
+        cerr << "ERROR: Wrote " << frames_.size() << " of " << NUM_FRAMES
+             << " frames" << endl;
+        exit(1);
+      }
+
+      cout << "  " << distr.name << " (" << groups_.size() << " groups, avg "
+           << payloadBytes_ / NUM_FRAMES << " B/frame)" << endl;
+
+      double secs = time_([&]() {
+        size_t nGroups = 0;
+        writeAll_(group, [&nGroups](group_t&) { nGroups++; });
+        sink = nGroups;
+      });
+      report("write", nFrames, nBytes, secs);
+
+      secs = time_([this]() {
+        msg_t frame;
+        size_t nValid = 0;
+        for (const FrameLoc& loc : frames_) {
+          bytes_t& bytes = groups_[loc.group];
+          frame.reset(bytes.data() + loc.offset,
+                      static_cast<uint16_t>(bytes.size() - loc.offset),
+                      MplexOpMode::READ);
+          nValid += frame.isValid();
+        }
+        sink = nValid;
+      });
+      report("validate", nFrames, nBytes, secs);
+
+      // Avoid the frame magic # followed by 0
+      const uint8_t avoidSeq[2] = {msg_t::MAGIC_NUMBER, 0x00};
+      bytes_t stuffed(2 * MAX_LEN);
+      bytes_t destuffed(2 * MAX_LEN);
+      vector<uint32_t> stuffedLens(NUM_FRAMES);
+      secs = time_([&]() {
+        for (size_t i = 0; i < lens_.size(); i++) {
+          int64_t len = ByteStuffUtils::stuff(
+              payload_.data(), lens_[i], stuffed.data(),
+              static_cast<uint32_t>(stuffed.size()), avoidSeq, 2);
+          stuffedLens[i] = static_cast<uint32_t>(len);
+        }
+      });
+      report("stuff", nFrames, nBytes, secs);
+
+      secs = time_([&]() {
+        // Destuffs the stuffed payload each time; same cost per length
+        int64_t total = 0;
+        for (size_t i = 0; i < lens_.size(); i++) {
+          total += ByteStuffUtils::destuff(
+              stuffed.data(), stuffedLens[i], destuffed.data(),
+              static_cast<uint32_t>(destuffed.size()), avoidSeq, 2);
+        }
+        sink = static_cast<uint64_t>(total);
+      });
+      report("destuff", nFrames, nBytes, secs);
+
+      secs = time_([this]() { sink = scan_(groups_); });
+      report("scan", nFrames, nBytes, secs);
+
+      // Flip a bit in the data of each group's first frame, so the rest of
+      // the group is found by resyncing
+      vector<bytes_t> corrupted = groups_;
+      size_t nFrames1st = 0;
+      for (bytes_t& bytes : corrupted) {
+        bytes[sizeof(MsgGroupHeader) + sizeof(frame_header_t)] ^= 0x01;
+        nFrames1st++;
+      }
+      secs = time_([&]() { sink = scan_(corrupted); });
+      if (scan_(corrupted) + nFrames1st != NUM_FRAMES) {
+        // TODO: Replace w/ log
+        cerr << "ERROR: Frames lost resyncing" << endl;
+        exit(1);
+      }
+      report("resync", nFrames, nBytes, secs);
+    }
+};
+
+// Stuffs 'data' w/ 'method' 'nLoops' times
+template <StuffMethod method>
+void stuffWith(const char* name, const bytes_t& data, size_t nLoops) {
+  const uint8_t avoidSeq[3] = {0x7E, 0x81, 0x00};
+  bytes_t stuffed(2 * data.size());
+  auto start = chrono::steady_clock::now();
+  int64_t total = 0;
+  for (size_t i = 0; i < nLoops; i++) {
+    total += ByteStuffUtils::stuff<method>(
+        data.data(), static_cast<uint32_t>(data.size()), stuffed.data(),
+        static_cast<uint32_t>(stuffed.size()), avoidSeq, 3);
+  }
+  chrono::duration<double> secs = chrono::steady_clock::now() - start;
+  sink = static_cast<uint64_t>(total);
+  report(name, double(nLoops), double(nLoops) * double(data.size()),
+         secs.count());
+}
+
+void runStuffMethods(double scale) {
+  // Roughly 1 in 4 positions starts an escaped prefix
+  default_random_engine eng(1);
+  uniform_int_distribution<int> coin(0, 1);
+  bytes_t data(BUF_SIZE);
+  for (uint8_t& byte : data) {
+    byte = coin(eng) ? 0x7E : 0x81;
+  }
+
+  size_t nLoops = static_cast<size_t>(scale * TARGET_BYTES / BUF_SIZE) + 1;
+  cout << "Stuffing " << BUF_SIZE << "-byte escape-heavy payloads:" << endl;
+  stuffWith<StuffMethod::SCALAR>("SCALAR", data, nLoops);
+  stuffWith<StuffMethod::SSE2>("SSE2", data, nLoops);
+  stuffWith<StuffMethod::AVX2>("AVX2", data, nLoops);
+}
+
+template <typename MsgGroupHeader>
+void runAll(const char* name, double scale) {
+  cout << name << " headers, " << BUF_SIZE << "-byte groups:" << endl;
+  CodecBench<MsgGroupHeader> bench;
+  for (const Distribution& distr : DISTRIBUTIONS) {
+    bench.run(distr, scale);
+  }
+}
+
+int main(int argc, char** argv) {
+  double scale = argc > 1 ? atof(argv[1]) : 1.0;
+  if (scale <= 0) {
+    cerr << "Usage: " << argv[0] << " [scale]" << endl;
+    return 1;
+  }
+
+  runAll<MsgGroupHeader_v0>("v0", scale);
+  runAll<MsgGroupHeader_v1>("v1", scale);
+  runStuffMethods(scale);
+  return 0;
+}
@@ -0,0 +1,270 @@
+#ifndef MPLEX_BUFFER_POOL_H
+#define MPLEX_BUFFER_POOL_H
+
+// C headers
+#include <stdint.h>
+#include <stddef.h>
+
+// C++ headers
+#include <atomic>
+#include <new>
+
+/*
+ * Buffer providers for MplexMsgGroup. A provider hands out raw buffers w/
+ *    static uint8_t* acquire(uint16_t sz);  // Throws std::bad_alloc
+ *    static void release(uint8_t* buf, uint16_t sz);
+ * where release() is passed the size the buffer was acquired w/.
+ */
+
+// Provider that simply uses new[] & delete[]
+struct MplexHeapBuffers {
+  static uint8_t* acquire(uint16_t sz) {
+    return new uint8_t[sz];
+  }
+
+  static void release(uint8_t* buf, uint16_t) {
+    delete[] buf;
+  }
+};
+
+/*
+ * Provider that recycles slabs in size classes of SLAB_SIZE, SLAB_SIZE / 2,
+ * SLAB_SIZE / 4, ... (up to MAX_CLASSES of them, none smaller than 1 byte).
+ * Each request is served from the smallest class that fits it, so e.g. a
+ * 1472-byte group holds a 2 KiB slab rather than a 64 KiB one.
+ *
+ * For each class, each thread keeps up to THREAD_CACHE released slabs for
+ * itself, in front of a process-wide, lock-free freelist of up to CAPACITY
+ * slabs (D. Vyukov's bounded MPMC queue, as in MPMCChannel) through which
+ * slabs move between threads, e.g. when groups are built on one thread &
+ * freed on another.
+ *
+ * Requests that fit in a slab take one of their class from the thread's
+ * cache or the freelist (a hit), or allocate a new slab if both are empty
+ * (a miss). Released slabs go back to the thread's cache or the freelist,
+ * or are freed if both are full. Larger requests bypass the pool and count
+ * as misses.
+ *
+ * NOTE: A freelist push that is preempted mid-way briefly hides the slabs
+ *       behind it, so pops that race w/ it miss rather than wait.
+ *
+ * Each instantiation has its own pool.
+ */
+template <uint32_t SLAB_SIZE = 64 * 1024, size_t CAPACITY = 64,
+          size_t THREAD_CACHE = 4>
+class MplexBufferPool {
+  static_assert(CAPACITY >= 2 && (CAPACITY & (CAPACITY - 1)) == 0,
+                "CAPACITY must be a power of 2 >= 2");
+
+  public:
+    // Snapshot of the pool's counters, summed over all size classes
+    struct Stats {
+      uint64_t hits;
+      uint64_t misses;
+    };
+
+    static constexpr size_t MAX_CLASSES = 8;
+
+  private:
+    static constexpr size_t CACHE_LINE = 64;
+
+    static constexpr size_t numClasses_() {
+      size_t n = 1;
+      while (n < MAX_CLASSES && (SLAB_SIZE >> n) != 0) {
+        n++;
+      }
+      return n;
+    }
+    static constexpr size_t NUM_CLASSES = numClasses_();
+
+    // Bytes in each slab of class 'cls'; class 0 holds the largest slabs
+    static constexpr uint32_t classSize_(size_t cls) {
+      return SLAB_SIZE >> cls;
+    }
+
+    // Smallest class that fits 'sz' (<= SLAB_SIZE) bytes
+    static size_t classOf_(uint16_t sz) {
+      size_t cls = 0;
+      while (cls + 1 < NUM_CLASSES && classSize_(cls + 1) >= sz) {
+        cls++;
+      }
+      return cls;
+    }
+
+    /* Each slot's sequence number encodes its state relative to a position:
+     *  - seq == pos:     Slot is free for the push claiming 'pos'
+     *  - seq == pos + 1: Slot holds the slab for the pop claiming 'pos'
+     */
+    struct Slot {
+      std::atomic<size_t> seq;
+      uint8_t* slab;
+    };
+
+    class FreeList {
+      private:
+        Slot slots_[CAPACITY];
+
+        alignas(CACHE_LINE) std::atomic<size_t> pushPos_{0};
+        alignas(CACHE_LINE) std::atomic<size_t> popPos_{0};
+
+      public:
+        alignas(CACHE_LINE) std::atomic<uint64_t> hits{0};
+        std::atomic<uint64_t> misses{0};
+
+        FreeList() {
+          for (size_t i = 0; i < CAPACITY; i++) {
+            slots_[i].seq.store(i, std::memory_order_relaxed);
+            slots_[i].slab = nullptr;
+          }
+        }
+
+        ~FreeList() {
+          for (uint8_t* slab = pop(); slab != nullptr; slab = pop()) {
+            delete[] slab;
+          }
+        }
+
+        // Returns false if the freelist is full
+        bool push(uint8_t* slab) {
+          size_t pos = pushPos_.load(std::memory_order_relaxed);
+          for (;;) {
+            Slot& slot = slots_[pos & (CAPACITY - 1)];
+            size_t seq = slot.seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq - pos);
+            if (diff == 0) {
+              if (pushPos_.compare_exchange_weak(pos, pos + 1,
+                                                 std::memory_order_relaxed)) {
+                slot.slab = slab;
+                slot.seq.store(pos + 1, std::memory_order_release);
+                return true;
+              }
+            } else if (diff < 0) {
+              return false;
+            } else {
+              pos = pushPos_.load(std::memory_order_relaxed);
+            }
+          }
+        }
+
+        // Returns nullptr if the freelist is empty
+        uint8_t* pop() {
+          size_t pos = popPos_.load(std::memory_order_relaxed);
+          for (;;) {
+            Slot& slot = slots_[pos & (CAPACITY - 1)];
+            size_t seq = slot.seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq - (pos + 1));
+            if (diff == 0) {
+              if (popPos_.compare_exchange_weak(pos, pos + 1,
+                                                std::memory_order_relaxed)) {
+                uint8_t* slab = slot.slab;
+                slot.seq.store(pos + CAPACITY, std::memory_order_release);
+                return slab;
+              }
+            } else if (diff < 0) {
+              return nullptr;
+            } else {
+              pos = popPos_.load(std::memory_order_relaxed);
+            }
+          }
+        }
+    };
+
+    // One per size class. Constructed on first use, so they outlive any
+    // (static) group that acquired a slab from them.
+    static FreeList& freeList_(size_t cls) {
+      static FreeList freeLists[NUM_CLASSES];
+      return freeLists[cls];
+    }
+
+    // Hands its slabs over to the freelists when the thread exits. Slabs
+    // released after that (e.g. by static groups) skip the cache.
+    struct ThreadCache {
+      uint8_t* slabs[NUM_CLASSES][THREAD_CACHE];
+      size_t len[NUM_CLASSES] = {};
+
+      ~ThreadCache() {
+        for (size_t cls = 0; cls < NUM_CLASSES; cls++) {
+          for (size_t i = 0; i < len[cls]; i++) {
+            if (freeList_(cls).push(slabs[cls][i]) == false) {
+              delete[] slabs[cls][i];
+            }
+          }
+          len[cls] = 0;
+        }
+        cacheClosed_() = true;
+      }
+    };
+
+    // Set once the thread's cache has been destroyed. Being trivially
+    // destructible, it can still be read by later thread_local destructors.
+    static bool& cacheClosed_() {
+      thread_local bool closed = false;
+      return closed;
+    }
+
+    // Returns NULL once the thread's cache has been destroyed
+    static ThreadCache* threadCache_() {
+      if (cacheClosed_()) {
+        return nullptr;
+      }
+
+      thread_local ThreadCache cache;
+      return &cache;
+    }
+
+  public:
+    static uint8_t* acquire(uint16_t sz) {
+      if (sz > SLAB_SIZE) {
+        freeList_(0).misses.fetch_add(1, std::memory_order_relaxed);
+        return new uint8_t[sz];
+      }
+
+      size_t cls = classOf_(sz);
+      FreeList& freeList = freeList_(cls);
+      ThreadCache* cache = threadCache_();
+      uint8_t* slab = cache != nullptr && cache->len[cls] > 0 ?
+                      cache->slabs[cls][--cache->len[cls]] : freeList.pop();
+      if (slab != nullptr) {
+        freeList.hits.fetch_add(1, std::memory_order_relaxed);
+        return slab;
+      }
+
+      freeList.misses.fetch_add(1, std::memory_order_relaxed);
+      return new uint8_t[classSize_(cls)];
+    }
+
+    static void release(uint8_t* buf, uint16_t sz) {
+      if (buf == nullptr) {
+        return;
+      } else if (sz > SLAB_SIZE) {
+        delete[] buf;
+        return;
+      }
+
+      size_t cls = classOf_(sz);
+      ThreadCache* cache = threadCache_();
+      if (cache != nullptr && cache->len[cls] < THREAD_CACHE) {
+        cache->slabs[cls][cache->len[cls]++] = buf;
+      } else if (freeList_(cls).push(buf) == false) {
+        delete[] buf;
+      }
+    }
+
+    // Bytes in the slab that acquire(sz) hands out (or 'sz', if it bypasses
+    // the pool)
+    static uint32_t slabSize(uint16_t sz) {
+      return sz > SLAB_SIZE ? sz : classSize_(classOf_(sz));
+    }
+
+    static Stats stats() {
+      Stats total = {0, 0};
+      for (size_t cls = 0; cls < NUM_CLASSES; cls++) {
+        FreeList& freeList = freeList_(cls);
+        total.hits += freeList.hits.load(std::memory_order_relaxed);
+        total.misses += freeList.misses.load(std::memory_order_relaxed);
+      }
+      return total;
+    }
+};
+
+#endif
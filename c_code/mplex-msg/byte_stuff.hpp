@@ -0,0 +1,778 @@
+#pragma once
+#ifndef MPLEX_BYTE_STUFF_H
+#define MPLEX_BYTE_STUFF_H
+
+// C headers
+#include <stdint.h>
+#include <string.h>
+
+// C++ headers
+#include <array>
+
+#if defined(__x86_64__)
+#define BYTE_STUFF_HAVE_X86_64
+#include <immintrin.h>
+#endif
+
+/*
+ * Byte-stuffing engine used by MplexMsgFrame::byteStuff() & byteDestuff().
+ *
+ * Stuffing escapes every occurrence of the first ('seqSz' - 1) bytes of an
+ * "avoid" sequence by following it w/ an escape byte, the bit-wise inverse
+ * of the sequence's last byte. Occurrences are found left to right and don't
+ * overlap (i.e. the same matches as repeated memmem() calls).
+ *
+ * Both directions run in a single pass from an input buffer to an output
+ * buffer. The input is scanned w/ SIMD byte-compare masks that find all
+ * prefix positions in a block at once, and the runs of bytes between them
+ * are copied in bulk.
+ */
+namespace ByteStuffUtils {
+
+/*
+ * Method to locate the prefixes w/:
+ *  - AUTO:   The widest of the below supported by the running CPU.
+ *  - SCALAR: memmem(); available everywhere.
+ *  - SSE2:   16-byte compare masks (x86-64 baseline).
+ *  - AVX2:   32-byte compare masks; same as AUTO if the CPU lacks AVX2.
+ */
+enum class StuffMethod {
+  AUTO,
+  SCALAR,
+  SSE2,
+  AVX2
+};
+
+// Implementation details of stuff() & destuff(); not meant to be called
+// directly
+namespace internal {
+
+#define BYTE_STUFF_INLINE inline __attribute__((always_inline))
+
+/*
+ * Finders locate the next occurrence of prefix 'pre' (of length 'preLen'
+ * >= 1) fully within [p, end) via find(p, end), or return nullptr. Calls
+ * must move forward through a single buffer.
+ */
+class ScalarFinder {
+  private:
+    const uint8_t* pre_;
+    uint16_t preLen_;
+
+  public:
+    ScalarFinder(const uint8_t* pre, uint16_t preLen)
+        : pre_(pre), preLen_(preLen) {}
+
+    BYTE_STUFF_INLINE
+    const uint8_t* find(const uint8_t* p, const uint8_t* end) {
+      return static_cast<const uint8_t*>(
+          memmem(p, static_cast<size_t>(end - p), pre_, preLen_));
+    }
+};
+
+#ifdef BYTE_STUFF_HAVE_X86_64
+// Max # of prefix bytes compared w/ SIMD masks; any beyond are memcmp()'d
+#define BYTE_STUFF_VEC_CMP_LEN 8
+
+/*
+ * Finds prefixes w/ 'Vec' compare masks. Bit i of a block's mask is set if
+ * p[i + k] == pre[k] for the first (up to) BYTE_STUFF_VEC_CMP_LEN bytes of
+ * 'pre', which is exact for the short prefixes byte-stuffing uses. The last
+ * block's mask is kept, since the next match is often in the same block.
+ */
+template <typename Vec>
+class VecFinder {
+  private:
+    typedef typename Vec::type vec_t;
+    static const int64_t WIDTH = Vec::WIDTH;
+
+    vec_t preVecs_[BYTE_STUFF_VEC_CMP_LEN];
+    const uint8_t* pre_;
+    uint16_t preLen_;
+    uint16_t vecLen_;
+
+    // Last block scanned & its remaining candidates
+    const uint8_t* blockStart_ = nullptr;
+    uint32_t blockMask_ = 0;
+
+    // Returns the first candidate in 'mask' that matches all of 'pre' & keeps
+    // the ones after it
+    BYTE_STUFF_INLINE
+    const uint8_t* firstMatch(const uint8_t* block, uint32_t mask) {
+      for (; mask != 0; mask &= mask - 1) {
+        const uint8_t* cand = block + __builtin_ctz(mask);
+        if (preLen_ <= vecLen_ ||
+            memcmp(cand + vecLen_, pre_ + vecLen_, preLen_ - vecLen_) == 0) {
+          blockStart_ = block;
+          blockMask_ = mask & (mask - 1);
+          return cand;
+        }
+      }
+      return nullptr;
+    }
+
+  public:
+    VecFinder(const uint8_t* pre, uint16_t preLen)
+        : pre_(pre), preLen_(preLen),
+          vecLen_(preLen < BYTE_STUFF_VEC_CMP_LEN ? preLen :
+                                                    BYTE_STUFF_VEC_CMP_LEN) {
+      for (uint16_t k = 0; k < vecLen_; k++) {
+        Vec::set1(&preVecs_[k], pre[k]);
+      }
+    }
+
+    BYTE_STUFF_INLINE
+    const uint8_t* find(const uint8_t* p, const uint8_t* end) {
+      // Remaining candidates of the last block at or after 'p'
+      if (p >= blockStart_ && p < blockStart_ + WIDTH) {
+        const uint32_t skip = static_cast<uint32_t>(p - blockStart_);
+        const uint8_t* found = firstMatch(blockStart_,
+                                          blockMask_ & (~0U << skip));
+        if (found != nullptr) {
+          return found;
+        }
+        p = blockStart_ + WIDTH;
+      }
+
+      for (; end - p >= preLen_ - 1 + WIDTH; p += WIDTH) {
+        uint32_t mask = Vec::eqMask(p, preVecs_[0]);
+        for (uint16_t k = 1; k < vecLen_ && mask != 0; k++) {
+          mask &= Vec::eqMask(p + k, preVecs_[k]);
+        }
+
+        const uint8_t* found = firstMatch(p, mask);
+        if (found != nullptr) {
+          return found;
+        }
+      }
+
+      // Fewer than a block's worth of bytes are left, too few for memmem()'s
+      // setup to pay off
+      blockStart_ = nullptr;
+      for (; end - p >= preLen_; p++) {
+        if (p[0] == pre_[0] && memcmp(p + 1, pre_ + 1, preLen_ - 1U) == 0) {
+          return p;
+        }
+      }
+      return nullptr;
+    }
+};
+
+struct SSE2Vec {
+  typedef __m128i type;
+  static const int64_t WIDTH = 16;
+
+  BYTE_STUFF_INLINE
+  static void set1(type* dst, uint8_t val) {
+    *dst = _mm_set1_epi8(static_cast<char>(val));
+  }
+
+  // Bit i set if p[i] == the bytes of 'val'
+  BYTE_STUFF_INLINE
+  static uint32_t eqMask(const uint8_t* p, const type& val) {
+    const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(data, val)));
+  }
+};
+
+#define BYTE_STUFF_AVX2_TARGET __attribute__((target("avx2")))
+
+// Not always_inline, as GCC checks that against the generic callers.
+// Flattening the AVX2 entry points below inlines these into them instead.
+struct AVX2Vec {
+  typedef __m256i type;
+  static const int64_t WIDTH = 32;
+
+  BYTE_STUFF_AVX2_TARGET
+  static void set1(type* dst, uint8_t val) {
+    *dst = _mm256_set1_epi8(static_cast<char>(val));
+  }
+
+  BYTE_STUFF_AVX2_TARGET
+  static uint32_t eqMask(const uint8_t* p, const type& val) {
+    const __m256i data = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(p));
+    return static_cast<uint32_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(data, val)));
+  }
+};
+
+typedef VecFinder<SSE2Vec> SSE2Finder;
+typedef VecFinder<AVX2Vec> AVX2Finder;
+
+// Whether the running CPU supports the instructions used by AVX2Finder
+inline bool hasAVX2() {
+  static const bool supported = __builtin_cpu_supports("avx2");
+  return supported;
+}
+#endif // BYTE_STUFF_HAVE_X86_64
+
+/*
+ * memmove() of 'len' bytes, inlined for runs of up to 32 bytes (typical
+ * between escapes). All bytes are loaded before any are stored, so 'dst'
+ * may overlap 'src'.
+ */
+BYTE_STUFF_INLINE
+void moveBytes(uint8_t* dst, const uint8_t* src, size_t len) {
+  if (len >= 8 && len <= 32) {
+    uint64_t a, b, c, d;
+    memcpy(&a, src, 8);
+    memcpy(&b, src + (len - 8) / 3, 8);
+    memcpy(&c, src + 2 * (len - 8) / 3, 8);
+    memcpy(&d, src + len - 8, 8);
+    memcpy(dst, &a, 8);
+    memcpy(dst + (len - 8) / 3, &b, 8);
+    memcpy(dst + 2 * (len - 8) / 3, &c, 8);
+    memcpy(dst + len - 8, &d, 8);
+  } else if (len >= 4 && len < 8) {
+    uint32_t a, b;
+    memcpy(&a, src, 4);
+    memcpy(&b, src + len - 4, 4);
+    memcpy(dst, &a, 4);
+    memcpy(dst + len - 4, &b, 4);
+  } else if (len < 4) {
+    for (size_t i = 0; i < len; i++) {
+      dst[i] = src[i];
+    }
+  } else {
+    memmove(dst, src, len);
+  }
+}
+
+/*
+ * Stuffing loop; see stuff(). If not 'write', the output is only measured.
+ * Resumes from 'inPos', w/ 'outLen' bytes already output. Returns the
+ * output size, or -1 if it won't fit in 'outSz' bytes.
+ */
+template <typename Finder, bool write>
+BYTE_STUFF_INLINE
+int64_t stuffLoop(const uint8_t* in, uint32_t inLen, uint8_t* out,
+                  uint32_t outSz, const uint8_t* seq, uint16_t seqSz,
+                  size_t inPos = 0, size_t outLen = 0) {
+  const uint16_t preLen = static_cast<uint16_t>(seqSz - 1);
+  const uint8_t escByte = static_cast<uint8_t>(~seq[seqSz - 1]);
+  const uint8_t* const end = in + inLen;
+  const uint8_t* p = in + inPos;
+  Finder finder(seq, preLen);
+
+  while (end - p >= preLen) {
+    const uint8_t* match = finder.find(p, end);
+    if (match == nullptr) {
+      break;
+    }
+
+    // Copy up to & including the prefix, then the escape byte
+    const size_t runLen = static_cast<size_t>(match + preLen - p);
+    if constexpr (write) {
+      if (outLen + runLen + 1 > outSz) {
+        return -1;
+      }
+      moveBytes(out + outLen, p, runLen);
+      out[outLen + runLen] = escByte;
+    }
+    outLen += runLen + 1;
+    p = match + preLen;
+  }
+
+  const size_t remainLen = static_cast<size_t>(end - p);
+  if constexpr (write) {
+    if (outLen + remainLen > outSz) {
+      return -1;
+    }
+    moveBytes(out + outLen, p, remainLen);
+  }
+  outLen += remainLen;
+
+  return static_cast<int64_t>(outLen);
+}
+
+/*
+ * De-stuffing loop; see destuff(). If not 'write', the input is only
+ * validated & the output measured. Resumes like stuffLoop(). Returns the
+ * output size, or -1 if the input is mis-stuffed.
+ */
+template <typename Finder, bool write>
+BYTE_STUFF_INLINE
+int64_t destuffLoop(const uint8_t* in, uint32_t inLen, uint8_t* out,
+                    const uint8_t* seq, uint16_t seqSz,
+                    size_t inPos = 0, size_t outLen = 0) {
+  const uint16_t preLen = static_cast<uint16_t>(seqSz - 1);
+  const uint8_t escByte = static_cast<uint8_t>(~seq[seqSz - 1]);
+  const uint8_t* const end = in + inLen;
+  const uint8_t* p = in + inPos;
+  Finder finder(seq, preLen);
+
+  while (end - p >= preLen) {
+    const uint8_t* match = finder.find(p, end);
+    if (match == nullptr) {
+      break;
+    }
+
+    // Every prefix must be followed by the escape byte
+    const uint8_t* esc = match + preLen;
+    if (esc == end || *esc != escByte) {
+      return -1;
+    }
+
+    const size_t runLen = static_cast<size_t>(esc - p);
+    if constexpr (write) {
+      moveBytes(out + outLen, p, runLen);
+    }
+    outLen += runLen;
+    p = esc + 1;
+  }
+
+  const size_t remainLen = static_cast<size_t>(end - p);
+  if constexpr (write) {
+    moveBytes(out + outLen, p, remainLen);
+  }
+  outLen += remainLen;
+
+  return static_cast<int64_t>(outLen);
+}
+
+template <typename Finder>
+BYTE_STUFF_INLINE
+int64_t stuffWith(const uint8_t* in, uint32_t inLen, uint8_t* out,
+                  uint32_t outSz, const uint8_t* seq, uint16_t seqSz) {
+  return out == nullptr ?
+      stuffLoop<Finder, false>(in, inLen, out, outSz, seq, seqSz) :
+      stuffLoop<Finder, true>(in, inLen, out, outSz, seq, seqSz);
+}
+
+template <typename Finder>
+BYTE_STUFF_INLINE
+int64_t destuffWith(const uint8_t* in, uint32_t inLen, uint8_t* out,
+                    uint32_t outSz, const uint8_t* seq, uint16_t seqSz) {
+  // De-stuffing never grows the data
+  if (out != nullptr && outSz < inLen) {
+    return -1;
+  }
+  return out == nullptr ?
+      destuffLoop<Finder, false>(in, inLen, out, seq, seqSz) :
+      destuffLoop<Finder, true>(in, inLen, out, seq, seqSz);
+}
+
+#ifdef BYTE_STUFF_HAVE_X86_64
+/*
+ * AVX2 block path: rather than branching on each match, every 32-byte block
+ * gets a mask of the bytes an escape follows (or, de-stuffing, of the escape
+ * bytes), and each 8 bytes are then expanded (or compressed) w/ a single
+ * byte shuffle from the tables below.
+ */
+typedef std::array<std::array<uint8_t, 16>, 256> shuffle_lut_t;
+
+// Shuffles that insert byte 8 (the escape) after each byte i of the low 8
+// bytes w/ bit i set in the index
+constexpr shuffle_lut_t generateStuffShuffleLUT() {
+  shuffle_lut_t lut = {};
+  for (uint32_t bits = 0; bits < 256; bits++) {
+    uint32_t pos = 0;
+    for (uint8_t i = 0; i < 8; i++) {
+      lut[bits][pos++] = i;
+      if ((bits >> i) & 1) {
+        lut[bits][pos++] = 8;
+      }
+    }
+  }
+  return lut;
+}
+
+// Shuffles that drop each byte i of the low 8 bytes w/ bit i set in the index
+constexpr shuffle_lut_t generateDestuffShuffleLUT() {
+  shuffle_lut_t lut = {};
+  for (uint32_t bits = 0; bits < 256; bits++) {
+    uint32_t pos = 0;
+    for (uint8_t i = 0; i < 8; i++) {
+      if (((bits >> i) & 1) == 0) {
+        lut[bits][pos++] = i;
+      }
+    }
+  }
+  return lut;
+}
+
+// Mask of positions in the 32-byte block at 'p' that start 'pre' (of at most
+// BYTE_STUFF_VEC_CMP_LEN bytes)
+BYTE_STUFF_AVX2_TARGET
+inline uint64_t prefixMaskAVX2(const uint8_t* p, const __m256i* preVecs,
+                               uint16_t preLen) {
+  __m256i eq = _mm256_cmpeq_epi8(
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), preVecs[0]);
+  for (uint16_t k = 1; k < preLen; k++) {
+    eq = _mm256_and_si256(eq, _mm256_cmpeq_epi8(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + k)),
+        preVecs[k]));
+  }
+  return static_cast<uint32_t>(_mm256_movemask_epi8(eq));
+}
+
+/*
+ * Keeps the matches in 'mask' that a left-to-right search would, where
+ * each match hides any others starting in the following 'gap' - 1 bytes.
+ * Only loops if some matches are that close.
+ */
+inline uint64_t greedyMatches(uint64_t mask, uint16_t gap) {
+  uint64_t near = 0;
+  for (uint16_t d = 1; d < gap; d++) {
+    near |= mask << d;
+  }
+  if ((mask & near) == 0) {
+    return mask;
+  }
+
+  uint64_t kept = 0;
+  while (mask != 0) {
+    const uint32_t start = static_cast<uint32_t>(__builtin_ctzll(mask));
+    kept |= 1ULL << start;
+    mask &= ~0ULL << (start + gap);
+  }
+  return kept;
+}
+
+/*
+ * Stuffs whole 32-byte blocks from 'p' while the prefix fits past them,
+ * then completes any match spanning the last block. Advances 'p' & 'outLen'
+ * past what's been done. Returns false if the output won't fit.
+ */
+template <bool write>
+BYTE_STUFF_AVX2_TARGET
+inline bool stuffBlocksAVX2(const uint8_t*& pIn, const uint8_t* end,
+                            uint8_t* out, uint32_t outSz, size_t& outLenIn,
+                            const uint8_t* seq, uint16_t preLen,
+                            uint8_t escByte) {
+  static constexpr shuffle_lut_t SHUFFLES = generateStuffShuffleLUT();
+
+  // Work on local copies, which byte stores through 'out' can't alias
+  const uint8_t* p = pIn;
+  size_t outLen = outLenIn;
+
+  __m256i preVecs[BYTE_STUFF_VEC_CMP_LEN];
+  for (uint16_t k = 0; k < preLen; k++) {
+    preVecs[k] = _mm256_set1_epi8(static_cast<char>(seq[k]));
+  }
+  const __m128i escVec = _mm_set1_epi8(static_cast<char>(escByte));
+
+  // Shuffled groups are stored 16 bytes at a time, which must neither pass
+  // the end of 'out' nor reach input still to be read
+  const bool disjoint = reinterpret_cast<uintptr_t>(out + outSz) <=
+                            reinterpret_cast<uintptr_t>(p) ||
+                        reinterpret_cast<uintptr_t>(out) >=
+                            reinterpret_cast<uintptr_t>(end);
+
+  uint64_t escCarry = 0; // Escapes due in the next block
+  uint32_t skip = 0;     // Bytes of the next block in a match
+
+  for (; end - p >= 32 + preLen - 1; p += 32) {
+    uint64_t starts = prefixMaskAVX2(p, preVecs, preLen) & (~0ULL << skip);
+    starts = greedyMatches(starts, preLen);
+
+    const uint64_t escs = (starts << (preLen - 1)) | escCarry;
+    escCarry = escs >> 32;
+    skip = starts == 0 ? 0 : static_cast<uint32_t>(
+        (63 - __builtin_clzll(starts)) + preLen > 32 ?
+        (63 - __builtin_clzll(starts)) + preLen - 32 : 0);
+
+    if constexpr (!write) {
+      outLen += 32 + static_cast<uint32_t>(
+          __builtin_popcount(static_cast<uint32_t>(escs)));
+      continue;
+    }
+
+    // Blocks w/o escapes are copied as is, which is safe even in-place as
+    // the output never leads the input
+    const uint32_t blockEscs = static_cast<uint32_t>(escs);
+    if (blockEscs == 0 && outLen + 32 <= outSz) {
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + outLen),
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+      outLen += 32;
+      continue;
+    }
+
+    for (uint32_t g = 0; g < 32; g += 8) {
+      const uint32_t bits = (blockEscs >> g) & 0xFF;
+      const uint8_t* src = p + g;
+      const size_t groupLen = 8 + static_cast<uint32_t>(
+          __builtin_popcount(bits));
+
+      if (outLen + 16 <= outSz &&
+          (disjoint || reinterpret_cast<uintptr_t>(out + outLen + 16) <=
+                           reinterpret_cast<uintptr_t>(src + 8))) {
+        const __m128i data = _mm_unpacklo_epi64(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src)), escVec);
+        const __m128i shuf = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(SHUFFLES[bits].data()));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + outLen),
+                         _mm_shuffle_epi8(data, shuf));
+      } else {
+        if (outLen + groupLen > outSz) {
+          return false;
+        }
+        for (uint32_t i = 0, pos = 0; i < 8; i++) {
+          out[outLen + pos++] = src[i];
+          if ((bits >> i) & 1) {
+            out[outLen + pos++] = escByte;
+          }
+        }
+      }
+      outLen += groupLen;
+    }
+  }
+
+  // Finish a match spanning into the remaining bytes
+  if (skip > 0) {
+    if constexpr (write) {
+      if (outLen + skip + 1 > outSz) {
+        return false;
+      }
+      moveBytes(out + outLen, p, skip);
+      out[outLen + skip] = escByte;
+    }
+    outLen += skip + 1;
+    p += skip;
+  }
+
+  pIn = p;
+  outLenIn = outLen;
+  return true;
+}
+
+/*
+ * De-stuffs whole 32-byte blocks from 'p' while a prefix & its escape fit
+ * past them, then completes any match spanning the last block. Advances
+ * 'p' & 'outLen' past what's been done. Returns false if a prefix isn't
+ * followed by the escape byte.
+ */
+template <bool write>
+BYTE_STUFF_AVX2_TARGET
+inline bool destuffBlocksAVX2(const uint8_t*& pIn, const uint8_t* end,
+                              uint8_t* out, size_t& outLenIn,
+                              const uint8_t* seq, uint16_t preLen,
+                              uint8_t escByte) {
+  static constexpr shuffle_lut_t SHUFFLES = generateDestuffShuffleLUT();
+
+  const uint8_t* p = pIn;
+  size_t outLen = outLenIn;
+
+  __m256i preVecs[BYTE_STUFF_VEC_CMP_LEN];
+  for (uint16_t k = 0; k < preLen; k++) {
+    preVecs[k] = _mm256_set1_epi8(static_cast<char>(seq[k]));
+  }
+  const __m256i escVec = _mm256_set1_epi8(static_cast<char>(escByte));
+
+  uint64_t escCarry = 0; // Escapes due in the next block
+  uint32_t skip = 0;     // Bytes of the next block in a match (incl. escape)
+
+  for (; end - p >= 32 + preLen; p += 32) {
+    uint64_t starts = prefixMaskAVX2(p, preVecs, preLen) & (~0ULL << skip);
+    starts = greedyMatches(starts, static_cast<uint16_t>(preLen + 1));
+
+    const uint64_t escs = (starts << preLen) | escCarry;
+    escCarry = escs >> 32;
+    skip = starts == 0 ? 0 : static_cast<uint32_t>(
+        (63 - __builtin_clzll(starts)) + preLen + 1 > 32 ?
+        (63 - __builtin_clzll(starts)) + preLen + 1 - 32 : 0);
+
+    // Every prefix must be followed by the escape byte
+    const uint64_t blockEscs = escs & 0xFFFFFFFF;
+    const uint64_t isEsc = static_cast<uint32_t>(_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)),
+            escVec)));
+    if ((blockEscs & ~isEsc) != 0) {
+      return false;
+    }
+
+    if constexpr (!write) {
+      outLen += 32 - static_cast<uint32_t>(__builtin_popcountll(blockEscs));
+      continue;
+    }
+
+    // Compressed groups are stored 8 bytes at a time, which never reaches
+    // input still to be read (or past the end of 'out', which is at least
+    // the size of the input)
+    for (uint32_t g = 0; g < 32; g += 8) {
+      const uint32_t bits = static_cast<uint32_t>((blockEscs >> g) & 0xFF);
+      const __m128i data = _mm_loadl_epi64(
+          reinterpret_cast<const __m128i*>(p + g));
+      const __m128i shuf = _mm_loadl_epi64(
+          reinterpret_cast<const __m128i*>(SHUFFLES[bits].data()));
+      _mm_storel_epi64(reinterpret_cast<__m128i*>(out + outLen),
+                       _mm_shuffle_epi8(data, shuf));
+      outLen += 8 - static_cast<uint32_t>(__builtin_popcount(bits));
+    }
+  }
+
+  // Finish a match spanning into the remaining bytes
+  if (skip > 0) {
+    if (p[skip - 1] != escByte) {
+      return false;
+    }
+    if constexpr (write) {
+      moveBytes(out + outLen, p, skip - 1);
+    }
+    outLen += skip - 1;
+    p += skip;
+  }
+
+  pIn = p;
+  outLenIn = outLen;
+  return true;
+}
+
+#define BYTE_STUFF_AVX2_ENTRY __attribute__((target("avx2"), flatten))
+
+template <bool write>
+BYTE_STUFF_AVX2_ENTRY
+int64_t stuffAVX2(const uint8_t* in, uint32_t inLen, uint8_t* out,
+                  uint32_t outSz, const uint8_t* seq, uint16_t seqSz) {
+  const uint16_t preLen = static_cast<uint16_t>(seqSz - 1);
+  if (preLen > BYTE_STUFF_VEC_CMP_LEN) {
+    return stuffLoop<AVX2Finder, write>(in, inLen, out, outSz, seq, seqSz);
+  }
+
+  const uint8_t* p = in;
+  size_t outLen = 0;
+  if (!stuffBlocksAVX2<write>(p, in + inLen, out, outSz, outLen, seq, preLen,
+                              static_cast<uint8_t>(~seq[seqSz - 1]))) {
+    return -1;
+  }
+
+  return stuffLoop<AVX2Finder, write>(in, inLen, out, outSz, seq, seqSz,
+                                      static_cast<size_t>(p - in), outLen);
+}
+
+template <bool write>
+BYTE_STUFF_AVX2_ENTRY
+int64_t destuffAVX2(const uint8_t* in, uint32_t inLen, uint8_t* out,
+                    const uint8_t* seq, uint16_t seqSz) {
+  const uint16_t preLen = static_cast<uint16_t>(seqSz - 1);
+  if (preLen > BYTE_STUFF_VEC_CMP_LEN) {
+    return destuffLoop<AVX2Finder, write>(in, inLen, out, seq, seqSz);
+  }
+
+  const uint8_t* p = in;
+  size_t outLen = 0;
+  if (!destuffBlocksAVX2<write>(p, in + inLen, out, outLen, seq, preLen,
+                                static_cast<uint8_t>(~seq[seqSz - 1]))) {
+    return -1;
+  }
+
+  return destuffLoop<AVX2Finder, write>(in, inLen, out, seq, seqSz,
+                                        static_cast<size_t>(p - in), outLen);
+}
+
+inline int64_t stuffAVX2(const uint8_t* in, uint32_t inLen, uint8_t* out,
+                         uint32_t outSz, const uint8_t* seq, uint16_t seqSz) {
+  return out == nullptr ?
+      stuffAVX2<false>(in, inLen, out, outSz, seq, seqSz) :
+      stuffAVX2<true>(in, inLen, out, outSz, seq, seqSz);
+}
+
+inline int64_t destuffAVX2(const uint8_t* in, uint32_t inLen, uint8_t* out,
+                           uint32_t outSz, const uint8_t* seq,
+                           uint16_t seqSz) {
+  // De-stuffing never grows the data
+  if (out != nullptr && outSz < inLen) {
+    return -1;
+  }
+  return out == nullptr ? destuffAVX2<false>(in, inLen, out, seq, seqSz) :
+                          destuffAVX2<true>(in, inLen, out, seq, seqSz);
+}
+#endif
+
+} // internal namespace
+
+/**
+ * @brief Byte-stuffs 'inLen' bytes from 'in' into 'out', escaping each
+ *        occurrence of the first ('seqSz' - 1) bytes of 'seq'.
+ *
+ *        'out' may overlap 'in' as long as no output byte is written ahead
+ *        of the input still to be read. i.e. 'out' <= 'in' and the input
+ *        starts at least (# of escapes) bytes past 'out'.
+ *
+ * @param in Data to be stuffed.
+ * @param inLen Length of 'in'.
+ * @param out Buffer for the stuffed data. If nullptr, nothing is written and
+ *            only the stuffed size is returned.
+ * @param outSz Size of 'out'.
+ * @param seq Sequence to be avoided.
+ * @param seqSz Length of 'seq'. Must be at least 2.
+ *
+ * @return Returns the size of the stuffed data. Returns -1 if 'seq' is NULL,
+ *         'seqSz' < 2, or the stuffed data won't fit in 'outSz' bytes (in
+ *         which case 'out' holds a partial result).
+ */
+template <StuffMethod method = StuffMethod::AUTO>
+int64_t stuff(const uint8_t* in, uint32_t inLen, uint8_t* out,
+              uint32_t outSz, const uint8_t* seq, uint16_t seqSz) {
+  if (seq == nullptr || seqSz < 2 || (in == nullptr && inLen > 0)) {
+    return -1;
+  }
+
+#ifdef BYTE_STUFF_HAVE_X86_64
+  if constexpr (method == StuffMethod::AUTO || method == StuffMethod::AVX2) {
+    if (internal::hasAVX2()) {
+      return internal::stuffAVX2(in, inLen, out, outSz, seq, seqSz);
+    }
+  }
+  if constexpr (method != StuffMethod::SCALAR) {
+    return internal::stuffWith<internal::SSE2Finder>(in, inLen, out, outSz,
+                                                     seq, seqSz);
+  }
+#endif
+
+  return internal::stuffWith<internal::ScalarFinder>(in, inLen, out, outSz,
+                                                     seq, seqSz);
+}
+
+/**
+ * @brief Inverse of stuff(): de-stuffs 'inLen' bytes from 'in' into 'out',
+ *        removing the escape byte after each occurrence of the first
+ *        ('seqSz' - 1) bytes of 'seq'. 'out' may be the same as 'in'.
+ *
+ * @param in Stuffed data.
+ * @param inLen Length of 'in'.
+ * @param out Buffer for the de-stuffed data, at least 'inLen' bytes. If
+ *            nullptr, nothing is written and the input is only validated.
+ * @param outSz Size of 'out'.
+ * @param seq Sequence that was avoided.
+ * @param seqSz Length of 'seq'. Must be at least 2.
+ *
+ * @return Returns the size of the de-stuffed data. Returns -1 if 'seq' is
+ *         NULL, 'seqSz' < 2, 'outSz' < 'inLen', or a prefix isn't followed
+ *         by the escape byte (in which case 'out' holds a partial result).
+ */
+template <StuffMethod method = StuffMethod::AUTO>
+int64_t destuff(const uint8_t* in, uint32_t inLen, uint8_t* out,
+                uint32_t outSz, const uint8_t* seq, uint16_t seqSz) {
+  if (seq == nullptr || seqSz < 2 || (in == nullptr && inLen > 0)) {
+    return -1;
+  }
+
+#ifdef BYTE_STUFF_HAVE_X86_64
+  if constexpr (method == StuffMethod::AUTO || method == StuffMethod::AVX2) {
+    if (internal::hasAVX2()) {
+      return internal::destuffAVX2(in, inLen, out, outSz, seq, seqSz);
+    }
+  }
+  if constexpr (method != StuffMethod::SCALAR) {
+    return internal::destuffWith<internal::SSE2Finder>(in, inLen, out, outSz,
+                                                       seq, seqSz);
+  }
+#endif
+
+  return internal::destuffWith<internal::ScalarFinder>(in, inLen, out, outSz,
+                                                       seq, seqSz);
+}
+
+} // ByteStuffUtils namespace
+
+// Keep the helper macros out of includers
+#undef BYTE_STUFF_INLINE
+#undef BYTE_STUFF_VEC_CMP_LEN
+#undef BYTE_STUFF_AVX2_TARGET
+#undef BYTE_STUFF_AVX2_ENTRY
+#undef BYTE_STUFF_HAVE_X86_64
+
+#endif // MPLEX_BYTE_STUFF_H
@@ -0,0 +1,168 @@
+#pragma once
+#ifndef MPLEX_BYTE_SWAP_H
+#define MPLEX_BYTE_SWAP_H
+
+// C headers
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#if defined(__x86_64__)
+#define BYTE_SWAP_HAVE_X86_64
+#include <immintrin.h>
+#endif
+
+/*
+ * Bulk byte-order reversal used by MplexMsgFrame::writeSpan() & readSpan().
+ * Copies an array of 2, 4 or 8-byte elements while reversing the bytes of
+ * each one, w/ 16 or 32 bytes at a time shuffled by pshufb.
+ */
+namespace ByteSwapUtils {
+
+/*
+ * Method to reverse the bytes w/:
+ *  - AUTO:   The widest of the below supported by the running CPU.
+ *  - SCALAR: __builtin_bswap*() per element; available everywhere.
+ *  - SSSE3:  16-byte pshufb.
+ *  - AVX2:   32-byte vpshufb; same as AUTO if the CPU lacks AVX2.
+ */
+enum class SwapMethod {
+  AUTO,
+  SCALAR,
+  SSSE3,
+  AVX2
+};
+
+// Implementation details of copySwapped(); not meant to be called directly
+namespace internal {
+
+template <size_t SIZE>
+inline void copySwappedScalar(uint8_t* __restrict__ dst,
+                              const uint8_t* __restrict__ src, size_t n) {
+  for (size_t i = 0; i < n; i++, dst += SIZE, src += SIZE) {
+    if constexpr (SIZE == 2) {
+      uint16_t val;
+      memcpy(&val, src, SIZE);
+      val = __builtin_bswap16(val);
+      memcpy(dst, &val, SIZE);
+    } else if constexpr (SIZE == 4) {
+      uint32_t val;
+      memcpy(&val, src, SIZE);
+      val = __builtin_bswap32(val);
+      memcpy(dst, &val, SIZE);
+    } else {
+      uint64_t val;
+      memcpy(&val, src, SIZE);
+      val = __builtin_bswap64(val);
+      memcpy(dst, &val, SIZE);
+    }
+  }
+}
+
+#ifdef BYTE_SWAP_HAVE_X86_64
+// pshufb control reversing each SIZE-byte element of a 16-byte lane
+template <size_t SIZE>
+struct SwapMask {
+  uint8_t bytes[16];
+
+  constexpr SwapMask() : bytes() {
+    for (size_t j = 0; j < 16; j++) {
+      bytes[j] = static_cast<uint8_t>((j / SIZE) * SIZE + SIZE - 1 - j % SIZE);
+    }
+  }
+};
+
+template <size_t SIZE>
+inline constexpr SwapMask<SIZE> SWAP_MASK{};
+
+inline bool hasSSSE3() {
+  static const bool supported = __builtin_cpu_supports("ssse3");
+  return supported;
+}
+
+inline bool hasAVX2() {
+  static const bool supported = __builtin_cpu_supports("avx2");
+  return supported;
+}
+
+template <size_t SIZE>
+__attribute__((target("ssse3")))
+void copySwappedSSSE3(uint8_t* __restrict__ dst,
+                      const uint8_t* __restrict__ src, size_t n) {
+  const __m128i mask = _mm_loadu_si128(
+      reinterpret_cast<const __m128i*>(SWAP_MASK<SIZE>.bytes));
+  size_t len = n * SIZE;
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                     _mm_shuffle_epi8(v, mask));
+  }
+  copySwappedScalar<SIZE>(dst + i, src + i, (len - i) / SIZE);
+}
+
+template <size_t SIZE>
+__attribute__((target("avx2")))
+void copySwappedAVX2(uint8_t* __restrict__ dst,
+                     const uint8_t* __restrict__ src, size_t n) {
+  const __m256i mask = _mm256_broadcastsi128_si256(_mm_loadu_si128(
+      reinterpret_cast<const __m128i*>(SWAP_MASK<SIZE>.bytes)));
+  size_t len = n * SIZE;
+  size_t i = 0;
+  for (; i + 64 <= len; i += 64) {
+    __m256i v0 = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(src + i));
+    __m256i v1 = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(src + i + 32));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+                        _mm256_shuffle_epi8(v0, mask));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 32),
+                        _mm256_shuffle_epi8(v1, mask));
+  }
+  for (; i + 16 <= len; i += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                     _mm_shuffle_epi8(v, _mm256_castsi256_si128(mask)));
+  }
+  copySwappedScalar<SIZE>(dst + i, src + i, (len - i) / SIZE);
+}
+#endif // BYTE_SWAP_HAVE_X86_64
+
+} // namespace internal
+
+/**
+ * @brief Copies 'n' elements of SIZE (2, 4 or 8) bytes from 'src' to 'dst',
+ *        reversing the byte order of each element. The buffers must not
+ *        overlap and need not be aligned.
+ *
+ * @param dst Destination buffer of at least n * SIZE bytes.
+ * @param src Source buffer of at least n * SIZE bytes.
+ * @param n Number of elements.
+ */
+template <size_t SIZE, SwapMethod method = SwapMethod::AUTO>
+void copySwapped(void* dst, const void* src, size_t n) {
+  static_assert(SIZE == 2 || SIZE == 4 || SIZE == 8,
+                "Only 2, 4 and 8-byte elements can be byte-swapped");
+
+  uint8_t* out = static_cast<uint8_t*>(dst);
+  const uint8_t* in = static_cast<const uint8_t*>(src);
+#ifdef BYTE_SWAP_HAVE_X86_64
+  if constexpr (method == SwapMethod::AUTO || method == SwapMethod::AVX2) {
+    if (internal::hasAVX2()) {
+      internal::copySwappedAVX2<SIZE>(out, in, n);
+      return;
+    }
+  }
+  if constexpr (method != SwapMethod::SCALAR) {
+    if (internal::hasSSSE3()) {
+      internal::copySwappedSSSE3<SIZE>(out, in, n);
+      return;
+    }
+  }
+#endif
+  internal::copySwappedScalar<SIZE>(out, in, n);
+}
+
+} // namespace ByteSwapUtils
+
+#endif
@@ -0,0 +1,130 @@
+/*
+ * libFuzzer target for parsing untrusted Message Groups: loads each input w/
+ * MplexMsgGroup(const uint8_t*, sz), as both v0 & v1, then resyncs through
+ * it w/ nextValidFrame(), reading out every frame found. Built w/ clang
+ * (see the Makefile's fuzz_MsgGroup target); FUZZ_STANDALONE builds a main()
+ * that replays inputs given as files instead, e.g. to reproduce a crash w/
+ * GCC.
+ *
+ * Besides crashes & sanitizer reports, tracks the per-input cost of the
+ * resync scan: the CRCs calculated, the bytes they covered & the time taken,
+ * per input byte. A new worst case is reported to stderr as it's found, so
+ * inputs that make the scan degrade show up long before they hit libFuzzer's
+ * -timeout. test_MsgGroupv1's ResyncCost test bounds the CRC bytes/byte
+ * on magic-dense noise.
+ */
+
+// C++ libs
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+// C libs
+#include <stdint.h>
+#include <stddef.h>
+
+#include "mplex_msg_group.hpp"
+
+namespace {
+
+// Worst per-Byte cost seen so far, for one header version
+struct ResyncCost {
+  const char* name;
+  double crcsPerByte = 0;
+  double crcBytesPerByte = 0;
+  double nsPerByte = 0;
+
+  ~ResyncCost() {
+    std::cerr << name << " worst resync cost: " << crcsPerByte
+              << " CRCs/byte, " << crcBytesPerByte << " CRC bytes/byte, "
+              << nsPerByte << " ns/byte" << std::endl;
+  }
+};
+
+// Inputs shorter than this aren't timed, as their ns/byte is mostly noise
+const size_t MIN_TIMED_SIZE = 256;
+
+template <typename MsgGroupHeader>
+void parse(const uint8_t* data, size_t sz, ResyncCost& worst) {
+  typedef MplexMsgGroup<MsgGroupHeader> group_t;
+  typedef typename group_t::msg_t msg_t;
+
+  if (sz < group_t::MIN_SIZE || sz > group_t::MAX_SIZE) {
+    return;
+  }
+
+  typename msg_t::Stats before = msg_t::stats();
+  auto start = std::chrono::steady_clock::now();
+
+  group_t msgGroup(data, static_cast<uint16_t>(sz));
+  if (msgGroup.headerIsValid()) {
+    msgGroup.numFrames();
+    msgGroup.timestamp();
+    if (msgGroup.calcGroupSize() > sz) {
+      __builtin_trap();
+    }
+  }
+
+  // Read out each frame found, so overreads trip the sanitizers
+  std::vector<uint8_t> frameData;
+  msgGroup.forEachValidFrame([&](msg_t& frame) {
+    frameData.resize(frame.len());
+    if (frame.readSpan(frameData.data(), frameData.size()) == false ||
+        frame.msgSize() > sz) {
+      __builtin_trap();
+    }
+  });
+
+  std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+  typename msg_t::Stats after = msg_t::stats();
+  double crcsPerByte = double(after.crcs - before.crcs) / double(sz);
+  double crcBytesPerByte =
+      double(after.crcBytes - before.crcBytes) / double(sz);
+  double nsPerByte = elapsed.count() / double(sz);
+  if (crcsPerByte > worst.crcsPerByte ||
+      crcBytesPerByte > worst.crcBytesPerByte ||
+      (sz >= MIN_TIMED_SIZE && nsPerByte > worst.nsPerByte)) {
+    worst.crcsPerByte = std::max(worst.crcsPerByte, crcsPerByte);
+    worst.crcBytesPerByte = std::max(worst.crcBytesPerByte, crcBytesPerByte);
+    if (sz >= MIN_TIMED_SIZE) {
+      worst.nsPerByte = std::max(worst.nsPerByte, nsPerByte);
+    }
+    std::cerr << "NEW " << worst.name << " resync cost: " << crcsPerByte
+              << " CRCs/byte, " << crcBytesPerByte << " CRC bytes/byte, "
+              << nsPerByte << " ns/byte (" << sz << " bytes)" << std::endl;
+  }
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t sz) {
+  static ResyncCost worstv0{"v0"};
+  static ResyncCost worstv1{"v1"};
+
+  parse<MsgGroupHeader_v0>(data, sz, worstv0);
+  parse<MsgGroupHeader_v1>(data, sz, worstv1);
+  return 0;
+}
+
+#ifdef FUZZ_STANDALONE
+#include <fstream>
+#include <iterator>
+
+int main(int argc, char** argv) {
+  for (int i = 1; i < argc; i++) {
+    std::ifstream file(argv[i], std::ios::binary);
+    if (file.is_open() == false) {
+      // TODO: Replace w/ log
+      std::cerr << "ERROR: Unable to open " << argv[i] << std::endl;
+      return 1;
+    }
+
+    std::vector<uint8_t> input((std::istreambuf_iterator<char>(file)),
+                               std::istreambuf_iterator<char>());
+    LLVMFuzzerTestOneInput(input.data(), input.size());
+  }
+
+  return 0;
+}
+#endif
@@ -4,6 +4,7 @@
 
 // C headers
 #include <asm/byteorder.h>
+#include <endian.h>
 #include <stdint.h>
 
 // libtins
@@ -45,6 +46,7 @@ class __attribute__((packed)) MsgFrameHeader_v0 {
     static const uint8_t CRC_WIDTH = 14; // Bit-width of CRC field
 
     static const uint64_t CRC_POLY = CRCUtils::CRC_POLY_TABLE[CRC_WIDTH];
+    static const bool CRC_REFLECTED = false; // See CRCUtils::CRC()
     static_assert(CRC_POLY != 0);
 
     // Header-dependent types
@@ -174,5 +176,118 @@ class __attribute__((packed)) MsgFrameHeader_v0 {
 static_assert(sizeof(MsgFrameHeader_v0) == 5,
               "Size of MsgFrameHeader_v0 != 5");
 
+/*
+ * Bit layout of v1 multiplex message frame header, in big-endian byte order.
+ *  - NOTE: The drawing below is not to scale.
+ *
+ * The header consists of 8 Bytes. Unlike v0, every field is Byte-aligned,
+ * so no bit manipulation is needed on either endianness:
+ *  0                8                16               24
+ * +----------------+----------------+----------------+----------------+
+ * |     Magic #    |     Msg ID     |         Msg Data Length         |
+ * |<--- 8 Bits --->|<--- 8 Bits --->|<----------- 16 Bits ----------->|
+ * +----------------+----------------+----------------+----------------+
+ *  32               40               48               56
+ * +----------------+----------------+----------------+----------------+
+ * |                             Msg CRC                               |
+ * |<---------------------------- 32 Bits ---------------------------->|
+ * +----------------+----------------+----------------+----------------+
+ *
+ * The CRC is CRC-32C, which is calculated w/ the CPU's crc32 instruction
+ * where available.
+ */
+class __attribute__((packed)) MsgFrameHeader_v1 {
+  public:
+    static const vers_t VERS = 1;
+    static const uint8_t MAGIC_NUMBER = 0x7E;
+
+    static const uint8_t ID_WIDTH = 8;   // Bit-width of ID field
+    static const uint8_t LEN_WIDTH = 16; // Bit-width of length field
+    static const uint8_t CRC_WIDTH = 32; // Bit-width of CRC field
+
+    static const uint64_t CRC_POLY = CRC_POLY_32C;
+    static const bool CRC_REFLECTED = true; // See CRCUtils::CRC()
+
+    // Header-dependent types
+    typedef Tins::small_uint<ID_WIDTH> id_t;
+    typedef Tins::small_uint<LEN_WIDTH> len_t;
+    typedef Tins::small_uint<CRC_WIDTH> crc_t;
+
+    // End of Message Group ID
+    static const id_t::repr_type END_OF_GROUP_ID = id_t::max_value;
+
+  private:
+    // Magic number
+    uint8_t magic_ = MsgFrameHeader_v1::MAGIC_NUMBER;
+
+    // Initialized to End of Message Group values
+    uint8_t id_ = END_OF_GROUP_ID;  // Message type/topic ID
+    uint16_t len_ = 0;              // Length of message data in Bytes
+    uint32_t crc_ = 0;              // Checksum for whole frame
+
+  public:
+    void setMagic() {
+      magic_ = MsgFrameHeader_v1::MAGIC_NUMBER;
+    }
+
+    uint8_t magic() const {
+      return magic_;
+    }
+
+    void id(id_t id) {
+      id_ = id;
+    }
+
+    id_t id() const {
+      return id_;
+    }
+
+    void len(len_t len) {
+      len_ = htobe16(len);
+    }
+
+    len_t len() const {
+      return be16toh(len_);
+    }
+
+    void crc(crc_t crc) {
+      crc_ = htobe32(crc);
+    }
+
+    crc_t crc() const {
+      return be32toh(crc_);
+    }
+};
+static_assert(sizeof(MsgFrameHeader_v1) == 8,
+              "Size of MsgFrameHeader_v1 != 8");
+
+/*
+ * Template option that selects the CRC of a MsgFrameHeader-style header,
+ * w/o changing its layout. The CRC keeps the header's width, but uses
+ * generator polynomial 'crcPoly' and, if 'crcReflected', feeds bytes in
+ * LSB-first:
+ *
+ *   MplexMsgFrame<MsgFrameHeaderCRC<MsgFrameHeader_v0, 0x2F2B, true>> frame;
+ */
+template <typename MsgFrameHeader, uint64_t crcPoly, bool crcReflected>
+class __attribute__((packed)) MsgFrameHeaderCRC : public MsgFrameHeader {
+  public:
+    static const uint64_t CRC_POLY = crcPoly;
+    static const bool CRC_REFLECTED = crcReflected;
+    static_assert(CRC_POLY != 0);
+};
+
+/*
+ * Selects CRC-32C (Castagnoli) for a header w/ a 32-bit CRC field. It's
+ * calculated w/ the CPU's crc32 instruction where available, and is
+ * otherwise no slower than the header's default CRC.
+ */
+template <typename MsgFrameHeader>
+class __attribute__((packed)) MsgFrameHeader_CRC32C
+    : public MsgFrameHeaderCRC<MsgFrameHeader, CRC_POLY_32C, true> {
+  static_assert(MsgFrameHeader::CRC_WIDTH == 32,
+                "CRC-32C requires a 32-bit CRC field");
+};
+
 #endif
 
@@ -4,6 +4,8 @@
 
 // C headers
 #include <asm/byteorder.h>
+#include <endian.h>
+#include <stdint.h>
 
 #include "../../crc/crc.hpp"
 
@@ -183,4 +185,119 @@ class __attribute__((packed)) MsgGroupHeader_v0 {
 };
 static_assert(sizeof(MsgGroupHeader_v0) == 13);
 
+/*
+ * Bit layout of v1 multiplex message group header, in big-endian byte order.
+ *  - NOTE: The drawing below is not to scale.
+ *
+ * The header consists of 17 Bytes, which are broken down into their various
+ * header fields as follows:
+ *  0                8                16               24
+ * +----------------+----------------+----------------+----------------+
+ * |     Magic #    |    Version #   |            Timestamp (nsec) ... |
+ * |<--- 8 Bits --->|<--- 8 Bits --->|<-------------------- 64 Bits -- |
+ * +----------------+----------------+----------------+----------------+
+ *  32               40               48               56
+ * +----------------+----------------+----------------+----------------+
+ * | ... Timestamp (nsec) cont. ...                                    |
+ * | ----------------------------------------------------------------- |
+ * +----------------+----------------+----------------+----------------+
+ *  64               72               80               88
+ * +----------------+----------------+----------------+----------------+
+ * | ... Timestamp (nsec) cont.      |          # Msg Frames           |
+ * | ------------------------------->|<----------- 16 Bits ----------->|
+ * +----------------+----------------+----------------+----------------+
+ *  96               104              112              120
+ * +----------------+----------------+----------------+----------------+
+ * |  Header Len.   |                 Header-only CRC ...              |
+ * |<--- 8 Bits --->|<-------------------- 32 Bits ------------------- |
+ * +----------------+----------------+----------------+----------------+
+ *  128
+ * +----------------+
+ * | ... CRC cont.  |
+ * | -------------->|
+ * +----------------+
+ *
+ * The timestamp is in nanoseconds since the Unix epoch.
+ */
+class __attribute__((packed)) MsgGroupHeader_v1 {
+  public:
+    static const vers_t VERS = 1;
+    static const uint8_t MAGIC_NUMBER = 0xAA;
+
+    static const uint8_t NUM_FRAMES_WIDTH = 16; // Bit-width of numFrames_
+    static const uint8_t HLEN_WIDTH = 8;        // Bit-width of headerLen_
+    static const uint8_t HCRC_WIDTH = 32;       // Bit-width of header CRC
+
+    static const uint64_t CRC_POLY = CRCUtils::CRC_POLY_TABLE[HCRC_WIDTH];
+    static_assert(CRC_POLY != 0);
+
+    // Header-dependent types
+    typedef Tins::small_uint<NUM_FRAMES_WIDTH> nFrames_t;
+    typedef Tins::small_uint<HLEN_WIDTH> len_t;
+    typedef Tins::small_uint<HCRC_WIDTH> hcrc_t;
+
+  private:
+    // Magic number
+    uint8_t magic_ = MsgGroupHeader_v1::MAGIC_NUMBER;
+
+    // Version of header & Message Frames
+    const vers_t vers_ = MsgGroupHeader_v1::VERS;
+
+    // Multi-Byte fields are stored big-endian
+    uint64_t timestamp_ = 0;  // Nanoseconds since the Unix epoch
+    uint16_t numFrames_ = 0;  // Number of message frames
+    uint8_t headerLen_ = 0;   // Header length in Bytes
+    uint32_t hcrc_ = 0;       // Checksum of header
+
+  public:
+    void setMagic() {
+      magic_ = MsgGroupHeader_v1::MAGIC_NUMBER;
+    }
+
+    uint8_t magic() const {
+      return magic_;
+    }
+
+    vers_t vers() const {
+      return vers_;
+    }
+
+    void timestamp(uint32_t sec, uint32_t nsec) {
+      this->timestamp(uint64_t(sec) * 1000000000 + nsec);
+    }
+
+    void timestamp(uint64_t nsec) {
+      timestamp_ = htobe64(nsec);
+    }
+
+    uint64_t timestamp() const {
+      return be64toh(timestamp_);
+    }
+
+    void numFrames(nFrames_t nFrames) {
+      numFrames_ = htobe16(nFrames);
+    }
+
+    nFrames_t numFrames() const {
+      return be16toh(numFrames_);
+    }
+
+    void headerLen(len_t len) {
+      headerLen_ = len;
+    }
+
+    len_t headerLen() const {
+      return headerLen_;
+    }
+
+    void hcrc(hcrc_t hcrc) {
+      hcrc_ = htobe32(hcrc);
+    }
+
+    hcrc_t hcrc() const {
+      return be32toh(hcrc_);
+    }
+};
+static_assert(sizeof(MsgGroupHeader_v1) == 17);
+
 #endif
@@ -0,0 +1,30 @@
+#pragma once
+#ifndef MPLEX_MSG_HEADERS_H
+#define MPLEX_MSG_HEADERS_H
+
+#include "frame_headers.hpp"
+#include "group_headers.hpp"
+
+/*
+ * Maps a protocol version, as carried in a group header's version byte, to
+ * its group & frame headers. MplexMsgGroup uses it to pick the frame header
+ * (& thus the frame codec) matching its group header at compile time:
+ *
+ *   MplexMsgGroup<MsgGroupHeader_v1> group;  // w/ MsgFrameHeader_v1 frames
+ */
+template <vers_t VERS>
+struct MsgHeaders;
+
+template <>
+struct MsgHeaders<0> {
+  typedef MsgGroupHeader_v0 group_header_t;
+  typedef MsgFrameHeader_v0 frame_header_t;
+};
+
+template <>
+struct MsgHeaders<1> {
+  typedef MsgGroupHeader_v1 group_header_t;
+  typedef MsgFrameHeader_v1 frame_header_t;
+};
+
+#endif
@@ -0,0 +1,496 @@
+#ifndef MPLEX_MSG_BATCHER_H
+#define MPLEX_MSG_BATCHER_H
+
+// C headers
+#include <stdint.h>
+#include <string.h>
+
+// C++ headers
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "mplex_msg_group.hpp"
+
+/*
+ * MplexMsgBatcher class
+ * Packs frames submitted by many threads into Message Groups, and hands
+ * each group to a sink callback once it's finalized (i.e. w/ its header &
+ * End of Message Group trailer written).
+ *
+ * Each producing thread submits through its own Producer, which encodes &
+ * CRCs frames into a private staging buffer w/o touching shared state.
+ * Staged frames are moved into the open group in bulk, a run of frames per
+ * memcpy(), when the staging buffer fills up or on a deadline. A group is
+ * emitted when the next frame doesn't fit in it (as when commitFrame()
+ * returns NULL), or once its oldest frame is 'maxLatency' old.
+ *
+ * The sink is called by one thread at a time (a producer's, or the flush
+ * timer's), in the order groups are closed, & never w/ any of the
+ * batcher's or a Producer's locks held. It may submit to the batcher (even
+ * through the Producer whose submit() it's running under) & construct or
+ * destroy Producers; groups it closes are queued, & emitted once it
+ * returns. The group it's given is reused afterwards, so it must be sent or
+ * copied before returning.
+ *
+ * Producers must be destroyed before the batcher.
+ */
+template <typename MsgGroupHeader,
+          typename MsgFrameHeader =
+              typename MsgHeaders<MsgGroupHeader::VERS>::frame_header_t,
+          typename BufferProvider = MplexBufferPool<>>
+class MplexMsgBatcher {
+  public:
+    typedef MplexMsgGroup<MsgGroupHeader, MsgFrameHeader, BufferProvider>
+        group_t;
+    typedef typename group_t::msg_t msg_t;
+    typedef typename MsgFrameHeader::id_t id_t;
+    typedef std::function<void(group_t&)> sink_t;
+    typedef std::chrono::steady_clock::time_point time_point_t;
+
+    struct Policy {
+      // Size of the groups' buffers, i.e. max size of an emitted group.
+      // 1472 = 1500 - 20 - 8; to fit an MTU of 1500.
+      uint16_t maxGroupSize = 1472;
+
+      // Max time a frame waits before its group is emitted; 0 disables the
+      // flush timer, leaving groups to be emitted when full or on flush()
+      std::chrono::microseconds maxLatency{1000};
+
+      // Size of each Producer's staging buffer; 0 for 'maxGroupSize'. Must
+      // fit the largest frame a group can hold.
+      size_t stagingSize = 0;
+    };
+
+    struct Stats {
+      uint64_t groups;        // Groups emitted
+      uint64_t frames;        // Frames in the emitted groups
+      uint64_t timedFlushes;  // Groups emitted before being full
+    };
+
+    class Producer;
+
+  private:
+    const Policy policy_;
+    const size_t stagingSz_;
+    const uint16_t maxData_;
+    sink_t sink_;
+
+    // Open group & its state
+    std::mutex mtx_;
+    std::unique_ptr<group_t> group_;
+    size_t nFrames_ = 0;
+    time_point_t groupSince_;
+    Stats stats_ = {0, 0, 0};
+
+    // Closed groups waiting for the sink, & emptied ones to reuse. The sink
+    // is run by one thread at a time, the 'drainer_'.
+    std::deque<std::unique_ptr<group_t>> ready_;
+    std::vector<std::unique_ptr<group_t>> spares_;
+    std::condition_variable drainCv_;
+    bool draining_ = false;
+    std::thread::id drainer_;
+
+    std::mutex regMtx_;
+    std::vector<Producer*> producers_;
+
+    std::thread timer_;
+    std::mutex timerMtx_;
+    std::condition_variable timerCv_;
+    bool stop_ = false;
+
+    static size_t calcStagingSize_(const Policy& policy) {
+      return policy.stagingSize == 0 ? policy.maxGroupSize :
+                                       policy.stagingSize;
+    }
+
+    // Largest frame data a group can hold
+    static uint16_t calcMaxData_(const Policy& policy) {
+      if (policy.maxGroupSize < group_t::MIN_SIZE + sizeof(MsgFrameHeader)) {
+        return 0;
+      }
+      size_t room = policy.maxGroupSize - group_t::MIN_SIZE -
+                    sizeof(MsgFrameHeader);
+      return static_cast<uint16_t>(std::min<size_t>(room, msg_t::MAX_DATA));
+    }
+
+    /**
+     * @brief Moves 'sz' bytes of consecutive, valid frames into the open
+     *        group, closing it whenever the next frame doesn't fit.
+     *        'since' is when the oldest of them was submitted. Doesn't call
+     *        the sink; follow up w/ drain_() once no locks are held.
+     */
+    void take_(const uint8_t* frames, size_t sz, time_point_t since) {
+      std::lock_guard<std::mutex> lock(mtx_);
+      size_t pos = 0;
+      while (pos < sz) {
+        // Reserve the run of frames that fits, then copy it in one go
+        size_t room = size_t(group_->getBufSize()) - group_->processedSize();
+        size_t runEnd = pos;
+        size_t nFramesBefore = nFrames_;
+        uint8_t* dst = nullptr;
+        while (runEnd < sz && nFrames_ < group_t::nFrames_t::max_value) {
+          MsgFrameHeader header;
+          memcpy((void*)&header, frames + runEnd, sizeof(MsgFrameHeader));
+          size_t frameSz = sizeof(MsgFrameHeader) + header.len();
+          if (frameSz > room) {
+            break;
+          }
+
+          uint8_t* slot = group_->reserveFrame(header.len());
+          if (dst == nullptr) {
+            dst = slot;
+          }
+          room -= frameSz;
+          runEnd += frameSz;
+          nFrames_++;
+        }
+
+        if (runEnd > pos) {
+          memcpy(dst, frames + pos, runEnd - pos);
+          groupSince_ = nFramesBefore == 0 ? since :
+                                             std::min(groupSince_, since);
+          pos = runEnd;
+        }
+
+        // Close the group once nothing more fits
+        if (pos < sz || room < sizeof(MsgFrameHeader) ||
+            nFrames_ == group_t::nFrames_t::max_value) {
+          close_(false);
+        }
+      }
+    }
+
+    /**
+     * @brief Finalizes the open group, queues it for the sink & swaps in a
+     *        spare. Requires mtx_.
+     */
+    void close_(bool timed) {
+      if (nFrames_ == 0) {
+        return;
+      }
+
+      if (group_->writeHeaderTrailer() == false) {
+        // TODO: Replace w/ log
+        std::cerr << "ERROR: Unable to finalize MsgGroup, frames dropped\n";
+      }
+      ready_.push_back(std::move(group_));
+
+      if (spares_.empty()) {
+        group_.reset(new group_t(policy_.maxGroupSize));
+      } else {
+        group_ = std::move(spares_.back());
+        spares_.pop_back();
+      }
+      stats_.groups++;
+      stats_.frames += nFrames_;
+      stats_.timedFlushes += timed ? 1 : 0;
+      nFrames_ = 0;
+    }
+
+    /**
+     * @brief Passes the closed groups to the sink, in order. Must be called
+     *        w/o holding any of the batcher's or a Producer's locks.
+     *
+     *        If another thread is running the sink, waits for it to finish
+     *        (it'll have emitted the caller's groups too). If the caller is
+     *        the sink itself, returns right away; the groups it closed are
+     *        emitted after it returns.
+     */
+    void drain_() {
+      std::unique_lock<std::mutex> lock(mtx_);
+      if (draining_ && drainer_ == std::this_thread::get_id()) {
+        return;
+      }
+      drainCv_.wait(lock, [this]() { return draining_ == false; });
+
+      draining_ = true;
+      drainer_ = std::this_thread::get_id();
+      while (ready_.empty() == false) {
+        std::unique_ptr<group_t> full = std::move(ready_.front());
+        ready_.pop_front();
+        lock.unlock();
+
+        // Producers fill the next group in the meantime
+        sink_(*full);
+        full->reset();
+
+        lock.lock();
+        spares_.push_back(std::move(full));
+      }
+      draining_ = false;
+      lock.unlock();
+      drainCv_.notify_all();
+    }
+
+    /**
+     * @brief Moves the frames staged before 'cutoff' into the open group,
+     *        then closes the group if its oldest frame is from before then.
+     *        The sink runs after the registry & Producer locks are released.
+     */
+    void flushOlderThan_(time_point_t cutoff) {
+      {
+        std::lock_guard<std::mutex> regLock(regMtx_);
+        for (Producer* producer : producers_) {
+          std::lock_guard<std::mutex> lock(producer->mtx_);
+          if (producer->used_ > 0 && producer->stagedSince_ <= cutoff) {
+            producer->handover_();
+          }
+        }
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (nFrames_ > 0 && groupSince_ <= cutoff) {
+          close_(true);
+        }
+      }
+      drain_();
+    }
+
+    void timerLoop_() {
+      // Ticks are half of 'maxLatency' apart, & frames are emitted on the
+      // first tick at least a tick after they're submitted, i.e. within
+      // 'maxLatency'
+      std::chrono::microseconds tick = std::max(policy_.maxLatency / 2,
+                                                std::chrono::microseconds(1));
+      std::unique_lock<std::mutex> lock(timerMtx_);
+      while (stop_ == false) {
+        timerCv_.wait_for(lock, tick);
+        if (stop_) {
+          break;
+        }
+
+        lock.unlock();
+        flushOlderThan_(std::chrono::steady_clock::now() - tick);
+        lock.lock();
+      }
+    }
+
+    void register_(Producer* producer) {
+      std::lock_guard<std::mutex> lock(regMtx_);
+      producers_.push_back(producer);
+    }
+
+    void unregister_(Producer* producer) {
+      std::lock_guard<std::mutex> lock(regMtx_);
+      producers_.erase(std::remove(producers_.begin(), producers_.end(),
+                                   producer),
+                       producers_.end());
+    }
+
+  public:
+    /**
+     * @brief Constructor; starts the flush timer if 'policy.maxLatency' is
+     *        non-zero. Throws std::invalid_argument if 'sink' is empty, if
+     *        'policy.maxGroupSize' can't hold a frame, or if
+     *        'policy.stagingSize' can't hold the largest one.
+     */
+    MplexMsgBatcher(sink_t sink, const Policy& policy) :
+        policy_(policy), stagingSz_(calcStagingSize_(policy)),
+        maxData_(calcMaxData_(policy)), sink_(std::move(sink)) {
+      if (static_cast<bool>(sink_) == false) {
+        throw std::invalid_argument("MsgBatcher requires a sink");
+      } else if (policy.maxGroupSize <
+                 group_t::MIN_SIZE + sizeof(MsgFrameHeader)) {
+        throw std::invalid_argument("Max group size can't hold a frame");
+      } else if (stagingSz_ < sizeof(MsgFrameHeader) + maxData_) {
+        throw std::invalid_argument(
+            "Staging size < largest frame a group can hold");
+      }
+
+      group_.reset(new group_t(policy_.maxGroupSize));
+      spares_.emplace_back(new group_t(policy_.maxGroupSize));
+      if (policy_.maxLatency.count() > 0) {
+        timer_ = std::thread(&MplexMsgBatcher::timerLoop_, this);
+      }
+    }
+
+    /**
+     * @brief Same as above, w/ the default Policy.
+     */
+    explicit MplexMsgBatcher(sink_t sink) :
+        MplexMsgBatcher(std::move(sink), Policy()) {}
+
+    /**
+     * @brief Destructor; stops the flush timer & emits what's left.
+     */
+    ~MplexMsgBatcher() {
+      if (timer_.joinable()) {
+        {
+          std::lock_guard<std::mutex> lock(timerMtx_);
+          stop_ = true;
+        }
+        timerCv_.notify_one();
+        timer_.join();
+      }
+      this->flush();
+    }
+
+    MplexMsgBatcher(const MplexMsgBatcher&) = delete;
+    MplexMsgBatcher& operator=(const MplexMsgBatcher&) = delete;
+
+    /**
+     * @brief Moves every Producer's staged frames into groups & emits them,
+     *        including a partially filled one. Returns once the sink has
+     *        been called for all of them, unless called from the sink, in
+     *        which case they're emitted after it returns.
+     */
+    void flush() {
+      flushOlderThan_(time_point_t::max());
+    }
+
+    // Largest frame data that can be submitted
+    uint16_t maxData() const {
+      return maxData_;
+    }
+
+    Stats stats() {
+      std::lock_guard<std::mutex> lock(mtx_);
+      return stats_;
+    }
+};
+
+/*
+ * MplexMsgBatcher::Producer class
+ * A thread's handle for submitting frames. Not thread-safe; use one per
+ * thread. Frames left staged on destruction are handed to the batcher.
+ */
+template <typename MsgGroupHeader, typename MsgFrameHeader,
+          typename BufferProvider>
+class MplexMsgBatcher<MsgGroupHeader, MsgFrameHeader,
+                      BufferProvider>::Producer {
+  private:
+    friend class MplexMsgBatcher;
+
+    MplexMsgBatcher& batcher_;
+    std::unique_ptr<uint8_t[]> staging_;
+
+    // Taken by the owning thread, & by the flush timer when it's due
+    std::mutex mtx_;
+    size_t used_ = 0;
+    time_point_t stagedSince_;
+
+    // Requires mtx_; the groups it closes are emitted by drain_()
+    void handover_() {
+      batcher_.take_(staging_.get(), used_, stagedSince_);
+      used_ = 0;
+    }
+
+  public:
+    explicit Producer(MplexMsgBatcher& batcher) :
+        batcher_(batcher), staging_(new uint8_t[batcher.stagingSz_]) {
+      batcher_.register_(this);
+    }
+
+    ~Producer() {
+      {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (used_ > 0) {
+          handover_();
+        }
+      }
+      batcher_.unregister_(this);
+      batcher_.drain_();
+    }
+
+    Producer(const Producer&) = delete;
+    Producer& operator=(const Producer&) = delete;
+
+    /**
+     * @brief Submits a frame w/ ID 'id' & 'len' bytes of data, written by
+     *        fill(frame) (e.g. w/ writeData()), which returns false on
+     *        error.
+     *
+     * @return Returns true on success. Returns false if 'len' exceeds
+     *         maxData(), or if fill() fails or writes a different length.
+     */
+    template <typename Fn>
+    bool submit(id_t id, uint16_t len, Fn&& fill) {
+      if (len > batcher_.maxData_) {
+        // TODO: Replace w/ log
+        std::cerr << "ERROR: Frame data length (" << len << ") > max ("
+                  << batcher_.maxData_ << ")\n";
+        return false;
+      }
+
+      uint16_t frameSz = static_cast<uint16_t>(sizeof(MsgFrameHeader) + len);
+      std::unique_lock<std::mutex> lock(mtx_);
+      while (used_ + frameSz > batcher_.stagingSz_) {
+        handover_();
+        // Emit w/o holding mtx_, so the sink can submit through this
+        // Producer (which may stage frames again, hence the loop)
+        lock.unlock();
+        batcher_.drain_();
+        lock.lock();
+      }
+
+      msg_t frame;
+      if (frame.reset(staging_.get() + used_, frameSz,
+                      MplexOpMode::WRITE) == false ||
+          fill(frame) == false) {
+        return false;
+      } else if (frame.processedSize() != frameSz) {
+        // TODO: Replace w/ log
+        std::cerr << "ERROR: Frame filled w/ "
+                  << frame.processedSize() - sizeof(MsgFrameHeader)
+                  << " of " << len << " bytes\n";
+        return false;
+      } else if (frame.writeHeader(id) == false) {
+        return false;
+      }
+
+      if (used_ == 0) {
+        stagedSince_ = std::chrono::steady_clock::now();
+      }
+      used_ += frameSz;
+
+      return true;
+    }
+
+    /**
+     * @brief Submits a frame w/ ID 'id' & a copy of the 'len' bytes at
+     *        'data'; see above.
+     */
+    bool submit(id_t id, const void* data, uint16_t len) {
+      if (data == nullptr && len > 0) {
+        return false;
+      }
+
+      return this->submit(id, len, [&](msg_t& frame) {
+        if (len == 0) {
+          return true;
+        }
+        uint8_t* dst = frame.claimWrite(len);
+        if (dst == nullptr) {
+          return false;
+        }
+        memcpy(dst, data, len);
+        return true;
+      });
+    }
+
+    /**
+     * @brief Hands the staged frames to the batcher now, rather than when
+     *        the staging buffer fills up or they're due.
+     */
+    void flush() {
+      {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (used_ > 0) {
+          handover_();
+        }
+      }
+      batcher_.drain_();
+    }
+};
+
+#endif
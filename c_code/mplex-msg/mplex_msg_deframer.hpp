@@ -0,0 +1,357 @@
+#ifndef MPLEX_MSG_DEFRAMER_H
+#define MPLEX_MSG_DEFRAMER_H
+
+// C headers
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+// C++ headers
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <string>
+
+#include "mplex_msg_group.hpp"
+
+/*
+ * MplexMsgDeframer class
+ * Incremental (push) parser that recovers Message Groups from a byte stream,
+ * e.g. a serial port or TCP socket, where reads split & merge groups
+ * arbitrarily. Bytes are fed in w/ push() as they arrive; each complete
+ * group, whose header & frames are all valid and which ends w/ an End of
+ * Message Group trailer, is passed to the callback as a READ-mode view.
+ *
+ * Groups that lie entirely within a pushed chunk are handed out in place.
+ * Only the tail of a chunk holding the start of a group is buffered, in a
+ * ring mapped twice back-to-back in virtual memory so that buffered groups
+ * are always contiguous, even across the ring's end. Each byte is therefore
+ * copied at most once, and never moved afterwards.
+ *
+ * Anything that doesn't parse as a group (noise, or a group w/ a corrupted
+ * header, frame or trailer) is dropped, and parsing resumes at the next
+ * MAGIC_NUMBER byte after the start of the rejected candidate, found w/
+ * memchr().
+ */
+template <typename MsgGroupHeader,
+          typename MsgFrameHeader =
+              typename MsgHeaders<MsgGroupHeader::VERS>::frame_header_t>
+class MplexMsgDeframer {
+  public:
+    typedef MplexMsgGroup<MsgGroupHeader, MsgFrameHeader> group_t;
+    typedef typename group_t::msg_t msg_t;
+    typedef typename group_t::nFrames_t nFrames_t;
+
+    // Called w/ each complete group, whose view spans exactly the group
+    // (i.e. getBufSize() is its size); only valid during the call
+    typedef std::function<void(group_t& group)> callback_t;
+
+    // Running totals since construction
+    struct Stats {
+      uint64_t groups;         // Groups passed to the callback
+      uint64_t droppedBytes;   // Bytes skipped while (re)synchronizing
+      uint64_t bufferedBytes;  // Bytes copied into the ring
+    };
+
+  private:
+    // Parsing stage of the current candidate group
+    enum class State {
+      HEADER,
+      FRAME_HEADER,
+      FRAME,
+      TRAILER
+    };
+
+    enum class Parse {
+      MORE,  // Need more bytes
+      DONE,  // Complete & valid group
+      BAD    // Not a group
+    };
+
+    callback_t callback_;
+    Stats stats_ = {0, 0, 0};
+
+    // Progress through the current candidate, starting at its first byte
+    State state_ = State::HEADER;
+    size_t parsed_ = 0;
+    uint16_t framesLeft_ = 0;
+    uint16_t frameLen_ = 0;
+
+    // Ring of ringSize_ bytes, mapped twice from ring_ onwards. Non-empty
+    // only while a candidate group starting at ring_ + head_ is incomplete.
+    uint8_t* ring_ = nullptr;
+    size_t ringSize_ = 0;
+    size_t head_ = 0;
+    size_t len_ = 0;
+
+    /**
+     * @brief Maps a memfd twice, back-to-back, so that any ringSize_ bytes
+     *        starting in the first mapping are contiguous.
+     */
+    void mapRing_() {
+      long pageSz = sysconf(_SC_PAGESIZE);
+      size_t page = pageSz > 0 ? static_cast<size_t>(pageSz) : 4096;
+      ringSize_ = (group_t::MAX_SIZE + page - 1) / page * page;
+
+      int fd = memfd_create("mplex_deframer", MFD_CLOEXEC);
+      if (fd == -1) {
+        throw std::runtime_error(std::string("memfd_create() failed: ") +
+                                 strerror(errno));
+      }
+
+      void* base = MAP_FAILED;
+      if (ftruncate(fd, static_cast<off_t>(ringSize_)) == 0) {
+        base = mmap(nullptr, 2 * ringSize_, PROT_NONE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      }
+      if (base != MAP_FAILED) {
+        uint8_t* lo = static_cast<uint8_t*>(base);
+        if (mmap(lo, ringSize_, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ||
+            mmap(lo + ringSize_, ringSize_, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+          munmap(base, 2 * ringSize_);
+          base = MAP_FAILED;
+        }
+      }
+      int err = errno;
+      close(fd);
+
+      if (base == MAP_FAILED) {
+        throw std::runtime_error(std::string("Unable to map ring: ") +
+                                 strerror(err));
+      }
+      ring_ = static_cast<uint8_t*>(base);
+    }
+
+    uint8_t* ringHead_() const {
+      return ring_ + head_;
+    }
+
+    void ringAppend_(const uint8_t* data, size_t sz) {
+      memcpy(ring_ + (head_ + len_) % ringSize_, data, sz);
+      len_ += sz;
+      stats_.bufferedBytes += sz;
+    }
+
+    void ringConsume_(size_t sz) {
+      head_ = (head_ + sz) % ringSize_;
+      len_ -= sz;
+    }
+
+    void resetParse_() {
+      state_ = State::HEADER;
+      parsed_ = 0;
+    }
+
+    // Bytes of the candidate needed to finish its current stage
+    size_t needed_() const {
+      switch (state_) {
+        case State::HEADER:
+          return sizeof(MsgGroupHeader);
+        case State::FRAME:
+          return parsed_ + sizeof(MsgFrameHeader) + frameLen_;
+        case State::FRAME_HEADER:
+        case State::TRAILER:
+        default:
+          return parsed_ + sizeof(MsgFrameHeader);
+      }
+    }
+
+    /**
+     * @brief Continues parsing the candidate group at 'grp', of which 'avail'
+     *        bytes are available, from where the last call left off.
+     */
+    Parse parse_(const uint8_t* grp, size_t avail) {
+      for (;;) {
+        size_t needed = needed_();
+        if (needed > group_t::MAX_SIZE) {
+          return Parse::BAD;
+        } else if (needed > avail) {
+          return Parse::MORE;
+        }
+
+        const uint8_t* p = grp + parsed_;
+        switch (state_) {
+          case State::HEADER: {
+            if (group_t::headerIsValid(p) == false) {
+              return Parse::BAD;
+            }
+            MsgGroupHeader header;
+            memcpy((void*)&header, p, sizeof(MsgGroupHeader));
+            framesLeft_ = header.numFrames();
+            parsed_ = sizeof(MsgGroupHeader);
+            state_ = framesLeft_ > 0 ? State::FRAME_HEADER : State::TRAILER;
+            break;
+          }
+          case State::FRAME_HEADER: {
+            MsgFrameHeader header;
+            memcpy((void*)&header, p, sizeof(MsgFrameHeader));
+            if (header.magic() != MsgFrameHeader::MAGIC_NUMBER) {
+              return Parse::BAD;
+            }
+            frameLen_ = header.len();
+            state_ = State::FRAME;
+            break;
+          }
+          case State::FRAME: {
+            // Frames are only read here, never written
+            uint16_t frameSz = static_cast<uint16_t>(sizeof(MsgFrameHeader) +
+                                                     frameLen_);
+            msg_t frame;
+            if (frame.reset(const_cast<uint8_t*>(p), frameSz,
+                            MplexOpMode::READ) == false ||
+                frame.isEndOfMsgGroup() || frame.isValid() == false) {
+              return Parse::BAD;
+            }
+            parsed_ += frameSz;
+            framesLeft_--;
+            state_ = framesLeft_ > 0 ? State::FRAME_HEADER : State::TRAILER;
+            break;
+          }
+          case State::TRAILER: {
+            MsgFrameHeader endOfGroup;
+            if (memcmp(p, (const void*)&endOfGroup,
+                       sizeof(MsgFrameHeader)) != 0) {
+              return Parse::BAD;
+            }
+            parsed_ += sizeof(MsgFrameHeader);
+            return Parse::DONE;
+          }
+        }
+      }
+    }
+
+    void emit_(const uint8_t* grp) {
+      group_t view(MPLEX_VIEW, grp, static_cast<uint16_t>(parsed_));
+      stats_.groups++;
+      callback_(view);
+    }
+
+    /**
+     * @brief Parses the candidate at the ring's head, moving on to later
+     *        candidates in the ring if it's done or bad. Returns once the
+     *        ring is empty, or its head candidate needs more bytes.
+     */
+    void drainRing_() {
+      while (len_ > 0) {
+        Parse res = parse_(ringHead_(), len_);
+        if (res == Parse::MORE) {
+          return;
+        }
+
+        size_t skip = 1;
+        if (res == Parse::DONE) {
+          emit_(ringHead_());
+          skip = parsed_;
+        } else {
+          stats_.droppedBytes++;
+        }
+        ringConsume_(skip);
+        resetParse_();
+
+        const void* magic = memchr(ringHead_(), MsgGroupHeader::MAGIC_NUMBER,
+                                   len_);
+        size_t gap = magic == nullptr ? len_ :
+            static_cast<size_t>(static_cast<const uint8_t*>(magic) -
+                                ringHead_());
+        stats_.droppedBytes += gap;
+        ringConsume_(gap);
+      }
+      head_ = 0;
+    }
+
+  public:
+    /**
+     * @brief Constructor for a deframer that passes complete groups to
+     *        'callback'. Throws std::invalid_argument for an empty callback,
+     *        or std::runtime_error if the ring can't be mapped.
+     */
+    explicit MplexMsgDeframer(callback_t callback)
+        : callback_(std::move(callback)) {
+      if (!callback_) {
+        throw std::invalid_argument("Deframer callback is empty");
+      }
+      mapRing_();
+    }
+
+    ~MplexMsgDeframer() {
+      munmap(ring_, 2 * ringSize_);
+    }
+
+    MplexMsgDeframer(const MplexMsgDeframer&) = delete;
+    MplexMsgDeframer& operator=(const MplexMsgDeframer&) = delete;
+
+    /**
+     * @brief Feeds the next 'sz' bytes of the stream to the deframer,
+     *        calling the callback for each group they complete. Bytes of an
+     *        incomplete group at the end are kept for the next push().
+     *
+     * @param data Pointer to the bytes; only used during the call.
+     * @param sz Number of bytes.
+     */
+    void push(const uint8_t* data, size_t sz) {
+      if (data == nullptr) {
+        return;
+      }
+      const uint8_t* end = data + sz;
+
+      // Complete (or reject) the buffered candidate first, taking only as
+      // many bytes as each of its stages needs
+      while (len_ > 0 && data < end) {
+        size_t n = std::min(needed_() - len_, static_cast<size_t>(end - data));
+        ringAppend_(data, n);
+        data += n;
+        drainRing_();
+      }
+
+      // Then parse in place, buffering only a trailing incomplete group
+      while (data < end) {
+        const void* magic = memchr(data, MsgGroupHeader::MAGIC_NUMBER,
+                                   static_cast<size_t>(end - data));
+        if (magic == nullptr) {
+          stats_.droppedBytes += static_cast<size_t>(end - data);
+          return;
+        }
+        const uint8_t* grp = static_cast<const uint8_t*>(magic);
+        stats_.droppedBytes += static_cast<size_t>(grp - data);
+
+        resetParse_();
+        Parse res = parse_(grp, static_cast<size_t>(end - grp));
+        if (res == Parse::DONE) {
+          emit_(grp);
+          data = grp + parsed_;
+        } else if (res == Parse::BAD) {
+          stats_.droppedBytes++;
+          data = grp + 1;
+        } else {
+          ringAppend_(grp, static_cast<size_t>(end - grp));
+          return;
+        }
+      }
+    }
+
+    /**
+     * @brief Drops any buffered partial group, e.g. when the stream is
+     *        re-opened. The dropped bytes are counted in Stats::droppedBytes.
+     */
+    void reset() {
+      stats_.droppedBytes += len_;
+      head_ = 0;
+      len_ = 0;
+      resetParse_();
+    }
+
+    // Number of bytes of an incomplete group held in the ring
+    size_t buffered() const {
+      return len_;
+    }
+
+    Stats stats() const {
+      return stats_;
+    }
+};
+
+#endif
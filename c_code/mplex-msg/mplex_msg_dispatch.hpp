@@ -0,0 +1,208 @@
+#ifndef MPLEX_MSG_DISPATCH_H
+#define MPLEX_MSG_DISPATCH_H
+
+// C headers
+#include <stdint.h>
+#include <stddef.h>
+
+// C++ headers
+#include <vector>
+
+#include "mplex_msg_group.hpp"
+
+/*
+ * MplexMsgDispatcher class
+ * Demultiplexes the frames of Message Groups by frame ID. Handlers are kept
+ * in flat tables indexed by ID (128 entries for v0, 256 for v1), each being a
+ * plain function pointer & context pointer, so dispatching a frame is one
+ * indexed load & an indirect call, w/o any hashing or type erasure.
+ *
+ * Frames can be delivered:
+ *  - One at a time, w/ dispatch(): each valid frame is passed to its ID's
+ *    frame handler as it's read.
+ *  - In batches, w/ collect() & flush(): the frames of any number of groups
+ *    are bucketed by ID, then each ID's batch handler receives all of its
+ *    frames at once, in order, as an array of FrameRefs. The groups'
+ *    buffers must outlive the flush().
+ *
+ * Frames w/o a handler for their ID are counted & skipped.
+ */
+template <typename MsgGroupHeader,
+          typename MsgFrameHeader =
+              typename MsgHeaders<MsgGroupHeader::VERS>::frame_header_t>
+class MplexMsgDispatcher {
+  public:
+    typedef MplexMsgGroup<MsgGroupHeader, MsgFrameHeader> group_t;
+    typedef typename group_t::msg_t msg_t;
+    typedef typename MsgFrameHeader::id_t id_t;
+
+    // Number of distinct frame IDs
+    static const size_t NUM_IDS = size_t(id_t::max_value) + 1;
+
+    // Data of a frame delivered in a batch; points into its group's buffer
+    struct FrameRef {
+      const uint8_t* data;  // Start of the frame's data section
+      uint16_t len;
+      uint32_t group;       // # of the collect() call that found the frame,
+                            // counting from 0 since the last flush()
+    };
+
+    typedef void (*frame_fn)(void* ctx, msg_t& frame);
+    typedef void (*batch_fn)(void* ctx, id_t id, const FrameRef* frames,
+                             size_t n);
+
+  private:
+    struct FrameHandler_ {
+      frame_fn fn = nullptr;
+      void* ctx = nullptr;
+    };
+
+    struct BatchHandler_ {
+      batch_fn fn = nullptr;
+      void* ctx = nullptr;
+    };
+
+    FrameHandler_ frameHandlers_[NUM_IDS];
+    BatchHandler_ batchHandlers_[NUM_IDS];
+
+    // Collected frames per ID & a bitmap of the non-empty buckets
+    static const size_t BITMAP_WORDS = (NUM_IDS + 63) / 64;
+    std::vector<FrameRef> buckets_[NUM_IDS];
+    uint64_t pending_[BITMAP_WORDS] = {};
+    uint32_t nCollected_ = 0;
+
+    uint64_t unhandled_ = 0;
+
+    static size_t index_(id_t id) {
+      return static_cast<typename id_t::repr_type>(id);
+    }
+
+  public:
+    MplexMsgDispatcher() {}
+
+    MplexMsgDispatcher(const MplexMsgDispatcher&) = delete;
+    MplexMsgDispatcher& operator=(const MplexMsgDispatcher&) = delete;
+
+    /**
+     * @brief Sets the handler called by dispatch() for frames w/ ID 'id',
+     *        replacing any previous one. A NULL 'fn' removes the handler.
+     */
+    void onFrame(id_t id, frame_fn fn, void* ctx = nullptr) {
+      frameHandlers_[index_(id)] = {fn, ctx};
+    }
+
+    /**
+     * @brief Same as above, for a callable invoked as callable(frame). The
+     *        callable is referenced, not copied, so it must outlive its use.
+     */
+    template <typename F>
+    void onFrame(id_t id, F& callable) {
+      this->onFrame(id, [](void* ctx, msg_t& frame) {
+        (*static_cast<F*>(ctx))(frame);
+      }, static_cast<void*>(&callable));
+    }
+
+    /**
+     * @brief Sets the handler called by flush() w/ the collected frames of ID
+     *        'id', replacing any previous one. A NULL 'fn' removes the
+     *        handler.
+     */
+    void onBatch(id_t id, batch_fn fn, void* ctx = nullptr) {
+      batchHandlers_[index_(id)] = {fn, ctx};
+    }
+
+    /**
+     * @brief Same as above, for a callable invoked as callable(id, frames, n).
+     *        The callable is referenced, not copied, so it must outlive its
+     *        use.
+     */
+    template <typename F>
+    void onBatch(id_t id, F& callable) {
+      this->onBatch(id, [](void* ctx, id_t frameId, const FrameRef* frames,
+                           size_t n) {
+        (*static_cast<F*>(ctx))(frameId, frames, n);
+      }, static_cast<void*>(&callable));
+    }
+
+    /**
+     * @brief Passes each valid frame of a READ-mode group to the frame handler
+     *        of its ID, in order.
+     *
+     * @return Returns the number of frames handled.
+     */
+    size_t dispatch(group_t& group) {
+      size_t nHandled = 0;
+      group.forEachValidFrame([&](msg_t& frame) {
+        const FrameHandler_& handler = frameHandlers_[index_(frame.id())];
+        if (handler.fn == nullptr) {
+          unhandled_++;
+          return;
+        }
+        handler.fn(handler.ctx, frame);
+        nHandled++;
+      });
+
+      return nHandled;
+    }
+
+    /**
+     * @brief Buckets the valid frames of a READ-mode group by ID, for the
+     *        next flush(). Only frames whose ID has a batch handler are kept.
+     *        The group's buffer must stay alive & unmodified until then.
+     *
+     * @return Returns the number of frames collected.
+     */
+    size_t collect(group_t& group) {
+      size_t nCollected = 0;
+      group.forEachValidFrame([&](msg_t& frame) {
+        size_t idx = index_(frame.id());
+        if (batchHandlers_[idx].fn == nullptr) {
+          unhandled_++;
+          return;
+        }
+        buckets_[idx].push_back({frame.getData(), frame.len(), nCollected_});
+        pending_[idx / 64] |= uint64_t(1) << (idx % 64);
+        nCollected++;
+      });
+      nCollected_++;
+
+      return nCollected;
+    }
+
+    /**
+     * @brief Passes each ID's collected frames to its batch handler, in order
+     *        of ID, then empties the buckets (keeping their capacity).
+     *
+     * @return Returns the number of frames delivered.
+     */
+    size_t flush() {
+      size_t nDelivered = 0;
+      for (size_t w = 0; w < BITMAP_WORDS; w++) {
+        for (uint64_t bits = pending_[w]; bits != 0; bits &= bits - 1) {
+          size_t idx = w * 64 + static_cast<size_t>(__builtin_ctzll(bits));
+          std::vector<FrameRef>& bucket = buckets_[idx];
+          const BatchHandler_& handler = batchHandlers_[idx];
+          if (handler.fn != nullptr) {
+            handler.fn(handler.ctx,
+                       static_cast<typename id_t::repr_type>(idx),
+                       bucket.data(), bucket.size());
+            nDelivered += bucket.size();
+          } else {
+            unhandled_ += bucket.size();
+          }
+          bucket.clear();
+        }
+        pending_[w] = 0;
+      }
+      nCollected_ = 0;
+
+      return nDelivered;
+    }
+
+    // Number of frames skipped for lack of a handler
+    uint64_t unhandled() const {
+      return unhandled_;
+    }
+};
+
+#endif
@@ -0,0 +1,269 @@
+#ifndef MPLEX_MSG_ENCODER_H
+#define MPLEX_MSG_ENCODER_H
+
+// C headers
+#include <stdint.h>
+
+// C++ headers
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "mplex_msg_group.hpp"
+
+/*
+ * MplexMsgGroupEncoder class
+ * Builds Message Groups w/ a pool of worker threads. Since each frame's
+ * data length is given up front, every frame's slot in the group is
+ * reserved (see MplexMsgGroup::reserveFrame()) before any data is written.
+ * The frames are then filled in & CRC'd in parallel, and the header &
+ * End of Message Group trailer are written once all of them are done.
+ *
+ * The result is byte-for-byte what writing the same frames one after the
+ * other w/ currFrame() / writeHeader() / commitFrame() would produce.
+ *
+ * The thread calling encode() works alongside the pool, so a pool of 0
+ * workers encodes serially. Only one encode() may run at a time.
+ */
+template <typename MsgGroupHeader,
+          typename MsgFrameHeader =
+              typename MsgHeaders<MsgGroupHeader::VERS>::frame_header_t,
+          typename BufferProvider = MplexBufferPool<>>
+class MplexMsgGroupEncoder {
+  public:
+    typedef MplexMsgGroup<MsgGroupHeader, MsgFrameHeader, BufferProvider>
+        group_t;
+    typedef typename group_t::msg_t msg_t;
+    typedef typename MsgFrameHeader::id_t id_t;
+
+    // A frame to encode: its ID & the exact length of its data
+    struct FrameSpec {
+      id_t id;
+      uint16_t len;
+    };
+
+    /*
+     * Writes the data of frame 'idx' (of a group's FrameSpecs) to 'frame',
+     * e.g. w/ writeData(). Called concurrently for different frames. Returns
+     * false on error.
+     */
+    typedef std::function<bool(size_t idx, msg_t& frame)> fill_t;
+
+    // A group to encode, for the batch encode()
+    struct GroupJob {
+      group_t* group;
+      const FrameSpec* frames;
+      size_t nFrames;
+      fill_t fill;
+      bool ok; // Set by encode()
+    };
+
+  private:
+    // Frames are handed to threads in runs of this many
+    static const size_t TASKS_PER_CLAIM = 4;
+
+    struct Task_ {
+      uint8_t* slot;
+      size_t job;
+      size_t idx;
+    };
+
+    std::vector<std::thread> workers_;
+
+    // Tasks of the current encode(); read-only while workers run
+    GroupJob* jobs_ = nullptr;
+    std::vector<Task_> tasks_;
+    std::unique_ptr<std::atomic<bool>[]> failed_;
+    size_t failedSz_ = 0;
+    std::atomic<size_t> nextTask_{0};
+
+    std::mutex mtx_;
+    std::condition_variable workReady_;
+    std::condition_variable workDone_;
+    uint64_t generation_ = 0;
+    size_t nBusy_ = 0;
+    bool stop_ = false;
+
+    void runTasks_() {
+      const size_t nTasks = tasks_.size();
+      for (;;) {
+        size_t first = nextTask_.fetch_add(TASKS_PER_CLAIM,
+                                           std::memory_order_relaxed);
+        if (first >= nTasks) {
+          return;
+        }
+
+        size_t last = std::min(first + TASKS_PER_CLAIM, nTasks);
+        for (size_t i = first; i < last; i++) {
+          const Task_& task = tasks_[i];
+          if (encodeFrame_(task) == false) {
+            failed_[task.job].store(true, std::memory_order_relaxed);
+          }
+        }
+      }
+    }
+
+    bool encodeFrame_(const Task_& task) const {
+      const GroupJob& job = jobs_[task.job];
+      const FrameSpec& spec = job.frames[task.idx];
+      uint16_t frameSz = static_cast<uint16_t>(sizeof(MsgFrameHeader) +
+                                               spec.len);
+      msg_t frame;
+      if (frame.reset(task.slot, frameSz, MplexOpMode::WRITE) == false ||
+          job.fill(task.idx, frame) == false) {
+        return false;
+      }
+
+      if (frame.processedSize() != frameSz) {
+        // TODO: Use log
+        std::cerr << "ERROR: Frame " << task.idx << " filled w/ "
+                  << frame.processedSize() - sizeof(MsgFrameHeader)
+                  << " of " << spec.len << " bytes\n";
+        return false;
+      }
+
+      return frame.writeHeader(spec.id);
+    }
+
+    void workerLoop_() {
+      uint64_t seen = 0;
+      for (;;) {
+        {
+          std::unique_lock<std::mutex> lock(mtx_);
+          workReady_.wait(lock, [&]() {
+            return stop_ || generation_ != seen;
+          });
+          if (stop_) {
+            return;
+          }
+          seen = generation_;
+        }
+
+        runTasks_();
+
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (--nBusy_ == 0) {
+          workDone_.notify_one();
+        }
+      }
+    }
+
+  public:
+    /**
+     * @brief Constructor; starts 'nWorkers' threads, which wait for encode()
+     *        calls until the object is destroyed.
+     */
+    explicit MplexMsgGroupEncoder(size_t nWorkers) {
+      workers_.reserve(nWorkers);
+      for (size_t i = 0; i < nWorkers; i++) {
+        workers_.emplace_back(&MplexMsgGroupEncoder::workerLoop_, this);
+      }
+    }
+
+    ~MplexMsgGroupEncoder() {
+      {
+        std::lock_guard<std::mutex> lock(mtx_);
+        stop_ = true;
+      }
+      workReady_.notify_all();
+      for (std::thread& worker : workers_) {
+        worker.join();
+      }
+    }
+
+    MplexMsgGroupEncoder(const MplexMsgGroupEncoder&) = delete;
+    MplexMsgGroupEncoder& operator=(const MplexMsgGroupEncoder&) = delete;
+
+    size_t numWorkers() const {
+      return workers_.size();
+    }
+
+    /**
+     * @brief Encodes a batch of groups, w/ the frames of all of them spread
+     *        across the pool. Each job's group must be in WRITE mode & have
+     *        no frames written to it yet. Blocks until every job is done.
+     *
+     *        Jobs whose frames don't all fit, or whose fill() fails or writes
+     *        a different length than specified, have 'ok' set to false; their
+     *        groups must be reset before being reused.
+     *
+     * @return Returns true if every job's 'ok' is true.
+     */
+    bool encode(GroupJob* jobs, size_t nJobs) {
+      if (jobs == nullptr) {
+        return nJobs == 0;
+      }
+
+      // Reserve every frame's slot up front
+      tasks_.clear();
+      for (size_t j = 0; j < nJobs; j++) {
+        GroupJob& job = jobs[j];
+        job.ok = job.group != nullptr && static_cast<bool>(job.fill) &&
+                 (job.frames != nullptr || job.nFrames == 0);
+        size_t firstTask = tasks_.size();
+        for (size_t i = 0; job.ok && i < job.nFrames; i++) {
+          uint8_t* slot = job.group->reserveFrame(job.frames[i].len);
+          job.ok = slot != nullptr;
+          tasks_.push_back({slot, j, i});
+        }
+        if (job.ok == false) {
+          // Skip the frames of unusable jobs
+          tasks_.resize(firstTask);
+        }
+      }
+
+      if (failedSz_ < nJobs) {
+        failed_.reset(new std::atomic<bool>[nJobs]);
+        failedSz_ = nJobs;
+      }
+      for (size_t j = 0; j < nJobs; j++) {
+        failed_[j].store(false, std::memory_order_relaxed);
+      }
+      jobs_ = jobs;
+      nextTask_.store(0, std::memory_order_relaxed);
+
+      // Fill & CRC the frames, then wait for the workers to finish
+      if (workers_.empty() == false) {
+        {
+          std::lock_guard<std::mutex> lock(mtx_);
+          nBusy_ = workers_.size();
+          generation_++;
+        }
+        workReady_.notify_all();
+      }
+      runTasks_();
+      if (workers_.empty() == false) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        workDone_.wait(lock, [&]() { return nBusy_ == 0; });
+      }
+
+      bool allOk = true;
+      for (size_t j = 0; j < nJobs; j++) {
+        GroupJob& job = jobs[j];
+        job.ok = job.ok &&
+                 failed_[j].load(std::memory_order_relaxed) == false &&
+                 job.group->writeHeaderTrailer();
+        allOk = allOk && job.ok;
+      }
+      jobs_ = nullptr;
+
+      return allOk;
+    }
+
+    /**
+     * @brief Encodes a single group; see above.
+     */
+    bool encode(group_t& group, const std::vector<FrameSpec>& frames,
+                const fill_t& fill) {
+      GroupJob job = {&group, frames.data(), frames.size(), fill, false};
+      return this->encode(&job, 1);
+    }
+};
+
+#endif
@@ -0,0 +1,551 @@
+#ifndef MPLEX_MSG_FRAGMENT_H
+#define MPLEX_MSG_FRAGMENT_H
+
+// C headers
+#include <stdint.h>
+#include <string.h>
+
+// C++ headers
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include "mplex_msg_group.hpp"
+#include "mplex_msg_schema.hpp"
+
+/*
+ * Fragmentation of messages larger than a frame's data.
+ *
+ * A message is split into fragments, each sent as the data of one frame
+ * (of an ID set aside for fragments), across as many consecutive frames &
+ * groups as needed. Each fragment starts w/ a 16-byte header, followed by
+ * its part of the message:
+ *
+ *  0                                 32
+ * +---------------------------------+---------------------------------+
+ * |   Message sequence # (32 Bits)  |    Message size (32 Bits)       |
+ * +---------------------------------+---------------------------------+
+ *  64                                96
+ * +---------------------------------+---------------------------------+
+ * |   Fragment index (32 Bits)      |    # Fragments (32 Bits)        |
+ * +---------------------------------+---------------------------------+
+ *
+ * All fields are big-endian. Every fragment but the last carries
+ * ceil(size / # fragments) Bytes of the message, so a fragment's place in
+ * the message follows from its index. Sequence #s tell apart the messages
+ * of a sender; they're chosen by the sender, e.g. a counter.
+ */
+struct MplexFragmentHeader {
+  uint32_t seq;
+  uint32_t size;
+  uint32_t index;
+  uint32_t count;
+};
+
+typedef MplexSchema::Schema<
+    MplexSchema::Field<&MplexFragmentHeader::seq>,
+    MplexSchema::Field<&MplexFragmentHeader::size>,
+    MplexSchema::Field<&MplexFragmentHeader::index>,
+    MplexSchema::Field<&MplexFragmentHeader::count>
+  > MplexFragmentSchema;
+
+/*
+ * MplexMsgFragmenter class
+ * Splits one message into fragments. The message isn't copied until the
+ * fragments are written, so it must outlive the object.
+ *
+ * Fragments can be written into groups w/ writeTo(), or one at a time w/
+ * writeFragment(), e.g. from MplexMsgGroupEncoder or MplexMsgBatcher (w/
+ * frameLen() as the length of each).
+ */
+template <typename MsgGroupHeader,
+          typename MsgFrameHeader =
+              typename MsgHeaders<MsgGroupHeader::VERS>::frame_header_t,
+          typename BufferProvider = MplexBufferPool<>>
+class MplexMsgFragmenter {
+  public:
+    typedef MplexMsgGroup<MsgGroupHeader, MsgFrameHeader, BufferProvider>
+        group_t;
+    typedef typename group_t::msg_t msg_t;
+    typedef typename MsgFrameHeader::id_t id_t;
+
+    static const uint16_t HEADER_SIZE = MplexFragmentSchema::SIZE;
+
+    // Largest frame data that fits in a group of the maximum size
+    static const uint16_t MAX_FRAME_DATA = static_cast<uint16_t>(
+        std::min<size_t>(msg_t::MAX_DATA, group_t::MAX_SIZE -
+                                          group_t::MIN_SIZE -
+                                          sizeof(MsgFrameHeader)));
+
+  private:
+    const uint8_t* data_;
+    MplexFragmentHeader header_;
+    uint32_t fragData_;  // Message Bytes per fragment, but the last
+    uint32_t next_ = 0;  // Next fragment for writeTo()
+
+  public:
+    /**
+     * @brief Splits the 'sz' Bytes at 'data' into fragments whose frames
+     *        hold at most 'maxFrameData' Bytes (fragment header included).
+     *        Empty messages take a single fragment.
+     *
+     *        Throws std::invalid_argument if 'data' is NULL (& 'sz' isn't 0),
+     *        if 'sz' doesn't fit in 32 bits, or if 'maxFrameData' doesn't
+     *        leave room for any of the message or exceeds MAX_FRAME_DATA.
+     */
+    MplexMsgFragmenter(const uint8_t* data, size_t sz, uint32_t seq,
+                       uint16_t maxFrameData = MAX_FRAME_DATA) : data_(data) {
+      if (data == nullptr && sz > 0) {
+        throw std::invalid_argument("Cannot fragment a NULL message");
+      } else if (sz > UINT32_MAX) {
+        throw std::invalid_argument("Message size > 32 bits");
+      } else if (maxFrameData <= HEADER_SIZE ||
+                 maxFrameData > MAX_FRAME_DATA) {
+        throw std::invalid_argument("Invalid max fragment frame size");
+      }
+
+      size_t maxPayload = maxFrameData - HEADER_SIZE;
+      size_t count = std::max<size_t>((sz + maxPayload - 1) / maxPayload, 1);
+      header_ = {seq, static_cast<uint32_t>(sz), 0,
+                 static_cast<uint32_t>(count)};
+      fragData_ = static_cast<uint32_t>((sz + count - 1) / count);
+    }
+
+    uint32_t numFragments() const {
+      return header_.count;
+    }
+
+    /**
+     * @brief Returns the length of fragment 'i''s frame data, header
+     *        included.
+     */
+    uint16_t frameLen(uint32_t i) const {
+      uint32_t payload = i + 1 < header_.count ?
+                         fragData_ : header_.size - fragData_ * i;
+      return static_cast<uint16_t>(HEADER_SIZE + payload);
+    }
+
+    /**
+     * @brief Writes fragment 'i' (< numFragments()) to the data of 'frame',
+     *        which must be in WRITE mode. The frame's header is left to the
+     *        caller.
+     *
+     * @return Returns true on success, false if 'i' is out of range or the
+     *         fragment doesn't fit in the frame.
+     */
+    bool writeFragment(uint32_t i, msg_t& frame) const {
+      if (i >= header_.count) {
+        return false;
+      }
+
+      uint16_t len = this->frameLen(i);
+      uint8_t* dst = frame.claimWrite(len);
+      if (dst == nullptr) {
+        return false;
+      }
+
+      MplexFragmentHeader header = header_;
+      header.index = i;
+      MplexFragmentSchema::encodeTo(dst, header);
+      if (len > HEADER_SIZE) {
+        memcpy(dst + HEADER_SIZE, data_ + size_t(fragData_) * i,
+               len - HEADER_SIZE);
+      }
+
+      return true;
+    }
+
+    /**
+     * @brief Writes the fragments not yet written by this method to 'group',
+     *        in WRITE mode, as frames w/ ID 'id', for as long as they fit.
+     *        Call again w/ the next group until done().
+     *
+     *        Throws std::invalid_argument if the next fragment wouldn't fit
+     *        even in an empty group of the same size, as calling again would
+     *        then never get done(); size the fragments (i.e. 'maxFrameData')
+     *        for the groups.
+     *
+     * @return Returns the number of fragments written.
+     */
+    size_t writeTo(group_t& group, id_t id) {
+      if (next_ < header_.count &&
+          size_t(group_t::MIN_SIZE) + sizeof(MsgFrameHeader) +
+          this->frameLen(next_) > group.getBufSize()) {
+        throw std::invalid_argument("Fragment doesn't fit in the group");
+      }
+
+      size_t nWritten = 0;
+      msg_t* pMsg = group.currFrame();
+      while (next_ < header_.count && pMsg != nullptr) {
+        // Leave room for the End of Message Group frame
+        size_t frameSz = sizeof(MsgFrameHeader) + this->frameLen(next_);
+        if (size_t(group.processedSize()) + frameSz > group.getBufSize() ||
+            this->writeFragment(next_, *pMsg) == false ||
+            pMsg->writeHeader(id) == false) {
+          break;
+        }
+
+        next_++;
+        nWritten++;
+        pMsg = group.commitFrame();
+      }
+
+      return nWritten;
+    }
+
+    // Whether writeTo() has written every fragment
+    bool done() const {
+      return next_ == header_.count;
+    }
+};
+
+/*
+ * MplexMsgReassembler class
+ * Rebuilds fragmented messages from the groups they arrive in, & passes
+ * each complete message to a callback.
+ *
+ * Messages whose fragments all arrive in the same group are handed over
+ * w/o being copied, as the list of their fragments' Bytes in the group's
+ * buffer (a single span if unfragmented). Messages spread across groups are
+ * copied into a buffer of their size as their fragments arrive, in any
+ * order, & handed over as one span.
+ *
+ * Memory is bounded: messages larger than 'maxMessageSize' are dropped, and
+ * the least recently added-to partial messages are evicted to keep their
+ * buffers under 'maxBuffered' Bytes. Partial messages that go 'timeout'
+ * w/o a new fragment are expired.
+ *
+ * Expects the messages of a single sender, i.e. unique sequence #s. Not
+ * thread-safe.
+ */
+template <typename MsgGroupHeader,
+          typename MsgFrameHeader =
+              typename MsgHeaders<MsgGroupHeader::VERS>::frame_header_t,
+          typename BufferProvider = MplexBufferPool<>>
+class MplexMsgReassembler {
+  public:
+    typedef MplexMsgGroup<MsgGroupHeader, MsgFrameHeader, BufferProvider>
+        group_t;
+    typedef typename group_t::msg_t msg_t;
+    typedef typename MsgFrameHeader::id_t id_t;
+    typedef std::chrono::steady_clock::time_point time_point_t;
+
+    static const uint16_t HEADER_SIZE = MplexFragmentSchema::SIZE;
+
+    struct Span {
+      const uint8_t* data;
+      size_t len;
+    };
+
+    // A complete message; only valid during the callback
+    struct Message {
+      uint32_t seq;
+      size_t size;
+      const Span* spans;  // In order; 'size' Bytes in all
+      size_t nSpans;
+
+      void copyTo(uint8_t* dst) const {
+        for (size_t i = 0; i < nSpans; i++) {
+          memcpy(dst, spans[i].data, spans[i].len);
+          dst += spans[i].len;
+        }
+      }
+    };
+
+    typedef std::function<void(const Message&)> callback_t;
+
+    struct Limits {
+      size_t maxMessageSize = size_t(64) << 20;
+      size_t maxBuffered = size_t(256) << 20;
+      std::chrono::milliseconds timeout{1000};  // 0 to never expire
+    };
+
+    struct Stats {
+      uint64_t messages;      // Messages handed over
+      uint64_t zeroCopy;      // ... of which w/o copying
+      uint64_t expired;       // Partial messages timed out
+      uint64_t evicted;       // Partial messages evicted for memory
+      uint64_t dropped;       // Invalid, duplicate or oversized fragments
+      size_t bufferedBytes;   // Allocated for partial messages
+    };
+
+  private:
+    // A message being copied together
+    struct Partial_ {
+      std::unique_ptr<uint8_t[]> buf;
+      uint32_t size;
+      uint32_t count;
+      uint32_t nReceived;
+      std::vector<bool> received;
+      time_point_t lastSeen;
+    };
+
+    // A fragment of the group being pushed
+    struct Fragment_ {
+      MplexFragmentHeader header;
+      const uint8_t* data;
+      uint32_t len;
+    };
+
+    const id_t fragId_;
+    const Limits limits_;
+    callback_t callback_;
+
+    std::unordered_map<uint32_t, Partial_> partials_;
+    std::vector<Fragment_> fragments_;
+    std::vector<Span> spans_;
+    time_point_t lastSweep_;
+    Stats stats_ = {0, 0, 0, 0, 0, 0};
+
+    static uint32_t fragData_(const MplexFragmentHeader& header) {
+      return static_cast<uint32_t>((uint64_t(header.size) + header.count - 1) /
+                                   header.count);
+    }
+
+    /**
+     * @brief Checks a fragment's header against its length.
+     */
+    bool isValid_(const MplexFragmentHeader& header, uint32_t len) const {
+      if (header.count == 0 || header.index >= header.count ||
+          header.size > limits_.maxMessageSize) {
+        return false;
+      }
+
+      // Every fragment but the last must carry some of the message
+      uint64_t fragData = fragData_(header);
+      uint64_t lastOffset = fragData * (header.count - 1);
+      if (header.count > 1 && lastOffset >= header.size) {
+        return false;
+      }
+
+      uint64_t expected = header.index + 1 < header.count ?
+                          fragData : header.size - lastOffset;
+      return len == expected;
+    }
+
+    void deliver_(uint32_t seq, size_t size) {
+      Message msg = {seq, size, spans_.data(), spans_.size()};
+      stats_.messages++;
+      callback_(msg);
+    }
+
+    /**
+     * @brief Frees partial messages, oldest first, until 'sz' more Bytes
+     *        fit under the limit.
+     *
+     * @return Returns false if they can't.
+     */
+    bool makeRoom_(size_t sz) {
+      if (sz > limits_.maxBuffered) {
+        return false;
+      }
+
+      while (stats_.bufferedBytes + sz > limits_.maxBuffered) {
+        auto oldest = partials_.begin();
+        for (auto it = partials_.begin(); it != partials_.end(); ++it) {
+          if (it->second.lastSeen < oldest->second.lastSeen) {
+            oldest = it;
+          }
+        }
+        if (oldest == partials_.end()) {
+          break;
+        }
+
+        stats_.bufferedBytes -= oldest->second.size;
+        stats_.evicted++;
+        partials_.erase(oldest);
+      }
+
+      return true;
+    }
+
+    /**
+     * @brief Copies fragments [first, last) of a message into its partial
+     *        message, handing it over once complete.
+     */
+    void copyIn_(const Fragment_* first, const Fragment_* last,
+                 time_point_t now) {
+      const MplexFragmentHeader& header = first->header;
+      auto it = partials_.find(header.seq);
+      if (it == partials_.end()) {
+        if (makeRoom_(header.size) == false) {
+          stats_.dropped += static_cast<uint64_t>(last - first);
+          return;
+        }
+
+        Partial_ partial = {std::unique_ptr<uint8_t[]>(
+                                new uint8_t[std::max<uint32_t>(header.size,
+                                                               1)]),
+                            header.size, header.count, 0,
+                            std::vector<bool>(header.count, false), now};
+        it = partials_.emplace(header.seq, std::move(partial)).first;
+        stats_.bufferedBytes += header.size;
+      }
+
+      Partial_& partial = it->second;
+      partial.lastSeen = now;
+      uint32_t fragData = fragData_(header);
+      for (const Fragment_* frag = first; frag != last; frag++) {
+        if (frag->header.size != partial.size ||
+            frag->header.count != partial.count ||
+            partial.received[frag->header.index]) {
+          stats_.dropped++;
+          continue;
+        }
+
+        memcpy(partial.buf.get() + size_t(fragData) * frag->header.index,
+               frag->data, frag->len);
+        partial.received[frag->header.index] = true;
+        partial.nReceived++;
+      }
+
+      if (partial.nReceived == partial.count) {
+        spans_.assign(1, {partial.buf.get(), partial.size});
+        deliver_(header.seq, partial.size);
+        stats_.bufferedBytes -= partial.size;
+        partials_.erase(it);
+      }
+    }
+
+    void expire_(time_point_t now) {
+      lastSweep_ = now;
+      for (auto it = partials_.begin(); it != partials_.end();) {
+        if (now - it->second.lastSeen >= limits_.timeout) {
+          stats_.bufferedBytes -= it->second.size;
+          stats_.expired++;
+          it = partials_.erase(it);
+        } else {
+          ++it;
+        }
+      }
+    }
+
+  public:
+    /**
+     * @brief Constructor; fragments are read from frames w/ ID 'fragId'.
+     *        Throws std::invalid_argument if 'callback' is empty.
+     */
+    MplexMsgReassembler(id_t fragId, callback_t callback,
+                        const Limits& limits) :
+        fragId_(fragId), limits_(limits), callback_(std::move(callback)),
+        lastSweep_(std::chrono::steady_clock::now()) {
+      if (static_cast<bool>(callback_) == false) {
+        throw std::invalid_argument("MsgReassembler requires a callback");
+      }
+    }
+
+    /**
+     * @brief Same as above, w/ the default Limits.
+     */
+    MplexMsgReassembler(id_t fragId, callback_t callback) :
+        MplexMsgReassembler(fragId, std::move(callback), Limits()) {}
+
+    MplexMsgReassembler(const MplexMsgReassembler&) = delete;
+    MplexMsgReassembler& operator=(const MplexMsgReassembler&) = delete;
+
+    /**
+     * @brief Reads the fragments in the valid frames of a READ-mode group,
+     *        handing over the messages they complete. Frames of other IDs
+     *        are skipped. The group is only used during the call.
+     *
+     * @return Returns the number of messages handed over.
+     */
+    size_t push(group_t& group) {
+      time_point_t now = std::chrono::steady_clock::now();
+      uint64_t nMessages = stats_.messages;
+
+      fragments_.clear();
+      group.forEachValidFrame([&](msg_t& frame) {
+        if (frame.id() != fragId_) {
+          return;
+        }
+
+        uint32_t len = frame.len();
+        const uint8_t* data = frame.getData();
+        Fragment_ frag;
+        if (len < HEADER_SIZE || data == nullptr) {
+          stats_.dropped++;
+          return;
+        }
+        MplexFragmentSchema::decodeFrom(data, frag.header);
+        frag.data = data + HEADER_SIZE;
+        frag.len = len - HEADER_SIZE;
+        if (isValid_(frag.header, frag.len) == false) {
+          stats_.dropped++;
+          return;
+        }
+        fragments_.push_back(frag);
+      });
+
+      // Group the fragments by message, in order
+      std::stable_sort(fragments_.begin(), fragments_.end(),
+          [](const Fragment_& a, const Fragment_& b) {
+            return a.header.seq < b.header.seq ||
+                   (a.header.seq == b.header.seq &&
+                    a.header.index < b.header.index);
+          });
+
+      for (size_t first = 0; first < fragments_.size();) {
+        const MplexFragmentHeader& header = fragments_[first].header;
+        size_t last = first + 1;
+        while (last < fragments_.size() &&
+               fragments_[last].header.seq == header.seq) {
+          last++;
+        }
+
+        // All of a new message's fragments are here: hand them over as is
+        bool whole = last - first == header.count &&
+                     partials_.count(header.seq) == 0;
+        for (size_t i = first; whole && i < last; i++) {
+          const MplexFragmentHeader& fragHeader = fragments_[i].header;
+          whole = fragHeader.index == i - first &&
+                  fragHeader.size == header.size &&
+                  fragHeader.count == header.count;
+        }
+
+        if (whole) {
+          spans_.clear();
+          for (size_t i = first; i < last; i++) {
+            spans_.push_back({fragments_[i].data, fragments_[i].len});
+          }
+          stats_.zeroCopy++;
+          deliver_(header.seq, header.size);
+        } else {
+          copyIn_(&fragments_[first], fragments_.data() + last, now);
+        }
+        first = last;
+      }
+
+      if (limits_.timeout.count() > 0 &&
+          now - lastSweep_ >= limits_.timeout / 2) {
+        expire_(now);
+      }
+
+      return static_cast<size_t>(stats_.messages - nMessages);
+    }
+
+    /**
+     * @brief Drops the partial messages that have gone 'timeout' w/o a new
+     *        fragment; push() does so periodically.
+     */
+    void expire() {
+      if (limits_.timeout.count() > 0) {
+        expire_(std::chrono::steady_clock::now());
+      }
+    }
+
+    // Number of partial messages held
+    size_t numPartial() const {
+      return partials_.size();
+    }
+
+    const Stats& stats() const {
+      return stats_;
+    }
+};
+
+#endif
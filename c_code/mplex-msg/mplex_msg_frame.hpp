@@ -8,6 +8,8 @@
 #include <string.h>
 
 // C++ headers
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <exception>
 #include <type_traits>
@@ -19,6 +21,8 @@
 #include <tins/memory_helpers.h>
 
 #include "../crc/crc.hpp"
+#include "byte_stuff.hpp"
+#include "byte_swap.hpp"
 #include "headers/frame_headers.hpp"
 
 #if (__FLOAT_WORD_ORDER == __LITTLE_ENDIAN)
@@ -68,9 +72,20 @@ class MplexMsgFrame : MplexMsgFrameBase {
     typedef Tins::small_uint<MsgFrameHeader::ID_WIDTH> id_t;
     typedef Tins::small_uint<MsgFrameHeader::LEN_WIDTH> len_t;
     typedef Tins::small_uint<MsgFrameHeader::CRC_WIDTH> crc_t;
+    typedef CRCUtils::CRCState<MsgFrameHeader::CRC_WIDTH,
+                               MsgFrameHeader::CRC_POLY,
+                               CRCUtils::CRCMethod::AUTO,
+                               MsgFrameHeader::CRC_REFLECTED> crc_state_t;
 
     static const uint8_t MAGIC_NUMBER = MsgFrameHeader::MAGIC_NUMBER;
 
+    // Per-thread counters of the CRC work done by frames of this type
+    struct Stats {
+      uint64_t crcs;          // CRCs calculated (isValid() & writeHeader())
+      uint64_t crcBytes;      // Bytes covered by those CRCs
+      uint64_t cachedChecks;  // isValid() calls answered w/o a CRC
+    };
+
   private:
     // Pointer to entire frame buffer & its size
     const uint8_t* rawBuf_ = nullptr;
@@ -89,6 +104,36 @@ class MplexMsgFrame : MplexMsgFrameBase {
     // Operational mode
     MplexOpMode::opmode mode_ = MplexOpMode::READ | MplexOpMode::WRITE;
 
+    // Result of the last isValid() check, so the CRC is only recalculated
+    // after the frame is changed (reset(), writeData(), writeHeader(),
+    // byteStuff() or byteDestuff()). Atomic so that concurrent isValid()
+    // calls on a shared frame don't race; relaxed, as each caller would
+    // cache the same result. Unlike a bare std::atomic, it's copied w/ the
+    // frame.
+    enum class Validity : uint8_t { UNKNOWN, VALID, INVALID };
+    class ValidityCache {
+      private:
+        std::atomic<Validity> val_{Validity::UNKNOWN};
+
+      public:
+        ValidityCache() {}
+        ValidityCache(const ValidityCache& other) : val_(other.load()) {}
+
+        ValidityCache& operator=(const ValidityCache& other) {
+          store(other.load());
+          return *this;
+        }
+
+        Validity load() const {
+          return val_.load(std::memory_order_relaxed);
+        }
+
+        void store(Validity val) {
+          val_.store(val, std::memory_order_relaxed);
+        }
+    };
+    mutable ValidityCache validity_;
+
     // Memory helpers
     // Initialize here so default constructor can be used
     Tins::Memory::OutputMemoryStream outStream_ =
@@ -102,14 +147,101 @@ class MplexMsgFrame : MplexMsgFrameBase {
      * all-0 data from having the same CRC.
      */
     crc_t calcCRC_(const uint8_t* buf, uint64_t sz) const {
+      stats_().crcs++;
+      stats_().crcBytes += sz;
       crc_t init = CRC_INIT & crc_t::max_value;
-      return CRCUtils::CRC<MsgFrameHeader::CRC_WIDTH>(buf, sz, init);
+      return CRCUtils::CRC<MsgFrameHeader::CRC_WIDTH,
+                           MsgFrameHeader::CRC_POLY,
+                           CRCUtils::CRCMethod::AUTO,
+                           MsgFrameHeader::CRC_REFLECTED>(buf, sz, init);
+    }
+
+    static Stats& stats_() {
+      thread_local Stats stats = {0, 0, 0};
+      return stats;
+    }
+
+    /*
+     * Copies 'n' values of type T from 'src' to 'dst', reversing the bytes of
+     * each value where writeData() & readData() would (i.e. converting
+     * between host & network order).
+     */
+    template <typename T>
+    static void copySpan_(void* dst, const void* src, size_t n) {
+#if (__BYTE_ORDER == __LITTLE_ENDIAN)
+      if constexpr (std::is_integral_v<T> && sizeof(T) != sizeof(uint8_t)) {
+        if constexpr (sizeof(T) == sizeof(uint16_t) ||
+                      sizeof(T) == sizeof(uint32_t) ||
+                      sizeof(T) == sizeof(uint64_t)) {
+          ByteSwapUtils::copySwapped<sizeof(T)>(dst, src, n);
+          return;
+        } else {
+          // TODO: Replace w/ log
+          std::cerr << "ERROR: Integral type of uncommon length\n";
+        }
+      }
+#if (__FLOAT_WORD_ORDER == __LITTLE_ENDIAN)
+      else if constexpr (std::is_floating_point_v<T>) {
+        if constexpr (sizeof(T) == sizeof(float) ||
+                      sizeof(T) == sizeof(double)) {
+          ByteSwapUtils::copySwapped<sizeof(T)>(dst, src, n);
+          return;
+        } else {
+          // TODO: Replace w/ log
+          std::cerr << "ERROR: Floating type of uncommon length\n";
+        }
+      }
+#endif
+#elif (__BYTE_ORDER != __BIG_ENDIAN)
+#error  "Please fix <endian.h>"
+#endif
+      memcpy(dst, src, n * sizeof(T));
+    }
+
+    // Checks the magic # and CRC; see isValid()
+    bool checkValid_() const {
+      uint64_t frameSize = sizeof(MsgFrameHeader) + header_.len();
+      if (frameSize > rawBufSize_ || frameSize > MAX_SIZE) {
+        return false;
+      } else if (rawBuf_ == nullptr) {
+        return false;
+      }
+
+      // The CRC is calculated w/ the header's CRC field set to 0. Stream a
+      // zeroed copy of the header, then the data, rather than modifying the
+      // underlying buffer.
+      MsgFrameHeader zeroedHead;
+      memcpy((void*)&zeroedHead, (void*)rawBuf_, sizeof(MsgFrameHeader));
+      zeroedHead.crc(0);
+
+      crc_t calcCRC = 0;
+      try {
+        stats_().crcs++;
+        stats_().crcBytes += frameSize;
+        crc_state_t state(CRC_INIT & crc_t::max_value);
+        state.update(reinterpret_cast<const uint8_t*>(&zeroedHead),
+                     sizeof(MsgFrameHeader));
+        state.update(rawBuf_ + sizeof(MsgFrameHeader),
+                     frameSize - sizeof(MsgFrameHeader));
+        calcCRC = state.finalize();
+      } catch (std::exception& exc) {
+        // TODO: Replace w/ log
+        std::cerr << exc.what() << std::endl;
+        return false;
+      }
+
+      return (MsgFrameHeader::MAGIC_NUMBER == header_.magic() &&
+              calcCRC == header_.crc());
     }
 
   public:
     // Useful header-dependent constants
     static const vers_t VERS = MsgFrameHeader::VERS;
-    static const uint16_t MAX_DATA = len_t::max_value;
+    // Frames are sized w/ 16-bit integers, like the groups holding them, so
+    // wider length fields (e.g. v1's) are capped to what fits
+    static const uint16_t MAX_DATA = static_cast<uint16_t>(
+        std::min<uint32_t>(len_t::max_value,
+                           UINT16_MAX - sizeof(MsgFrameHeader)));
     static const uint16_t MIN_SIZE = sizeof(MsgFrameHeader);
     static const uint16_t MAX_SIZE = sizeof(MsgFrameHeader) + MAX_DATA;
 
@@ -188,6 +320,7 @@ class MplexMsgFrame : MplexMsgFrameBase {
                                              buf + sizeof(MsgFrameHeader);
       rwPos_ = 0;
       mode_ = mode;
+      validity_.store(Validity::UNKNOWN);
 
       // Assume buf holds a serialized Message Frame & load the header.
       // Afterwards, inStream_'s position will be the start of data_.
@@ -256,6 +389,7 @@ class MplexMsgFrame : MplexMsgFrameBase {
 
       // The CRC field in the header is calculated over both header + data,
       // with the CRC field initially set to 0. Then re-update the CRC field.
+      validity_.store(Validity::UNKNOWN);
       header_.setMagic();
       header_.id(id);
       header_.len(dataLen & len_t::max_value);
@@ -272,6 +406,10 @@ class MplexMsgFrame : MplexMsgFrameBase {
       }
       memcpy((void*)rawBuf_, (void*)&header_, sizeof(MsgFrameHeader));
 
+      // writeData() keeps the data within the buffer, so the frame is now
+      // valid by construction
+      validity_.store(Validity::VALID);
+
       return true;
     }
 
@@ -310,54 +448,33 @@ class MplexMsgFrame : MplexMsgFrameBase {
 
       // Count the number of necessary extra bytes to stuff. i.e. Count the
       // number of occurrences of the first ('seqSz' - 1) bytes of 'avoidSeq'.
-      uint8_t* startSearch = data_;
-      void* seqStart = nullptr;
-      uint16_t remainLen = rwPos_;
-      std::vector<uint8_t*> startLocs; // Pointers to start of each sequence found.
-
-      while (remainLen >= seqSz - 1) {
-        // Find sequence of the first ('seqSz' - 1) bytes of 'avoidSeq'
-        seqStart = memmem(startSearch, remainLen, avoidSeq, seqSz - 1);
-        if (seqStart == nullptr) {
-          break;
-        }
-
-        // Update startSearch to start at 'seqSz' beyond the start of the found
-        // sequence (i.e. right after where we intend to stuff the extra byte).
-        startSearch = static_cast<uint8_t*>(seqStart) + (seqSz - 1);
-        remainLen = static_cast<uint16_t>(data_ + rwPos_ - startSearch);
-
-        startLocs.push_back(static_cast<uint8_t*>(seqStart));
+      const int64_t stuffedLen =
+          ByteStuffUtils::stuff(data_, rwPos_, nullptr, 0, avoidSeq, seqSz);
+      if (stuffedLen < 0) {
+        return -1;
       }
+      const uint16_t numStuffed = static_cast<uint16_t>(stuffedLen - rwPos_);
 
-      if (startLocs.size() == 0) {
+      if (numStuffed == 0) {
         return 0; // No need to stuff, "done" stuffing
       }
 
       // See if stuffing these bytes will exceed the underlying buffer size
       const uint8_t* const endOfBuf = rawBuf_ + rawBufSize_;
-      if (data_ + rwPos_ + startLocs.size() >= endOfBuf) {
+      if (data_ + rwPos_ + numStuffed >= endOfBuf) {
         return -1;
       }
 
-      // Stuff extra bytes. We want to stuff bytes at an offset of (seqSz - 1)
-      // from the beginning of each found sequence. For each start location of
-      // a sequence, we need to shift the data after the target byte (where we
-      // want to stuff) by 1. We must also consider that as we shift, we are
-      // changing the start location of subsequent sequences.
-      const uint8_t escByte = ~avoidSeq[seqSz - 1];
-      for (uint16_t i = 0; i < startLocs.size(); i++) {
-        // Shift data to create room to stuff a byte
-        uint8_t* insertAt = startLocs[i] + i + (seqSz - 1);
-        remainLen = static_cast<uint16_t>(data_ + rwPos_ - insertAt);
-        memmove(insertAt + 1, insertAt, remainLen);
+      // Shift the data right by the number of bytes to stuff, then stuff it
+      // back into place in a single pass. The stuffed output never overtakes
+      // the shifted data still to be read.
+      memmove(data_ + numStuffed, data_, rwPos_);
+      ByteStuffUtils::stuff(data_ + numStuffed, rwPos_, data_,
+                            rwPos_ + numStuffed, avoidSeq, seqSz);
+      rwPos_ = static_cast<uint16_t>(rwPos_ + numStuffed);
+      validity_.store(Validity::UNKNOWN);
 
-        // Stuff & increment rwPos_
-        *insertAt = escByte;
-        rwPos_++;
-      }
-
-      return static_cast<int16_t>(startLocs.size());
+      return static_cast<int16_t>(numStuffed);
     }
 
     /**
@@ -387,53 +504,23 @@ class MplexMsgFrame : MplexMsgFrameBase {
         return -1;
       }
 
-      uint16_t dataLen = this->len();
-
-      // Count the number of necessary extra bytes to remove. i.e. Count the
-      // number of occurrences of the first ('seqSz' - 1) bytes of 'avoidSeq'.
-      uint8_t* startSearch = data_;
-      void* seqStart = nullptr;
-      uint16_t remainLen = dataLen;
-      std::vector<uint8_t*> startLocs; // Pointers to start of each sequence
-      const uint8_t escByte = ~avoidSeq[seqSz - 1];
-
-      while (remainLen >= seqSz) {
-        seqStart = memmem(startSearch, remainLen, avoidSeq, seqSz - 1);
-        if (seqStart == nullptr) {
-          break;
-        }
-
-        // While we're at it, ensure that the "escape" byte follows the
-        // sub-sequence found. If it is not there, then something went wrong
-        // with the stuffing, or the frame is corrupted.
-        if (static_cast<uint8_t*>(seqStart)[seqSz - 1] != escByte) {
-          // Uh oh, something went wrong...
-          return -1;
-        }
-
-        startSearch = static_cast<uint8_t*>(seqStart) + seqSz;
-        remainLen = static_cast<uint16_t>(data_ + dataLen - startSearch);
-
-        startLocs.push_back(static_cast<uint8_t*>(seqStart));
-      }
+      const uint16_t dataLen = this->len();
 
-      if (startLocs.size() == 0) {
+      // Validate the stuffing first so a corrupted frame is left untouched,
+      // then remove the "escape" bytes in place
+      const int64_t destuffedLen = ByteStuffUtils::destuff(
+          data_, dataLen, nullptr, 0, avoidSeq, seqSz);
+      if (destuffedLen < 0) {
+        return -1;
+      } else if (destuffedLen == dataLen) {
         return 0; // No potential stuffing found, "done" de-stuffing
       }
 
-      // Remove the "escape" bytes by shifting the data afterwards to fill
-      // its place. Must also consider that as we shift, we are changing
-      // the start locations of subsequent sequences.
-      for (uint16_t i = 0; i < startLocs.size(); i++) {
-        uint8_t* removeFrom = startLocs[i] - i + (seqSz - 1);
+      ByteStuffUtils::destuff(data_, dataLen, data_, dataLen,
+                              avoidSeq, seqSz);
+      validity_.store(Validity::UNKNOWN);
 
-        // Shift data to fill space & decrement dataLen
-        remainLen = static_cast<uint16_t>(data_ + dataLen - removeFrom);
-        memmove(removeFrom, removeFrom + 1, remainLen);
-        dataLen--;
-      }
-
-      return static_cast<int16_t>(startLocs.size());
+      return static_cast<int16_t>(dataLen - destuffedLen);
     }
 
     /**
@@ -467,34 +554,31 @@ class MplexMsgFrame : MplexMsgFrameBase {
      * Assumes the header information is valid and checks the magic # and CRC.
      * May call writeHeader() beforehand to update the header information.
      *
+     * The result is cached until this object changes the frame; changes made
+     * to the buffer by other means (e.g. through getData()) require a reset().
+     * Concurrent isValid() calls on a shared frame are safe, but not while
+     * another thread changes the frame.
+     *
      * Returns true if frame's magic number is as expected and the CRC check
      * is correct, otherwise returns false.
      */
     bool isValid() const {
-      uint64_t frameSize = sizeof(MsgFrameHeader) + header_.len();
-      if (frameSize > rawBufSize_ || frameSize > MAX_SIZE) {
-        return false;
-      } else if (rawBuf_ == nullptr) {
-        return false;
+      Validity validity = validity_.load();
+      if (validity != Validity::UNKNOWN) {
+        stats_().cachedChecks++;
+        return validity == Validity::VALID;
       }
 
-      // Set header CRC to 0 before calculating CRC, then restore
-      MsgFrameHeader* pHead = (MsgFrameHeader*)rawBuf_;
-      crc_t origCRC = pHead->crc();
-      pHead->crc(0);
-      crc_t calcCRC = 0;
-      try {
-        calcCRC = calcCRC_(rawBuf_, frameSize);
-      } catch (std::exception& exc) {
-        // TODO: Replace w/ log
-        std::cerr << exc.what() << std::endl;
-        pHead->crc(origCRC);
-        return false;
-      }
-      pHead->crc(origCRC);
+      validity = this->checkValid_() ? Validity::VALID : Validity::INVALID;
+      validity_.store(validity);
+      return validity == Validity::VALID;
+    }
 
-      return (MsgFrameHeader::MAGIC_NUMBER == header_.magic() &&
-              calcCRC == header_.crc());
+    /**
+     * @brief Returns the calling thread's counters for frames of this type.
+     */
+    static Stats stats() {
+      return stats_();
     }
 
     /**
@@ -599,6 +683,7 @@ class MplexMsgFrame : MplexMsgFrameBase {
       // Increment inStream_'s read position & update rwPos_
       inStream_.skip(sizeof(T));
       rwPos_ = static_cast<uint16_t>(rwPos_ + sizeof(T));
+      validity_.store(Validity::UNKNOWN);
 
       return true;
     }
@@ -682,6 +767,135 @@ class MplexMsgFrame : MplexMsgFrameBase {
       return true;
     }
 
+    /**
+     * @brief Writes 'n' values to the data portion of the frame. Produces the
+     *        same data as calling writeData() on each value, but w/ a single
+     *        bounds check & a vectorized byte-swap.
+     *        Will simultaneously increment the read/write position.
+     *
+     * @tparam T Type of values to be written.
+     * @param vals Array of values to be written.
+     * @param n Number of values in 'vals'.
+     *
+     * @return Returns true if successful, false otherwise.
+     *         Returning false may be due to a number of reasons:
+     *          - data_ or 'vals' is NULL
+     *          - Writing will exceed the bounds of the underlying buffer
+     */
+    template <typename T>
+    bool writeSpan(const T* vals, size_t n) {
+      static_assert(std::is_trivially_copyable_v<T>,
+          "Cannot write data that is not trivially copyable");
+
+      if ((mode_ & MplexOpMode::WRITE) == 0) {
+        return false;
+      } else if (n == 0) {
+        return true;
+      } else if (vals == nullptr || n > rawBufSize_) {
+        return false;
+      }
+
+      uint8_t* dst = this->claimWrite(n * sizeof(T));
+      if (dst == nullptr) {
+        return false;
+      }
+      copySpan_<T>(dst, vals, n);
+
+      return true;
+    }
+
+    /**
+     * @brief Reads 'n' values from the data portion of the frame. Same as
+     *        calling readData() for each value, but w/ a single bounds check
+     *        & a vectorized byte-swap.
+     *        Will simultaneously increment the read/write position.
+     *
+     * @tparam T Type of values to be read.
+     * @param vals Array to read 'n' values into.
+     * @param n Number of values to read.
+     *
+     * @return Returns true if successful, false otherwise.
+     *         Returning false may be due to a number of reasons:
+     *          - data_ or 'vals' is NULL
+     *          - Reading will exceed the bounds of the underlying buffer
+     */
+    template <typename T>
+    bool readSpan(T* vals, size_t n) {
+      static_assert(std::is_trivially_copyable_v<T>,
+          "Cannot read data that is not trivially copyable");
+
+      if ((mode_ & MplexOpMode::READ) == 0) {
+        return false;
+      } else if (n == 0) {
+        return true;
+      } else if (vals == nullptr || n > rawBufSize_) {
+        return false;
+      }
+
+      const uint8_t* src = this->claimRead(n * sizeof(T));
+      if (src == nullptr) {
+        return false;
+      }
+      copySpan_<T>(vals, src, n);
+
+      return true;
+    }
+
+    /**
+     * @brief Claims the next 'sz' (> 0) bytes of the data portion for the
+     *        caller to write to directly, e.g. w/ MplexSchema encoders.
+     *        Will simultaneously increment the read/write position past them.
+     *
+     * @param sz Number of bytes to claim.
+     *
+     * @return Returns a pointer to the claimed bytes. Returns NULL if the
+     *         object is not in WRITE mode, or if 'sz' bytes would exceed the
+     *         bounds of the underlying buffer.
+     */
+    uint8_t* claimWrite(size_t sz) {
+      if ((mode_ & MplexOpMode::WRITE) == 0 || data_ == nullptr || sz == 0 ||
+          this->processedSize() + sz > rawBufSize_) {
+        return nullptr;
+      }
+
+      uint8_t* claimed = data_ + rwPos_;
+
+      // Increment both streams' positions & update rwPos_
+      outStream_.skip(sz);
+      inStream_.skip(sz);
+      rwPos_ = static_cast<uint16_t>(rwPos_ + sz);
+      validity_.store(Validity::UNKNOWN);
+
+      return claimed;
+    }
+
+    /**
+     * @brief Claims the next 'sz' (> 0) bytes of the data portion for the
+     *        caller to read directly, e.g. w/ MplexSchema decoders.
+     *        Will simultaneously increment the read/write position past them.
+     *
+     * @param sz Number of bytes to claim.
+     *
+     * @return Returns a pointer to the claimed bytes. Returns NULL if the
+     *         object is not in READ mode, or if 'sz' bytes would exceed the
+     *         bounds of the underlying buffer.
+     */
+    const uint8_t* claimRead(size_t sz) {
+      if ((mode_ & MplexOpMode::READ) == 0 || data_ == nullptr || sz == 0 ||
+          this->processedSize() + sz > rawBufSize_) {
+        return nullptr;
+      }
+
+      const uint8_t* claimed = data_ + rwPos_;
+
+      // Increment both streams' positions & update rwPos_
+      inStream_.skip(sz);
+      outStream_.skip(sz);
+      rwPos_ = static_cast<uint16_t>(rwPos_ + sz);
+
+      return claimed;
+    }
+
     // Returns:
     //  - Pointer to the start of the data section of the MsgFrame; or
     //  - NULL if this frame is an End of Message Group frame.
@@ -0,0 +1,195 @@
+#ifndef MPLEX_MSG_GATHER_H
+#define MPLEX_MSG_GATHER_H
+
+// C headers
+#include <stdint.h>
+#include <string.h>
+#include <sys/uio.h>
+
+// C++ headers
+#include <iostream>
+#include <vector>
+
+#include "mplex_msg_group.hpp"
+
+/*
+ * MplexMsgGroupGather class
+ * Scatter-gather counterpart to MplexMsgGroup's WRITE mode. Rather than
+ * copying frames into a contiguous group buffer, already-serialized frames
+ * are referenced where they live and the group is emitted as an iovec array
+ * (header, frames, End of Message Group trailer) for writev() / sendmsg().
+ *
+ * Only the group header & trailer are stored in this object, and iovecs()
+ * points into it, so it can be neither copied nor moved. Referenced frames
+ * must stay alive & unmodified until the group has been sent.
+ */
+template <typename MsgGroupHeader, typename MsgFrameHeader>
+class MplexMsgGroupGather {
+  public:
+    typedef MplexMsgGroup<MsgGroupHeader, MsgFrameHeader> group_t;
+    typedef typename group_t::nFrames_t nFrames_t;
+    typedef typename group_t::msg_t msg_t;
+
+  private:
+    MsgGroupHeader header_;
+    MsgFrameHeader endOfGroup_;
+
+    // iov_[0] is the header, followed by the frames & (once written) the
+    // trailer. Frames adjacent in memory share an iovec.
+    std::vector<struct iovec> iov_;
+    bool hasTrailer_ = false;
+
+    nFrames_t nFrames_ = 0;
+
+    // Size of the header & frames added so far
+    uint32_t size_ = sizeof(MsgGroupHeader);
+
+  public:
+    MplexMsgGroupGather() {
+      iov_.reserve(16);
+      iov_.push_back({&header_, sizeof(MsgGroupHeader)});
+    }
+
+    MplexMsgGroupGather(const MplexMsgGroupGather&) = delete;
+    MplexMsgGroupGather& operator=(const MplexMsgGroupGather&) = delete;
+
+    /**
+     * @brief Drops all frames & wipes the header so the object can be used
+     *        for a new group. Keeps the iovec storage allocated.
+     */
+    void reset() {
+      iov_.resize(1);
+      hasTrailer_ = false;
+      nFrames_ = 0;
+      size_ = sizeof(MsgGroupHeader);
+      // Copy in a fresh header rather than zeroing it, as that'd also wipe
+      // the (const) version field, which fillHeader_() doesn't write
+      const MsgGroupHeader freshHeader;
+      memcpy((void*)&header_, (const void*)&freshHeader,
+             sizeof(MsgGroupHeader));
+    }
+
+    /**
+     * @brief Appends a serialized Message Frame, by reference, to the group.
+     *        If the trailer has already been written, it is removed and
+     *        writeHeaderTrailer() must be called again.
+     *
+     * @param frame Pointer to the serialized frame.
+     * @param sz Size of the frame (i.e. its msgSize()).
+     *
+     * @return Returns true if the frame was added. Returns false if the frame
+     *         isn't a valid frame of exactly 'sz' bytes, or if the group is
+     *         out of frames or space.
+     */
+    bool addFrame(const uint8_t* frame, uint16_t sz) {
+      // Frames are only read here, never written
+      msg_t tmpMsg;
+      if (frame == nullptr || sz < sizeof(MsgFrameHeader) ||
+          tmpMsg.reset(const_cast<uint8_t*>(frame), sz,
+                       MplexOpMode::READ) == false) {
+        return false;
+      }
+
+      if (sizeof(MsgFrameHeader) + tmpMsg.len() != sz) {
+        // TODO: Use log
+        std::cerr << "Frame length doesn't match its size" << std::endl;
+        return false;
+      }
+
+      return this->addFrame(tmpMsg);
+    }
+
+    /**
+     * @brief Appends a Message Frame, by reference, to the group. Same as
+     *        above, using the frame's underlying buffer & size.
+     */
+    bool addFrame(msg_t& frame) {
+      if (frame.isEndOfMsgGroup() || frame.isValid() == false) {
+        // TODO: Use log
+        std::cerr << "Frame not valid, cannot add to MsgGroup" << std::endl;
+        return false;
+      }
+
+      uint16_t sz = static_cast<uint16_t>(sizeof(MsgFrameHeader) +
+                                          frame.len());
+      if (nFrames_ == nFrames_t::max_value ||
+          size_ + sz + sizeof(MsgFrameHeader) > group_t::MAX_SIZE) {
+        // TODO: Use log
+        std::cerr << "ERROR: No room left in MsgGroup for frame\n";
+        return false;
+      }
+
+      if (hasTrailer_) {
+        iov_.pop_back();
+        hasTrailer_ = false;
+      }
+
+      const uint8_t* buf = frame.getBuf();
+      struct iovec& last = iov_.back();
+      if (iov_.size() > 1 &&
+          static_cast<uint8_t*>(last.iov_base) + last.iov_len == buf) {
+        last.iov_len += sz;
+      } else {
+        iov_.push_back({const_cast<uint8_t*>(buf), sz});
+      }
+
+      nFrames_ = static_cast<typename nFrames_t::repr_type>(nFrames_ + 1);
+      size_ += sz;
+
+      return true;
+    }
+
+    /**
+     * @brief Updates the header & appends the End of Message Group trailer,
+     *        completing the iovec array.
+     *
+     * @return Returns true if the group is ready to be sent, false if an
+     *         error occurred.
+     */
+    bool writeHeaderTrailer() {
+      if (group_t::fillHeader_(header_, nFrames_) == false) {
+        return false;
+      }
+
+      if (hasTrailer_ == false) {
+        iov_.push_back({&endOfGroup_, sizeof(MsgFrameHeader)});
+        hasTrailer_ = true;
+      }
+
+      return true;
+    }
+
+    /**
+     * @brief Returns the iovec array describing the group, to be passed to
+     *        writev() or as a msghdr's msg_iov. Only complete once
+     *        writeHeaderTrailer() has returned true. The array is invalidated
+     *        by addFrame() & reset().
+     *
+     *        NOTE: writev() & sendmsg() reject more than IOV_MAX (1024 on
+     *        Linux) iovecs; add frames from a common buffer to keep the count
+     *        down.
+     */
+    const struct iovec* iovecs() const {
+      return iov_.data();
+    }
+
+    // Number of entries in iovecs()
+    size_t numIovecs() const {
+      return iov_.size();
+    }
+
+    // Number of frames in the group
+    nFrames_t numFrames() const {
+      return nFrames_;
+    }
+
+    /**
+     * @brief Returns the total size of the group, including the Message Group
+     *        Header and End of Message Group frame.
+     */
+    uint16_t groupSize() const {
+      return static_cast<uint16_t>(size_ + sizeof(MsgFrameHeader));
+    }
+};
+
+#endif
@@ -3,6 +3,7 @@
 
 // C headers
 #include <stdint.h>
+#include <string.h>
 #include <time.h>
 #include <endian.h>
 
@@ -18,12 +19,31 @@
 
 #include "../crc/crc.hpp"
 #include "mplex_msg_frame.hpp"
+#include "buffer_pool.hpp"
 #include "headers/group_headers.hpp"
+#include "headers/msg_headers.hpp"
+
+// Tag selecting MplexMsgGroup's non-owning (view) READ constructor
+struct MplexViewTag {
+  explicit MplexViewTag() = default;
+};
+inline constexpr MplexViewTag MPLEX_VIEW{};
 
-// MplexMsgGroup class
-// Encapsulates group of MplexMsgFrames
 template <typename MsgGroupHeader, typename MsgFrameHeader>
+class MplexMsgGroupGather;
+
+// MplexMsgGroup class
+// Encapsulates group of MplexMsgFrames. Owned buffers are drawn from, and
+// returned to, BufferProvider (see buffer_pool.hpp). The frame header
+// defaults to the one of the group header's version (see MsgHeaders).
+template <typename MsgGroupHeader,
+          typename MsgFrameHeader =
+              typename MsgHeaders<MsgGroupHeader::VERS>::frame_header_t,
+          typename BufferProvider = MplexBufferPool<>>
 class MplexMsgGroup {
+    static_assert(MsgFrameHeader::VERS == MsgGroupHeader::VERS,
+                  "MsgFrameHeader version != MsgGroupHeader version");
+
   public:
     // Header-dependent types
     typedef Tins::small_uint<MsgGroupHeader::NUM_FRAMES_WIDTH> nFrames_t;
@@ -39,9 +59,22 @@ class MplexMsgGroup {
     //               below w/ optimization level O0. Thus, pre-compute it here.
     constexpr static const uint16_t FRAME_MAX_SIZE = msg_t::MAX_SIZE;
 
-    std::unique_ptr<uint8_t> rawBuf_ = nullptr;
+    // Returns owned buffers to the provider
+    struct BufferDeleter_ {
+      uint16_t sz = 0;
+
+      void operator()(uint8_t* buf) const {
+        BufferProvider::release(buf, sz);
+      }
+    };
+
+    std::unique_ptr<uint8_t[], BufferDeleter_> rawBuf_ = nullptr;
     uint16_t rawBufSize_ = 0;
 
+    // Start of the buffer being processed. Either rawBuf_, or caller-owned
+    // memory if this object is a view (rawBuf_ is then empty).
+    uint8_t* buf_ = nullptr;
+
     MsgGroupHeader header_;
 
     // Internal MsgFrame instance and a raw pointer to its buffer location
@@ -59,25 +92,146 @@ class MplexMsgGroup {
      * to prevent 0 from being the default CRC and prevents arbitrary-length
      * all-0 data from having the same CRC.
      */
-    hcrc_t calcCRC_(const uint8_t* buf, uint64_t sz) const {
+    static hcrc_t calcCRC_(const uint8_t* buf, uint64_t sz) {
       hcrc_t init = CRC_INIT & hcrc_t::max_value;
       return CRCUtils::CRC<MsgGroupHeader::HCRC_WIDTH>(buf, sz, init);
     }
 
     /**
-     * @brief Common routine for constructors. Responsible for allocating
+     * @brief Common routine for constructors. Responsible for acquiring
      *        the underlying buffer and resetting the frame position.
      *
-     * @param bufSize Size of buffer to allocate.
+     * @param bufSize Size of buffer to acquire.
      */
     void resetBuffer_(const uint16_t bufSize) {
-      rawBuf_.reset(new uint8_t[bufSize]);
+      rawBuf_ = std::unique_ptr<uint8_t[], BufferDeleter_>(
+          BufferProvider::acquire(bufSize), BufferDeleter_{bufSize});
       if (rawBuf_.get() == nullptr) {
         throw std::bad_alloc();
       }
 
       rawBufSize_ = bufSize;
-      currFramePos_ = rawBuf_.get() + sizeof(MsgGroupHeader);
+      buf_ = rawBuf_.get();
+      currFramePos_ = buf_ + sizeof(MsgGroupHeader);
+    }
+
+    /**
+     * @brief Fills in a group header for 'nFrames' frames, stamped w/ the
+     *        current time & w/ its CRC calculated.
+     *
+     * @return Returns true on success, false if the CRC failed.
+     */
+    static bool fillHeader_(MsgGroupHeader& header, nFrames_t nFrames) {
+      struct timespec ts;
+      timespec_get(&ts, TIME_UTC);
+      header.setMagic();
+      header.timestamp((uint32_t)ts.tv_sec, (uint32_t)ts.tv_nsec);
+      header.headerLen(sizeof(MsgGroupHeader)); // Ignore options for now
+      header.numFrames(nFrames);
+
+      // The CRC field in the header is calculated over just the header.
+      // Set the CRC to 0 before calculating CRC.
+      header.hcrc(0);
+      try {
+        header.hcrc(calcCRC_(reinterpret_cast<const uint8_t*>(&header),
+                             sizeof(MsgGroupHeader)));
+      } catch (std::exception& exc) {
+        // TODO: Replace w/ log
+        std::cerr << exc.what() << std::endl;
+        return false;
+      }
+
+      return true;
+    }
+
+    template <typename, typename>
+    friend class MplexMsgGroupGather;
+
+    /**
+     * @brief Returns the first MAGIC_NUMBER byte in [p, end), or 'end' if
+     *        there is none. memchr() is vectorized by the C library, so
+     *        resyncing over noise or corrupted frames doesn't go byte-by-byte.
+     */
+    static uint8_t* findMagic_(uint8_t* p, const uint8_t* end) {
+      void* magic = memchr(p, MsgFrameHeader::MAGIC_NUMBER,
+                           static_cast<size_t>(end - p));
+      return magic == nullptr ? const_cast<uint8_t*>(end) :
+                                static_cast<uint8_t*>(magic);
+    }
+
+    // Length field width up to which a stray MAGIC_NUMBER is cheap to CRC,
+    // i.e. v0's (frames of at most 2 KiB)
+    static const uint8_t CHEAP_LEN_WIDTH_ = 11;
+
+    /**
+     * @brief Bytes of suspect candidates (see frameFits_()) a scan starting
+     *        at 'start' may CRC: a max-size v0 frame's worth, plus
+     *        PER_BYTE for each byte scanned past 'start'.
+     */
+    class CrcBudget {
+      private:
+        static const size_t INITIAL = (size_t(1) << CHEAP_LEN_WIDTH_) +
+                                      sizeof(MsgFrameHeader);
+        static const size_t PER_BYTE = 16;
+
+        const uint8_t* start_;
+        size_t spent_ = 0;
+
+      public:
+        explicit CrcBudget(const uint8_t* start) : start_(start) {}
+
+        // Charges 'sz' bytes at 'p' to the budget, unless it'd overdraw it
+        bool spend(const uint8_t* p, size_t sz) {
+          size_t earned = INITIAL +
+                          PER_BYTE * static_cast<size_t>(p - start_);
+          if (spent_ + sz > earned) {
+            return false;
+          }
+          spent_ += sz;
+          return true;
+        }
+    };
+
+    /**
+     * @brief Cheap pre-filter for a potential frame at 'p', w/ 'remainSz'
+     *        (>= the header size) bytes left before the buffer's 'end':
+     *        checks that the length field doesn't run past the buffer.
+     *        Candidates that fail skip MplexMsgFrame::reset() & the CRC.
+     *
+     *        W/ a wider length field (e.g. v1's), every stray MAGIC_NUMBER
+     *        can claim up to 64 KiB of CRC, making resyncing quadratic. So
+     *        non-empty frames that neither end the buffer, nor are followed
+     *        by another MAGIC_NUMBER (i.e. the next frame or the EoMG
+     *        trailer) whose length also fits, are suspect: they're only
+     *        passed while the scan's 'budget' can pay for their CRC.
+     *        NOTE: A valid frame followed by a corrupted header is thus only
+     *              skipped if the scan has already CRC'd a lot of noise.
+     */
+    static bool frameFits_(const uint8_t* p, uint16_t remainSz,
+                           const uint8_t* end, CrcBudget& budget) {
+      MsgFrameHeader header;
+      memcpy((void*)&header, (void*)p, sizeof(MsgFrameHeader));
+      size_t frameSz = sizeof(MsgFrameHeader) + header.len();
+      if (frameSz > remainSz) {
+        return false;
+      } else if (MsgFrameHeader::LEN_WIDTH <= CHEAP_LEN_WIDTH_ ||
+                 header.len() == 0) {
+        return true;
+      }
+
+      // The successor's own length must fit, too
+      const uint8_t* next = p + frameSz;
+      if (next == end) {
+        return true;
+      } else if (*next == MsgFrameHeader::MAGIC_NUMBER &&
+                 static_cast<size_t>(end - next) >= sizeof(MsgFrameHeader)) {
+        memcpy((void*)&header, (void*)next, sizeof(MsgFrameHeader));
+        if (sizeof(MsgFrameHeader) + header.len() <=
+            static_cast<size_t>(end - next)) {
+          return true;
+        }
+      }
+      return budget.spend(p, frameSz);
     }
 
     /**
@@ -87,7 +241,7 @@ class MplexMsgGroup {
      * @return Size of remaining buffer space that hasn't been processed.
      */
     uint16_t unprocessedSz_() {
-      return (uint16_t)((rawBuf_.get() + rawBufSize_) - currFramePos_);
+      return (uint16_t)((buf_ + rawBufSize_) - currFramePos_);
     }
 
   public:
@@ -182,15 +336,88 @@ class MplexMsgGroup {
       }
     }
 
+    /**
+     * @brief Constructor for a MsgGroup view of an existing buffer, e.g. an
+     *        mmap()'d capture or a recvmmsg() slot. Unlike the constructor
+     *        above, nothing is copied: frames are parsed in place, so the
+     *        buffer must outlive this object (and stay writable if frames
+     *        are to be byte-destuffed).
+     *
+     *        Note: Using this method puts the object in READ mode.
+     *
+     * @param rawBuf Pointer to the existing buffer.
+     * @param sz Size of the existing buffer.
+     */
+    MplexMsgGroup(MplexViewTag, const uint8_t* rawBuf, const uint16_t sz) {
+      if (sz < MIN_SIZE) {
+        throw std::invalid_argument("Requested buffer size < header size");
+      } else if (sz > MAX_SIZE) {
+        throw std::invalid_argument("Requested buffer size > maximum size");
+      }
+
+      if (rawBuf == nullptr) {
+        throw std::invalid_argument(
+            "Cannot construct MsgGroup with an empty buffer");
+      }
+
+      if (resetView(rawBuf, sz) == false) {
+        throw std::logic_error("Unable to set currFrame object");
+      }
+    }
+
+    /**
+     * @brief Re-points this object at another existing buffer, as if it was
+     *        just created w/ the view constructor. Any buffer owned by this
+     *        object is released; reset() will fail afterwards.
+     *
+     * @param rawBuf Pointer to the existing buffer.
+     * @param sz Size of the existing buffer.
+     *
+     * @return Returns true on success, false if the buffer is invalid.
+     */
+    bool resetView(const uint8_t* rawBuf, const uint16_t sz) {
+      if (rawBuf == nullptr || sz < MIN_SIZE || sz > MAX_SIZE) {
+        // TODO: Use log
+        std::cerr << "ERROR: Invalid buffer for MsgGroup view\n";
+        return false;
+      }
+
+      rawBuf_.reset();
+      rawBufSize_ = sz;
+      buf_ = const_cast<uint8_t*>(rawBuf);
+      memcpy((void*)&header_, (void*)rawBuf, sizeof(MsgGroupHeader));
+
+      mode_ = MplexOpMode::READ;
+      nFramesProcessed_ = 0;
+      currFramePos_ = buf_ + sizeof(MsgGroupHeader);
+
+      uint16_t maxFrameSz = std::min(unprocessedSz_(), FRAME_MAX_SIZE);
+      return currFrame_.reset(currFramePos_, maxFrameSz, mode_);
+    }
+
+    /**
+     * @brief Returns true if this object is a view of caller-owned memory.
+     */
+    bool isView() const {
+      return buf_ != nullptr && rawBuf_ == nullptr;
+    }
+
     /**
      * @brief Reset the Message Group, as if it was just created in WRITE mode.
      *        Note that this operation will also wipe the header.
      *
-     * @return Returns true on success, false if something went wrong.
+     * @return Returns true on success, false if something went wrong or if
+     *         this object is a view (it has no buffer of its own to write).
      */
     bool reset() {
+      if (this->isView()) {
+        // TODO: Use log
+        std::cerr << "ERROR: Cannot reset a MsgGroup view for writing\n";
+        return false;
+      }
+
       mode_ = MplexOpMode::WRITE;
-      currFramePos_ = rawBuf_.get() + sizeof(MsgGroupHeader);
+      currFramePos_ = buf_ + sizeof(MsgGroupHeader);
       uint16_t maxFrameSz = std::min(unprocessedSz_(), FRAME_MAX_SIZE);
       if (currFrame_.reset(currFramePos_, maxFrameSz, mode_) == false) {
         // TODO: Use log
@@ -198,7 +425,11 @@ class MplexMsgGroup {
         return false;
       }
       nFramesProcessed_ = 0;
-      memset((void*)&header_, 0x0, sizeof(MsgGroupHeader));
+      // Copy in a fresh header rather than zeroing it, as that'd also wipe
+      // the (const) version field, which fillHeader_() doesn't write
+      const MsgGroupHeader freshHeader;
+      memcpy((void*)&header_, (const void*)&freshHeader,
+             sizeof(MsgGroupHeader));
 
       return true;
     }
@@ -244,16 +475,20 @@ class MplexMsgGroup {
       }
 
       // Scan through buffer to find potential new frame.
-      const uint8_t* bufEnd = rawBuf_.get() + rawBufSize_;
+      const uint8_t* bufEnd = buf_ + rawBufSize_;
+      CrcBudget budget(currFramePos_);
       for (; currFramePos_ < bufEnd; currFramePos_++) {
-        if (*currFramePos_ != MsgFrameHeader::MAGIC_NUMBER) {
-          continue;
+        currFramePos_ = findMagic_(currFramePos_, bufEnd);
+        if (currFramePos_ == bufEnd) {
+          break;
         }
 
         // Check if the leftover space can't fit a new frame.
         uint16_t remainSz = std::min(unprocessedSz_(), FRAME_MAX_SIZE);
         if (remainSz < sizeof(MsgFrameHeader)) {
           return nullptr;
+        } else if (frameFits_(currFramePos_, remainSz, bufEnd, budget) == false) {
+          continue;
         }
 
         if (currFrame_.reset(currFramePos_, remainSz, mode_) == false) {
@@ -275,6 +510,31 @@ class MplexMsgGroup {
       return nullptr;
     }
 
+    /**
+     * @brief Calls fn(frame) for each valid frame, starting from the current
+     *        one (skipped if it's invalid, e.g. on a corrupted header) &
+     *        stopping at the End of Message Group frame.
+     *
+     *        NOTE: This method is only valid in READ mode.
+     *
+     * @return Returns the number of frames visited.
+     */
+    template <typename Fn>
+    size_t forEachValidFrame(Fn&& fn) {
+      size_t nFrames = 0;
+      msg_t* pMsg = this->currFrame();
+      if (pMsg != nullptr && pMsg->isValid() == false) {
+        pMsg = this->nextValidFrame();
+      }
+      for (; pMsg != nullptr && pMsg->isEndOfMsgGroup() == false;
+           pMsg = this->nextValidFrame()) {
+        fn(*pMsg);
+        nFrames++;
+      }
+
+      return nFrames;
+    }
+
     /**
      * @brief This method should only be invoked when the current message
      *        frame is valid.
@@ -328,6 +588,49 @@ class MplexMsgGroup {
       return &currFrame_;
     }
 
+    /**
+     * @brief Reserves a slot for a frame w/ 'len' bytes of data at the current
+     *        frame position and steps past it, as commitFrame() would once
+     *        the frame was written. The slot is filled in later, possibly by
+     *        another thread, w/ a Message Frame wrapping it (see
+     *        MplexMsgGroupEncoder). It is counted as a frame straight away,
+     *        so it must hold a valid frame of exactly 'len' bytes of data
+     *        before the group is sent.
+     *
+     *        Anything written to the current frame is discarded.
+     *
+     *        NOTE: This method is only valid in WRITE mode.
+     *
+     * @return Returns a pointer to the slot, of sizeof(MsgFrameHeader) + 'len'
+     *         bytes. Returns NULL if the object is not in WRITE mode, if 'len'
+     *         exceeds the maximum data length, or if the group is out of
+     *         frames or of space for the slot & an End of Message Group frame.
+     */
+    uint8_t* reserveFrame(uint16_t len) {
+      if (mode_ != MplexOpMode::WRITE || len > msg_t::MAX_DATA) {
+        return nullptr;
+      }
+
+      uint32_t slotSz = sizeof(MsgFrameHeader) + uint32_t(len);
+      if (nFramesProcessed_ == nFrames_t::max_value ||
+          slotSz + sizeof(MsgFrameHeader) > unprocessedSz_()) {
+        // TODO: Use log
+        std::cerr << "ERROR: No room left in MsgGroup for frame\n";
+        return nullptr;
+      }
+
+      uint8_t* slot = currFramePos_;
+      nFramesProcessed_ =
+          static_cast<typename nFrames_t::repr_type>(nFramesProcessed_ + 1);
+      currFramePos_ += slotSz;
+
+      // Room for at least the End of Message Group frame is left
+      uint16_t remainSz = std::min(unprocessedSz_(), FRAME_MAX_SIZE);
+      currFrame_.reset(currFramePos_, remainSz, mode_);
+
+      return slot;
+    }
+
     /**
      * @brief Updates & writes the header to the beginning of the underlying
      *        buffer, as well as an End of Message Group frame to location of
@@ -353,25 +656,10 @@ class MplexMsgGroup {
       memcpy((void*)currFramePos_, (void*)&endOfGroup, sizeof(endOfGroup));
 
       // Fill header contents
-      struct timespec ts;
-      timespec_get(&ts, TIME_UTC);
-      header_.setMagic();
-      header_.timestamp((uint32_t)ts.tv_sec, (uint32_t)ts.tv_nsec);
-      header_.headerLen(sizeof(MsgGroupHeader)); // Ignore options for now
-      header_.numFrames(nFramesProcessed_);
-
-      // The CRC field in the header is calculated over just the header.
-      // Set the CRC to 0 before calculating CRC.
-      header_.hcrc(0);
-      try {
-        header_.hcrc(calcCRC_(reinterpret_cast<const uint8_t*>(&header_),
-                              sizeof(MsgGroupHeader)));
-      } catch (std::exception& exc) {
-        // TODO: Replace w/ log
-        std::cerr << exc.what() << std::endl;
+      if (fillHeader_(header_, nFramesProcessed_) == false) {
         return false;
       }
-      memcpy((void*)rawBuf_.get(), (void*)&header_, sizeof(MsgGroupHeader));
+      memcpy((void*)buf_, (void*)&header_, sizeof(MsgGroupHeader));
 
       return true;
     }
@@ -379,11 +667,20 @@ class MplexMsgGroup {
     /**
      * @brief Get pointer to underlying buffer. This pointer will be invalid
      *        once this object goes out-of-scope or is manually destroyed.
+     *        For views, this is the caller's buffer.
      *
      * @return Returns pointer to underlying buffer.
      */
     uint8_t* getBuf() const {
-      return rawBuf_.get();
+      return buf_;
+    }
+
+    /**
+     * @brief Returns the size of the underlying buffer. For views handed out
+     *        by MplexMsgDeframer, this is exactly the size of the group.
+     */
+    uint16_t getBufSize() const {
+      return rawBufSize_;
     }
 
     /**
@@ -393,23 +690,43 @@ class MplexMsgGroup {
      *         calculated CRC matches), false otherwise.
      */
     bool headerIsValid() {
-      // Set header CRC to 0 before calculating CRC, then restore
-      MsgGroupHeader* pHead = (MsgGroupHeader*)rawBuf_.get();
-      hcrc_t origCRC = pHead->hcrc();
-      pHead->hcrc(0);
+      // The buffer must hold this group's header, not e.g. a stale one left
+      // in a recycled buffer before writeHeaderTrailer() is called
+      return (memcmp((void*)&header_, (void*)buf_,
+                     sizeof(MsgGroupHeader)) == 0 &&
+              headerIsValid(buf_));
+    }
+
+    /**
+     * @brief Checks to see if the serialized Msg Group header at 'buf' (of
+     *        at least sizeof(MsgGroupHeader) bytes) is valid. Used to find
+     *        groups in buffers that aren't (yet) wrapped by a MsgGroup.
+     *
+     * @return Returns true if the header is valid (i.e. magic number,
+     *         version and calculated CRC match), false otherwise.
+     */
+    static bool headerIsValid(const uint8_t* buf) {
+      // The CRC is calculated w/ the header's CRC field set to 0; do so on a
+      // copy, rather than modifying the underlying buffer
+      MsgGroupHeader zeroedHead;
+      memcpy((void*)&zeroedHead, (const void*)buf, sizeof(MsgGroupHeader));
+      if (zeroedHead.magic() != MsgGroupHeader::MAGIC_NUMBER ||
+          zeroedHead.vers() != MsgGroupHeader::VERS) {
+        return false;
+      }
+      hcrc_t hcrc = zeroedHead.hcrc();
+      zeroedHead.hcrc(0);
       hcrc_t calcCRC = 0;
       try {
-        calcCRC = calcCRC_(rawBuf_.get(), sizeof(MsgGroupHeader));
+        calcCRC = calcCRC_(reinterpret_cast<const uint8_t*>(&zeroedHead),
+                           sizeof(MsgGroupHeader));
       } catch (std::exception& exc) {
         // TODO: Replace /w log
         std::cerr << exc.what() << std::endl;
-        pHead->hcrc(origCRC);
         return false;
       }
-      pHead->hcrc(origCRC);
 
-      return (MsgGroupHeader::MAGIC_NUMBER == header_.magic() &&
-              calcCRC == header_.hcrc());
+      return calcCRC == hcrc;
     }
 
     /**
@@ -439,20 +756,26 @@ class MplexMsgGroup {
       msg_t tmpMsg;
       uint16_t maxFrameSz = 0;
       nFrames_t validFrames = 0;
-      uint8_t* ptr = rawBuf_.get() + sizeof(MsgGroupHeader);
-      uint8_t* endOfBuf = rawBuf_.get() + rawBufSize_;
+      uint8_t* ptr = buf_ + sizeof(MsgGroupHeader);
+      uint8_t* endOfBuf = buf_ + rawBufSize_;
+      CrcBudget budget(ptr);
 
       // Stop search if end of buffer reached or if number of frames found.
       // Leave room before end of buffer for an End of Message Group frame.
-      while (validFrames < this->numFrames() &&
-             ptr < (endOfBuf - sizeof(MsgFrameHeader))) {
-        if (*ptr != MsgFrameHeader::MAGIC_NUMBER) {
-          ptr++;
-          continue;
+      uint8_t* scanEnd = endOfBuf - sizeof(MsgFrameHeader);
+      while (validFrames < this->numFrames() && ptr < scanEnd) {
+        ptr = findMagic_(ptr, scanEnd);
+        if (ptr == scanEnd) {
+          break;
         }
 
         maxFrameSz = std::min(static_cast<uint16_t>(endOfBuf - ptr),
                               FRAME_MAX_SIZE);
+        if (frameFits_(ptr, maxFrameSz, endOfBuf, budget) == false) {
+          ptr++;
+          continue;
+        }
+
         tmpMsg.reset(ptr, maxFrameSz);
         if (tmpMsg.isEndOfMsgGroup()) {
           break;
@@ -470,7 +793,7 @@ class MplexMsgGroup {
 
       // Calculate size traversed by 'ptr' and add size for EoMG frame
       return static_cast<uint16_t>(
-          static_cast<uint16_t>(ptr - rawBuf_.get()) + sizeof(MsgFrameHeader));
+          static_cast<uint16_t>(ptr - buf_) + sizeof(MsgFrameHeader));
     }
 
     /**
@@ -487,15 +810,15 @@ class MplexMsgGroup {
      */
     uint16_t processedSize() const {
       return static_cast<uint16_t>(
-          static_cast<uint16_t>(currFramePos_ - rawBuf_.get()) +
+          static_cast<uint16_t>(currFramePos_ - buf_) +
                                           sizeof(MsgFrameHeader));
     }
 
 #ifdef DEBUG
     void printGroup() {
       uint8_t cnt = 0;
-      for (const uint8_t* i = rawBuf_.get();
-            i < rawBuf_.get() + this->calcGroupSize(); i++) {
+      for (const uint8_t* i = buf_;
+            i < buf_ + this->calcGroupSize(); i++) {
         printf("%02X ", *i);
 
         if (++cnt == 16) {
@@ -522,7 +845,7 @@ class MplexMsgGroup {
      * @return Returns the length of the Message Group Header.
      */
     hlen_t hlen() const {
-      return header_.hlen();
+      return header_.headerLen();
     }
 
     /**
@@ -533,6 +856,16 @@ class MplexMsgGroup {
     hcrc_t hcrc() const {
       return header_.hcrc();
     }
+
+    /**
+     * @brief Returns the timestamp of the Message Group Header.
+     *
+     * @return Returns the timestamp, as (seconds << 32) | nanoseconds for
+     *         v0 headers, or as nanoseconds since the Unix epoch from v1.
+     */
+    uint64_t timestamp() const {
+      return header_.timestamp();
+    }
 };
 
 #endif
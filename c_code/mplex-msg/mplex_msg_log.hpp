@@ -0,0 +1,549 @@
+#ifndef MPLEX_MSG_LOG_H
+#define MPLEX_MSG_LOG_H
+
+// C headers
+#include <stdint.h>
+#include <string.h>
+#include <endian.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// C++ headers
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "mplex_msg_group.hpp"
+#include "mplex_msg_deframer.hpp"
+
+/*
+ * On-disk log of Message Groups, for persistence & replay.
+ *
+ * A log is a segment file of whole groups, appended back-to-back exactly as
+ * serialized, plus a sidecar index file (the segment's path + ".idx"). The
+ * index starts w/ an 8-byte header ("MPLXIDX" & the group version),
+ * followed by one fixed-size entry per group, in the same order:
+ *
+ *  0                                 8                                 16
+ * +---------------------------------+---------------------------------+
+ * |     Timestamp (64 Bits)         |  Offset in segment (64 Bits)    |
+ * +---------------------------------+---------------------------------+
+ *  16               18               20
+ * +----------------+----------------+
+ * |   Group size   |   # Frames     |
+ * +----------------+----------------+
+ *
+ * All fields are big-endian. The timestamp is MsgGroupHeader::timestamp(),
+ * i.e. (seconds << 32) | nanoseconds for v0 & nanoseconds for v1, so
+ * entries sort in time order.
+ *
+ * The index is written after its group, so a crash can only leave groups
+ * that aren't indexed yet (or a torn group) at the end of the segment.
+ * Re-opening the log w/ MplexMsgLogWriter indexes the former & drops the
+ * latter.
+ */
+
+// One index entry, in host order
+struct MplexLogEntry {
+  uint64_t timestamp;
+  uint64_t offset;
+  uint16_t size;
+  uint16_t numFrames;
+};
+
+namespace MplexLogFormat {
+
+static const char INDEX_MAGIC[7] = {'M', 'P', 'L', 'X', 'I', 'D', 'X'};
+static const size_t INDEX_HEADER_SIZE = sizeof(INDEX_MAGIC) + 1;
+static const size_t ENTRY_SIZE = 20;
+
+inline std::string indexPath(const std::string& path) {
+  return path + ".idx";
+}
+
+inline void encodeEntry(uint8_t* dst, const MplexLogEntry& entry) {
+  uint64_t ts = htobe64(entry.timestamp);
+  uint64_t offset = htobe64(entry.offset);
+  uint16_t size = htobe16(entry.size);
+  uint16_t nFrames = htobe16(entry.numFrames);
+  memcpy(dst, &ts, sizeof(ts));
+  memcpy(dst + 8, &offset, sizeof(offset));
+  memcpy(dst + 16, &size, sizeof(size));
+  memcpy(dst + 18, &nFrames, sizeof(nFrames));
+}
+
+inline MplexLogEntry decodeEntry(const uint8_t* src) {
+  uint64_t ts, offset;
+  uint16_t size, nFrames;
+  memcpy(&ts, src, sizeof(ts));
+  memcpy(&offset, src + 8, sizeof(offset));
+  memcpy(&size, src + 16, sizeof(size));
+  memcpy(&nFrames, src + 18, sizeof(nFrames));
+
+  return {be64toh(ts), be64toh(offset), be16toh(size), be16toh(nFrames)};
+}
+
+// Whether the group 'entry' points to lies w/in a 'segSize'-byte segment.
+// Written to not overflow on corrupt offsets.
+inline bool entryFits(const MplexLogEntry& entry, uint64_t segSize) {
+  return entry.offset <= segSize && entry.size <= segSize - entry.offset;
+}
+
+// Writes all 'sz' bytes, retrying on interrupts & short writes
+inline bool writeAll(int fd, const uint8_t* buf, size_t sz) {
+  while (sz > 0) {
+    ssize_t n = ::write(fd, buf, sz);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    buf += n;
+    sz -= static_cast<size_t>(n);
+  }
+
+  return true;
+}
+
+inline std::runtime_error sysError(const std::string& what,
+                                   const std::string& path) {
+  return std::runtime_error(what + " " + path + ": " + strerror(errno));
+}
+
+// Private, copy-on-write mapping of a whole file; empty files aren't mapped.
+// Writes through it (e.g. byteDestuff() on a frame) never reach the file.
+struct Mapping {
+  const uint8_t* data = nullptr;
+  size_t size = 0;
+
+  void map(const std::string& path) {
+    unmap();
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+      throw sysError("Unable to open", path);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+      int err = errno;
+      close(fd);
+      errno = err;
+      throw sysError("Unable to stat", path);
+    }
+
+    size_t sz = static_cast<size_t>(st.st_size);
+    if (sz > 0) {
+      void* addr = mmap(nullptr, sz, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                        fd, 0);
+      if (addr == MAP_FAILED) {
+        int err = errno;
+        close(fd);
+        errno = err;
+        throw sysError("Unable to map", path);
+      }
+      data = static_cast<const uint8_t*>(addr);
+      size = sz;
+    }
+    close(fd);
+  }
+
+  void unmap() {
+    if (data != nullptr) {
+      munmap(const_cast<uint8_t*>(data), size);
+    }
+    data = nullptr;
+    size = 0;
+  }
+
+  ~Mapping() {
+    unmap();
+  }
+};
+
+} // namespace MplexLogFormat
+
+/*
+ * MplexMsgLogWriter class
+ * Appends groups to a log, creating its files if needed. Not thread-safe.
+ */
+template <typename MsgGroupHeader,
+          typename MsgFrameHeader =
+              typename MsgHeaders<MsgGroupHeader::VERS>::frame_header_t>
+class MplexMsgLogWriter {
+  public:
+    typedef MplexMsgGroup<MsgGroupHeader, MsgFrameHeader> group_t;
+
+  private:
+    std::string path_;
+    int segFd_ = -1;
+    int idxFd_ = -1;
+    uint64_t segSize_ = 0;
+    uint64_t numGroups_ = 0;
+
+    /**
+     * @brief Brings the index in line w/ the segment after a crash: drops
+     *        torn or dangling entries, indexes trailing groups that never
+     *        made it into the index, and truncates a torn trailing group.
+     */
+    void recover_() {
+      using namespace MplexLogFormat;
+
+      struct stat st;
+      if (fstat(idxFd_, &st) == -1) {
+        throw sysError("Unable to stat", indexPath(path_));
+      }
+      uint64_t idxSize = static_cast<uint64_t>(st.st_size);
+      if (idxSize < INDEX_HEADER_SIZE) {
+        uint8_t header[INDEX_HEADER_SIZE];
+        memcpy(header, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+        header[sizeof(INDEX_MAGIC)] = MsgGroupHeader::VERS;
+        if (ftruncate(idxFd_, 0) == -1 ||
+            writeAll(idxFd_, header, sizeof(header)) == false) {
+          throw sysError("Unable to write", indexPath(path_));
+        }
+        idxSize = INDEX_HEADER_SIZE;
+      }
+
+      // Keep entries up to the first one past the end of the segment
+      Mapping idx;
+      idx.map(indexPath(path_));
+      if (memcmp(idx.data, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0 ||
+          idx.data[sizeof(INDEX_MAGIC)] != MsgGroupHeader::VERS) {
+        throw std::runtime_error("Not a v" +
+                                 std::to_string(MsgGroupHeader::VERS) +
+                                 " log index: " + indexPath(path_));
+      }
+      uint64_t indexedEnd = 0;
+      numGroups_ = 0;
+      for (uint64_t pos = INDEX_HEADER_SIZE; pos + ENTRY_SIZE <= idxSize;
+           pos += ENTRY_SIZE) {
+        MplexLogEntry entry = decodeEntry(idx.data + pos);
+        if (entryFits(entry, segSize_) == false) {
+          break;
+        }
+        indexedEnd = entry.offset + entry.size;
+        numGroups_++;
+      }
+      idx.unmap();
+      if (ftruncate(idxFd_, static_cast<off_t>(INDEX_HEADER_SIZE +
+                                               numGroups_ * ENTRY_SIZE)) ==
+          -1) {
+        throw sysError("Unable to truncate", indexPath(path_));
+      }
+
+      if (indexedEnd == segSize_) {
+        return;
+      }
+
+      // Index whatever whole groups follow the last indexed one
+      Mapping seg;
+      seg.map(path_);
+      uint64_t validEnd = indexedEnd;
+      bool ok = true;
+      MplexMsgDeframer<MsgGroupHeader, MsgFrameHeader> deframer(
+          [&](typename MplexMsgDeframer<MsgGroupHeader,
+                                        MsgFrameHeader>::group_t& group) {
+        uint64_t offset = static_cast<uint64_t>(group.getBuf() - seg.data);
+        uint16_t sz = group.getBufSize();
+        ok = ok && this->appendIndex_(group.getBuf(), offset, sz);
+        validEnd = offset + sz;
+      });
+      deframer.push(seg.data + indexedEnd, seg.size - indexedEnd);
+      seg.unmap();
+      if (ok == false) {
+        throw sysError("Unable to write", indexPath(path_));
+      }
+
+      if (ftruncate(segFd_, static_cast<off_t>(validEnd)) == -1) {
+        throw sysError("Unable to truncate", path_);
+      }
+      segSize_ = validEnd;
+    }
+
+    bool appendIndex_(const uint8_t* grp, uint64_t offset, uint16_t sz) {
+      MsgGroupHeader header;
+      memcpy((void*)&header, grp, sizeof(MsgGroupHeader));
+      MplexLogEntry entry = {header.timestamp(), offset, sz,
+                             header.numFrames()};
+      uint8_t buf[MplexLogFormat::ENTRY_SIZE];
+      MplexLogFormat::encodeEntry(buf, entry);
+      if (MplexLogFormat::writeAll(idxFd_, buf, sizeof(buf)) == false) {
+        return false;
+      }
+      numGroups_++;
+
+      return true;
+    }
+
+  public:
+    /**
+     * @brief Opens (or creates) the log at 'path' for appending, recovering
+     *        from a previous crash if needed. Throws std::runtime_error if
+     *        the files can't be opened or aren't a log of this version.
+     */
+    explicit MplexMsgLogWriter(const std::string& path) : path_(path) {
+      std::string idxPath = MplexLogFormat::indexPath(path);
+      segFd_ = open(path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC,
+                    0644);
+      idxFd_ = open(idxPath.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC,
+                    0644);
+      struct stat st;
+      if (segFd_ == -1 || idxFd_ == -1 || fstat(segFd_, &st) == -1) {
+        std::runtime_error err = MplexLogFormat::sysError(
+            "Unable to open", segFd_ == -1 ? path : idxPath);
+        this->close_();
+        throw err;
+      }
+      segSize_ = static_cast<uint64_t>(st.st_size);
+
+      try {
+        recover_();
+      } catch (...) {
+        this->close_();
+        throw;
+      }
+    }
+
+    ~MplexMsgLogWriter() {
+      this->close_();
+    }
+
+    MplexMsgLogWriter(const MplexMsgLogWriter&) = delete;
+    MplexMsgLogWriter& operator=(const MplexMsgLogWriter&) = delete;
+
+    /**
+     * @brief Appends the serialized group at 'grp', of 'sz' bytes, to the
+     *        log. Only the header is checked.
+     *
+     * @return Returns true on success. Returns false if the group header is
+     *         invalid, or if writing failed.
+     */
+    bool append(const uint8_t* grp, uint16_t sz) {
+      if (grp == nullptr || sz < group_t::MIN_SIZE ||
+          group_t::headerIsValid(grp) == false) {
+        // TODO: Replace w/ log
+        std::cerr << "ERROR: Invalid MsgGroup, not logged\n";
+        return false;
+      }
+
+      if (MplexLogFormat::writeAll(segFd_, grp, sz) == false) {
+        // TODO: Replace w/ log
+        std::cerr << "ERROR: Unable to write to " << path_ << ": "
+                  << strerror(errno) << std::endl;
+        // Don't leave a torn group behind
+        if (ftruncate(segFd_, static_cast<off_t>(segSize_)) == -1) {
+          std::cerr << "ERROR: Unable to truncate " << path_ << std::endl;
+        }
+        return false;
+      }
+
+      if (appendIndex_(grp, segSize_, sz) == false) {
+        // TODO: Replace w/ log
+        std::cerr << "ERROR: Unable to write to "
+                  << MplexLogFormat::indexPath(path_) << ": "
+                  << strerror(errno) << std::endl;
+        // Drop the unindexed group & any torn entry, so the next append's
+        // offset & entry line up again
+        off_t idxSize = static_cast<off_t>(MplexLogFormat::INDEX_HEADER_SIZE +
+                                           numGroups_ *
+                                           MplexLogFormat::ENTRY_SIZE);
+        if (ftruncate(segFd_, static_cast<off_t>(segSize_)) == -1 ||
+            ftruncate(idxFd_, idxSize) == -1) {
+          std::cerr << "ERROR: Unable to truncate " << path_ << std::endl;
+        }
+        return false;
+      }
+      segSize_ += sz;
+
+      return true;
+    }
+
+    /**
+     * @brief Appends a group completed w/ writeHeaderTrailer(); see above.
+     *        For READ-mode groups, use the above w/ calcGroupSize().
+     */
+    bool append(group_t& group) {
+      return this->append(group.getBuf(), group.processedSize());
+    }
+
+    /**
+     * @brief Flushes both files to disk.
+     */
+    bool sync() {
+      return fdatasync(segFd_) == 0 && fdatasync(idxFd_) == 0;
+    }
+
+    uint64_t numGroups() const {
+      return numGroups_;
+    }
+
+    // Size of the segment file, in bytes
+    uint64_t size() const {
+      return segSize_;
+    }
+
+  private:
+    void close_() {
+      if (segFd_ != -1) {
+        close(segFd_);
+        segFd_ = -1;
+      }
+      if (idxFd_ != -1) {
+        close(idxFd_);
+        idxFd_ = -1;
+      }
+    }
+};
+
+/*
+ * MplexMsgLogReader class
+ * Memory-maps a log for random access by position or time. Groups and
+ * their frames are handed out as READ-mode views into the mapping, so
+ * nothing is copied. Views are valid until refresh() or destruction. The
+ * mapping is private: frames can be modified in place (e.g. destuffed)
+ * w/o affecting the log, until the next refresh().
+ *
+ * Only what was in the log when it was mapped is visible; call refresh() to
+ * pick up groups appended since. Seeking by time requires the groups to
+ * have been appended in time order, as they are when logged as they're
+ * built.
+ */
+template <typename MsgGroupHeader,
+          typename MsgFrameHeader =
+              typename MsgHeaders<MsgGroupHeader::VERS>::frame_header_t>
+class MplexMsgLogReader {
+  public:
+    typedef MplexMsgGroup<MsgGroupHeader, MsgFrameHeader> group_t;
+    typedef typename group_t::msg_t msg_t;
+
+  private:
+    std::string path_;
+    MplexLogFormat::Mapping seg_;
+    MplexLogFormat::Mapping idx_;
+    size_t numGroups_ = 0;
+
+  public:
+    /**
+     * @brief Maps the log at 'path'. Throws std::runtime_error if it can't
+     *        be mapped or isn't a log of this version.
+     */
+    explicit MplexMsgLogReader(const std::string& path) : path_(path) {
+      this->refresh();
+    }
+
+    MplexMsgLogReader(const MplexMsgLogReader&) = delete;
+    MplexMsgLogReader& operator=(const MplexMsgLogReader&) = delete;
+
+    /**
+     * @brief Re-maps the log to pick up groups appended since it was last
+     *        mapped. Invalidates all views.
+     */
+    void refresh() {
+      using namespace MplexLogFormat;
+
+      // Map the index first, so all of its entries' groups are in the
+      // segment's mapping
+      idx_.map(indexPath(path_));
+      seg_.map(path_);
+      if (idx_.size < INDEX_HEADER_SIZE ||
+          memcmp(idx_.data, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0 ||
+          idx_.data[sizeof(INDEX_MAGIC)] != MsgGroupHeader::VERS) {
+        throw std::runtime_error("Not a v" +
+                                 std::to_string(MsgGroupHeader::VERS) +
+                                 " log index: " + indexPath(path_));
+      }
+
+      // Ignore entries past the end of the segment (e.g. being written)
+      numGroups_ = (idx_.size - INDEX_HEADER_SIZE) / ENTRY_SIZE;
+      while (numGroups_ > 0) {
+        if (MplexLogFormat::entryFits(entry(numGroups_ - 1), seg_.size)) {
+          break;
+        }
+        numGroups_--;
+      }
+    }
+
+    size_t numGroups() const {
+      return numGroups_;
+    }
+
+    /**
+     * @brief Returns the index entry of group 'i' (< numGroups()).
+     */
+    MplexLogEntry entry(size_t i) const {
+      return MplexLogFormat::decodeEntry(idx_.data +
+          MplexLogFormat::INDEX_HEADER_SIZE + i * MplexLogFormat::ENTRY_SIZE);
+    }
+
+    /**
+     * @brief Returns the position of the first group w/ a timestamp >=
+     *        'timestamp' (in MsgGroupHeader::timestamp() format), or
+     *        numGroups() if there is none. O(log n) over the index.
+     */
+    size_t seek(uint64_t timestamp) const {
+      size_t lo = 0;
+      size_t hi = numGroups_;
+      while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (entry(mid).timestamp < timestamp) {
+          lo = mid + 1;
+        } else {
+          hi = mid;
+        }
+      }
+
+      return lo;
+    }
+
+    /**
+     * @brief Returns a view of group 'i' (< numGroups()) in the mapping.
+     *        Throws std::out_of_range otherwise, & std::runtime_error if its
+     *        index entry is corrupt (i.e. points outside the mapping, or at
+     *        less than a group).
+     */
+    group_t group(size_t i) const {
+      if (i >= numGroups_) {
+        throw std::out_of_range("Log group index out of range");
+      }
+
+      // Only the last entry is checked on mapping; the others may be corrupt
+      // or from another log
+      MplexLogEntry e = entry(i);
+      if (e.size < group_t::MIN_SIZE ||
+          MplexLogFormat::entryFits(e, seg_.size) == false) {
+        throw std::runtime_error("Corrupt entry " + std::to_string(i) +
+                                 " in log index: " +
+                                 MplexLogFormat::indexPath(path_));
+      }
+      return group_t(MPLEX_VIEW, seg_.data + e.offset, e.size);
+    }
+
+    /**
+     * @brief Calls fn(entry, frame) for each valid frame of groups
+     *        [first, last), in order, w/ 'frame' wrapping the mapping.
+     *        Throws std::runtime_error on a corrupt index entry; see group().
+     *
+     * @return Returns the number of frames visited.
+     */
+    template <typename Fn>
+    size_t forEachFrame(size_t first, size_t last, Fn&& fn) const {
+      size_t nFrames = 0;
+      last = std::min(last, numGroups_);
+      for (size_t i = first; i < last; i++) {
+        MplexLogEntry e = entry(i);
+        group_t view = this->group(i);
+        nFrames += view.forEachValidFrame([&](msg_t& frame) {
+          fn(e, frame);
+        });
+      }
+
+      return nFrames;
+    }
+};
+
+#endif
@@ -0,0 +1,343 @@
+#pragma once
+#ifndef MPLEX_MSG_SCHEMA_H
+#define MPLEX_MSG_SCHEMA_H
+
+// C headers
+#include <stdint.h>
+#include <stddef.h>
+#include <endian.h>
+#include <string.h>
+
+// C++ headers
+#include <array>
+#include <type_traits>
+#include <utility>
+
+#include "mplex_msg_frame.hpp"
+
+/*
+ * Compile-time payload schemas. A payload struct is described once as a list
+ * of its fields, in wire order, w/ each field's wire width & byte order:
+ *
+ *    struct Reading {
+ *      uint16_t sensor;
+ *      int32_t temp;
+ *      float samples[4];
+ *    };
+ *
+ *    typedef MplexSchema::Schema<
+ *        MplexSchema::Field<&Reading::sensor>,
+ *        MplexSchema::Field<&Reading::temp, 2>,   // 2 Bytes on the wire
+ *        MplexSchema::Field<&Reading::samples, 0, MplexSchema::Endian::LITTLE>
+ *      > ReadingSchema;
+ *
+ *    ReadingSchema::encode(msgFrame, reading);  // Writes SIZE (= 20) Bytes
+ *
+ * The encoded size (SIZE) and each field's offset are known at compile time,
+ * so encode() & decode() do a single bounds check on the frame and then a
+ * fixed sequence of (byte-swapped) loads & stores, which the compiler is free
+ * to merge, instead of one writeData() / readData() call per field.
+ *
+ * Fields default to big-endian & their in-memory width, which encodes the
+ * same as writeData() would. Supported fields are integral, enum & floating
+ * point members, and (C or std::) arrays of them. Integers narrower on the
+ * wire than in memory are truncated when encoded and sign/zero-extended when
+ * decoded; floating point fields must keep their width.
+ */
+namespace MplexSchema {
+
+// Byte order of a field on the wire
+enum class Endian {
+  BIG,
+  LITTLE
+};
+
+// Implementation details of Field & Schema; not meant to be used directly
+namespace internal {
+
+template <typename T>
+struct MemberOf;
+
+template <typename S, typename M>
+struct MemberOf<M S::*> {
+  typedef S struct_t;
+  typedef M member_t;
+};
+
+// Element type & number of elements of a (possibly array) member
+template <typename M>
+struct Elems {
+  typedef M elem_t;
+  static constexpr size_t COUNT = 1;
+};
+
+template <typename M, size_t N>
+struct Elems<M[N]> {
+  typedef M elem_t;
+  static constexpr size_t COUNT = N;
+};
+
+template <typename M, size_t N>
+struct Elems<std::array<M, N>> {
+  typedef M elem_t;
+  static constexpr size_t COUNT = N;
+};
+
+template <size_t WIDTH> struct Int;
+template <> struct Int<1> { typedef uint8_t u_t; typedef int8_t s_t; };
+template <> struct Int<2> { typedef uint16_t u_t; typedef int16_t s_t; };
+template <> struct Int<4> { typedef uint32_t u_t; typedef int32_t s_t; };
+template <> struct Int<8> { typedef uint64_t u_t; typedef int64_t s_t; };
+
+template <typename U>
+inline U byteSwap(U val) {
+  if constexpr (sizeof(U) == sizeof(uint16_t)) {
+    return __builtin_bswap16(val);
+  } else if constexpr (sizeof(U) == sizeof(uint32_t)) {
+    return __builtin_bswap32(val);
+  } else if constexpr (sizeof(U) == sizeof(uint64_t)) {
+    return __builtin_bswap64(val);
+  } else {
+    return val;
+  }
+}
+
+// Whether a value of type T must be byte-swapped to be in 'E' order
+template <typename T, Endian E>
+constexpr bool needsSwap() {
+#if (__BYTE_ORDER != __LITTLE_ENDIAN) && (__BYTE_ORDER != __BIG_ENDIAN)
+#error  "Please fix <endian.h>"
+#endif
+  if constexpr (std::is_floating_point_v<T>) {
+    return (E == Endian::BIG) != (__FLOAT_WORD_ORDER == __BIG_ENDIAN);
+  } else {
+    return (E == Endian::BIG) != (__BYTE_ORDER == __BIG_ENDIAN);
+  }
+}
+
+// Converts between integral T & the unsigned wire representation U. Going
+// to U truncates, coming from U sign/zero-extends as per T's signedness.
+template <typename U, typename T>
+inline U toWire(T val) {
+  if constexpr (std::is_same_v<T, U>) {
+    return val;
+  } else {
+    return static_cast<U>(val);
+  }
+}
+
+template <typename T, typename U>
+inline T fromWire(U raw) {
+  typedef typename Int<sizeof(U)>::s_t s_t;
+  if constexpr (std::is_same_v<T, bool>) {
+    return raw != 0;
+  } else if constexpr (std::is_same_v<T, U>) {
+    return raw;
+  } else if constexpr (std::is_signed_v<T> && sizeof(U) < sizeof(T)) {
+    return static_cast<T>(static_cast<s_t>(raw));
+  } else {
+    return static_cast<T>(raw);
+  }
+}
+
+// Stores 'val' as WIDTH Bytes in 'E' order at 'dst'
+template <size_t WIDTH, Endian E, typename T>
+inline void store(uint8_t* dst, const T& val) {
+  typedef typename Int<WIDTH>::u_t u_t;
+  u_t raw;
+  if constexpr (std::is_floating_point_v<T>) {
+    memcpy(&raw, &val, WIDTH);
+  } else if constexpr (std::is_enum_v<T>) {
+    raw = toWire<u_t>(static_cast<std::underlying_type_t<T>>(val));
+  } else {
+    raw = toWire<u_t>(val);
+  }
+
+  if constexpr (needsSwap<T, E>()) {
+    raw = byteSwap(raw);
+  }
+  memcpy(dst, &raw, WIDTH);
+}
+
+// Loads WIDTH Bytes in 'E' order from 'src' into 'val'
+template <size_t WIDTH, Endian E, typename T>
+inline void load(const uint8_t* src, T& val) {
+  typedef typename Int<WIDTH>::u_t u_t;
+  u_t raw;
+  memcpy(&raw, src, WIDTH);
+  if constexpr (needsSwap<T, E>()) {
+    raw = byteSwap(raw);
+  }
+
+  if constexpr (std::is_floating_point_v<T>) {
+    memcpy(&val, &raw, WIDTH);
+  } else if constexpr (std::is_enum_v<T>) {
+    val = static_cast<T>(fromWire<std::underlying_type_t<T>>(raw));
+  } else {
+    val = fromWire<T>(raw);
+  }
+}
+
+template <typename First, typename...>
+struct FirstOf {
+  typedef First type;
+};
+
+} // namespace internal
+
+/*
+ * Describes one field of a payload struct.
+ *  - MEMBER: Pointer to the member, e.g. &Reading::temp.
+ *  - WIDTH:  Bytes per element on the wire (1, 2, 4 or 8); 0 for the
+ *            element's in-memory width.
+ *  - E:      Byte order on the wire.
+ */
+template <auto MEMBER, size_t WIDTH = 0, Endian E = Endian::BIG>
+struct Field {
+  typedef internal::MemberOf<decltype(MEMBER)> member_traits;
+  typedef typename member_traits::struct_t struct_t;
+  typedef typename member_traits::member_t member_t;
+  typedef typename internal::Elems<member_t>::elem_t elem_t;
+
+  static constexpr size_t COUNT = internal::Elems<member_t>::COUNT;
+  static constexpr size_t ELEM_WIDTH = WIDTH == 0 ? sizeof(elem_t) : WIDTH;
+  static constexpr size_t SIZE = ELEM_WIDTH * COUNT;
+
+  static_assert(std::is_arithmetic_v<elem_t> || std::is_enum_v<elem_t>,
+                "Fields must be integral, enum or floating point members, or "
+                "arrays of them");
+  static_assert(ELEM_WIDTH == 1 || ELEM_WIDTH == 2 || ELEM_WIDTH == 4 ||
+                ELEM_WIDTH == 8, "Field widths must be 1, 2, 4 or 8 Bytes");
+  static_assert(std::is_floating_point_v<elem_t> == false ||
+                ELEM_WIDTH == sizeof(elem_t),
+                "Floating point fields can't be resized");
+
+  static void encode(uint8_t* dst, const struct_t& val) {
+    if constexpr (COUNT == 1) {
+      internal::store<ELEM_WIDTH, E>(dst, val.*MEMBER);
+    } else {
+      for (size_t i = 0; i < COUNT; i++) {
+        internal::store<ELEM_WIDTH, E>(dst + i * ELEM_WIDTH, (val.*MEMBER)[i]);
+      }
+    }
+  }
+
+  static void decode(const uint8_t* src, struct_t& val) {
+    if constexpr (COUNT == 1) {
+      internal::load<ELEM_WIDTH, E>(src, val.*MEMBER);
+    } else {
+      for (size_t i = 0; i < COUNT; i++) {
+        internal::load<ELEM_WIDTH, E>(src + i * ELEM_WIDTH, (val.*MEMBER)[i]);
+      }
+    }
+  }
+};
+
+/*
+ * Schema of a payload struct, made up of its Fields in wire order. Fields
+ * must all belong to the same struct; not every member needs to be listed.
+ */
+template <typename... Fields>
+class Schema {
+  static_assert(sizeof...(Fields) > 0, "Schemas need at least one Field");
+
+  public:
+    typedef typename internal::FirstOf<Fields...>::type::struct_t struct_t;
+
+    // Encoded size, in Bytes
+    static constexpr size_t SIZE = (Fields::SIZE + ...);
+
+  private:
+    static_assert((std::is_same_v<typename Fields::struct_t, struct_t> && ...),
+                  "All Fields must belong to the same struct");
+
+    static constexpr std::array<size_t, sizeof...(Fields)> offsets_() {
+      std::array<size_t, sizeof...(Fields)> offsets{};
+      size_t sizes[] = {Fields::SIZE...};
+      for (size_t i = 1; i < sizeof...(Fields); i++) {
+        offsets[i] = offsets[i - 1] + sizes[i - 1];
+      }
+      return offsets;
+    }
+
+    // Offset of each Field within the encoded payload
+    static constexpr std::array<size_t, sizeof...(Fields)> OFFSETS =
+        offsets_();
+
+    template <size_t... I>
+    static void encode_(uint8_t* dst, const struct_t& val,
+                        std::index_sequence<I...>) {
+      (Fields::encode(dst + OFFSETS[I], val), ...);
+    }
+
+    template <size_t... I>
+    static void decode_(const uint8_t* src, struct_t& val,
+                        std::index_sequence<I...>) {
+      (Fields::decode(src + OFFSETS[I], val), ...);
+    }
+
+    template <typename MsgFrameHeader>
+    static constexpr void checkFits_() {
+      static_assert(SIZE <= MplexMsgFrame<MsgFrameHeader>::MAX_DATA,
+                    "Schema doesn't fit in a Message Frame");
+    }
+
+  public:
+    /**
+     * @brief Encodes 'val' into the SIZE Bytes at 'dst'.
+     */
+    static void encodeTo(uint8_t* dst, const struct_t& val) {
+      encode_(dst, val, std::index_sequence_for<Fields...>{});
+    }
+
+    /**
+     * @brief Decodes the SIZE Bytes at 'src' into 'val'. Members not in the
+     *        schema are left untouched.
+     */
+    static void decodeFrom(const uint8_t* src, struct_t& val) {
+      decode_(src, val, std::index_sequence_for<Fields...>{});
+    }
+
+    /**
+     * @brief Encodes 'val' into the frame's data at its current position,
+     *        advancing the position by SIZE Bytes. See writeData().
+     *
+     * @return Returns true on success. Returns false if the frame is not in
+     *         WRITE mode, or has less than SIZE Bytes left.
+     */
+    template <typename MsgFrameHeader>
+    static bool encode(MplexMsgFrame<MsgFrameHeader>& frame,
+                       const struct_t& val) {
+      checkFits_<MsgFrameHeader>();
+      uint8_t* dst = frame.claimWrite(SIZE);
+      if (dst == nullptr) {
+        return false;
+      }
+
+      encodeTo(dst, val);
+      return true;
+    }
+
+    /**
+     * @brief Decodes SIZE Bytes from the frame's data at its current position
+     *        into 'val', advancing the position. See readData().
+     *
+     * @return Returns true on success. Returns false if the frame is not in
+     *         READ mode, or has less than SIZE Bytes left.
+     */
+    template <typename MsgFrameHeader>
+    static bool decode(MplexMsgFrame<MsgFrameHeader>& frame, struct_t& val) {
+      checkFits_<MsgFrameHeader>();
+      const uint8_t* src = frame.claimRead(SIZE);
+      if (src == nullptr) {
+        return false;
+      }
+
+      decodeFrom(src, val);
+      return true;
+    }
+};
+
+} // namespace MplexSchema
+
+#endif
@@ -0,0 +1,209 @@
+#include "gtest/gtest.h"
+
+// C++ libs
+#include <thread>
+#include <vector>
+#include <set>
+
+// C libs
+#include <stdint.h>
+#include <string.h>
+
+// Lib to be tesed
+#include "buffer_pool.hpp"
+#include "mplex_msg_group.hpp"
+
+using namespace std;
+
+// Slabs are recycled & counted as hits; oversized requests bypass the pool
+TEST(BufferPool, HitsMisses) {
+  typedef MplexBufferPool<1024, 4, 2> pool_t;
+
+  uint8_t* a = pool_t::acquire(1024);
+  uint8_t* b = pool_t::acquire(1000);
+  EXPECT_TRUE(a != b);
+  EXPECT_EQ(pool_t::stats().hits, 0U);
+  EXPECT_EQ(pool_t::stats().misses, 2U);
+
+  // Slabs of a class are always the class's size
+  EXPECT_EQ(pool_t::slabSize(1000), 1024U);
+  memset(b, 0xFF, 1024);
+
+  pool_t::release(a, 1024);
+  pool_t::release(b, 1000);
+  uint8_t* c = pool_t::acquire(513);
+  uint8_t* d = pool_t::acquire(1024);
+  EXPECT_EQ(pool_t::stats().hits, 2U);
+  EXPECT_EQ(pool_t::stats().misses, 2U);
+  EXPECT_TRUE((c == a && d == b) || (c == b && d == a));
+
+  uint8_t* big = pool_t::acquire(4096);
+  EXPECT_EQ(pool_t::stats().misses, 3U);
+  memset(big, 0xFF, 4096);
+  pool_t::release(big, 4096);
+  pool_t::release(nullptr, 1024);
+
+  // Releases beyond THREAD_CACHE + CAPACITY are freed, not cached
+  vector<uint8_t*> bufs = {c, d};
+  for (size_t i = 0; i < 6; i++) {
+    bufs.push_back(pool_t::acquire(1024));
+  }
+  EXPECT_EQ(pool_t::stats().hits, 2U);
+  EXPECT_EQ(pool_t::stats().misses, 9U);
+  for (uint8_t* buf : bufs) {
+    pool_t::release(buf, 1024);
+  }
+  for (size_t i = 0; i < 6; i++) {
+    bufs[i] = pool_t::acquire(1024);
+  }
+  EXPECT_EQ(pool_t::stats().hits, 8U);
+  bufs[6] = pool_t::acquire(1024);
+  EXPECT_EQ(pool_t::stats().misses, 10U);
+  for (size_t i = 0; i < 7; i++) {
+    pool_t::release(bufs[i], 1024);
+  }
+}
+
+// Small requests take a slab of the smallest class that fits, & each class
+// is recycled separately
+TEST(BufferPool, SizeClasses) {
+  typedef MplexBufferPool<1024, 4, 2> pool_t;
+  const uint32_t MIN_CLASS = 1024 >> (pool_t::MAX_CLASSES - 1);
+
+  EXPECT_EQ(pool_t::slabSize(512), 512U);
+  EXPECT_EQ(pool_t::slabSize(300), 512U);
+  EXPECT_EQ(pool_t::slabSize(256), 256U);
+  EXPECT_EQ(pool_t::slabSize(1), MIN_CLASS);
+  EXPECT_EQ(pool_t::slabSize(0), MIN_CLASS);
+  EXPECT_EQ(pool_t::slabSize(2000), 2000U);
+
+  pool_t::Stats before = pool_t::stats();
+  uint8_t* small = pool_t::acquire(100);
+  memset(small, 0xFF, 128);
+  pool_t::release(small, 100);
+
+  // A different class doesn't reuse it
+  uint8_t* other = pool_t::acquire(200);
+  EXPECT_TRUE(other != small);
+  memset(other, 0xFF, 256);
+  EXPECT_EQ(pool_t::stats().misses, before.misses + 2);
+
+  // The same class does
+  uint8_t* same = pool_t::acquire(65);
+  EXPECT_EQ(same, small);
+  EXPECT_EQ(pool_t::stats().hits, before.hits + 1);
+  pool_t::release(same, 65);
+  pool_t::release(other, 200);
+
+  // The smallest class takes the smallest requests
+  uint8_t* tiny = pool_t::acquire(1);
+  memset(tiny, 0xFF, MIN_CLASS);
+  pool_t::release(tiny, 1);
+}
+
+// Slabs must never be handed out twice concurrently. Hold more slabs than
+// the thread cache fits so they also cycle through the shared freelist.
+TEST(BufferPool, Concurrent) {
+  typedef MplexBufferPool<64, 16, 1> pool_t;
+  const uint8_t NUM_THREADS = 4;
+  const uint32_t NUM_LOOPS = 100000;
+
+  vector<thread> threads;
+  vector<uint32_t> errors(NUM_THREADS, 0);
+  for (uint8_t t = 0; t < NUM_THREADS; t++) {
+    threads.emplace_back([t, &errors]() {
+      uint8_t* held[3];
+      for (uint32_t i = 0; i < NUM_LOOPS; i++) {
+        for (uint8_t*& buf : held) {
+          buf = pool_t::acquire(64);
+          memset(buf, t, 64);
+        }
+        for (uint8_t* buf : held) {
+          for (size_t k = 0; k < 64; k++) {
+            errors[t] += buf[k] != t;
+          }
+          pool_t::release(buf, 64);
+        }
+      }
+    });
+  }
+  for (thread& thr : threads) {
+    thr.join();
+  }
+
+  for (uint8_t t = 0; t < NUM_THREADS; t++) {
+    EXPECT_EQ(errors[t], 0U);
+  }
+  pool_t::Stats stats = pool_t::stats();
+  EXPECT_EQ(stats.hits + stats.misses, uint64_t(NUM_THREADS) * NUM_LOOPS * 3);
+
+  // Exited threads hand their cached slabs over to the freelist
+  uint8_t* buf = pool_t::acquire(64);
+  EXPECT_EQ(pool_t::stats().hits, stats.hits + 1);
+  pool_t::release(buf, 64);
+}
+
+// Slabs released by thread_local objects destroyed after the thread's cache
+// skip it, & go to the freelist
+TEST(BufferPool, ReleaseAfterThreadExit) {
+  typedef MplexBufferPool<1024, 8, 2> pool_t;
+
+  // Constructed before the thread's cache, so destroyed after it
+  struct LateRelease {
+    uint8_t* slab = nullptr;
+    ~LateRelease() {
+      pool_t::release(slab, 1024);
+      pool_t::release(pool_t::acquire(1024), 1024);
+    }
+  };
+
+  uint8_t* released = nullptr;
+  thread thr([&released]() {
+    thread_local LateRelease late;
+    late.slab = pool_t::acquire(1024);
+    released = late.slab;
+  });
+  thr.join();
+
+  uint8_t* slab = pool_t::acquire(1024);
+  EXPECT_EQ(slab, released);
+  pool_t::release(slab, 1024);
+}
+
+// Groups draw their buffers from the provider & return them on destruction
+TEST(BufferPool, MsgGroup) {
+  typedef MplexBufferPool<> pool_t;
+  typedef MplexMsgGroup<MsgGroupHeader_v0, MsgFrameHeader_v0, pool_t> group_t;
+
+  pool_t::Stats before = pool_t::stats();
+  set<uint8_t*> seen;
+  for (int i = 0; i < 100; i++) {
+    group_t msgGroup;
+    seen.insert(msgGroup.getBuf());
+
+    group_t msgGroup2(1472);
+    seen.insert(msgGroup2.getBuf());
+  }
+  pool_t::Stats after = pool_t::stats();
+  EXPECT_EQ(seen.size(), 2U);
+  EXPECT_EQ(pool_t::slabSize(1472), 2048U);
+  EXPECT_EQ(after.misses - before.misses, seen.size());
+  EXPECT_EQ(after.hits - before.hits, 200 - seen.size());
+
+  // Views don't acquire anything
+  group_t msgGroup;
+  EXPECT_TRUE(msgGroup.writeHeaderTrailer());
+  group_t view(MPLEX_VIEW, msgGroup.getBuf(), msgGroup.processedSize());
+  EXPECT_EQ(pool_t::stats().hits, after.hits + 1);
+
+  // Plain heap buffers still work
+  MplexMsgGroup<MsgGroupHeader_v0, MsgFrameHeader_v0, MplexHeapBuffers>
+      heapGroup;
+  EXPECT_TRUE(heapGroup.writeHeaderTrailer());
+  EXPECT_TRUE(heapGroup.headerIsValid());
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
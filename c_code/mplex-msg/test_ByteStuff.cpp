@@ -0,0 +1,266 @@
+#include "gtest/gtest.h"
+#include "gtest/gtest-spi.h"
+
+// C++ libs
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+// C libs
+#include <stdint.h>
+#include <string.h>
+
+// Lib to be tesed
+#include "byte_stuff.hpp"
+
+// Max buffer size for MsgFrames
+// 1472 = 1500 - 20 - 8; to emulate MTU of 1500
+#define BUF_SIZE 1472
+
+using namespace std;
+using ByteStuffUtils::StuffMethod;
+
+static default_random_engine eng(random_device{}());
+
+// Fills 'buf' w/ 'bufSz' Bytes drawn from the first 'numVals' bytes of
+// 'vals'. Fewer values means more occurrences of the avoid sequence.
+void fillFromVals(uint8_t* buf, uint64_t bufSz,
+                  const uint8_t* vals, uint32_t numVals) {
+  uniform_int_distribution<uint32_t> idxDistr(0, numVals - 1);
+  for (uint64_t i = 0; i < bufSz; i++) {
+    buf[i] = vals[idxDistr(eng)];
+  }
+}
+
+/*
+ * Reference stuffing, as previously done in-place by MplexMsgFrame: memmem()
+ * for each prefix, then a memmove() of the tail per escape byte.
+ */
+vector<uint8_t> refStuff(const uint8_t* in, uint32_t inLen,
+                         const uint8_t* seq, uint16_t seqSz) {
+  vector<uint8_t> data(in, in + inLen);
+  vector<size_t> startLocs;
+
+  size_t pos = 0;
+  while (data.size() - pos >= seqSz - 1U) {
+    void* seqStart = memmem(data.data() + pos, data.size() - pos,
+                            seq, seqSz - 1U);
+    if (seqStart == nullptr) {
+      break;
+    }
+    startLocs.push_back(static_cast<size_t>(
+        static_cast<uint8_t*>(seqStart) - data.data()));
+    pos = startLocs.back() + seqSz - 1U;
+  }
+
+  const uint8_t escByte = static_cast<uint8_t>(~seq[seqSz - 1]);
+  data.resize(inLen + startLocs.size());
+  for (size_t i = 0; i < startLocs.size(); i++) {
+    uint8_t* insertAt = data.data() + startLocs[i] + i + (seqSz - 1U);
+    memmove(insertAt + 1, insertAt,
+            static_cast<size_t>(data.data() + inLen + i - insertAt));
+    *insertAt = escByte;
+  }
+
+  return data;
+}
+
+template <StuffMethod method>
+void expectMatchesRef(const uint8_t* in, uint32_t inLen,
+                      const uint8_t* seq, uint16_t seqSz) {
+  const vector<uint8_t> ref = refStuff(in, inLen, seq, seqSz);
+  const uint32_t refLen = static_cast<uint32_t>(ref.size());
+  const int64_t refLen64 = refLen;
+  const int64_t inLen64 = inLen;
+
+  // Measure, then stuff into a separate buffer
+  vector<uint8_t> out(refLen);
+  EXPECT_EQ(ByteStuffUtils::stuff<method>(in, inLen, nullptr, 0, seq, seqSz),
+            refLen64);
+  EXPECT_EQ(ByteStuffUtils::stuff<method>(in, inLen, out.data(), refLen,
+                                          seq, seqSz), refLen64);
+  EXPECT_TRUE(out == ref) << "inLen " << inLen << ", seqSz " << seqSz;
+
+  // One byte short of the stuffed size must fail
+  if (refLen > 0) {
+    EXPECT_EQ(ByteStuffUtils::stuff<method>(in, inLen, out.data(),
+                                            refLen - 1, seq, seqSz), -1);
+  }
+
+  // Stuff in-place from the data shifted right by the # of escapes
+  vector<uint8_t> inPlace(refLen);
+  const uint32_t shift = refLen - inLen;
+  memcpy(inPlace.data() + shift, in, inLen);
+  EXPECT_EQ(ByteStuffUtils::stuff<method>(inPlace.data() + shift, inLen,
+                                          inPlace.data(), refLen,
+                                          seq, seqSz), refLen64);
+  EXPECT_TRUE(inPlace == ref);
+
+  // De-stuff both out of place & in-place
+  vector<uint8_t> destuffed(refLen);
+  EXPECT_EQ(ByteStuffUtils::destuff<method>(ref.data(), refLen, nullptr, 0,
+                                            seq, seqSz), inLen64);
+  EXPECT_EQ(ByteStuffUtils::destuff<method>(ref.data(), refLen,
+                                            destuffed.data(), refLen,
+                                            seq, seqSz), inLen64);
+  EXPECT_TRUE(memcmp(destuffed.data(), in, inLen) == 0);
+
+  EXPECT_EQ(ByteStuffUtils::destuff<method>(inPlace.data(), refLen,
+                                            inPlace.data(), refLen,
+                                            seq, seqSz), inLen64);
+  EXPECT_TRUE(memcmp(inPlace.data(), in, inLen) == 0);
+}
+
+TEST(ByteStuff, InvalidArgs) {
+  uint8_t data[8] = {0};
+  const uint8_t seq[2] = {0, 0};
+
+  EXPECT_EQ(ByteStuffUtils::stuff(data, 8, data, 8, nullptr, 2), -1);
+  EXPECT_EQ(ByteStuffUtils::stuff(data, 8, data, 8, seq, 1), -1);
+  EXPECT_EQ(ByteStuffUtils::destuff(data, 8, data, 8, nullptr, 2), -1);
+  EXPECT_EQ(ByteStuffUtils::destuff(data, 8, data, 8, seq, 1), -1);
+  EXPECT_EQ(ByteStuffUtils::destuff(data, 8, data, 7, seq, 2), -1);
+
+  EXPECT_EQ(ByteStuffUtils::stuff(nullptr, 0, nullptr, 0, seq, 2), 0);
+  EXPECT_EQ(ByteStuffUtils::destuff(nullptr, 0, nullptr, 0, seq, 2), 0);
+}
+
+// Every method must produce the same bytes as the reference, at every
+// length around the SIMD block sizes & for a range of escape densities
+TEST(ByteStuff, MatchesReference) {
+  const uint8_t vals[4] = {0x7E, 0x81, 0x00, 0x55};
+  vector<uint8_t> data(BUF_SIZE);
+
+  for (uint16_t seqSz = 2; seqSz <= 6; seqSz++) {
+    for (uint32_t numVals = 1; numVals <= 4; numVals++) {
+      uint8_t seq[6] = {0};
+      fillFromVals(seq, seqSz, vals, numVals);
+
+      for (uint32_t len = 0; len <= 100; len++) {
+        fillFromVals(data.data(), len, vals, numVals);
+        expectMatchesRef<StuffMethod::SCALAR>(data.data(), len, seq, seqSz);
+        expectMatchesRef<StuffMethod::SSE2>(data.data(), len, seq, seqSz);
+        expectMatchesRef<StuffMethod::AVX2>(data.data(), len, seq, seqSz);
+        expectMatchesRef<StuffMethod::AUTO>(data.data(), len, seq, seqSz);
+      }
+
+      fillFromVals(data.data(), BUF_SIZE, vals, numVals);
+      expectMatchesRef<StuffMethod::SCALAR>(data.data(), BUF_SIZE,
+                                            seq, seqSz);
+      expectMatchesRef<StuffMethod::SSE2>(data.data(), BUF_SIZE, seq, seqSz);
+      expectMatchesRef<StuffMethod::AVX2>(data.data(), BUF_SIZE, seq, seqSz);
+    }
+  }
+}
+
+TEST(ByteStuff, DestuffRejectsMissingEscape) {
+  const uint8_t seq[3] = {0x7E, 0x7E, 0x01};
+  const uint8_t escByte = static_cast<uint8_t>(~seq[2]);
+
+  uint8_t good[6] = {0x00, 0x7E, 0x7E, escByte, 0x00, 0x00};
+  uint8_t bad[6] = {0x00, 0x7E, 0x7E, 0x00, 0x00, 0x00};
+  uint8_t truncated[6] = {0x00, 0x00, 0x00, 0x00, 0x7E, 0x7E};
+  uint8_t out[6] = {0};
+
+  EXPECT_EQ(ByteStuffUtils::destuff(good, 6, out, 6, seq, 3), 5);
+  EXPECT_EQ(ByteStuffUtils::destuff(bad, 6, out, 6, seq, 3), -1);
+  EXPECT_EQ(ByteStuffUtils::destuff(truncated, 6, out, 6, seq, 3), -1);
+  EXPECT_EQ(ByteStuffUtils::destuff<StuffMethod::SCALAR>(bad, 6, out, 6,
+                                                         seq, 3), -1);
+}
+
+// Corrupted stuffed data must be rejected (or de-stuffed) the same way by
+// every method
+TEST(ByteStuff, DestuffCorrupted) {
+  const uint8_t vals[3] = {0x7E, 0x81, 0xFF};
+  const uint8_t seq[3] = {0x7E, 0x81, 0x00};
+  vector<uint8_t> data(BUF_SIZE);
+  fillFromVals(data.data(), BUF_SIZE, vals, 3);
+  const vector<uint8_t> stuffed = refStuff(data.data(), BUF_SIZE, seq, 3);
+  const uint32_t len = static_cast<uint32_t>(stuffed.size());
+
+  uniform_int_distribution<uint32_t> posDistr(0, len - 1);
+  for (uint32_t i = 0; i < 2000; i++) {
+    vector<uint8_t> corrupted = stuffed;
+    corrupted[posDistr(eng)] = vals[i % 3];
+
+    vector<uint8_t> expected(len), out(len);
+    const int64_t expectedLen = ByteStuffUtils::destuff<StuffMethod::SCALAR>(
+        corrupted.data(), len, expected.data(), len, seq, 3);
+
+    EXPECT_EQ(ByteStuffUtils::destuff<StuffMethod::SSE2>(
+        corrupted.data(), len, out.data(), len, seq, 3), expectedLen);
+    EXPECT_TRUE(expectedLen < 0 || out == expected);
+    EXPECT_EQ(ByteStuffUtils::destuff<StuffMethod::AVX2>(
+        corrupted.data(), len, out.data(), len, seq, 3), expectedLen);
+    EXPECT_TRUE(expectedLen < 0 || out == expected);
+    EXPECT_EQ(ByteStuffUtils::destuff<StuffMethod::AVX2>(
+        corrupted.data(), len, nullptr, 0, seq, 3), expectedLen);
+  }
+}
+
+// A prefix ending the input lacks its escape, however close to the end
+TEST(ByteStuff, DestuffTrailingPrefix) {
+  const uint8_t seq[4] = {0x00, 0x01, 0x01, 0x01};
+  const uint8_t escByte = static_cast<uint8_t>(~seq[3]);
+  const uint8_t twoPrefixes[7] = {0x00, 0x01, 0x01, escByte,
+                                  0x00, 0x01, 0x01};
+  const uint8_t onePrefix[4] = {0xFF, 0x00, 0x01, 0x01};
+
+  EXPECT_EQ(ByteStuffUtils::destuff<StuffMethod::SCALAR>(
+      twoPrefixes, 7, nullptr, 0, seq, 4), -1);
+  EXPECT_EQ(ByteStuffUtils::destuff<StuffMethod::SSE2>(
+      twoPrefixes, 7, nullptr, 0, seq, 4), -1);
+  EXPECT_EQ(ByteStuffUtils::destuff<StuffMethod::AVX2>(
+      twoPrefixes, 7, nullptr, 0, seq, 4), -1);
+  EXPECT_EQ(ByteStuffUtils::destuff<StuffMethod::SCALAR>(
+      onePrefix, 4, nullptr, 0, seq, 4), -1);
+  EXPECT_EQ(ByteStuffUtils::destuff<StuffMethod::SSE2>(
+      onePrefix, 4, nullptr, 0, seq, 4), -1);
+  EXPECT_EQ(ByteStuffUtils::destuff<StuffMethod::AVX2>(
+      onePrefix, 4, nullptr, 0, seq, 4), -1);
+}
+
+// Random (mostly mis-stuffed) input must be validated the same way by every
+// method, at every length around the SIMD block sizes
+TEST(ByteStuff, DestuffDifferential) {
+  const uint8_t vals[4] = {0x00, 0x01, 0xFE, 0xFF};
+  vector<uint8_t> data(100), expected(100), out(100);
+
+  for (uint32_t i = 0; i < 200; i++) {
+    for (uint16_t seqSz = 2; seqSz <= 5; seqSz++) {
+      uint8_t seq[5] = {0};
+      fillFromVals(seq, seqSz, vals, 2);
+
+      for (uint32_t len = 0; len <= 100; len++) {
+        fillFromVals(data.data(), len, vals, 4);
+        const int64_t expectedLen =
+            ByteStuffUtils::destuff<StuffMethod::SCALAR>(
+                data.data(), len, expected.data(), len, seq, seqSz);
+
+        EXPECT_EQ(ByteStuffUtils::destuff<StuffMethod::SCALAR>(
+            data.data(), len, nullptr, 0, seq, seqSz), expectedLen);
+        EXPECT_EQ(ByteStuffUtils::destuff<StuffMethod::SSE2>(
+            data.data(), len, nullptr, 0, seq, seqSz), expectedLen);
+        EXPECT_EQ(ByteStuffUtils::destuff<StuffMethod::SSE2>(
+            data.data(), len, out.data(), len, seq, seqSz), expectedLen);
+        EXPECT_TRUE(expectedLen < 0 ||
+                    memcmp(out.data(), expected.data(),
+                           static_cast<size_t>(expectedLen)) == 0);
+        EXPECT_EQ(ByteStuffUtils::destuff<StuffMethod::AVX2>(
+            data.data(), len, nullptr, 0, seq, seqSz), expectedLen);
+        EXPECT_EQ(ByteStuffUtils::destuff<StuffMethod::AVX2>(
+            data.data(), len, out.data(), len, seq, seqSz), expectedLen);
+        EXPECT_TRUE(expectedLen < 0 ||
+                    memcmp(out.data(), expected.data(),
+                           static_cast<size_t>(expectedLen)) == 0);
+      }
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
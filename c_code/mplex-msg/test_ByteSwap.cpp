@@ -0,0 +1,86 @@
+#include "gtest/gtest.h"
+
+// C++ libs
+#include <random>
+#include <vector>
+
+// C libs
+#include <stdint.h>
+#include <string.h>
+
+// Lib to be tesed
+#include "byte_swap.hpp"
+
+using namespace std;
+using ByteSwapUtils::SwapMethod;
+
+// Checks copySwapped() against reversing each element by hand, for all
+// lengths up to 'maxN' & all misalignments of the source & destination
+template <size_t SIZE, SwapMethod method>
+void expectSwapped(size_t maxN) {
+  static default_random_engine eng(1);
+  static uniform_int_distribution<uint8_t> byteDistr;
+
+  for (size_t n = 0; n <= maxN; n++) {
+    for (size_t srcOff = 0; srcOff < 3; srcOff++) {
+      for (size_t dstOff = 0; dstOff < 3; dstOff++) {
+        vector<uint8_t> src(n * SIZE + srcOff);
+        for (uint8_t& byte : src) {
+          byte = byteDistr(eng);
+        }
+
+        // Guard bytes after the output must be left alone
+        vector<uint8_t> dst(n * SIZE + dstOff + 8, 0xA5);
+        vector<uint8_t> expected = dst;
+        for (size_t i = 0; i < n; i++) {
+          for (size_t k = 0; k < SIZE; k++) {
+            expected[dstOff + i * SIZE + k] =
+                src[srcOff + i * SIZE + SIZE - 1 - k];
+          }
+        }
+
+        ByteSwapUtils::copySwapped<SIZE, method>(dst.data() + dstOff,
+                                                 src.data() + srcOff, n);
+        ASSERT_EQ(dst, expected) << "SIZE " << SIZE << ", n " << n <<
+            ", offsets " << srcOff << "/" << dstOff;
+      }
+    }
+  }
+}
+
+template <SwapMethod method>
+void expectSwappedAllSizes() {
+  expectSwapped<2, method>(80);
+  expectSwapped<4, method>(40);
+  expectSwapped<8, method>(20);
+}
+
+TEST(ByteSwap, AllMethods) {
+  expectSwappedAllSizes<SwapMethod::SCALAR>();
+  expectSwappedAllSizes<SwapMethod::SSSE3>();
+  expectSwappedAllSizes<SwapMethod::AVX2>();
+  expectSwappedAllSizes<SwapMethod::AUTO>();
+}
+
+TEST(ByteSwap, MatchesBuiltins) {
+  const uint16_t a[2] = {0x0102, 0xA1B2};
+  const uint32_t b[2] = {0x01020304, 0xA1B2C3D4};
+  const uint64_t c[2] = {0x0102030405060708ULL, 0xA1B2C3D4E5F6A7B8ULL};
+  uint16_t a2[2];
+  uint32_t b2[2];
+  uint64_t c2[2];
+
+  ByteSwapUtils::copySwapped<2>(a2, a, 2);
+  ByteSwapUtils::copySwapped<4>(b2, b, 2);
+  ByteSwapUtils::copySwapped<8>(c2, c, 2);
+  for (size_t i = 0; i < 2; i++) {
+    EXPECT_EQ(a2[i], __builtin_bswap16(a[i]));
+    EXPECT_EQ(b2[i], __builtin_bswap32(b[i]));
+    EXPECT_EQ(c2[i], __builtin_bswap64(c[i]));
+  }
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
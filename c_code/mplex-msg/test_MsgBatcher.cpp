@@ -0,0 +1,382 @@
+#include "gtest/gtest.h"
+
+// C++ libs
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// C libs
+#include <stdint.h>
+#include <string.h>
+
+// Lib to be tesed
+#include "mplex_msg_batcher.hpp"
+
+using namespace std;
+
+typedef MplexMsgBatcher<MsgGroupHeader_v0, MsgFrameHeader_v0> batcher_t;
+typedef batcher_t::group_t group_t;
+typedef batcher_t::msg_t msg_t;
+typedef batcher_t::Producer producer_t;
+typedef vector<uint8_t> bytes_t;
+
+// A frame read back from an emitted group
+struct Received {
+  uint8_t id;
+  uint32_t tag;
+  uint16_t len;
+};
+
+// Sink that keeps a copy of each group, & reads back their frames
+struct Recorder {
+  mutex mtx;
+  vector<bytes_t> groups;
+  batcher_t::sink_t sink = [this](group_t& group) {
+    EXPECT_TRUE(group.headerIsValid());
+    lock_guard<mutex> lock(mtx);
+    groups.emplace_back(group.getBuf(),
+                        group.getBuf() + group.processedSize());
+  };
+
+  size_t numGroups() {
+    lock_guard<mutex> lock(mtx);
+    return groups.size();
+  }
+
+  vector<Received> frames() {
+    lock_guard<mutex> lock(mtx);
+    vector<Received> frames;
+    for (bytes_t& bytes : groups) {
+      group_t view(MPLEX_VIEW, bytes.data(),
+                   static_cast<uint16_t>(bytes.size()));
+      EXPECT_TRUE(view.headerIsValid());
+      EXPECT_EQ(view.calcGroupSize(), bytes.size());
+      size_t nFrames = 0;
+      msg_t* pMsg = view.currFrame();
+      if (pMsg != nullptr && pMsg->isValid() == false) {
+        pMsg = view.nextValidFrame();
+      }
+      for (; pMsg != nullptr && pMsg->isEndOfMsgGroup() == false;
+           pMsg = view.nextValidFrame()) {
+        uint32_t tag = 0;
+        EXPECT_TRUE(pMsg->readData(tag));
+        frames.push_back({static_cast<uint8_t>(pMsg->id()), tag,
+                          pMsg->len()});
+        nFrames++;
+      }
+      EXPECT_EQ(nFrames, view.numFrames());
+    }
+    return frames;
+  }
+};
+
+// Submits a frame holding 'tag', padded to 'len' bytes
+bool submitTag(producer_t& producer, uint8_t id, uint32_t tag,
+               uint16_t len) {
+  return producer.submit(id, len, [&](msg_t& frame) {
+    return frame.writeData(tag) &&
+           (len == sizeof(tag) || frame.claimWrite(len - sizeof(tag)));
+  });
+}
+
+// Groups are emitted as they fill up, w/ every frame in order
+TEST(MsgBatcher, SizeFlush) {
+  Recorder rec;
+  batcher_t::Policy policy;
+  policy.maxLatency = chrono::microseconds(0);
+  policy.stagingSize = 4000;
+  batcher_t batcher(rec.sink, policy);
+
+  const uint32_t NUM_FRAMES = 2000;
+  {
+    producer_t producer(batcher);
+    for (uint32_t i = 0; i < NUM_FRAMES; i++) {
+      uint16_t len = static_cast<uint16_t>(4 + i % 200);
+      ASSERT_TRUE(submitTag(producer, static_cast<uint8_t>(i % 100), i,
+                            len));
+    }
+    // Only groups that are full have been emitted
+    size_t nFull = rec.numGroups();
+    EXPECT_GT(nFull, 0U);
+    for (size_t i = 0; i < nFull; i++) {
+      EXPECT_GT(rec.groups[i].size() + sizeof(MsgFrameHeader_v0) + 203,
+                policy.maxGroupSize);
+    }
+  }
+  batcher.flush();
+
+  vector<Received> frames = rec.frames();
+  ASSERT_EQ(frames.size(), NUM_FRAMES);
+  for (uint32_t i = 0; i < NUM_FRAMES; i++) {
+    EXPECT_EQ(frames[i].id, i % 100);
+    EXPECT_EQ(frames[i].tag, i);
+    EXPECT_EQ(frames[i].len, 4 + i % 200);
+  }
+  for (const bytes_t& bytes : rec.groups) {
+    EXPECT_LE(bytes.size(), policy.maxGroupSize);
+  }
+
+  batcher_t::Stats stats = batcher.stats();
+  EXPECT_EQ(stats.groups, rec.groups.size());
+  EXPECT_EQ(stats.frames, NUM_FRAMES);
+  EXPECT_EQ(stats.timedFlushes, 1U);
+}
+
+// Frames from many threads all make it, each thread's in order
+TEST(MsgBatcher, MultiThread) {
+  const uint32_t NUM_THREADS = 4;
+  const uint32_t NUM_FRAMES = 20000;
+  Recorder rec;
+  {
+    batcher_t batcher(rec.sink);
+    vector<thread> threads;
+    for (uint32_t t = 0; t < NUM_THREADS; t++) {
+      threads.emplace_back([&batcher, t]() {
+        producer_t producer(batcher);
+        for (uint32_t i = 0; i < NUM_FRAMES; i++) {
+          uint32_t tag = (t << 24) | i;
+          EXPECT_TRUE(submitTag(producer, static_cast<uint8_t>(t), tag,
+                                static_cast<uint16_t>(4 + i % 16)));
+        }
+      });
+    }
+    for (thread& th : threads) {
+      th.join();
+    }
+  }
+
+  vector<Received> frames = rec.frames();
+  ASSERT_EQ(frames.size(), NUM_THREADS * NUM_FRAMES);
+  vector<uint32_t> next(NUM_THREADS, 0);
+  for (const Received& frame : frames) {
+    uint32_t t = frame.tag >> 24;
+    ASSERT_LT(t, NUM_THREADS);
+    EXPECT_EQ(frame.id, t);
+    EXPECT_EQ(frame.tag & 0xFFFFFF, next[t]);
+    next[t]++;
+  }
+}
+
+// A lone frame is emitted once it's due, w/o filling the group
+TEST(MsgBatcher, Deadline) {
+  Recorder rec;
+  batcher_t::Policy policy;
+  policy.maxLatency = chrono::milliseconds(5);
+  batcher_t batcher(rec.sink, policy);
+  producer_t producer(batcher);
+
+  auto start = chrono::steady_clock::now();
+  ASSERT_TRUE(submitTag(producer, 1, 42, 4));
+  while (rec.numGroups() == 0 &&
+         chrono::steady_clock::now() - start < chrono::seconds(5)) {
+    this_thread::sleep_for(chrono::microseconds(100));
+  }
+  chrono::duration<double, milli> latency = chrono::steady_clock::now() -
+                                            start;
+
+  vector<Received> frames = rec.frames();
+  ASSERT_EQ(frames.size(), 1U);
+  EXPECT_EQ(frames[0].tag, 42U);
+  EXPECT_EQ(batcher.stats().timedFlushes, 1U);
+  // Loose bound, for busy machines
+  EXPECT_LT(latency.count(), 500);
+  cout << "Emitted after " << latency.count() << " ms (max latency 5 ms)"
+       << endl;
+}
+
+// A sink run by the flush timer can construct a Producer & submit through it
+TEST(MsgBatcher, SinkSubmitsOnTimedFlush) {
+  const uint32_t NUM_ECHOES = 3;
+  Recorder rec;
+  atomic<uint32_t> echoes{0};
+  batcher_t* pBatcher = nullptr;
+  auto sink = [&](group_t& group) {
+    rec.sink(group);
+    uint32_t n = echoes.load();
+    if (n < NUM_ECHOES) {
+      echoes++;
+      producer_t echo(*pBatcher);
+      EXPECT_TRUE(submitTag(echo, 2, 100 + n, 4));
+    }
+  };
+
+  batcher_t::Policy policy;
+  policy.maxLatency = chrono::milliseconds(2);
+  batcher_t batcher(sink, policy);
+  pBatcher = &batcher;
+  {
+    producer_t producer(batcher);
+    ASSERT_TRUE(submitTag(producer, 1, 42, 4));
+  }
+
+  auto start = chrono::steady_clock::now();
+  while (rec.numGroups() < NUM_ECHOES + 1 &&
+         chrono::steady_clock::now() - start < chrono::seconds(5)) {
+    this_thread::sleep_for(chrono::microseconds(100));
+  }
+
+  vector<Received> frames = rec.frames();
+  ASSERT_EQ(frames.size(), NUM_ECHOES + 1);
+  EXPECT_EQ(frames[0].tag, 42U);
+  for (uint32_t i = 1; i <= NUM_ECHOES; i++) {
+    EXPECT_EQ(frames[i].id, 2U);
+    EXPECT_EQ(frames[i].tag, 100 + i - 1);
+  }
+}
+
+// A sink run by a full group can submit through the Producer that filled it
+TEST(MsgBatcher, SinkSubmitsThroughProducer) {
+  const uint32_t NUM_FRAMES = 2000;
+  const uint32_t NUM_ECHOES = 5;
+  Recorder rec;
+  uint32_t echoes = 0;
+  producer_t* pProducer = nullptr;
+  auto sink = [&](group_t& group) {
+    rec.sink(group);
+    if (echoes < NUM_ECHOES) {
+      EXPECT_TRUE(submitTag(*pProducer, 2, 100000 + echoes, 4));
+      echoes++;
+    }
+  };
+
+  batcher_t::Policy policy;
+  policy.maxLatency = chrono::microseconds(0);
+  batcher_t batcher(sink, policy);
+  {
+    producer_t producer(batcher);
+    pProducer = &producer;
+    for (uint32_t i = 0; i < NUM_FRAMES; i++) {
+      ASSERT_TRUE(submitTag(producer, 1, i, 32));
+    }
+  }
+  batcher.flush();
+  EXPECT_EQ(echoes, NUM_ECHOES);
+
+  vector<Received> frames = rec.frames();
+  ASSERT_EQ(frames.size(), NUM_FRAMES + NUM_ECHOES);
+  uint32_t next = 0;
+  uint32_t nextEcho = 0;
+  for (const Received& frame : frames) {
+    if (frame.id == 2) {
+      EXPECT_EQ(frame.tag, 100000 + nextEcho);
+      nextEcho++;
+    } else {
+      EXPECT_EQ(frame.tag, next);
+      next++;
+    }
+  }
+  EXPECT_EQ(next, NUM_FRAMES);
+  EXPECT_EQ(nextEcho, NUM_ECHOES);
+}
+
+TEST(MsgBatcher, Errors) {
+  Recorder rec;
+  EXPECT_THROW(batcher_t{batcher_t::sink_t()}, std::invalid_argument);
+
+  batcher_t::Policy policy;
+  policy.maxGroupSize = group_t::MIN_SIZE;
+  EXPECT_THROW((batcher_t{rec.sink, policy}), std::invalid_argument);
+  policy.maxGroupSize = 1472;
+  policy.stagingSize = 100;
+  EXPECT_THROW((batcher_t{rec.sink, policy}), std::invalid_argument);
+
+  policy.stagingSize = 0;
+  policy.maxLatency = chrono::microseconds(0);
+  batcher_t batcher(rec.sink, policy);
+  EXPECT_EQ(batcher.maxData(), 1472 - group_t::MIN_SIZE -
+                               sizeof(MsgFrameHeader_v0));
+  producer_t producer(batcher);
+
+  // Too large
+  bytes_t data(batcher.maxData() + 1U);
+  EXPECT_FALSE(producer.submit(1, data.data(),
+                               static_cast<uint16_t>(data.size())));
+  EXPECT_FALSE(producer.submit(1, nullptr, 4));
+  // Fill fails, or writes the wrong length
+  EXPECT_FALSE(producer.submit(1, 4, [](msg_t&) { return false; }));
+  EXPECT_FALSE(producer.submit(1, 8, [](msg_t& frame) {
+    return frame.writeData(uint32_t(1));
+  }));
+
+  // Largest & empty frames are fine
+  EXPECT_TRUE(producer.submit(2, data.data(), batcher.maxData()));
+  EXPECT_TRUE(producer.submit(3, nullptr, 0));
+  producer.flush();
+  batcher.flush();
+  EXPECT_EQ(batcher.stats().frames, 2U);
+  EXPECT_EQ(rec.numGroups(), 2U);
+}
+
+// Compares w/ threads sharing one group behind a mutex
+TEST(MsgBatcher, Throughput) {
+  const uint32_t NUM_THREADS = 4;
+  const uint32_t NUM_FRAMES = 200000;
+  atomic<uint64_t> nGroups{0};
+  auto count = [&nGroups](group_t&) { nGroups++; };
+
+  auto start = chrono::steady_clock::now();
+  {
+    batcher_t batcher(count);
+    vector<thread> threads;
+    for (uint32_t t = 0; t < NUM_THREADS; t++) {
+      threads.emplace_back([&batcher, t]() {
+        producer_t producer(batcher);
+        for (uint32_t i = 0; i < NUM_FRAMES; i++) {
+          uint32_t vals[4] = {t, i, i, i};
+          producer.submit(static_cast<uint8_t>(t), vals, sizeof(vals));
+        }
+      });
+    }
+    for (thread& th : threads) {
+      th.join();
+    }
+  }
+  chrono::duration<double> batchSecs = chrono::steady_clock::now() - start;
+  uint64_t batchGroups = nGroups.exchange(0);
+
+  start = chrono::steady_clock::now();
+  {
+    mutex mtx;
+    group_t group(1472);
+    vector<thread> threads;
+    for (uint32_t t = 0; t < NUM_THREADS; t++) {
+      threads.emplace_back([&, t]() {
+        for (uint32_t i = 0; i < NUM_FRAMES; i++) {
+          uint32_t vals[4] = {t, i, i, i};
+          lock_guard<mutex> lock(mtx);
+          msg_t* pMsg = group.currFrame();
+          if (pMsg->writeSpan(vals, 4) == false) {
+            group.writeHeaderTrailer();
+            count(group);
+            group.reset();
+            pMsg = group.currFrame();
+            pMsg->writeSpan(vals, 4);
+          }
+          pMsg->writeHeader(static_cast<uint8_t>(t));
+          if (group.commitFrame() == nullptr) {
+            group.writeHeaderTrailer();
+            count(group);
+            group.reset();
+          }
+        }
+      });
+    }
+    for (thread& th : threads) {
+      th.join();
+    }
+  }
+  chrono::duration<double> mutexSecs = chrono::steady_clock::now() - start;
+
+  double nFrames = double(NUM_THREADS) * NUM_FRAMES;
+  cout << "Batcher: " << nFrames / batchSecs.count() / 1e6 << " M frames/s ("
+       << batchGroups << " groups); mutex around one group: "
+       << nFrames / mutexSecs.count() / 1e6 << " M frames/s" << endl;
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,204 @@
+#include "gtest/gtest.h"
+
+// C++ libs
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// C libs
+#include <stdint.h>
+#include <string.h>
+
+// Lib to be tesed
+#include "mplex_msg_deframer.hpp"
+#include "../gtest-extras/msg_group_utils.hpp"
+
+// 1472 = 1500 - 20 - 8; to emulate MTU of 1500
+#define BUF_SIZE 1472
+
+using namespace std;
+
+typedef MplexMsgDeframer<MsgGroupHeader_v0, MsgFrameHeader_v0> deframer_t;
+typedef deframer_t::group_t group_t;
+typedef vector<uint8_t> bytes_t;
+
+// Writes a group of random-length frames into a 'sz'-byte buffer
+bytes_t writeGroup(default_random_engine& eng, uint16_t sz) {
+  return TestUtils::writeRandomGroup<group_t>(eng, sz);
+}
+
+void append(bytes_t& stream, const bytes_t& bytes) {
+  stream.insert(stream.end(), bytes.begin(), bytes.end());
+}
+
+// Deframer that records a copy of each group it emits
+struct Recorder {
+  vector<bytes_t> groups;
+  deframer_t deframer;
+
+  Recorder() : deframer([this](group_t& group) {
+      EXPECT_TRUE(group.isView());
+      EXPECT_TRUE(group.headerIsValid());
+      uint16_t sz = group.calcGroupSize();
+      groups.emplace_back(group.getBuf(), group.getBuf() + sz);
+    }) {}
+
+  void push(const bytes_t& stream, size_t chunkSz) {
+    for (size_t i = 0; i < stream.size(); i += chunkSz) {
+      deframer.push(stream.data() + i, min(chunkSz, stream.size() - i));
+    }
+  }
+};
+
+// Groups split arbitrarily across pushes come out whole, w/ noise skipped
+TEST(MsgDeframer, Chunked) {
+  default_random_engine eng(1);
+  uniform_int_distribution<uint16_t> szDistr(group_t::MIN_SIZE, 4 * BUF_SIZE);
+  uniform_int_distribution<uint8_t> byteDistr;
+
+  vector<bytes_t> groups;
+  bytes_t stream;
+  for (size_t i = 0; i < 200; i++) {
+    if (i % 3 == 0) {
+      bytes_t noise(i % 50);
+      for (uint8_t& byte : noise) {
+        byte = i % 2 ? MsgGroupHeader_v0::MAGIC_NUMBER : byteDistr(eng);
+      }
+      append(stream, noise);
+    }
+    groups.push_back(writeGroup(eng, szDistr(eng)));
+    append(stream, groups.back());
+  }
+
+  for (size_t chunkSz : {size_t(1), size_t(7), size_t(BUF_SIZE),
+                         stream.size()}) {
+    Recorder rec;
+    rec.push(stream, chunkSz);
+    ASSERT_EQ(rec.groups, groups);
+    EXPECT_EQ(rec.deframer.buffered(), 0U);
+
+    deframer_t::Stats stats = rec.deframer.stats();
+    EXPECT_EQ(stats.groups, groups.size());
+    EXPECT_LE(stats.bufferedBytes, stream.size());
+    if (chunkSz == stream.size()) {
+      EXPECT_EQ(stats.bufferedBytes, 0U);
+    }
+  }
+
+  // Random chunk sizes
+  Recorder rec;
+  uniform_int_distribution<size_t> chunkDistr(1, 3 * BUF_SIZE);
+  for (size_t i = 0; i < stream.size();) {
+    size_t n = min(chunkDistr(eng), stream.size() - i);
+    rec.deframer.push(stream.data() + i, n);
+    i += n;
+  }
+  EXPECT_EQ(rec.groups, groups);
+}
+
+// Corrupted groups are dropped w/o losing the ones around them
+TEST(MsgDeframer, Corruption) {
+  default_random_engine eng(2);
+  vector<bytes_t> groups;
+  for (int i = 0; i < 8; i++) {
+    groups.push_back(writeGroup(eng, BUF_SIZE));
+  }
+
+  groups[1][3] ^= 0x40;                                  // Group header
+  groups[3][sizeof(MsgGroupHeader_v0) + 10] ^= 0x01;     // Frame data
+  groups[5].back() ^= 0x80;                              // Trailer
+  groups[6].resize(groups[6].size() - 1);                // Truncated
+
+  bytes_t stream;
+  vector<bytes_t> expected;
+  for (size_t i = 0; i < groups.size(); i++) {
+    append(stream, groups[i]);
+    if (i != 1 && i != 3 && i != 5 && i != 6) {
+      expected.push_back(groups[i]);
+    }
+  }
+
+  for (size_t chunkSz : {size_t(1), size_t(100), stream.size()}) {
+    Recorder rec;
+    rec.push(stream, chunkSz);
+    EXPECT_EQ(rec.groups, expected);
+    EXPECT_GE(rec.deframer.stats().droppedBytes,
+              groups[1].size() + groups[3].size() + groups[5].size() +
+              groups[6].size());
+  }
+}
+
+// A rejected candidate leaves the ring's head mid-way, so the next large
+// group is buffered across the end of the ring
+TEST(MsgDeframer, RingWrap) {
+  default_random_engine eng(3);
+  bytes_t truncated = writeGroup(eng, 40000);
+  truncated.resize(truncated.size() - sizeof(MsgFrameHeader_v0));
+  bytes_t big = writeGroup(eng, 40000);
+  bytes_t small = writeGroup(eng, BUF_SIZE);
+
+  bytes_t stream;
+  append(stream, truncated);
+  append(stream, big);
+  append(stream, small);
+  append(stream, big);
+
+  Recorder rec;
+  rec.push(stream, 997);
+  ASSERT_EQ(rec.groups.size(), 3U);
+  EXPECT_EQ(rec.groups[0], big);
+  EXPECT_EQ(rec.groups[1], small);
+  EXPECT_EQ(rec.groups[2], big);
+  EXPECT_LE(rec.deframer.stats().bufferedBytes, stream.size());
+
+  // Partial groups can be discarded
+  rec.deframer.push(big.data(), 100);
+  EXPECT_EQ(rec.deframer.buffered(), 100U);
+  rec.deframer.reset();
+  EXPECT_EQ(rec.deframer.buffered(), 0U);
+  rec.deframer.push(small.data(), small.size());
+  EXPECT_EQ(rec.groups.size(), 4U);
+}
+
+TEST(MsgDeframer, Errors) {
+  EXPECT_THROW(deframer_t(deframer_t::callback_t()), std::invalid_argument);
+
+  Recorder rec;
+  rec.deframer.push(nullptr, 10);
+  bytes_t empty;
+  rec.deframer.push(empty.data(), 0);
+  EXPECT_EQ(rec.deframer.stats().groups, 0U);
+}
+
+// Deframes a stream of MTU-sized reads
+TEST(MsgDeframer, Throughput) {
+  const uint32_t NUM_LOOPS = 20;
+  default_random_engine eng(4);
+  bytes_t stream;
+  for (int i = 0; i < 500; i++) {
+    append(stream, writeGroup(eng, 3 * BUF_SIZE));
+  }
+
+  uint64_t nGroups = 0;
+  deframer_t deframer([&nGroups](group_t&) { nGroups++; });
+  auto start = chrono::steady_clock::now();
+  for (uint32_t i = 0; i < NUM_LOOPS; i++) {
+    for (size_t k = 0; k < stream.size(); k += BUF_SIZE) {
+      deframer.push(stream.data() + k, min<size_t>(BUF_SIZE,
+                                                   stream.size() - k));
+    }
+  }
+  chrono::duration<double> secs = chrono::steady_clock::now() - start;
+  EXPECT_EQ(nGroups, 500U * NUM_LOOPS);
+
+  cout << "Deframed " << static_cast<double>(stream.size()) * NUM_LOOPS /
+                         secs.count() / 1e6
+       << " MB/s" << endl;
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,290 @@
+#include "gtest/gtest.h"
+
+// C++ libs
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// C libs
+#include <stdint.h>
+#include <string.h>
+
+// Lib to be tesed
+#include "mplex_msg_dispatch.hpp"
+#include "../gtest-extras/msg_group_utils.hpp"
+
+// 1472 = 1500 - 20 - 8; to emulate MTU of 1500
+#define BUF_SIZE 1472
+
+using namespace std;
+
+typedef MplexMsgDispatcher<MsgGroupHeader_v0, MsgFrameHeader_v0> dispatcher_t;
+typedef dispatcher_t::group_t group_t;
+typedef dispatcher_t::msg_t msg_t;
+typedef dispatcher_t::FrameRef FrameRef;
+typedef vector<uint8_t> bytes_t;
+
+// A frame as written: its ID & a tag identifying it
+struct Sent {
+  uint8_t id;
+  uint32_t tag;
+};
+
+// Writes a group w/ frames of random IDs < 'nIds', each holding its tag
+bytes_t writeGroup(default_random_engine& eng, uint32_t groupNum,
+                   uint8_t nIds, vector<Sent>& sent) {
+  uniform_int_distribution<uint32_t> distr;
+  auto writeFrame = [&](msg_t& frame, size_t seq) {
+    uint8_t id = static_cast<uint8_t>(distr(eng) % nIds);
+    uint32_t tag = (groupNum << 16) | static_cast<uint32_t>(seq);
+    if (frame.writeData(tag) == false || frame.writeHeader(id) == false) {
+      return false;
+    }
+    sent.push_back({id, tag});
+    return true;
+  };
+
+  return TestUtils::writeGroup<group_t>(BUF_SIZE, writeFrame);
+}
+
+uint32_t readTag(const uint8_t* data) {
+  uint32_t tag;
+  memcpy(&tag, data, sizeof(tag));
+  return be32toh(tag);
+}
+
+// Each frame goes to its ID's handler, in order; the rest are counted
+TEST(MsgDispatch, Dispatch) {
+  default_random_engine eng(1);
+  vector<Sent> sent;
+  vector<bytes_t> groups;
+  for (uint32_t i = 0; i < 20; i++) {
+    groups.push_back(writeGroup(eng, i, 8, sent));
+  }
+
+  vector<Sent> received;
+  auto record = [&received](msg_t& frame) {
+    uint32_t tag = 0;
+    EXPECT_TRUE(frame.readData(tag));
+    received.push_back({static_cast<uint8_t>(frame.id()), tag});
+  };
+
+  dispatcher_t dispatcher;
+  for (uint8_t id = 0; id < 6; id++) {
+    dispatcher.onFrame(id, record);
+  }
+  // Registered, then removed
+  dispatcher.onFrame(7, record);
+  dispatcher.onFrame(7, nullptr);
+
+  size_t nHandled = 0;
+  for (bytes_t& bytes : groups) {
+    group_t view(MPLEX_VIEW, bytes.data(),
+                 static_cast<uint16_t>(bytes.size()));
+    nHandled += dispatcher.dispatch(view);
+  }
+
+  vector<Sent> expected;
+  for (const Sent& frame : sent) {
+    if (frame.id < 6) {
+      expected.push_back(frame);
+    }
+  }
+  ASSERT_EQ(received.size(), expected.size());
+  EXPECT_EQ(nHandled, expected.size());
+  for (size_t i = 0; i < expected.size(); i++) {
+    EXPECT_EQ(received[i].id, expected[i].id);
+    EXPECT_EQ(received[i].tag, expected[i].tag);
+  }
+  EXPECT_EQ(dispatcher.unhandled(), sent.size() - expected.size());
+}
+
+// All frames of an ID across groups are delivered together, in order
+TEST(MsgDispatch, Batch) {
+  default_random_engine eng(2);
+  dispatcher_t dispatcher;
+  vector<vector<uint32_t>> received(dispatcher_t::NUM_IDS);
+  size_t nCalls = 0;
+  auto record = [&](dispatcher_t::id_t id, const FrameRef* frames,
+                    size_t n) {
+    EXPECT_GT(n, 0U);
+    nCalls++;
+    for (size_t i = 0; i < n; i++) {
+      EXPECT_EQ(frames[i].len, sizeof(uint32_t));
+      EXPECT_EQ(frames[i].group, readTag(frames[i].data) >> 16);
+      received[id].push_back(readTag(frames[i].data));
+    }
+  };
+
+  // Include the highest ID, which is also the End of Message Group ID
+  const uint8_t MAX_ID = MsgFrameHeader_v0::END_OF_GROUP_ID;
+  for (uint8_t id = 0; id < 10; id++) {
+    dispatcher.onBatch(id, record);
+  }
+  dispatcher.onBatch(MAX_ID, record);
+
+  for (int round = 0; round < 2; round++) {
+    vector<Sent> sent;
+    vector<bytes_t> groups;
+    for (uint32_t i = 0; i < 30; i++) {
+      groups.push_back(writeGroup(eng, i, 12, sent));
+    }
+    // Add a group of frames w/ the highest ID
+    {
+      group_t msgGroup(BUF_SIZE);
+      for (uint32_t seq = 0; seq < 3; seq++) {
+        msg_t* pMsg = msgGroup.currFrame();
+        uint32_t tag = (30U << 16) | seq;
+        ASSERT_TRUE(pMsg->writeData(tag));
+        ASSERT_TRUE(pMsg->writeHeader(MAX_ID));
+        msgGroup.commitFrame();
+        sent.push_back({MAX_ID, tag});
+      }
+      msgGroup.writeHeaderTrailer();
+      groups.emplace_back(msgGroup.getBuf(),
+                          msgGroup.getBuf() + msgGroup.processedSize());
+    }
+
+    size_t nCollected = 0;
+    for (bytes_t& bytes : groups) {
+      group_t view(MPLEX_VIEW, bytes.data(),
+                   static_cast<uint16_t>(bytes.size()));
+      nCollected += dispatcher.collect(view);
+    }
+    EXPECT_EQ(nCalls, 0U);
+
+    vector<vector<uint32_t>> expected(dispatcher_t::NUM_IDS);
+    for (const Sent& frame : sent) {
+      if (frame.id < 10 || frame.id == MAX_ID) {
+        expected[frame.id].push_back(frame.tag);
+      }
+    }
+    size_t nIds = 0;
+    size_t nExpected = 0;
+    for (const vector<uint32_t>& tags : expected) {
+      if (tags.empty() == false) {
+        nIds++;
+      }
+      nExpected += tags.size();
+    }
+
+    EXPECT_EQ(nCollected, nExpected);
+    EXPECT_EQ(dispatcher.flush(), nExpected);
+    EXPECT_EQ(nCalls, nIds);
+    EXPECT_EQ(received, expected);
+
+    // Nothing left to deliver
+    EXPECT_EQ(dispatcher.flush(), 0U);
+    EXPECT_EQ(nCalls, nIds);
+
+    nCalls = 0;
+    for (vector<uint32_t>& tags : received) {
+      tags.clear();
+    }
+  }
+
+  // Removing a handler drops frames already collected for it
+  vector<Sent> sent;
+  bytes_t bytes = writeGroup(eng, 0, 1, sent);
+  group_t view(MPLEX_VIEW, bytes.data(), static_cast<uint16_t>(bytes.size()));
+  uint64_t unhandled = dispatcher.unhandled();
+  EXPECT_EQ(dispatcher.collect(view), sent.size());
+  dispatcher.onBatch(0, nullptr);
+  EXPECT_EQ(dispatcher.flush(), 0U);
+  EXPECT_EQ(nCalls, 0U);
+  EXPECT_EQ(dispatcher.unhandled(), unhandled + sent.size());
+}
+
+// Corrupted frames are skipped
+TEST(MsgDispatch, Corruption) {
+  default_random_engine eng(3);
+  vector<Sent> sent;
+  bytes_t bytes = writeGroup(eng, 0, 4, sent);
+  ASSERT_GT(sent.size(), 2U);
+  // Corrupt the data of the 2nd frame
+  bytes[sizeof(MsgGroupHeader_v0) + 2 * sizeof(MsgFrameHeader_v0) +
+        sizeof(uint32_t)] ^= 0x01;
+
+  uint32_t nFrames = 0;
+  auto count = [&nFrames](msg_t&) { nFrames++; };
+  dispatcher_t dispatcher;
+  for (uint8_t id = 0; id < 4; id++) {
+    dispatcher.onFrame(id, count);
+  }
+  group_t view(MPLEX_VIEW, bytes.data(), static_cast<uint16_t>(bytes.size()));
+  EXPECT_EQ(dispatcher.dispatch(view), sent.size() - 1);
+  EXPECT_EQ(nFrames, sent.size() - 1);
+  EXPECT_EQ(dispatcher.unhandled(), 0U);
+}
+
+// Compares dispatching one frame at a time w/ dispatching in batches
+TEST(MsgDispatch, Throughput) {
+  const uint32_t NUM_LOOPS = 2000;
+  default_random_engine eng(4);
+  vector<Sent> sent;
+  vector<bytes_t> groups;
+  for (uint32_t i = 0; i < 50; i++) {
+    groups.push_back(writeGroup(eng, i, 16, sent));
+  }
+
+  uint64_t sums[16] = {};
+  auto add = [&sums](msg_t& frame) {
+    uint32_t tag = 0;
+    EXPECT_TRUE(frame.readData(tag));
+    sums[static_cast<uint8_t>(frame.id())] += tag;
+  };
+  dispatcher_t dispatcher;
+  for (uint8_t id = 0; id < 16; id++) {
+    dispatcher.onFrame(id, add);
+  }
+
+  auto start = chrono::steady_clock::now();
+  for (uint32_t i = 0; i < NUM_LOOPS; i++) {
+    for (bytes_t& bytes : groups) {
+      group_t view(MPLEX_VIEW, bytes.data(),
+                   static_cast<uint16_t>(bytes.size()));
+      dispatcher.dispatch(view);
+    }
+  }
+  chrono::duration<double> dispatchSecs = chrono::steady_clock::now() - start;
+
+  uint64_t batchSum = 0;
+  auto sum = [&batchSum](dispatcher_t::id_t, const FrameRef* frames,
+                         size_t n) {
+    for (size_t i = 0; i < n; i++) {
+      batchSum += readTag(frames[i].data);
+    }
+  };
+  for (uint8_t id = 0; id < 16; id++) {
+    dispatcher.onBatch(id, sum);
+  }
+
+  start = chrono::steady_clock::now();
+  for (uint32_t i = 0; i < NUM_LOOPS; i++) {
+    for (bytes_t& bytes : groups) {
+      group_t view(MPLEX_VIEW, bytes.data(),
+                   static_cast<uint16_t>(bytes.size()));
+      dispatcher.collect(view);
+    }
+    dispatcher.flush();
+  }
+  chrono::duration<double> batchSecs = chrono::steady_clock::now() - start;
+
+  uint64_t total = 0;
+  for (uint64_t s : sums) {
+    total += s;
+  }
+  EXPECT_EQ(total, batchSum);
+
+  double nFrames = static_cast<double>(sent.size()) * NUM_LOOPS;
+  cout << "Dispatched " << nFrames / dispatchSecs.count() / 1e6
+       << " M frames/s one at a time, "
+       << nFrames / batchSecs.count() / 1e6 << " M frames/s in batches"
+       << endl;
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
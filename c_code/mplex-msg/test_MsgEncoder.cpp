@@ -0,0 +1,208 @@
+#include "gtest/gtest.h"
+
+// C++ libs
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// C libs
+#include <stdint.h>
+#include <string.h>
+
+// Lib to be tesed
+#include "mplex_msg_encoder.hpp"
+
+using namespace std;
+
+typedef MplexMsgGroupEncoder<MsgGroupHeader_v0, MsgFrameHeader_v0> encoder_t;
+typedef encoder_t::group_t group_t;
+typedef encoder_t::FrameSpec spec_t;
+typedef vector<uint8_t> bytes_t;
+
+// Frames of random data, w/ their specs
+struct TestFrames {
+  vector<spec_t> specs;
+  vector<bytes_t> data;
+
+  TestFrames(default_random_engine& eng, size_t n, uint16_t maxLen) {
+    uniform_int_distribution<uint16_t> lenDistr(0, maxLen);
+    uniform_int_distribution<uint8_t> byteDistr;
+    for (size_t i = 0; i < n; i++) {
+      data.emplace_back(lenDistr(eng));
+      for (uint8_t& byte : data.back()) {
+        byte = byteDistr(eng);
+      }
+      specs.push_back({static_cast<uint8_t>(i % 100),
+                       static_cast<uint16_t>(data.back().size())});
+    }
+  }
+
+  encoder_t::fill_t filler() const {
+    return [this](size_t idx, group_t::msg_t& frame) {
+      return frame.writeSpan(data[idx].data(), data[idx].size());
+    };
+  }
+
+  // The serial path
+  void writeTo(group_t& group) const {
+    auto pMsg = group.currFrame();
+    for (size_t i = 0; i < data.size(); i++) {
+      ASSERT_TRUE(pMsg != nullptr);
+      ASSERT_TRUE(pMsg->writeSpan(data[i].data(), data[i].size()));
+      ASSERT_TRUE(pMsg->writeHeader(specs[i].id));
+      pMsg = group.commitFrame();
+    }
+    ASSERT_TRUE(group.writeHeaderTrailer());
+  }
+};
+
+// Everything but the header's timestamp & CRC must match
+void expectSameGroup(group_t& a, group_t& b) {
+  ASSERT_TRUE(a.headerIsValid());
+  ASSERT_TRUE(b.headerIsValid());
+  EXPECT_EQ(a.numFrames(), b.numFrames());
+  EXPECT_EQ(a.hlen(), b.hlen());
+  ASSERT_EQ(a.processedSize(), b.processedSize());
+  EXPECT_TRUE(memcmp(a.getBuf() + sizeof(MsgGroupHeader_v0),
+                     b.getBuf() + sizeof(MsgGroupHeader_v0),
+                     a.processedSize() - sizeof(MsgGroupHeader_v0)) == 0);
+}
+
+TEST(MsgEncoder, MatchesSerial) {
+  default_random_engine eng(1);
+  for (size_t nWorkers : {size_t(0), size_t(1), size_t(3)}) {
+    encoder_t encoder(nWorkers);
+    EXPECT_EQ(encoder.numWorkers(), nWorkers);
+    for (size_t n : {size_t(0), size_t(1), size_t(7), size_t(60)}) {
+      TestFrames frames(eng, n, 1000);
+      group_t serial;
+      frames.writeTo(serial);
+
+      group_t parallel;
+      ASSERT_TRUE(encoder.encode(parallel, frames.specs, frames.filler()));
+      expectSameGroup(serial, parallel);
+
+      // Frames read back as usual
+      group_t view(MPLEX_VIEW, parallel.getBuf(), parallel.processedSize());
+      size_t nRead = 0;
+      for (auto pMsg = view.currFrame();
+           pMsg != nullptr && pMsg->isEndOfMsgGroup() == false;
+           pMsg = view.nextValidFrame(), nRead++) {
+        ASSERT_TRUE(pMsg->isValid());
+        EXPECT_EQ(uint32_t(pMsg->id()), uint32_t(frames.specs[nRead].id));
+      }
+      EXPECT_EQ(nRead, n);
+    }
+  }
+}
+
+// Frames of many groups are spread across the pool in one go
+TEST(MsgEncoder, Batch) {
+  default_random_engine eng(2);
+  encoder_t encoder(3);
+  const size_t NUM_GROUPS = 50;
+
+  vector<TestFrames> frames;
+  vector<group_t> groups(NUM_GROUPS);
+  vector<encoder_t::GroupJob> jobs;
+  for (size_t i = 0; i < NUM_GROUPS; i++) {
+    frames.emplace_back(eng, i % 20, 200);
+  }
+  for (size_t i = 0; i < NUM_GROUPS; i++) {
+    jobs.push_back({&groups[i], frames[i].specs.data(),
+                    frames[i].specs.size(), frames[i].filler(), false});
+  }
+  ASSERT_TRUE(encoder.encode(jobs.data(), jobs.size()));
+
+  for (size_t i = 0; i < NUM_GROUPS; i++) {
+    EXPECT_TRUE(jobs[i].ok);
+    group_t serial;
+    frames[i].writeTo(serial);
+    expectSameGroup(serial, groups[i]);
+  }
+}
+
+TEST(MsgEncoder, Errors) {
+  default_random_engine eng(3);
+  encoder_t encoder(2);
+  TestFrames frames(eng, 10, 100);
+
+  // Filled w/ fewer bytes than specified
+  vector<spec_t> specs = frames.specs;
+  specs[5].len = static_cast<uint16_t>(specs[5].len + 1);
+  group_t group;
+  EXPECT_FALSE(encoder.encode(group, specs, frames.filler()));
+
+  // Filled w/ more bytes than specified
+  specs = frames.specs;
+  specs[3].len = 0;
+  frames.data[3].resize(1);
+  group.reset();
+  EXPECT_FALSE(encoder.encode(group, specs, frames.filler()));
+
+  // Frames that don't fit in the group
+  group_t small(group_t::MIN_SIZE + 100);
+  specs.assign(2, {1, 60});
+  EXPECT_FALSE(encoder.encode(small, specs, [](size_t, group_t::msg_t&) {
+    return true;
+  }));
+
+  // Failed fill(), or none at all
+  group.reset();
+  EXPECT_FALSE(encoder.encode(group, frames.specs,
+                              [](size_t idx, group_t::msg_t&) {
+    return idx != 2;
+  }));
+  group.reset();
+  EXPECT_FALSE(encoder.encode(group, frames.specs, encoder_t::fill_t()));
+
+  // Failures don't affect the rest of a batch
+  group_t groups[2];
+  encoder_t::GroupJob jobs[2] = {
+    {&groups[0], frames.specs.data(), 2,
+     [](size_t, group_t::msg_t&) { return false; }, true},
+    {&groups[1], frames.specs.data(), 2, frames.filler(), false}
+  };
+  EXPECT_FALSE(encoder.encode(jobs, 2));
+  EXPECT_FALSE(jobs[0].ok);
+  EXPECT_TRUE(jobs[1].ok);
+  EXPECT_TRUE(groups[1].headerIsValid());
+}
+
+// Builds groups of MTU-sized frames serially vs w/ the encoder
+TEST(MsgEncoder, Throughput) {
+  const uint32_t NUM_LOOPS = 200;
+  const size_t NUM_WORKERS = 3;
+  default_random_engine eng(4);
+  TestFrames frames(eng, 40, 1400);
+  group_t group;
+
+  auto start = chrono::steady_clock::now();
+  for (uint32_t i = 0; i < NUM_LOOPS; i++) {
+    group.reset();
+    frames.writeTo(group);
+  }
+  chrono::duration<double, micro> serialUs =
+      chrono::steady_clock::now() - start;
+
+  encoder_t encoder(NUM_WORKERS);
+  encoder_t::fill_t fill = frames.filler();
+  start = chrono::steady_clock::now();
+  for (uint32_t i = 0; i < NUM_LOOPS; i++) {
+    group.reset();
+    encoder.encode(group, frames.specs, fill);
+  }
+  chrono::duration<double, micro> parallelUs =
+      chrono::steady_clock::now() - start;
+
+  cout << "Serial: " << serialUs.count() / NUM_LOOPS << " us/group, "
+       << NUM_WORKERS << " workers: " << parallelUs.count() / NUM_LOOPS
+       << " us/group (" << thread::hardware_concurrency() << " CPUs)"
+       << endl;
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,298 @@
+#include "gtest/gtest.h"
+
+// C++ libs
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+
+// C libs
+#include <stdint.h>
+#include <string.h>
+
+// Lib to be tesed
+#include "mplex_msg_fragment.hpp"
+
+using namespace std;
+
+typedef MplexMsgFragmenter<MsgGroupHeader_v1> fragmenter_t;
+typedef MplexMsgReassembler<MsgGroupHeader_v1> reassembler_t;
+typedef reassembler_t::group_t group_t;
+typedef reassembler_t::Message Message;
+typedef vector<uint8_t> bytes_t;
+
+const uint8_t FRAG_ID = 9;
+
+bytes_t randomBytes(default_random_engine& eng, size_t sz) {
+  uniform_int_distribution<uint16_t> distr(0, 255);
+  bytes_t bytes(sz);
+  for (uint8_t& byte : bytes) {
+    byte = static_cast<uint8_t>(distr(eng));
+  }
+  return bytes;
+}
+
+// Writes all of a message's fragments, in groups of 'groupSz' Bytes
+vector<bytes_t> fragment(fragmenter_t& fragmenter, uint16_t groupSz) {
+  vector<bytes_t> groups;
+  while (fragmenter.done() == false) {
+    group_t msgGroup(groupSz);
+    EXPECT_GT(fragmenter.writeTo(msgGroup, FRAG_ID), 0U);
+    EXPECT_TRUE(msgGroup.writeHeaderTrailer());
+    groups.emplace_back(msgGroup.getBuf(),
+                        msgGroup.getBuf() + msgGroup.processedSize());
+  }
+  return groups;
+}
+
+size_t push(reassembler_t& reassembler, bytes_t& bytes) {
+  group_t view(MPLEX_VIEW, bytes.data(), static_cast<uint16_t>(bytes.size()));
+  EXPECT_TRUE(view.headerIsValid());
+  return reassembler.push(view);
+}
+
+// Keeps a copy of each message handed over
+struct Recorder {
+  vector<uint32_t> seqs;
+  vector<bytes_t> messages;
+  reassembler_t::callback_t callback = [this](const Message& msg) {
+    size_t total = 0;
+    for (size_t i = 0; i < msg.nSpans; i++) {
+      total += msg.spans[i].len;
+    }
+    EXPECT_EQ(total, msg.size);
+    seqs.push_back(msg.seq);
+    messages.emplace_back(msg.size);
+    msg.copyTo(messages.back().data());
+  };
+};
+
+TEST(MsgFragment, Fragmenter) {
+  bytes_t data(1000, 0x5A);
+  fragmenter_t fragmenter(data.data(), data.size(), 7, 116);
+  // 10 fragments of 100 Bytes
+  EXPECT_EQ(fragmenter.numFragments(), 10U);
+  EXPECT_EQ(fragmenter.frameLen(0), 116);
+  EXPECT_EQ(fragmenter.frameLen(9), 116);
+
+  // Evenly spread, w/ the remainder in the last
+  fragmenter_t uneven(data.data(), 950, 7, 116);
+  EXPECT_EQ(uneven.numFragments(), 10U);
+  EXPECT_EQ(uneven.frameLen(0), 16 + 95);
+  EXPECT_EQ(uneven.frameLen(9), 16 + 95);
+  fragmenter_t last(data.data(), 901, 7, 116);
+  EXPECT_EQ(last.numFragments(), 10U);
+  EXPECT_EQ(last.frameLen(0), 16 + 91);
+  EXPECT_EQ(last.frameLen(9), 16 + 82);
+
+  const uint16_t headerSz = fragmenter_t::HEADER_SIZE;
+  fragmenter_t empty(nullptr, 0, 7);
+  EXPECT_EQ(empty.numFragments(), 1U);
+  EXPECT_EQ(empty.frameLen(0), headerSz);
+
+  // Header layout
+  group_t msgGroup;
+  group_t::msg_t* pMsg = msgGroup.currFrame();
+  ASSERT_TRUE(fragmenter.writeFragment(3, *pMsg));
+  EXPECT_FALSE(fragmenter.writeFragment(10, *pMsg));
+  const uint8_t expected[] = {0, 0, 0, 7, 0, 0, 0x03, 0xE8,
+                              0, 0, 0, 3, 0, 0, 0, 10, 0x5A};
+  EXPECT_EQ(memcmp(pMsg->getData(), expected, sizeof(expected)), 0);
+
+  EXPECT_THROW((fragmenter_t{nullptr, 1, 0}), std::invalid_argument);
+  EXPECT_THROW((fragmenter_t{data.data(), data.size(), 0, 16}),
+               std::invalid_argument);
+  const uint16_t maxFrameData = fragmenter_t::MAX_FRAME_DATA;
+  EXPECT_THROW((fragmenter_t{data.data(), data.size(), 0,
+                             static_cast<uint16_t>(maxFrameData + 1)}),
+               std::invalid_argument);
+  EXPECT_THROW(reassembler_t(FRAG_ID, reassembler_t::callback_t()),
+               std::invalid_argument);
+
+  // Fragments sized for larger groups than given are an error, rather than
+  // never getting written
+  bytes_t big(100000, 0x5A);
+  fragmenter_t maxSized(big.data(), big.size(), 8);
+  group_t mtuGroup(1472);
+  EXPECT_THROW(maxSized.writeTo(mtuGroup, FRAG_ID), std::invalid_argument);
+  fragmenter_t mtuSized(big.data(), big.size(), 8,
+      static_cast<uint16_t>(1472 - group_t::MIN_SIZE -
+                            sizeof(MsgFrameHeader_v1)));
+  EXPECT_EQ(mtuSized.writeTo(mtuGroup, FRAG_ID), 1U);
+}
+
+// A multi-MB message is rebuilt from groups in any order
+TEST(MsgFragment, LargeMessage) {
+  default_random_engine eng(1);
+  bytes_t data = randomBytes(eng, 3000000);
+  fragmenter_t fragmenter(data.data(), data.size(), 1);
+  vector<bytes_t> groups = fragment(fragmenter, group_t::MAX_SIZE);
+  EXPECT_GT(groups.size(), 40U);
+
+  Recorder rec;
+  reassembler_t reassembler(FRAG_ID, rec.callback);
+  shuffle(groups.begin(), groups.end(), eng);
+  // A repeated group adds nothing
+  groups.insert(groups.begin() + 5, groups[2]);
+  size_t nMessages = 0;
+  for (size_t i = 0; i < groups.size(); i++) {
+    EXPECT_EQ(reassembler.numPartial(), i == 0 ? 0U : 1U);
+    nMessages += push(reassembler, groups[i]);
+  }
+
+  EXPECT_EQ(nMessages, 1U);
+  ASSERT_EQ(rec.messages.size(), 1U);
+  EXPECT_EQ(rec.seqs[0], 1U);
+  EXPECT_TRUE(rec.messages[0] == data);
+
+  reassembler_t::Stats stats = reassembler.stats();
+  EXPECT_EQ(stats.messages, 1U);
+  EXPECT_EQ(stats.zeroCopy, 0U);
+  EXPECT_GT(stats.dropped, 0U);
+  EXPECT_EQ(stats.bufferedBytes, 0U);
+  EXPECT_EQ(reassembler.numPartial(), 0U);
+}
+
+// Messages w/in a group are handed over as spans of the group's buffer
+TEST(MsgFragment, ZeroCopy) {
+  default_random_engine eng(2);
+  vector<bytes_t> data;
+  vector<fragmenter_t> fragmenters;
+  for (uint32_t seq = 0; seq < 4; seq++) {
+    data.push_back(randomBytes(eng, 500U * seq));
+  }
+  for (uint32_t seq = 0; seq < 4; seq++) {
+    fragmenters.emplace_back(data[seq].data(), data[seq].size(), seq, 416);
+  }
+
+  // Fragments of other messages & frames of other IDs in between
+  group_t msgGroup;
+  for (uint32_t i = 0; i < 4; i++) {
+    for (uint32_t seq = 0; seq < 4; seq++) {
+      if (i < fragmenters[seq].numFragments()) {
+        group_t::msg_t* pMsg = msgGroup.currFrame();
+        ASSERT_TRUE(fragmenters[seq].writeFragment(i, *pMsg));
+        ASSERT_TRUE(pMsg->writeHeader(FRAG_ID));
+        msgGroup.commitFrame();
+      }
+      group_t::msg_t* pMsg = msgGroup.currFrame();
+      ASSERT_TRUE(pMsg->writeData(i));
+      ASSERT_TRUE(pMsg->writeHeader(1));
+      msgGroup.commitFrame();
+    }
+  }
+  ASSERT_TRUE(msgGroup.writeHeaderTrailer());
+  bytes_t bytes(msgGroup.getBuf(),
+                msgGroup.getBuf() + msgGroup.processedSize());
+
+  vector<size_t> nSpans;
+  Recorder rec;
+  reassembler_t reassembler(FRAG_ID, [&](const Message& msg) {
+    for (size_t i = 0; i < msg.nSpans; i++) {
+      EXPECT_GE(msg.spans[i].data, bytes.data());
+      EXPECT_LE(msg.spans[i].data + msg.spans[i].len,
+                bytes.data() + bytes.size());
+    }
+    nSpans.push_back(msg.nSpans);
+    rec.callback(msg);
+  });
+  EXPECT_EQ(push(reassembler, bytes), 4U);
+
+  EXPECT_EQ(rec.seqs, vector<uint32_t>({0, 1, 2, 3}));
+  EXPECT_EQ(nSpans, vector<size_t>({1, 2, 3, 4}));
+  EXPECT_EQ(rec.messages, data);
+  EXPECT_EQ(reassembler.stats().zeroCopy, 4U);
+  EXPECT_EQ(reassembler.numPartial(), 0U);
+}
+
+// Corrupted & lost fragments leave partial messages, which time out
+TEST(MsgFragment, Timeout) {
+  default_random_engine eng(3);
+  bytes_t data = randomBytes(eng, 20000);
+  fragmenter_t first(data.data(), data.size(), 1, 1016);
+  fragmenter_t second(data.data(), data.size(), 2, 1016);
+  vector<bytes_t> firstGroups = fragment(first, 4000);
+  vector<bytes_t> secondGroups = fragment(second, 4000);
+  ASSERT_GT(firstGroups.size(), 2U);
+
+  // Corrupt a fragment's data in the 1st message, & lose a group of the 2nd
+  firstGroups[1][sizeof(MsgGroupHeader_v1) + sizeof(MsgFrameHeader_v1) +
+                 100] ^= 0x01;
+  secondGroups.pop_back();
+
+  Recorder rec;
+  reassembler_t::Limits limits;
+  limits.timeout = chrono::milliseconds(20);
+  reassembler_t reassembler(FRAG_ID, rec.callback, limits);
+  for (size_t i = 0; i < firstGroups.size(); i++) {
+    push(reassembler, firstGroups[i]);
+    if (i < secondGroups.size()) {
+      push(reassembler, secondGroups[i]);
+    }
+  }
+  EXPECT_EQ(reassembler.numPartial(), 2U);
+  EXPECT_EQ(reassembler.stats().bufferedBytes, 2 * data.size());
+
+  reassembler.expire();
+  EXPECT_EQ(reassembler.numPartial(), 2U);
+  this_thread::sleep_for(chrono::milliseconds(30));
+  reassembler.expire();
+  EXPECT_EQ(reassembler.numPartial(), 0U);
+
+  reassembler_t::Stats stats = reassembler.stats();
+  EXPECT_EQ(stats.messages, 0U);
+  EXPECT_EQ(stats.expired, 2U);
+  EXPECT_EQ(stats.bufferedBytes, 0U);
+  EXPECT_TRUE(rec.messages.empty());
+}
+
+// Partial messages are kept under the memory limit
+TEST(MsgFragment, Limits) {
+  default_random_engine eng(4);
+  bytes_t data = randomBytes(eng, 10000);
+  reassembler_t::Limits limits;
+  limits.maxMessageSize = 20000;
+  limits.maxBuffered = 25000;
+  Recorder rec;
+  reassembler_t reassembler(FRAG_ID, rec.callback, limits);
+
+  // Too large
+  bytes_t big = randomBytes(eng, 20001);
+  fragmenter_t bigFragmenter(big.data(), big.size(), 100, 1016);
+  vector<bytes_t> bigGroups = fragment(bigFragmenter, 4000);
+  for (bytes_t& bytes : bigGroups) {
+    push(reassembler, bytes);
+  }
+  EXPECT_EQ(reassembler.numPartial(), 0U);
+  EXPECT_EQ(reassembler.stats().dropped, bigFragmenter.numFragments());
+
+  // Start 3 messages; the 3rd evicts the 1st
+  vector<vector<bytes_t>> groups;
+  for (uint32_t seq = 0; seq < 3; seq++) {
+    fragmenter_t fragmenter(data.data(), data.size(), seq, 1016);
+    groups.push_back(fragment(fragmenter, 4000));
+    ASSERT_GT(groups.back().size(), 1U);
+    push(reassembler, groups.back()[0]);
+    this_thread::sleep_for(chrono::milliseconds(1));
+  }
+  EXPECT_EQ(reassembler.numPartial(), 2U);
+  EXPECT_EQ(reassembler.stats().evicted, 1U);
+  EXPECT_LE(reassembler.stats().bufferedBytes, limits.maxBuffered);
+
+  // The others complete
+  for (uint32_t seq = 1; seq < 3; seq++) {
+    for (size_t i = 1; i < groups[seq].size(); i++) {
+      push(reassembler, groups[seq][i]);
+    }
+  }
+  EXPECT_EQ(rec.seqs, vector<uint32_t>({1, 2}));
+  EXPECT_TRUE(rec.messages[0] == data);
+  EXPECT_TRUE(rec.messages[1] == data);
+  EXPECT_EQ(reassembler.stats().bufferedBytes, 0U);
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
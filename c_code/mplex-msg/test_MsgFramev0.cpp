@@ -2,6 +2,7 @@
 #include "gtest/gtest-spi.h"
 
 // C++ libs
+#include <chrono>
 #include <ios>
 #include <string>
 #include <thread>
@@ -194,6 +195,75 @@ TEST(MsgFramev0, BasicReadWrite) {
       sizeof(MsgFrameHeader_v0) + sizeof(TestStruct));
 }
 
+// Validation must not modify the underlying buffer, so several readers can
+// validate the same frame concurrently
+TEST(MsgFramev0, IsValidIsReadOnly) {
+  unique_ptr<uint8_t[]> buf(new uint8_t[BUF_SIZE]);
+  ASSERT_TRUE(buf);
+  fillRandBytes(buf.get(), BUF_SIZE);
+
+  MplexMsgFrame<MsgFrameHeader_v0> msgFrame(buf.get(), BUF_SIZE);
+  for (uint32_t i = 0; i < 100; i++) {
+    EXPECT_TRUE(msgFrame.writeData(i));
+  }
+  EXPECT_TRUE(msgFrame.writeHeader(5));
+
+  vector<uint8_t> snapshot(buf.get(), buf.get() + BUF_SIZE);
+  EXPECT_TRUE(msgFrame.isValid());
+  EXPECT_TRUE(memcmp(snapshot.data(), buf.get(), BUF_SIZE) == 0);
+
+  const uint32_t NUM_READERS = 4;
+  vector<thread> readers;
+  vector<uint32_t> numValid(NUM_READERS, 0);
+  for (uint32_t r = 0; r < NUM_READERS; r++) {
+    readers.emplace_back([&, r]() {
+      MplexMsgFrame<MsgFrameHeader_v0> reader(buf.get(), BUF_SIZE,
+                                              MplexOpMode::READ);
+      for (uint32_t i = 0; i < 10000; i++) {
+        numValid[r] += reader.isValid();
+      }
+    });
+  }
+  for (auto& thr : readers) {
+    thr.join();
+  }
+
+  for (uint32_t r = 0; r < NUM_READERS; r++) {
+    EXPECT_EQ(numValid[r], 10000U);
+  }
+  EXPECT_TRUE(memcmp(snapshot.data(), buf.get(), BUF_SIZE) == 0);
+}
+
+// Headers can select a different CRC poly & bit order w/o changing layout
+TEST(MsgFramev0, CustomCRC) {
+  typedef MsgFrameHeaderCRC<MsgFrameHeader_v0, 0x2F2B, true> Header;
+  static_assert(sizeof(Header) == sizeof(MsgFrameHeader_v0));
+
+  unique_ptr<uint8_t[]> buf(new uint8_t[BUF_SIZE]);
+  unique_ptr<uint8_t[]> buf2(new uint8_t[BUF_SIZE]);
+  ASSERT_TRUE(buf && buf2);
+  memset(buf.get(), 0x0, BUF_SIZE);
+  memset(buf2.get(), 0x0, BUF_SIZE);
+
+  MplexMsgFrame<Header> msgFrame(buf.get(), BUF_SIZE);
+  MplexMsgFrame<MsgFrameHeader_v0> msgFrame2(buf2.get(), BUF_SIZE);
+  for (uint32_t i = 0; i < 100; i++) {
+    EXPECT_TRUE(msgFrame.writeData(i));
+    EXPECT_TRUE(msgFrame2.writeData(i));
+  }
+  EXPECT_TRUE(msgFrame.writeHeader(7));
+  EXPECT_TRUE(msgFrame2.writeHeader(7));
+  EXPECT_TRUE(msgFrame.isValid());
+  EXPECT_TRUE(msgFrame2.isValid());
+  EXPECT_NE(msgFrame.crc(), msgFrame2.crc());
+
+  // Each frame only validates w/ the CRC it was written w/
+  MplexMsgFrame<Header> reader(buf.get(), BUF_SIZE, MplexOpMode::READ);
+  MplexMsgFrame<Header> reader2(buf2.get(), BUF_SIZE, MplexOpMode::READ);
+  EXPECT_TRUE(reader.isValid());
+  EXPECT_FALSE(reader2.isValid());
+}
+
 TEST(MsgFramev0, ReadOnly) {
   // Create underlying buffer for MsgFrame
   unique_ptr<uint8_t[]> buf(new uint8_t[BUF_SIZE]);
@@ -453,6 +523,96 @@ TEST(MsgFramev0, ByteStuffDestuff) {
       sizeof(MsgFrameHeader_v0) + sizeof(TestStruct));
 }
 
+// The CRC is only recalculated after the frame changes
+TEST(MsgFramev0, ValidityCache) {
+  typedef MplexMsgFrame<MsgFrameHeader_v0> msg_t;
+  unique_ptr<uint8_t[]> buf(new uint8_t[BUF_SIZE]);
+  ASSERT_TRUE(buf);
+  memset(buf.get(), 0x0, BUF_SIZE);
+
+  msg_t msgFrame(buf.get(), BUF_SIZE);
+  msg_t::Stats before = msg_t::stats();
+  EXPECT_FALSE(msgFrame.isValid());
+  EXPECT_TRUE(msgFrame.msgSize() == 0);
+  EXPECT_EQ(msg_t::stats().crcs, before.crcs + 1);
+  EXPECT_EQ(msg_t::stats().cachedChecks, before.cachedChecks + 1);
+
+  // writeHeader() calculates the CRC, so the frame is known to be valid
+  const uint8_t avoidSeq[2] = {0x7E, 0x00};
+  EXPECT_TRUE(msgFrame.writeData(avoidSeq[0]));
+  EXPECT_TRUE(msgFrame.writeData(uint32_t(123456789)));
+  EXPECT_TRUE(msgFrame.writeHeader(10));
+  before = msg_t::stats();
+  for (uint32_t i = 0; i < 10; i++) {
+    EXPECT_TRUE(msgFrame.isValid());
+    EXPECT_TRUE(msgFrame.msgSize() == msgFrame.processedSize());
+  }
+  EXPECT_EQ(msg_t::stats().crcs, before.crcs);
+  EXPECT_EQ(msg_t::stats().cachedChecks, before.cachedChecks + 20);
+
+  // Each change re-checks the frame. Data appended after the length in the
+  // header doesn't affect validity, but stuffing the data within it does.
+  EXPECT_TRUE(msgFrame.writeData(uint8_t(1)));
+  EXPECT_TRUE(msgFrame.isValid());
+  EXPECT_TRUE(msgFrame.isValid());
+  EXPECT_EQ(msg_t::stats().crcs, before.crcs + 1);
+
+  EXPECT_TRUE(msgFrame.byteStuff(avoidSeq, 2) == 1);
+  EXPECT_FALSE(msgFrame.isValid());
+  EXPECT_EQ(msg_t::stats().crcs, before.crcs + 2);
+  EXPECT_TRUE(msgFrame.writeHeader(10));
+
+  // Readers validate once per reset()
+  msg_t reader(buf.get(), BUF_SIZE, MplexOpMode::READ);
+  before = msg_t::stats();
+  EXPECT_TRUE(reader.isValid());
+  EXPECT_TRUE(reader.isValid());
+  EXPECT_TRUE(reader.byteDestuff(avoidSeq, 2) == 1);
+  EXPECT_EQ(msg_t::stats().crcs, before.crcs + 1);
+  EXPECT_FALSE(reader.isValid()); // Length & CRC are now stale
+  EXPECT_EQ(msg_t::stats().crcs, before.crcs + 2);
+
+  // Changes made through another object need a reset() to be seen
+  EXPECT_TRUE(msgFrame.writeHeader(10));
+  EXPECT_FALSE(reader.isValid());
+  EXPECT_TRUE(reader.reset(buf.get(), BUF_SIZE, MplexOpMode::READ));
+  EXPECT_TRUE(reader.isValid());
+  EXPECT_EQ(msg_t::stats().crcs, before.crcs + 4);
+
+  // Copies keep the cached result
+  msg_t copy(reader);
+  before = msg_t::stats();
+  EXPECT_TRUE(copy.isValid());
+  EXPECT_EQ(msg_t::stats().crcs, before.crcs);
+}
+
+// A shared frame can be checked from several threads at once
+TEST(MsgFramev0, ConcurrentIsValid) {
+  typedef MplexMsgFrame<MsgFrameHeader_v0> msg_t;
+  unique_ptr<uint8_t[]> buf(new uint8_t[BUF_SIZE]);
+  memset(buf.get(), 0x0, BUF_SIZE);
+  {
+    msg_t writer(buf.get(), BUF_SIZE);
+    ASSERT_TRUE(writer.writeData(uint32_t(123456789)));
+    ASSERT_TRUE(writer.writeHeader(10));
+  }
+
+  const msg_t frame(buf.get(), BUF_SIZE, MplexOpMode::READ);
+  vector<uint32_t> nValid(4, 0);
+  vector<thread> threads;
+  for (size_t t = 0; t < nValid.size(); t++) {
+    threads.emplace_back([&frame, &nValid, t]() {
+      for (uint32_t i = 0; i < 10000; i++) {
+        nValid[t] += frame.isValid();
+      }
+    });
+  }
+  for (thread& thr : threads) {
+    thr.join();
+  }
+  EXPECT_EQ(nValid, vector<uint32_t>(nValid.size(), 10000));
+}
+
 TEST(MsgFramev0, RandDelimSeqInData) {
   const uint32_t NUM_LOOPS = 5000000;
   const uint16_t AVOID_SEQ_LEN = 4;
@@ -550,6 +710,155 @@ TEST(MsgFramev0, RandDelimSeqInData) {
 
 // TODO: Test End of Group message
 
+// Writes 'vals' w/ writeData() one at a time & w/ writeSpan(), checks that
+// both produce the same data & that readSpan() reads it back
+template <typename T>
+void expectSpanMatchesScalar(const vector<T>& vals) {
+  typedef MplexMsgFrame<MsgFrameHeader_v0> msg_t;
+  vector<uint8_t> buf(BUF_SIZE, 0);
+  vector<uint8_t> buf2(BUF_SIZE, 0);
+
+  msg_t scalarFrame(buf.data(), BUF_SIZE);
+  for (const T& val : vals) {
+    ASSERT_TRUE(scalarFrame.writeData(val));
+  }
+  msg_t spanFrame(buf2.data(), BUF_SIZE);
+  ASSERT_TRUE(spanFrame.writeSpan(vals.data(), vals.size()));
+  EXPECT_EQ(spanFrame.processedSize(), scalarFrame.processedSize());
+  EXPECT_EQ(buf, buf2);
+
+  EXPECT_TRUE(spanFrame.writeHeader(1));
+  EXPECT_TRUE(spanFrame.reset(buf2.data(), BUF_SIZE, MplexOpMode::READ));
+  vector<T> vals2(vals.size());
+  ASSERT_TRUE(spanFrame.readSpan(vals2.data(), vals2.size()));
+  EXPECT_TRUE(memcmp(vals.data(), vals2.data(), vals.size() * sizeof(T)) == 0);
+  EXPECT_EQ(spanFrame.processedSize(), scalarFrame.processedSize());
+}
+
+TEST(MsgFramev0, ReadWriteSpan) {
+  static default_random_engine eng(1);
+  uniform_int_distribution<uint64_t> distr;
+
+  for (size_t n : {size_t(0), size_t(1), size_t(7), size_t(40)}) {
+    vector<uint8_t> u8(n);
+    vector<uint16_t> u16(n);
+    vector<uint32_t> u32(n);
+    vector<uint64_t> u64(n);
+    vector<float> f32(n);
+    vector<double> f64(n);
+    vector<TestStruct> structs(n);
+    for (size_t i = 0; i < n; i++) {
+      uint64_t rnd = distr(eng);
+      u8[i] = static_cast<uint8_t>(rnd);
+      u16[i] = static_cast<uint16_t>(rnd);
+      u32[i] = static_cast<uint32_t>(rnd);
+      u64[i] = rnd;
+      f32[i] = static_cast<float>(rnd) / 3.0F;
+      f64[i] = static_cast<double>(rnd) / 7.0;
+      structs[i].a = static_cast<uint32_t>(rnd);
+    }
+
+    expectSpanMatchesScalar(u8);
+    expectSpanMatchesScalar(u16);
+    expectSpanMatchesScalar(u32);
+    expectSpanMatchesScalar(u64);
+    expectSpanMatchesScalar(f32);
+    expectSpanMatchesScalar(f64);
+    expectSpanMatchesScalar(structs);
+  }
+}
+
+TEST(MsgFramev0, SpanErrors) {
+  typedef MplexMsgFrame<MsgFrameHeader_v0> msg_t;
+  vector<uint8_t> buf(BUF_SIZE, 0);
+  const size_t MAX_FLOATS = (BUF_SIZE - sizeof(MsgFrameHeader_v0)) /
+                            sizeof(float);
+  vector<float> vals(MAX_FLOATS + 1, 1.5F);
+
+  msg_t msgFrame(buf.data(), BUF_SIZE, MplexOpMode::WRITE);
+  EXPECT_FALSE(msgFrame.writeSpan(vals.data(), MAX_FLOATS + 1));
+  EXPECT_FALSE(msgFrame.writeSpan(static_cast<float*>(nullptr), 1));
+  EXPECT_FALSE(msgFrame.readSpan(vals.data(), 1)); // WRITE only
+  EXPECT_EQ(msgFrame.processedSize(), sizeof(MsgFrameHeader_v0));
+
+  // Spans & single values may be mixed
+  EXPECT_TRUE(msgFrame.writeData(uint8_t(0xAB)));
+  EXPECT_TRUE(msgFrame.writeSpan(vals.data(), MAX_FLOATS - 1));
+  EXPECT_FALSE(msgFrame.writeSpan(vals.data(), 2));
+  EXPECT_TRUE(msgFrame.writeData(uint8_t(0xCD)));
+  EXPECT_TRUE(msgFrame.writeHeader(1));
+  ASSERT_TRUE(msgFrame.isValid());
+
+  msg_t reader(buf.data(), BUF_SIZE, MplexOpMode::READ);
+  uint8_t byte = 0;
+  EXPECT_FALSE(reader.writeSpan(vals.data(), 1)); // READ only
+  EXPECT_TRUE(reader.readData(byte));
+  EXPECT_EQ(byte, 0xAB);
+  vector<float> vals2(MAX_FLOATS - 1);
+  EXPECT_TRUE(reader.readSpan(vals2.data(), vals2.size()));
+  EXPECT_TRUE(memcmp(vals.data(), vals2.data(),
+                     vals2.size() * sizeof(float)) == 0);
+  EXPECT_TRUE(reader.readData(byte));
+  EXPECT_EQ(byte, 0xCD);
+}
+
+// Encodes & decodes a frame of float samples one at a time vs w/ spans
+TEST(MsgFramev0, SpanThroughput) {
+  typedef MplexMsgFrame<MsgFrameHeader_v0> msg_t;
+  const size_t NUM_SAMPLES = 256;
+  const uint32_t NUM_LOOPS = 20000;
+  vector<uint8_t> buf(BUF_SIZE, 0);
+  vector<float> samples(NUM_SAMPLES);
+  vector<float> samples2(NUM_SAMPLES);
+  for (size_t i = 0; i < NUM_SAMPLES; i++) {
+    samples[i] = static_cast<float>(i) * 0.25F;
+  }
+  msg_t msgFrame;
+
+  auto start = chrono::steady_clock::now();
+  for (uint32_t i = 0; i < NUM_LOOPS; i++) {
+    msgFrame.reset(buf.data(), BUF_SIZE);
+    for (const float& sample : samples) {
+      msgFrame.writeData(sample);
+    }
+  }
+  chrono::duration<double, nano> writeNs = chrono::steady_clock::now() - start;
+
+  start = chrono::steady_clock::now();
+  for (uint32_t i = 0; i < NUM_LOOPS; i++) {
+    msgFrame.reset(buf.data(), BUF_SIZE);
+    msgFrame.writeSpan(samples.data(), NUM_SAMPLES);
+  }
+  chrono::duration<double, nano> writeSpanNs =
+      chrono::steady_clock::now() - start;
+
+  start = chrono::steady_clock::now();
+  for (uint32_t i = 0; i < NUM_LOOPS; i++) {
+    msgFrame.reset(buf.data(), BUF_SIZE);
+    for (float& sample : samples2) {
+      msgFrame.readData(sample);
+    }
+  }
+  chrono::duration<double, nano> readNs = chrono::steady_clock::now() - start;
+
+  start = chrono::steady_clock::now();
+  for (uint32_t i = 0; i < NUM_LOOPS; i++) {
+    msgFrame.reset(buf.data(), BUF_SIZE);
+    msgFrame.readSpan(samples2.data(), NUM_SAMPLES);
+  }
+  chrono::duration<double, nano> readSpanNs =
+      chrono::steady_clock::now() - start;
+  EXPECT_EQ(samples, samples2);
+
+  fprintf(stderr, "%zu float samples (ns/frame):\n", NUM_SAMPLES);
+  fprintf(stderr, "  writeData: %8.0f  writeSpan: %8.0f (%.1fx)\n",
+          writeNs.count() / NUM_LOOPS, writeSpanNs.count() / NUM_LOOPS,
+          writeNs.count() / writeSpanNs.count());
+  fprintf(stderr, "  readData:  %8.0f  readSpan:  %8.0f (%.1fx)\n",
+          readNs.count() / NUM_LOOPS, readSpanNs.count() / NUM_LOOPS,
+          readNs.count() / readSpanNs.count());
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
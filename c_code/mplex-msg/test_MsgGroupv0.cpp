@@ -2,6 +2,7 @@
 #include "gtest/gtest-spi.h"
 
 // C++ libs
+#include <chrono>
 #include <ios>
 #include <string>
 #include <thread>
@@ -11,9 +12,13 @@
 
 // C libs
 #include <stdint.h>
+#include <unistd.h>
+#include <sys/uio.h>
 
 // Lib to be tesed
 #include "mplex_msg_group.hpp"
+#include "mplex_msg_gather.hpp"
+#include "../gtest-extras/msg_group_utils.hpp"
 
 // Max buffer size for MsgFrames
 // 1472 = 1500 - 20 - 8; to emulate MTU of 1500
@@ -528,6 +533,333 @@ TEST(MsgGroupv0, EndOfMsgInData) {
   ASSERT_TRUE(pMsg == nullptr);
 }
 
+// Parse a serialized group in place w/ a view; nothing should be copied.
+TEST(MsgGroupv0, ViewReadWrite) {
+  typedef MplexMsgGroup<MsgGroupHeader_v0, MsgFrameHeader_v0> group_t;
+  const uint16_t NUM_MSGS = 10;
+
+  group_t msgGroupWrite;
+  vector<TestStruct> rndDataList;
+  auto pMsg = msgGroupWrite.currFrame();
+  for (uint16_t i = 0; i < NUM_MSGS; i++, pMsg = msgGroupWrite.commitFrame()) {
+    ASSERT_TRUE(pMsg != nullptr);
+    TestStruct data = randTestStruct();
+    rndDataList.push_back(data);
+    EXPECT_TRUE(pMsg->writeData(data));
+    EXPECT_TRUE(pMsg->writeHeader(static_cast<uint8_t>(i)));
+  }
+  EXPECT_TRUE(msgGroupWrite.writeHeaderTrailer());
+
+  // Invalid buffers
+  const uint8_t* buf = msgGroupWrite.getBuf();
+  EXPECT_THROW(group_t(MPLEX_VIEW, nullptr, msgGroupWrite.processedSize()),
+               std::invalid_argument);
+  EXPECT_THROW(group_t(MPLEX_VIEW, buf, group_t::MIN_SIZE - 1),
+               std::invalid_argument);
+
+  group_t view(MPLEX_VIEW, buf, msgGroupWrite.processedSize());
+  EXPECT_TRUE(view.isView());
+  EXPECT_FALSE(msgGroupWrite.isView());
+  EXPECT_TRUE(view.getBuf() == buf);
+  ASSERT_TRUE(view.headerIsValid());
+  ASSERT_TRUE(view.numFrames() == NUM_MSGS);
+  ASSERT_TRUE(view.calcGroupSize() == msgGroupWrite.processedSize());
+
+  uint16_t loop = 0;
+  const uint8_t* expectedLoc = buf + sizeof(MsgGroupHeader_v0);
+  for (pMsg = view.currFrame(); pMsg != nullptr;
+       pMsg = view.nextValidFrame(), loop++) {
+    EXPECT_TRUE(pMsg->getBuf() == expectedLoc);
+    EXPECT_TRUE(pMsg->id() == loop);
+
+    TestStruct data;
+    EXPECT_TRUE(pMsg->readData(data));
+    EXPECT_TRUE(memcmp(&data, &rndDataList[loop], sizeof(TestStruct)) == 0);
+    expectedLoc += pMsg->msgSize();
+  }
+  EXPECT_TRUE(loop == NUM_MSGS);
+  EXPECT_TRUE(view.processedSize() == msgGroupWrite.processedSize());
+
+  // A view has no buffer to write to
+  EXPECT_FALSE(view.reset());
+  EXPECT_TRUE(view.commitFrame() == nullptr);
+  EXPECT_FALSE(view.writeHeaderTrailer());
+
+  // Re-point the view at a copy of the group & re-read it
+  vector<uint8_t> copy(buf, buf + msgGroupWrite.processedSize());
+  EXPECT_FALSE(view.resetView(copy.data(), group_t::MIN_SIZE - 1));
+  ASSERT_TRUE(view.resetView(copy.data(),
+                             static_cast<uint16_t>(copy.size())));
+  EXPECT_TRUE(view.getBuf() == copy.data());
+  ASSERT_TRUE(view.headerIsValid());
+  pMsg = view.currFrame();
+  ASSERT_TRUE(pMsg != nullptr);
+  EXPECT_TRUE(pMsg->getBuf() == copy.data() + sizeof(MsgGroupHeader_v0));
+  EXPECT_TRUE(pMsg->id() == 0);
+
+  // Owning groups become views too
+  ASSERT_TRUE(msgGroupWrite.resetView(copy.data(),
+                                      static_cast<uint16_t>(copy.size())));
+  EXPECT_TRUE(msgGroupWrite.isView());
+  EXPECT_TRUE(msgGroupWrite.numFrames() == NUM_MSGS);
+}
+
+// Gather frames from separate buffers into a group, send it w/ writev() and
+// read it back.
+TEST(MsgGroupv0, GatherWritev) {
+  typedef MplexMsgGroup<MsgGroupHeader_v0, MsgFrameHeader_v0> group_t;
+  typedef MplexMsgGroupGather<MsgGroupHeader_v0, MsgFrameHeader_v0> gather_t;
+  typedef MplexMsgFrame<MsgFrameHeader_v0> msg_t;
+  const uint16_t NUM_MSGS = 8;
+
+  // Frames 0-3 each get their own buffer, frames 4-7 are packed back-to-back
+  // in a common buffer & should share an iovec.
+  const uint16_t FRAME_SZ = sizeof(MsgFrameHeader_v0) + sizeof(TestStruct);
+  vector<vector<uint8_t>> bufs(4, vector<uint8_t>(FRAME_SZ));
+  vector<uint8_t> commonBuf(4 * FRAME_SZ);
+  vector<TestStruct> rndDataList;
+
+  gather_t gather;
+  for (uint16_t i = 0; i < NUM_MSGS; i++) {
+    uint8_t* buf = i < 4 ? bufs[i].data() :
+                           commonBuf.data() + (i - 4) * FRAME_SZ;
+    msg_t msg(buf, FRAME_SZ, MplexOpMode::WRITE);
+    TestStruct data = randTestStruct();
+    rndDataList.push_back(data);
+    EXPECT_TRUE(msg.writeData(data));
+
+    // Not valid until the header is written
+    EXPECT_FALSE(gather.addFrame(msg));
+    EXPECT_TRUE(msg.writeHeader(static_cast<uint8_t>(i)));
+    EXPECT_TRUE(gather.addFrame(msg));
+  }
+
+  // Frames must be exactly sized & not EoMG frames
+  EXPECT_FALSE(gather.addFrame(bufs[0].data(), FRAME_SZ - 1));
+  MsgFrameHeader_v0 endOfGroup;
+  EXPECT_FALSE(gather.addFrame(reinterpret_cast<uint8_t*>(&endOfGroup),
+                               sizeof(endOfGroup)));
+
+  ASSERT_TRUE(gather.writeHeaderTrailer());
+  EXPECT_TRUE(gather.numFrames() == NUM_MSGS);
+  EXPECT_TRUE(gather.numIovecs() == 1 + 4 + 1 + 1);
+  uint16_t expectedSize = sizeof(MsgGroupHeader_v0) +
+      NUM_MSGS * FRAME_SZ + sizeof(MsgFrameHeader_v0);
+  ASSERT_TRUE(gather.groupSize() == expectedSize);
+
+  int fds[2];
+  ASSERT_TRUE(pipe(fds) == 0);
+  ASSERT_TRUE(writev(fds[1], gather.iovecs(),
+                     static_cast<int>(gather.numIovecs())) == expectedSize);
+  vector<uint8_t> recvBuf(expectedSize);
+  ASSERT_TRUE(read(fds[0], recvBuf.data(), recvBuf.size()) == expectedSize);
+  close(fds[0]);
+  close(fds[1]);
+
+  group_t view(MPLEX_VIEW, recvBuf.data(), expectedSize);
+  ASSERT_TRUE(view.headerIsValid());
+  ASSERT_TRUE(view.numFrames() == NUM_MSGS);
+  ASSERT_TRUE(view.calcGroupSize() == expectedSize);
+
+  uint16_t loop = 0;
+  for (auto pMsg = view.currFrame(); pMsg != nullptr;
+       pMsg = view.nextValidFrame(), loop++) {
+    EXPECT_TRUE(pMsg->id() == loop);
+    TestStruct data;
+    EXPECT_TRUE(pMsg->readData(data));
+    EXPECT_TRUE(memcmp(&data, &rndDataList[loop], sizeof(TestStruct)) == 0);
+  }
+  EXPECT_TRUE(loop == NUM_MSGS);
+
+  // Adding a frame after the trailer moves the trailer after it
+  EXPECT_TRUE(gather.addFrame(bufs[0].data(), FRAME_SZ));
+  EXPECT_TRUE(gather.numIovecs() == 1 + 4 + 1 + 1);
+  ASSERT_TRUE(gather.writeHeaderTrailer());
+  EXPECT_TRUE(gather.numIovecs() == 1 + 4 + 1 + 1 + 1);
+  EXPECT_TRUE(gather.groupSize() == expectedSize + FRAME_SZ);
+
+  gather.reset();
+  EXPECT_TRUE(gather.numFrames() == 0);
+  EXPECT_TRUE(gather.numIovecs() == 1);
+  ASSERT_TRUE(gather.writeHeaderTrailer());
+  EXPECT_TRUE(gather.groupSize() == group_t::MIN_SIZE);
+}
+
+// Byte-by-byte resync w/ a frame reset & CRC at every MAGIC_NUMBER byte, as
+// nextValidFrame() used to do. Returns the IDs of the valid frames found.
+vector<uint32_t> refScanIds(uint8_t* buf, uint16_t sz) {
+  typedef MplexMsgFrame<MsgFrameHeader_v0> msg_t;
+  vector<uint32_t> ids;
+  msg_t frame;
+  uint8_t* end = buf + sz;
+  for (uint8_t* p = buf + sizeof(MsgGroupHeader_v0); p < end; p++) {
+    if (*p != MsgFrameHeader_v0::MAGIC_NUMBER) {
+      continue;
+    }
+
+    uint16_t remainSz = min(static_cast<uint16_t>(end - p), msg_t::MAX_SIZE);
+    if (remainSz < sizeof(MsgFrameHeader_v0)) {
+      break;
+    }
+
+    frame.reset(p, remainSz, MplexOpMode::READ);
+    if (frame.isEndOfMsgGroup()) {
+      break;
+    } else if (frame.isValid()) {
+      ids.push_back(frame.id());
+      p += frame.msgSize() - 1;
+    }
+  }
+
+  return ids;
+}
+
+// Returns the IDs of the valid frames found w/ nextValidFrame()
+template <typename Group>
+vector<uint32_t> scanIds(Group& group) {
+  vector<uint32_t> ids;
+  auto pMsg = group.currFrame();
+  if (pMsg->isValid() == false) {
+    pMsg = group.nextValidFrame();
+  }
+  for (; pMsg != nullptr; pMsg = group.nextValidFrame()) {
+    ids.push_back(pMsg->id());
+  }
+
+  return ids;
+}
+
+// Writes a group of TestStruct frames into a 'sz'-byte buffer
+vector<uint8_t> writeTestGroup(uint16_t sz) {
+  typedef MplexMsgGroup<MsgGroupHeader_v0, MsgFrameHeader_v0> group_t;
+  auto writeFrame = [](group_t::msg_t& frame, size_t frameNum) {
+    if (frame.writeData(randTestStruct()) == false) {
+      return false;
+    }
+    frame.writeHeader(static_cast<uint8_t>(frameNum % 100));
+    return true;
+  };
+
+  return TestUtils::writeGroup<group_t>(sz, writeFrame);
+}
+
+// Resyncing over corrupted groups & noise must find the same frames as the
+// byte-by-byte scan
+TEST(MsgGroupv0, ResyncMatchesReference) {
+  typedef MplexMsgGroup<MsgGroupHeader_v0, MsgFrameHeader_v0> group_t;
+  default_random_engine eng(1);
+  uniform_int_distribution<uint8_t> byteDistr;
+
+  for (uint32_t i = 0; i < 2000; i++) {
+    vector<uint8_t> buf = writeTestGroup(BUF_SIZE);
+    uniform_int_distribution<size_t> posDistr(sizeof(MsgGroupHeader_v0),
+                                              buf.size() - 1);
+
+    // Corrupt some bytes, or replace the frames w/ noise altogether
+    if (i % 4 == 0) {
+      for (size_t k = sizeof(MsgGroupHeader_v0); k < buf.size(); k++) {
+        buf[k] = byteDistr(eng);
+      }
+    } else {
+      for (uint32_t k = 0; k < i % 16; k++) {
+        buf[posDistr(eng)] = k % 2 ? MsgFrameHeader_v0::MAGIC_NUMBER :
+                                     byteDistr(eng);
+      }
+    }
+
+    vector<uint32_t> refIds = refScanIds(buf.data(),
+                                         static_cast<uint16_t>(buf.size()));
+    group_t view(MPLEX_VIEW, buf.data(), static_cast<uint16_t>(buf.size()));
+    ASSERT_EQ(scanIds(view), refIds);
+  }
+}
+
+// Benchmarks resyncing over corrupted groups & noise vs the byte-by-byte scan
+TEST(MsgGroupv0, ResyncThroughput) {
+  typedef MplexMsgGroup<MsgGroupHeader_v0, MsgFrameHeader_v0> group_t;
+  const uint32_t NUM_LOOPS = 2000;
+  default_random_engine eng(1);
+  uniform_int_distribution<uint8_t> byteDistr;
+
+  // Every other frame has its magic number corrupted
+  vector<uint8_t> corrupted = writeTestGroup(BUF_SIZE);
+  const size_t FRAME_SZ = sizeof(MsgFrameHeader_v0) + sizeof(TestStruct);
+  for (size_t k = sizeof(MsgGroupHeader_v0); k + FRAME_SZ < corrupted.size();
+       k += 2 * FRAME_SZ) {
+    corrupted[k] = 0;
+  }
+
+  // An MTU's worth of random bytes
+  vector<uint8_t> noise(BUF_SIZE);
+  for (uint8_t& byte : noise) {
+    byte = byteDistr(eng);
+  }
+
+  // A mostly-empty maximum-size buffer w/ the odd stray magic number
+  vector<uint8_t> sparse(group_t::MAX_SIZE, 0);
+  for (size_t k = 1000; k < sparse.size(); k += 4096) {
+    sparse[k] = MsgFrameHeader_v0::MAGIC_NUMBER;
+  }
+
+  struct Case {
+    const char* name;
+    vector<uint8_t>& buf;
+  } cases[] = {{"corrupted group", corrupted}, {"noise", noise},
+               {"sparse 64 KiB", sparse}};
+
+  group_t view(MPLEX_VIEW, noise.data(), BUF_SIZE);
+  fprintf(stderr, "Resyncing (ns/buffer):\n");
+  for (Case& c : cases) {
+    uint16_t sz = static_cast<uint16_t>(c.buf.size());
+    [[maybe_unused]] volatile size_t found = 0;
+
+    auto start = chrono::steady_clock::now();
+    for (uint32_t i = 0; i < NUM_LOOPS; i++) {
+      found = refScanIds(c.buf.data(), sz).size();
+    }
+    chrono::duration<double, nano> refNs = chrono::steady_clock::now() - start;
+
+    start = chrono::steady_clock::now();
+    for (uint32_t i = 0; i < NUM_LOOPS; i++) {
+      view.resetView(c.buf.data(), sz);
+      found = scanIds(view).size();
+    }
+    chrono::duration<double, nano> ns = chrono::steady_clock::now() - start;
+
+    EXPECT_EQ(found, refScanIds(c.buf.data(), sz).size());
+    fprintf(stderr, "  %-16s byte-by-byte: %8.0f  nextValidFrame: %8.0f "
+            "(%.1fx)\n", c.name, refNs.count() / NUM_LOOPS,
+            ns.count() / NUM_LOOPS, refNs.count() / ns.count());
+  }
+}
+
+// Writing & reading back a group should CRC each frame once per pass
+TEST(MsgGroupv0, OneCRCPerFrame) {
+  typedef MplexMsgGroup<MsgGroupHeader_v0, MsgFrameHeader_v0> group_t;
+  typedef group_t::msg_t msg_t;
+  const uint64_t NUM_MSGS = 20;
+
+  group_t msgGroup;
+  msg_t::Stats before = msg_t::stats();
+  auto pMsg = msgGroup.currFrame();
+  for (uint8_t i = 0; i < NUM_MSGS; i++, pMsg = msgGroup.commitFrame()) {
+    ASSERT_TRUE(pMsg != nullptr);
+    EXPECT_TRUE(pMsg->writeData(randTestStruct()));
+    EXPECT_TRUE(pMsg->writeHeader(i));
+  }
+  EXPECT_TRUE(msgGroup.writeHeaderTrailer());
+  EXPECT_EQ(msg_t::stats().crcs, before.crcs + NUM_MSGS);
+
+  before = msg_t::stats();
+  group_t view(MPLEX_VIEW, msgGroup.getBuf(), msgGroup.processedSize());
+  EXPECT_EQ(scanIds(view).size(), NUM_MSGS);
+  EXPECT_EQ(msg_t::stats().crcs, before.crcs + NUM_MSGS);
+
+  before = msg_t::stats();
+  EXPECT_EQ(view.calcGroupSize(), msgGroup.processedSize());
+  EXPECT_EQ(msg_t::stats().crcs, before.crcs + NUM_MSGS);
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -0,0 +1,329 @@
+#include "gtest/gtest.h"
+
+// C++ libs
+#include <iostream>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+// C libs
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+// Lib to be tesed
+#include "mplex_msg_group.hpp"
+#include "mplex_msg_deframer.hpp"
+#include "mplex_msg_gather.hpp"
+
+using namespace std;
+
+// The frame header is picked from the group header's version
+typedef MplexMsgGroup<MsgGroupHeader_v1> group_t;
+typedef group_t::msg_t msg_t;
+static_assert(is_same_v<msg_t, MplexMsgFrame<MsgFrameHeader_v1>>);
+static_assert(is_same_v<MplexMsgGroup<MsgGroupHeader_v0>::msg_t,
+                        MplexMsgFrame<MsgFrameHeader_v0>>);
+
+// Largest frame data that fits in a group
+const uint16_t MAX_GROUP_DATA = group_t::MAX_SIZE -
+                                sizeof(MsgGroupHeader_v1) -
+                                2 * sizeof(MsgFrameHeader_v1);
+
+// Fields are Byte-aligned & big-endian
+TEST(MsgGroupv1, HeaderLayout) {
+  MsgFrameHeader_v1 frameHeader;
+  EXPECT_EQ(frameHeader.magic(), 0x7E);
+  EXPECT_EQ(frameHeader.id(), MsgFrameHeader_v1::END_OF_GROUP_ID);
+  EXPECT_EQ(frameHeader.len(), 0);
+  EXPECT_EQ(frameHeader.crc(), 0U);
+
+  frameHeader.id(0xAB);
+  frameHeader.len(0x1234);
+  frameHeader.crc(0xDEADBEEF);
+  const uint8_t frameBytes[] = {0x7E, 0xAB, 0x12, 0x34, 0xDE, 0xAD, 0xBE, 0xEF};
+  EXPECT_EQ(memcmp(&frameHeader, frameBytes, sizeof(frameBytes)), 0);
+  EXPECT_EQ(frameHeader.id(), 0xAB);
+  EXPECT_EQ(frameHeader.len(), 0x1234);
+  EXPECT_EQ(frameHeader.crc(), 0xDEADBEEF);
+
+  MsgGroupHeader_v1 groupHeader;
+  groupHeader.setMagic();
+  groupHeader.timestamp(0x0102030405060708);
+  groupHeader.numFrames(0xA0B0);
+  groupHeader.headerLen(sizeof(MsgGroupHeader_v1));
+  groupHeader.hcrc(0xCAFEF00D);
+  const uint8_t groupBytes[] = {0xAA, 0x01, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+                                0x07, 0x08, 0xA0, 0xB0, 17, 0xCA, 0xFE, 0xF0,
+                                0x0D};
+  EXPECT_EQ(memcmp(&groupHeader, groupBytes, sizeof(groupBytes)), 0);
+  EXPECT_EQ(groupHeader.vers(), 1);
+  EXPECT_EQ(groupHeader.timestamp(), 0x0102030405060708U);
+  EXPECT_EQ(groupHeader.numFrames(), 0xA0B0);
+
+  groupHeader.timestamp(3, 500);
+  EXPECT_EQ(groupHeader.timestamp(), 3000000500U);
+}
+
+// A single frame can fill a whole group
+TEST(MsgGroupv1, JumboFrame) {
+  const uint16_t maxData = msg_t::MAX_DATA;
+  const uint16_t maxData_v0 = MplexMsgFrame<MsgFrameHeader_v0>::MAX_DATA;
+  const uint16_t maxSize = group_t::MAX_SIZE;
+  EXPECT_EQ(maxData, UINT16_MAX - sizeof(MsgFrameHeader_v1));
+  EXPECT_GT(MAX_GROUP_DATA, 30 * maxData_v0);
+
+  vector<uint8_t> data(MAX_GROUP_DATA);
+  default_random_engine eng(1);
+  uniform_int_distribution<uint16_t> distr(0, 255);
+  for (uint8_t& byte : data) {
+    byte = static_cast<uint8_t>(distr(eng));
+  }
+
+  struct timespec before;
+  timespec_get(&before, TIME_UTC);
+  group_t msgGroup;
+  msg_t* pMsg = msgGroup.currFrame();
+  ASSERT_TRUE(pMsg->writeSpan(data.data(), data.size()));
+  ASSERT_TRUE(pMsg->writeHeader(200));
+  EXPECT_TRUE(pMsg->isValid());
+  msgGroup.commitFrame();
+  ASSERT_TRUE(msgGroup.writeHeaderTrailer());
+  EXPECT_EQ(msgGroup.processedSize(), maxSize);
+
+  group_t view(MPLEX_VIEW, msgGroup.getBuf(), msgGroup.processedSize());
+  ASSERT_TRUE(view.headerIsValid());
+  EXPECT_EQ(view.numFrames(), 1);
+  EXPECT_EQ(view.calcGroupSize(), maxSize);
+  uint64_t nsec = uint64_t(before.tv_sec) * 1000000000 +
+                  uint64_t(before.tv_nsec);
+  EXPECT_GE(view.timestamp(), nsec);
+  EXPECT_LT(view.timestamp() - nsec, 60000000000U);
+
+  pMsg = view.currFrame();
+  ASSERT_TRUE(pMsg->isValid());
+  EXPECT_EQ(pMsg->id(), 200);
+  EXPECT_EQ(pMsg->len(), MAX_GROUP_DATA);
+  vector<uint8_t> readBack(MAX_GROUP_DATA);
+  ASSERT_TRUE(pMsg->readSpan(readBack.data(), readBack.size()));
+  EXPECT_EQ(readBack, data);
+  pMsg = view.nextValidFrame();
+  EXPECT_TRUE(pMsg == nullptr || pMsg->isEndOfMsgGroup());
+}
+
+// More frames than v0's 11-bit count allows, w/ a corrupted one skipped
+TEST(MsgGroupv1, ManyFrames) {
+  const uint16_t NUM_FRAMES = 5000;
+  group_t msgGroup;
+  msg_t* pMsg = msgGroup.currFrame();
+  for (uint16_t i = 0; i < NUM_FRAMES; i++) {
+    ASSERT_TRUE(pMsg != nullptr);
+    ASSERT_TRUE(pMsg->writeData(uint32_t(i)));
+    ASSERT_TRUE(pMsg->writeHeader(static_cast<uint8_t>(i)));
+    pMsg = msgGroup.commitFrame();
+  }
+  ASSERT_TRUE(msgGroup.writeHeaderTrailer());
+
+  vector<uint8_t> bytes(msgGroup.getBuf(),
+                        msgGroup.getBuf() + msgGroup.processedSize());
+  group_t view(MPLEX_VIEW, bytes.data(), static_cast<uint16_t>(bytes.size()));
+  ASSERT_TRUE(view.headerIsValid());
+  EXPECT_EQ(view.numFrames(), NUM_FRAMES);
+  EXPECT_EQ(view.calcGroupSize(), bytes.size());
+
+  // Flip a bit in the data of frame 1000
+  const size_t frameSz = sizeof(MsgFrameHeader_v1) + sizeof(uint32_t);
+  bytes[sizeof(MsgGroupHeader_v1) + 1000 * frameSz +
+        sizeof(MsgFrameHeader_v1)] ^= 0x10;
+  view.resetView(bytes.data(), static_cast<uint16_t>(bytes.size()));
+
+  uint32_t expected = 0;
+  pMsg = view.currFrame();
+  if (pMsg->isValid() == false) {
+    pMsg = view.nextValidFrame();
+  }
+  for (; pMsg != nullptr && pMsg->isEndOfMsgGroup() == false;
+       pMsg = view.nextValidFrame()) {
+    if (expected == 1000) {
+      expected++;
+    }
+    uint32_t val = 0;
+    ASSERT_TRUE(pMsg->readData(val));
+    EXPECT_EQ(val, expected);
+    EXPECT_EQ(pMsg->id(), static_cast<uint8_t>(expected));
+    expected++;
+  }
+  EXPECT_EQ(expected, NUM_FRAMES);
+}
+
+// A valid frame followed by a corrupted header is still found
+TEST(MsgGroupv1, CorruptedSuccessor) {
+  const uint8_t NUM_FRAMES = 14;
+  group_t msgGroup;
+  msg_t* pMsg = msgGroup.currFrame();
+  for (uint8_t i = 0; i < NUM_FRAMES; i++) {
+    ASSERT_TRUE(pMsg != nullptr);
+    ASSERT_TRUE(pMsg->writeData(uint32_t(i)));
+    ASSERT_TRUE(pMsg->writeHeader(i));
+    pMsg = msgGroup.commitFrame();
+  }
+  ASSERT_TRUE(msgGroup.writeHeaderTrailer());
+
+  // Flip frame 12's MAGIC_NUMBER
+  vector<uint8_t> bytes(msgGroup.getBuf(),
+                        msgGroup.getBuf() + msgGroup.processedSize());
+  const size_t frameSz = sizeof(MsgFrameHeader_v1) + sizeof(uint32_t);
+  bytes[sizeof(MsgGroupHeader_v1) + 12 * frameSz] ^= 0x01;
+  group_t view(MPLEX_VIEW, bytes.data(), static_cast<uint16_t>(bytes.size()));
+  ASSERT_TRUE(view.headerIsValid());
+
+  vector<uint32_t> vals;
+  pMsg = view.currFrame();
+  if (pMsg->isValid() == false) {
+    pMsg = view.nextValidFrame();
+  }
+  for (; pMsg != nullptr && pMsg->isEndOfMsgGroup() == false;
+       pMsg = view.nextValidFrame()) {
+    uint32_t val = 0;
+    ASSERT_TRUE(pMsg->readData(val));
+    vals.push_back(val);
+  }
+
+  vector<uint32_t> expected;
+  for (uint32_t i = 0; i < NUM_FRAMES; i++) {
+    if (i != 12) {
+      expected.push_back(i);
+    }
+  }
+  EXPECT_EQ(vals, expected);
+}
+
+// Resyncing over noise dense in MAGIC_NUMBERs mustn't CRC much more per byte
+// than v0 does at worst (one max-size v0 frame per byte), despite v1's 16-bit
+// length letting each candidate claim up to 64 KiB
+TEST(MsgGroupv1, ResyncCost) {
+  const double MAX_CRC_BYTES_PER_BYTE =
+      MplexMsgFrame<MsgFrameHeader_v0>::MAX_SIZE;
+  default_random_engine eng(1);
+  uniform_int_distribution<uint16_t> byteDistr(0, 255);
+
+  // 1 in 'oneIn' bytes are MAGIC_NUMBERs
+  const uint16_t DENSITIES[] = {1, 2, 4, 16, 256};
+  vector<uint8_t> noise(group_t::MAX_SIZE);
+  for (uint16_t oneIn : DENSITIES) {
+    uniform_int_distribution<uint16_t> magicDistr(1, oneIn);
+    for (uint8_t& byte : noise) {
+      byte = magicDistr(eng) == 1 ? MsgFrameHeader_v1::MAGIC_NUMBER :
+                                    static_cast<uint8_t>(byteDistr(eng));
+    }
+
+    msg_t::Stats before = msg_t::stats();
+    group_t view(MPLEX_VIEW, noise.data(),
+                 static_cast<uint16_t>(noise.size()));
+    view.calcGroupSize();
+    msg_t* pMsg = view.currFrame();
+    if (pMsg->isValid() == false) {
+      pMsg = view.nextValidFrame();
+    }
+    for (; pMsg != nullptr; pMsg = view.nextValidFrame()) {}
+
+    double crcBytesPerByte =
+        double(msg_t::stats().crcBytes - before.crcBytes) /
+        double(noise.size());
+    cout << "1 in " << oneIn << " bytes MAGIC_NUMBERs: " << crcBytesPerByte
+         << " CRC bytes/byte" << endl;
+    EXPECT_LE(crcBytesPerByte, MAX_CRC_BYTES_PER_BYTE);
+  }
+}
+
+// Writes a one-frame group into 'msgGroup', returning its header's bytes
+vector<uint8_t> writeOneFrame(group_t& msgGroup, uint32_t val) {
+  msg_t* pMsg = msgGroup.currFrame();
+  EXPECT_TRUE(pMsg->writeData(val));
+  EXPECT_TRUE(pMsg->writeHeader(1));
+  msgGroup.commitFrame();
+  EXPECT_TRUE(msgGroup.writeHeaderTrailer());
+  return vector<uint8_t>(msgGroup.getBuf(),
+                         msgGroup.getBuf() + sizeof(MsgGroupHeader_v1));
+}
+
+// A reset group is rewritten w/ its version intact
+TEST(MsgGroupv1, ResetKeepsVersion) {
+  const vers_t VERS = MsgGroupHeader_v1::VERS;
+  group_t msgGroup(1472);
+  vector<uint8_t> header = writeOneFrame(msgGroup, 1);
+  EXPECT_EQ(header[1], VERS);
+
+  ASSERT_TRUE(msgGroup.reset());
+  header = writeOneFrame(msgGroup, 2);
+  EXPECT_EQ(header[1], VERS);
+  EXPECT_TRUE(msgGroup.headerIsValid());
+
+  // Same for a gathered group
+  typedef MplexMsgGroupGather<MsgGroupHeader_v1, MsgFrameHeader_v1> gather_t;
+  gather_t gather;
+  gather.reset();
+  ASSERT_TRUE(gather.addFrame(msgGroup.getBuf() + sizeof(MsgGroupHeader_v1),
+                              sizeof(MsgFrameHeader_v1) + sizeof(uint32_t)));
+  ASSERT_TRUE(gather.writeHeaderTrailer());
+  const struct iovec& iov = gather.iovecs()[0];
+  ASSERT_EQ(iov.iov_len, sizeof(MsgGroupHeader_v1));
+  EXPECT_EQ(static_cast<const uint8_t*>(iov.iov_base)[1], VERS);
+}
+
+// A header of another version is rejected, even w/ a matching CRC
+TEST(MsgGroupv1, VersionMismatch) {
+  group_t msgGroup(1472);
+  writeOneFrame(msgGroup, 1);
+  vector<uint8_t> buf(msgGroup.getBuf(),
+                      msgGroup.getBuf() + msgGroup.processedSize());
+  ASSERT_TRUE(group_t::headerIsValid(buf.data()));
+
+  MsgGroupHeader_v1 header;
+  memcpy((void*)&header, buf.data(), sizeof(header));
+  EXPECT_EQ(header.vers(), 1);
+  buf[1] = 0;
+  memcpy((void*)&header, buf.data(), sizeof(header));
+  header.hcrc(0);
+  header.hcrc(CRCUtils::CRC<MsgGroupHeader_v1::HCRC_WIDTH>(
+      reinterpret_cast<const uint8_t*>(&header), sizeof(header),
+      CRC_INIT & MsgGroupHeader_v1::hcrc_t::max_value));
+  memcpy(buf.data(), (const void*)&header, sizeof(header));
+  EXPECT_FALSE(group_t::headerIsValid(buf.data()));
+
+  group_t view(MPLEX_VIEW, buf.data(), static_cast<uint16_t>(buf.size()));
+  EXPECT_FALSE(view.headerIsValid());
+}
+
+// Classes built on MplexMsgGroup take v1 headers as-is
+TEST(MsgGroupv1, Deframer) {
+  vector<uint8_t> stream;
+  for (uint16_t i = 0; i < 3; i++) {
+    group_t msgGroup;
+    msg_t* pMsg = msgGroup.currFrame();
+    vector<uint8_t> data(10000U * (i + 1U), static_cast<uint8_t>(i));
+    ASSERT_TRUE(pMsg->writeSpan(data.data(), data.size()));
+    ASSERT_TRUE(pMsg->writeHeader(static_cast<uint8_t>(i)));
+    msgGroup.commitFrame();
+    ASSERT_TRUE(msgGroup.writeHeaderTrailer());
+    stream.insert(stream.end(), msgGroup.getBuf(),
+                  msgGroup.getBuf() + msgGroup.processedSize());
+  }
+
+  vector<uint32_t> lens;
+  MplexMsgDeframer<MsgGroupHeader_v1> deframer([&lens](
+      MplexMsgDeframer<MsgGroupHeader_v1>::group_t& group) {
+    msg_t* pMsg = group.currFrame();
+    ASSERT_TRUE(pMsg->isValid());
+    lens.push_back(pMsg->len());
+  });
+  for (size_t i = 0; i < stream.size(); i += 1472) {
+    deframer.push(stream.data() + i, min<size_t>(1472, stream.size() - i));
+  }
+  EXPECT_EQ(lens, vector<uint32_t>({10000, 20000, 30000}));
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
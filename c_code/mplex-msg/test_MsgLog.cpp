@@ -0,0 +1,350 @@
+#include "gtest/gtest.h"
+
+// C++ libs
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+// C libs
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Lib to be tesed
+#include "mplex_msg_log.hpp"
+#include "../gtest-extras/msg_group_utils.hpp"
+
+// 1472 = 1500 - 20 - 8; to emulate MTU of 1500
+#define BUF_SIZE 1472
+
+using namespace std;
+
+typedef MplexMsgLogWriter<MsgGroupHeader_v0, MsgFrameHeader_v0> writer_t;
+typedef MplexMsgLogReader<MsgGroupHeader_v0, MsgFrameHeader_v0> reader_t;
+typedef writer_t::group_t group_t;
+typedef vector<uint8_t> bytes_t;
+
+// Writes a group of random-length frames into a 'sz'-byte buffer
+bytes_t writeGroup(default_random_engine& eng, uint16_t sz, size_t& nFrames) {
+  return TestUtils::writeRandomGroup<group_t>(eng, sz, &nFrames);
+}
+
+// Fresh log path in a temporary directory, removed afterwards
+class MsgLog : public ::testing::Test {
+  protected:
+    string dir_;
+    string path_;
+
+    void SetUp() override {
+      char tmpl[] = "/tmp/mplex_log_XXXXXX";
+      ASSERT_TRUE(mkdtemp(tmpl) != nullptr);
+      dir_ = tmpl;
+      path_ = dir_ + "/groups.log";
+    }
+
+    void TearDown() override {
+      unlink(path_.c_str());
+      unlink(MplexLogFormat::indexPath(path_).c_str());
+      rmdir(dir_.c_str());
+    }
+
+    void appendRaw(const string& path, const uint8_t* data, size_t sz) {
+      ofstream out(path, ios::binary | ios::app);
+      out.write(reinterpret_cast<const char*>(data),
+                static_cast<streamsize>(sz));
+    }
+};
+
+TEST_F(MsgLog, AppendAndRead) {
+  default_random_engine eng(1);
+  vector<bytes_t> groups;
+  size_t totalFrames = 0;
+  {
+    writer_t writer(path_);
+    for (int i = 0; i < 100; i++) {
+      size_t nFrames = 0;
+      groups.push_back(writeGroup(eng, BUF_SIZE, nFrames));
+      totalFrames += nFrames;
+      ASSERT_TRUE(writer.append(groups.back().data(),
+                                static_cast<uint16_t>(groups.back().size())));
+    }
+
+    // Complete WRITE-mode groups can be appended directly
+    group_t msgGroup;
+    ASSERT_TRUE(msgGroup.writeHeaderTrailer());
+    ASSERT_TRUE(writer.append(msgGroup));
+    groups.emplace_back(msgGroup.getBuf(),
+                        msgGroup.getBuf() + msgGroup.processedSize());
+
+    // Invalid groups aren't
+    bytes_t bad = groups[0];
+    bad[3] ^= 0xFF;
+    EXPECT_FALSE(writer.append(bad.data(), static_cast<uint16_t>(bad.size())));
+    EXPECT_TRUE(writer.sync());
+    EXPECT_EQ(writer.numGroups(), groups.size());
+  }
+
+  reader_t reader(path_);
+  ASSERT_EQ(reader.numGroups(), groups.size());
+  uint64_t offset = 0;
+  for (size_t i = 0; i < groups.size(); i++) {
+    MplexLogEntry entry = reader.entry(i);
+    EXPECT_EQ(entry.offset, offset);
+    EXPECT_EQ(entry.size, groups[i].size());
+    offset += entry.size;
+
+    group_t view = reader.group(i);
+    EXPECT_TRUE(view.isView());
+    ASSERT_TRUE(view.headerIsValid());
+    EXPECT_EQ(entry.timestamp, view.timestamp());
+    EXPECT_EQ(entry.numFrames, view.numFrames());
+    EXPECT_TRUE(memcmp(view.getBuf(), groups[i].data(),
+                       groups[i].size()) == 0);
+  }
+  EXPECT_THROW(reader.group(groups.size()), std::out_of_range);
+
+  // Frames wrap the mapping itself
+  size_t nFrames = reader.forEachFrame(0, reader.numGroups(),
+      [&](const MplexLogEntry& entry, reader_t::msg_t& frame) {
+    EXPECT_TRUE(frame.isValid());
+    EXPECT_TRUE(frame.getBuf() >= reader.group(0).getBuf() + entry.offset);
+    EXPECT_TRUE(frame.getBuf() < reader.group(0).getBuf() + entry.offset +
+                                 entry.size);
+  });
+  EXPECT_EQ(nFrames, totalFrames);
+}
+
+TEST_F(MsgLog, SeekByTime) {
+  default_random_engine eng(2);
+  writer_t writer(path_);
+  for (int i = 0; i < 50; i++) {
+    size_t nFrames = 0;
+    bytes_t group = writeGroup(eng, 200, nFrames);
+    ASSERT_TRUE(writer.append(group.data(),
+                              static_cast<uint16_t>(group.size())));
+  }
+
+  reader_t reader(path_);
+  ASSERT_EQ(reader.numGroups(), 50U);
+  EXPECT_EQ(reader.seek(0), 0U);
+  EXPECT_EQ(reader.seek(UINT64_MAX), reader.numGroups());
+  for (size_t i = 0; i < reader.numGroups(); i++) {
+    uint64_t ts = reader.entry(i).timestamp;
+    size_t pos = reader.seek(ts);
+    ASSERT_LE(pos, i);
+    EXPECT_EQ(reader.entry(pos).timestamp, ts);
+    if (pos > 0) {
+      EXPECT_LT(reader.entry(pos - 1).timestamp, ts);
+    }
+    EXPECT_EQ(reader.seek(ts + 1) > i, true);
+  }
+
+  // Groups appended later show up after a refresh
+  size_t nFrames = 0;
+  bytes_t group = writeGroup(eng, 200, nFrames);
+  ASSERT_TRUE(writer.append(group.data(),
+                            static_cast<uint16_t>(group.size())));
+  EXPECT_EQ(reader.numGroups(), 50U);
+  reader.refresh();
+  EXPECT_EQ(reader.numGroups(), 51U);
+}
+
+// Groups w/o index entries are indexed, & torn groups dropped, on reopening
+TEST_F(MsgLog, Recovery) {
+  default_random_engine eng(3);
+  vector<bytes_t> groups;
+  size_t nFrames = 0;
+  for (size_t i = 0; i < 6; i++) {
+    groups.push_back(writeGroup(eng, BUF_SIZE, nFrames));
+  }
+
+  {
+    writer_t writer(path_);
+    for (size_t i = 0; i < 3; i++) {
+      ASSERT_TRUE(writer.append(groups[i].data(),
+                                static_cast<uint16_t>(groups[i].size())));
+    }
+  }
+
+  // Crash after writing two more groups but not their index entries, while
+  // writing a third, and while writing an index entry
+  appendRaw(path_, groups[3].data(), groups[3].size());
+  appendRaw(path_, groups[4].data(), groups[4].size());
+  appendRaw(path_, groups[5].data(), groups[5].size() / 2);
+  uint8_t tornEntry[7] = {};
+  appendRaw(MplexLogFormat::indexPath(path_), tornEntry, sizeof(tornEntry));
+
+  uint64_t expectedSize = 0;
+  for (size_t i = 0; i < 5; i++) {
+    expectedSize += groups[i].size();
+  }
+  {
+    writer_t writer(path_);
+    EXPECT_EQ(writer.numGroups(), 5U);
+    EXPECT_EQ(writer.size(), expectedSize);
+    ASSERT_TRUE(writer.append(groups[5].data(),
+                              static_cast<uint16_t>(groups[5].size())));
+  }
+
+  reader_t reader(path_);
+  ASSERT_EQ(reader.numGroups(), groups.size());
+  for (size_t i = 0; i < groups.size(); i++) {
+    group_t view = reader.group(i);
+    ASSERT_EQ(view.getBufSize(), groups[i].size());
+    EXPECT_TRUE(memcmp(view.getBuf(), groups[i].data(),
+                       groups[i].size()) == 0);
+  }
+}
+
+// Frames in the mapping can be destuffed in place, w/o changing the log
+TEST_F(MsgLog, ModifyInPlace) {
+  const uint8_t avoidSeq[2] = {0x7E, 0x00};
+  group_t msgGroup;
+  group_t::msg_t* pMsg = msgGroup.currFrame();
+  ASSERT_TRUE(pMsg->writeData(avoidSeq[0]));
+  ASSERT_TRUE(pMsg->writeData(uint32_t(123456789)));
+  ASSERT_EQ(pMsg->byteStuff(avoidSeq, 2), 1);
+  ASSERT_TRUE(pMsg->writeHeader(10));
+  msgGroup.commitFrame();
+  ASSERT_TRUE(msgGroup.writeHeaderTrailer());
+  bytes_t bytes(msgGroup.getBuf(),
+                msgGroup.getBuf() + msgGroup.processedSize());
+  {
+    writer_t writer(path_);
+    ASSERT_TRUE(writer.append(msgGroup));
+  }
+
+  {
+    reader_t reader(path_);
+    size_t nFrames = reader.forEachFrame(0, 1,
+        [&](const MplexLogEntry&, reader_t::msg_t& frame) {
+      EXPECT_EQ(frame.byteDestuff(avoidSeq, 2), 1);
+    });
+    EXPECT_EQ(nFrames, 1U);
+  }
+
+  reader_t reader(path_);
+  group_t view = reader.group(0);
+  ASSERT_EQ(view.getBufSize(), bytes.size());
+  EXPECT_TRUE(memcmp(view.getBuf(), bytes.data(), bytes.size()) == 0);
+}
+
+// A failed index write leaves neither the group nor a torn entry behind
+TEST_F(MsgLog, IndexWriteFailure) {
+  // Empty groups are smaller than their index entries, so after enough of
+  // them a file size limit can fail an index write but not the group's
+  group_t msgGroup;
+  ASSERT_TRUE(msgGroup.writeHeaderTrailer());
+  const uint16_t groupSz = msgGroup.processedSize();
+  const size_t NUM_GROUPS = 10;
+  const size_t idxSize = MplexLogFormat::INDEX_HEADER_SIZE +
+                         NUM_GROUPS * MplexLogFormat::ENTRY_SIZE;
+  const rlim_t limit = idxSize + 6;
+  ASSERT_LE((NUM_GROUPS + 1) * groupSz, limit);
+
+  writer_t writer(path_);
+  for (size_t i = 0; i < NUM_GROUPS; i++) {
+    ASSERT_TRUE(writer.append(msgGroup));
+  }
+
+  struct rlimit orig;
+  ASSERT_EQ(getrlimit(RLIMIT_FSIZE, &orig), 0);
+  struct rlimit lowered = {limit, orig.rlim_max};
+  sighandler_t origHandler = signal(SIGXFSZ, SIG_IGN);
+  ASSERT_EQ(setrlimit(RLIMIT_FSIZE, &lowered), 0);
+  bool appended = writer.append(msgGroup);
+  ASSERT_EQ(setrlimit(RLIMIT_FSIZE, &orig), 0);
+  signal(SIGXFSZ, origHandler);
+
+  EXPECT_FALSE(appended);
+  EXPECT_EQ(writer.numGroups(), NUM_GROUPS);
+  EXPECT_EQ(writer.size(), NUM_GROUPS * groupSz);
+  struct stat st;
+  ASSERT_EQ(stat(path_.c_str(), &st), 0);
+  EXPECT_EQ(static_cast<uint64_t>(st.st_size), NUM_GROUPS * groupSz);
+  ASSERT_EQ(stat(MplexLogFormat::indexPath(path_).c_str(), &st), 0);
+  EXPECT_EQ(static_cast<size_t>(st.st_size), idxSize);
+
+  // The next group is indexed at the right offset
+  default_random_engine eng(4);
+  size_t nFrames = 0;
+  bytes_t bytes = writeGroup(eng, BUF_SIZE, nFrames);
+  ASSERT_TRUE(writer.append(bytes.data(), static_cast<uint16_t>(bytes.size())));
+
+  reader_t reader(path_);
+  ASSERT_EQ(reader.numGroups(), NUM_GROUPS + 1);
+  MplexLogEntry entry = reader.entry(NUM_GROUPS);
+  EXPECT_EQ(entry.offset, NUM_GROUPS * groupSz);
+  EXPECT_EQ(entry.size, bytes.size());
+  EXPECT_EQ(entry.numFrames, nFrames);
+  group_t view = reader.group(NUM_GROUPS);
+  EXPECT_TRUE(memcmp(view.getBuf(), bytes.data(), bytes.size()) == 0);
+}
+
+// Index entries pointing outside the log, or at less than a group, are
+// rejected rather than read
+TEST_F(MsgLog, CorruptIndex) {
+  default_random_engine eng(6);
+  size_t nFrames = 0;
+  {
+    writer_t writer(path_);
+    for (size_t i = 0; i < 3; i++) {
+      bytes_t bytes = writeGroup(eng, BUF_SIZE, nFrames);
+      ASSERT_TRUE(writer.append(bytes.data(),
+                                static_cast<uint16_t>(bytes.size())));
+    }
+  }
+
+  // Overwrites the middle group's entry w/ 'offset' & 'size'
+  string idxPath = MplexLogFormat::indexPath(path_);
+  auto corrupt = [&](uint64_t offset, uint16_t size) {
+    MplexLogEntry e = reader_t(path_).entry(1);
+    e.offset = offset;
+    e.size = size;
+    uint8_t raw[MplexLogFormat::ENTRY_SIZE];
+    MplexLogFormat::encodeEntry(raw, e);
+    fstream out(idxPath, ios::binary | ios::in | ios::out);
+    out.seekp(static_cast<streamoff>(MplexLogFormat::INDEX_HEADER_SIZE +
+                                     MplexLogFormat::ENTRY_SIZE));
+    out.write(reinterpret_cast<const char*>(raw), sizeof(raw));
+  };
+
+  struct stat st;
+  ASSERT_EQ(stat(path_.c_str(), &st), 0);
+  uint64_t segSize = static_cast<uint64_t>(st.st_size);
+  const uint64_t OFFSETS[] = {segSize, segSize - 10, UINT64_MAX - 10, 0};
+  const uint16_t SIZES[] = {100, 100, 100, group_t::MIN_SIZE - 1};
+  for (size_t i = 0; i < 4; i++) {
+    corrupt(OFFSETS[i], SIZES[i]);
+    reader_t reader(path_);
+    ASSERT_EQ(reader.numGroups(), 3U);
+    EXPECT_NO_THROW(reader.group(0));
+    EXPECT_NO_THROW(reader.group(2));
+    EXPECT_THROW(reader.group(1), std::runtime_error);
+    EXPECT_THROW(reader.forEachFrame(0, 3,
+                     [](const MplexLogEntry&, reader_t::msg_t&) {}),
+                 std::runtime_error);
+  }
+}
+
+TEST_F(MsgLog, Errors) {
+  EXPECT_THROW(reader_t{path_}, std::runtime_error);
+  EXPECT_THROW(writer_t{dir_ + "/missing/groups.log"}, std::runtime_error);
+
+  // Files that aren't logs are rejected
+  uint8_t junk[16] = {1, 2, 3};
+  appendRaw(path_, junk, sizeof(junk));
+  appendRaw(MplexLogFormat::indexPath(path_), junk, sizeof(junk));
+  EXPECT_THROW(writer_t{path_}, std::runtime_error);
+  EXPECT_THROW(reader_t{path_}, std::runtime_error);
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,246 @@
+#include "gtest/gtest.h"
+
+// C++ libs
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// C libs
+#include <stdint.h>
+#include <string.h>
+
+// Lib to be tesed
+#include "mplex_msg_schema.hpp"
+
+// 1472 = 1500 - 20 - 8; to emulate MTU of 1500
+#define BUF_SIZE 1472
+
+using namespace std;
+using MplexSchema::Endian;
+using MplexSchema::Field;
+using MplexSchema::Schema;
+
+typedef MplexMsgFrame<MsgFrameHeader_v0> msg_t;
+
+enum class Kind : uint8_t {
+  TEMP = 1,
+  PRESSURE = 2
+};
+
+struct Reading {
+  uint8_t sensor;
+  Kind kind;
+  bool ok;
+  uint16_t seq;
+  int32_t temp;
+  uint64_t ts;
+  double value;
+  float samples[4];
+  array<uint32_t, 2> extra;
+};
+
+// Natural widths, big-endian; same encoding as writeData() per field
+typedef Schema<Field<&Reading::sensor>, Field<&Reading::kind>,
+               Field<&Reading::ok>, Field<&Reading::seq>,
+               Field<&Reading::temp>, Field<&Reading::ts>,
+               Field<&Reading::value>, Field<&Reading::samples>,
+               Field<&Reading::extra>> ReadingSchema;
+
+// Resized & little-endian fields, in a different order than declared
+typedef Schema<Field<&Reading::ts, 4, Endian::LITTLE>,
+               Field<&Reading::temp, 2>,
+               Field<&Reading::seq, 1>,
+               Field<&Reading::sensor, 2, Endian::LITTLE>,
+               Field<&Reading::value, 0, Endian::LITTLE>> PackedSchema;
+
+static_assert(ReadingSchema::SIZE == 1 + 1 + 1 + 2 + 4 + 8 + 8 + 16 + 8);
+static_assert(PackedSchema::SIZE == 4 + 2 + 1 + 2 + 8);
+
+Reading randReading(default_random_engine& eng) {
+  uniform_int_distribution<uint64_t> distr;
+  Reading reading;
+  reading.sensor = static_cast<uint8_t>(distr(eng));
+  reading.kind = distr(eng) % 2 ? Kind::TEMP : Kind::PRESSURE;
+  reading.ok = distr(eng) % 2;
+  reading.seq = static_cast<uint16_t>(distr(eng));
+  reading.temp = static_cast<int32_t>(distr(eng));
+  reading.ts = distr(eng);
+  reading.value = static_cast<double>(distr(eng)) / 7.0;
+  for (float& sample : reading.samples) {
+    sample = static_cast<float>(distr(eng)) / 3.0F;
+  }
+  reading.extra = {static_cast<uint32_t>(distr(eng)),
+                   static_cast<uint32_t>(distr(eng))};
+
+  return reading;
+}
+
+void writeReadingScalar(msg_t& msgFrame, const Reading& reading) {
+  msgFrame.writeData(reading.sensor);
+  msgFrame.writeData(static_cast<uint8_t>(reading.kind));
+  msgFrame.writeData(static_cast<uint8_t>(reading.ok));
+  msgFrame.writeData(reading.seq);
+  msgFrame.writeData(static_cast<uint32_t>(reading.temp));
+  msgFrame.writeData(reading.ts);
+  msgFrame.writeData(reading.value);
+  for (const float& sample : reading.samples) {
+    msgFrame.writeData(sample);
+  }
+  for (const uint32_t& val : reading.extra) {
+    msgFrame.writeData(val);
+  }
+}
+
+void expectReadingsEq(const Reading& a, const Reading& b) {
+  EXPECT_EQ(a.sensor, b.sensor);
+  EXPECT_TRUE(a.kind == b.kind);
+  EXPECT_EQ(a.ok, b.ok);
+  EXPECT_EQ(a.seq, b.seq);
+  EXPECT_EQ(a.temp, b.temp);
+  EXPECT_EQ(a.ts, b.ts);
+  EXPECT_EQ(a.value, b.value);
+  EXPECT_TRUE(memcmp(a.samples, b.samples, sizeof(a.samples)) == 0);
+  EXPECT_TRUE(a.extra == b.extra);
+}
+
+// Encodes exactly as the equivalent sequence of writeData() calls
+TEST(MsgSchema, MatchesWriteData) {
+  default_random_engine eng(1);
+  vector<uint8_t> buf(BUF_SIZE, 0);
+  vector<uint8_t> buf2(BUF_SIZE, 0);
+
+  for (int i = 0; i < 100; i++) {
+    Reading reading = randReading(eng);
+
+    msg_t msgFrame(buf.data(), BUF_SIZE, MplexOpMode::WRITE);
+    writeReadingScalar(msgFrame, reading);
+    ASSERT_TRUE(msgFrame.writeHeader(1));
+
+    msg_t msgFrame2(buf2.data(), BUF_SIZE, MplexOpMode::WRITE);
+    ASSERT_TRUE(ReadingSchema::encode(msgFrame2, reading));
+    ASSERT_EQ(msgFrame2.processedSize(),
+              sizeof(MsgFrameHeader_v0) + ReadingSchema::SIZE);
+    ASSERT_TRUE(msgFrame2.writeHeader(1));
+    ASSERT_TRUE(msgFrame2.isValid());
+    ASSERT_EQ(msgFrame.msgSize(), msgFrame2.msgSize());
+    ASSERT_TRUE(memcmp(buf.data(), buf2.data(), msgFrame.msgSize()) == 0);
+
+    msg_t reader(buf.data(), BUF_SIZE, MplexOpMode::READ);
+    Reading reading2;
+    ASSERT_TRUE(ReadingSchema::decode(reader, reading2));
+    expectReadingsEq(reading, reading2);
+  }
+}
+
+TEST(MsgSchema, WidthsAndEndianness) {
+  Reading reading = {};
+  reading.ts = 0x1122334455667788ULL;
+  reading.temp = -2;
+  reading.seq = 0x1234;
+  reading.sensor = 0xAB;
+  reading.value = 1.5;
+
+  uint8_t buf[PackedSchema::SIZE];
+  PackedSchema::encodeTo(buf, reading);
+  const uint8_t expected[] = {
+    0x88, 0x77, 0x66, 0x55, // ts, truncated & little-endian
+    0xFF, 0xFE,             // temp, truncated
+    0x34,                   // seq, truncated
+    0xAB, 0x00,             // sensor, widened & little-endian
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF8, 0x3F // 1.5, little-endian
+  };
+  static_assert(sizeof(expected) == PackedSchema::SIZE);
+  EXPECT_TRUE(memcmp(buf, expected, sizeof(expected)) == 0);
+
+  // Narrowed signed fields are sign-extended; unlisted members are untouched
+  Reading reading2 = {};
+  reading2.ok = true;
+  PackedSchema::decodeFrom(buf, reading2);
+  EXPECT_EQ(reading2.ts, 0x55667788ULL);
+  EXPECT_EQ(reading2.temp, -2);
+  EXPECT_EQ(reading2.seq, 0x34);
+  EXPECT_EQ(reading2.sensor, 0xAB);
+  EXPECT_EQ(reading2.value, 1.5);
+  EXPECT_TRUE(reading2.ok);
+}
+
+TEST(MsgSchema, Errors) {
+  Reading reading = {};
+  vector<uint8_t> buf(BUF_SIZE, 0);
+  const size_t SMALL_SIZE = sizeof(MsgFrameHeader_v0) + ReadingSchema::SIZE;
+
+  // Only room for one encoded reading
+  msg_t msgFrame(buf.data(), SMALL_SIZE, MplexOpMode::WRITE);
+  EXPECT_FALSE(ReadingSchema::decode(msgFrame, reading)); // WRITE only
+  EXPECT_TRUE(msgFrame.writeData(uint8_t(0xAB)));
+  EXPECT_FALSE(ReadingSchema::encode(msgFrame, reading));
+  EXPECT_EQ(msgFrame.processedSize(), sizeof(MsgFrameHeader_v0) + 1);
+
+  msgFrame.reset(buf.data(), SMALL_SIZE, MplexOpMode::WRITE);
+  EXPECT_TRUE(ReadingSchema::encode(msgFrame, reading));
+  EXPECT_FALSE(ReadingSchema::encode(msgFrame, reading));
+  EXPECT_FALSE(msgFrame.claimWrite(1) != nullptr);
+  EXPECT_TRUE(msgFrame.writeHeader(1));
+  EXPECT_TRUE(msgFrame.isValid());
+
+  msg_t reader(buf.data(), SMALL_SIZE, MplexOpMode::READ);
+  EXPECT_FALSE(ReadingSchema::encode(reader, reading)); // READ only
+  EXPECT_TRUE(ReadingSchema::decode(reader, reading));
+  EXPECT_FALSE(ReadingSchema::decode(reader, reading));
+}
+
+// Encodes & decodes a frame of readings field by field vs w/ the schema
+TEST(MsgSchema, Throughput) {
+  const size_t NUM_READINGS = 20;
+  const uint32_t NUM_LOOPS = 20000;
+  default_random_engine eng(2);
+  vector<uint8_t> buf(BUF_SIZE, 0);
+  vector<Reading> readings(NUM_READINGS);
+  for (Reading& reading : readings) {
+    reading = randReading(eng);
+  }
+  msg_t msgFrame;
+
+  auto start = chrono::steady_clock::now();
+  for (uint32_t i = 0; i < NUM_LOOPS; i++) {
+    msgFrame.reset(buf.data(), BUF_SIZE);
+    for (const Reading& reading : readings) {
+      writeReadingScalar(msgFrame, reading);
+    }
+  }
+  chrono::duration<double, nano> writeNs = chrono::steady_clock::now() - start;
+
+  start = chrono::steady_clock::now();
+  for (uint32_t i = 0; i < NUM_LOOPS; i++) {
+    msgFrame.reset(buf.data(), BUF_SIZE);
+    for (const Reading& reading : readings) {
+      ReadingSchema::encode(msgFrame, reading);
+    }
+  }
+  chrono::duration<double, nano> encodeNs =
+      chrono::steady_clock::now() - start;
+
+  start = chrono::steady_clock::now();
+  Reading reading;
+  for (uint32_t i = 0; i < NUM_LOOPS; i++) {
+    msgFrame.reset(buf.data(), BUF_SIZE);
+    for (size_t j = 0; j < NUM_READINGS; j++) {
+      ReadingSchema::decode(msgFrame, reading);
+    }
+  }
+  chrono::duration<double, nano> decodeNs =
+      chrono::steady_clock::now() - start;
+  expectReadingsEq(reading, readings.back());
+
+  cout << "writeData(): " << writeNs.count() / NUM_LOOPS << " ns/frame, "
+       << "encode(): " << encodeNs.count() / NUM_LOOPS << " ns/frame, "
+       << "decode(): " << decodeNs.count() / NUM_LOOPS << " ns/frame"
+       << endl;
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}